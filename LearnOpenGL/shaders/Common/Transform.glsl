@@ -0,0 +1,26 @@
+#pragma once
+
+// model, view and projection matrices shared by every 3D vertex shader
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+#ifdef PRECOMPUTED_MVP
+// projection * view * model, multiplied on the CPU once per draw instead of once per vertex, see MatrixBatch
+uniform mat4 modelViewProjection;
+#endif
+
+// read the multiplication from right to left
+vec4 transformPosition(vec3 position)
+{
+#ifdef PRECOMPUTED_MVP
+    return modelViewProjection * vec4(position, 1.0);
+#else
+    return projection * view * model * vec4(position, 1.0);
+#endif
+}
+
+// same with a model matrix that does not come from the uniform, e.g. a per-draw attribute
+vec4 transformPosition(mat4 modelMatrix, vec3 position)
+{
+    return projection * view * modelMatrix * vec4(position, 1.0);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// decoding of the compressed VertexFormat attributes, the fixed function fetch already turned the
+// normalized integers and half floats into floats
+
+// PositionQuantization of the mesh, for Unorm16x3 positions
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+
+vec3 decodePosition(vec3 position)
+{
+    return position * positionScale + positionOffset;
+}
+
+// inverse of VertexEncoding::PackOctahedral: the octahedron is unfolded where the lower half was folded over it
+vec3 decodeOctahedral(vec2 encoded)
+{
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-n.z, 0.0);
+    n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0)));
+    return normalize(n);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+// page table and physical page atlas of a VirtualTexture, set by VirtualTexture::Bind
+uniform sampler2D vtIndirection;
+uniform sampler2D vtAtlas;
+uniform float vtPages;          // pages per side at level 0
+uniform float vtMaxLevel;
+uniform float vtTileSize;       // content texels per page side
+uniform float vtBorder;
+uniform float vtAtlasSlots;     // atlas size in pages per side
+// the feedback pass renders at a lower resolution, this compensates its larger derivatives
+uniform float vtFeedbackBias;
+
+// level of the page pyramid needed for uv, 0 is the most detailed
+float vtPageLevel(vec2 uv, float bias)
+{
+    vec2 texels = uv * vtPages * vtTileSize;
+    vec2 dx = dFdx(texels);
+    vec2 dy = dFdy(texels);
+    float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8)) + bias;
+    return clamp(floor(lod), 0.0, vtMaxLevel);
+}
+
+vec4 sampleVirtual(vec2 uv)
+{
+    float level = vtPageLevel(uv, 0.0);
+    // the entry points at the page itself or at its closest resident ancestor: (slot x, slot y, level)
+    vec3 entry = floor(textureLod(vtIndirection, uv, level).xyz * 255.0 + 0.5);
+    float pagesAtLevel = max(vtPages / exp2(entry.z), 1.0);
+    vec2 inPage = fract(uv * pagesAtLevel);
+    float slotSize = vtTileSize + 2.0 * vtBorder;
+    vec2 texel = entry.xy * slotSize + vtBorder + inPage * vtTileSize;
+    return textureLod(vtAtlas, texel / (vtAtlasSlots * slotSize), 0.0);
+}
+
+// feedback pass output: the page and level sampleVirtual needs at uv
+vec4 virtualFeedback(vec2 uv)
+{
+    float level = vtPageLevel(uv, vtFeedbackBias);
+    float pagesAtLevel = max(vtPages / exp2(level), 1.0);
+    vec2 page = min(floor(uv * pagesAtLevel), pagesAtLevel - 1.0);
+    return vec4(page, level, 255.0) / 255.0;
+}
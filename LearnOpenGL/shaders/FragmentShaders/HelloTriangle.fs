@@ -2,11 +2,12 @@
 
 out vec4 FragColor;
 
+#ifdef VERTEX_COLOR
 in vec3 ourAColor;
 in vec3 ourBColor;
 in vec3 ourCColor;
 
-// Change by timeAinput range 0~3
+// Change by time, input range 0~3
 uniform float gradientValue;
 
 // color lerp algorithm
@@ -20,9 +21,13 @@ vec4 lerp(vec3 startColor, vec3 endColor, float normalValue)
         1.0
     );
 }
+#else
+uniform float greenValue;
+#endif
 
 void main()
 {
+#ifdef VERTEX_COLOR
     // dicide linearGradient color
     if(gradientValue < 1)
     {
@@ -39,4 +44,7 @@ void main()
         // 2~3
         FragColor = lerp(ourCColor, ourAColor, gradientValue - 2);
     }
+#else
+    FragColor = vec4(0.0f, greenValue, 0.0f, 1.0f);
+#endif
 }
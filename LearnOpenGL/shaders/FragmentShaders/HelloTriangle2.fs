@@ -1,10 +0,0 @@
-#version 330 core
-
-out vec4 FragColor;
-
-uniform float greenValue;
-
-void main()
-{
-   FragColor = vec4(0.0f, greenValue, 0.0f, 1.0f);
-}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#version 330 core
+
+out vec4 FragColor;
+
+in vec3 Normal;
+in vec2 TexCoord;
+
+uniform sampler2D baseColor;
+uniform vec4 baseColorFactor;
+uniform vec3 lightDirection;
+
+void main()
+{
+    // a directional light and some ambient, enough to see the shape
+    // meshes without normals are lit fully
+    float diffuse = length(Normal) > 0.0 ? max(dot(normalize(Normal), -lightDirection), 0.0) : 1.0;
+    vec4 color = texture(baseColor, TexCoord) * baseColorFactor;
+    FragColor = vec4(color.rgb * (0.3 + 0.7 * diffuse), color.a);
+}
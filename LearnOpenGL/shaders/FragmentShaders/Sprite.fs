@@ -0,0 +1,24 @@
+#version 330 core
+
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+#ifdef TEXTURE_ARRAY
+uniform sampler2DArray sprites;
+uniform float layer;
+#else
+uniform sampler2D sprites;
+#endif
+
+void main()
+{
+#ifdef TEXTURE_ARRAY
+    FragColor = texture(sprites, vec3(TexCoord, layer));
+#else
+    FragColor = texture(sprites, TexCoord);
+#endif
+    // cut out, no blending needed
+    if (FragColor.a < 0.5)
+        discard;
+}
@@ -1,15 +1,44 @@
 #version 330 core
+#ifdef BINDLESS
+#extension GL_ARB_bindless_texture : require
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_ARB_shading_language_420pack : require
+#endif
 
 out vec4 FragColor;
 
 in vec2 TexCoord;
 
+#ifdef BINDLESS
+// two 64-bit texture handles per material, see MaterialTextures
+layout (std430, binding = 0) readonly buffer MaterialHandles
+{
+    uvec2 handles[];
+};
+flat in int Material;
+#elif defined(TEXTURE_ARRAY)
+// two layers per material, see MaterialTextures
+uniform sampler2DArray materialTextures;
+flat in int Material;
+#else
 uniform sampler2D texture0;
 uniform sampler2D texture1;
+#endif
 uniform float mixValue;
 
+vec4 sampleMaterial(int slot, vec2 uv)
+{
+#ifdef BINDLESS
+    return texture(sampler2D(handles[Material * 2 + slot]), uv);
+#elif defined(TEXTURE_ARRAY)
+    return texture(materialTextures, vec3(uv, Material * 2 + slot));
+#else
+    return slot == 0 ? texture(texture0, uv) : texture(texture1, uv);
+#endif
+}
+
 void main()
 {
     // linearly interpolate between both textures (80% container, 20% awesomeface)
-    FragColor = mix(texture(texture0, TexCoord), texture(texture1, vec2(1.0 - TexCoord.x, TexCoord.y)), mixValue);
+    FragColor = mix(sampleMaterial(0, TexCoord), sampleMaterial(1, vec2(1.0 - TexCoord.x, TexCoord.y)), mixValue);
 }
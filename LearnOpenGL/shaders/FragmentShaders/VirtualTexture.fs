@@ -0,0 +1,16 @@
+#version 330 core
+
+#include "../Common/VirtualTexture.glsl"
+
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+void main()
+{
+#ifdef FEEDBACK
+    FragColor = virtualFeedback(TexCoord);
+#else
+    FragColor = sampleVirtual(TexCoord);
+#endif
+}
@@ -0,0 +1,40 @@
+#version 330 core
+
+#include "../Common/Transform.glsl"
+#ifdef QUANTIZED
+#include "../Common/VertexDecode.glsl"
+#endif
+
+#ifdef QUANTIZED
+// Unorm16x3, Octahedral10 and Half2 attributes of VertexFormat
+layout (location = 0) in vec3 aQuantizedPos;
+layout (location = 1) in vec4 aPackedNormal;
+#else
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+#endif
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 Normal;
+out vec2 TexCoord;
+
+#ifdef NORMAL_MATRIX
+// transpose(inverse(mat3(model))), see MatrixBatch::NormalMatrices
+uniform mat3 normalMatrix;
+#endif
+
+void main()
+{
+#ifdef QUANTIZED
+    vec3 aPos = decodePosition(aQuantizedPos);
+    vec3 aNormal = decodeOctahedral(aPackedNormal.xy);
+#endif
+    gl_Position = transformPosition(aPos);
+#ifdef NORMAL_MATRIX
+    Normal = normalMatrix * aNormal;
+#else
+    // fine for the uniform scales of the loaded scenes, non-uniform scales need NORMAL_MATRIX
+    Normal = mat3(model) * aNormal;
+#endif
+    TexCoord = aTexCoord;
+}
@@ -0,0 +1,17 @@
+#version 330 core
+
+// unit quad, (0,0) bottom left to (1,1) top right
+layout (location = 0) in vec2 aPos;
+
+out vec2 TexCoord;
+
+// placement in normalized device coordinates: xy bottom left corner, zw size
+uniform vec4 rect;
+// sub-rectangle of the texture: xy offset, zw size. (0, 0, 1, 1) for a standalone texture
+uniform vec4 uvRect;
+
+void main()
+{
+    gl_Position = vec4(rect.xy + aPos * rect.zw, 0.0, 1.0);
+    TexCoord = uvRect.xy + aPos * uvRect.zw;
+}
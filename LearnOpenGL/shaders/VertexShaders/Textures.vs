@@ -1,17 +1,29 @@
 #version 330 core
 
+#include "../Common/Transform.glsl"
+
+#if defined(BINDLESS) || defined(TEXTURE_ARRAY)
+#define MERGED_DRAWS
+#endif
+
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
+#ifdef MERGED_DRAWS
+// per draw of a merged draw, see DrawBatch
+layout (location = 2) in mat4 aModel;
+layout (location = 6) in int aMaterial;
+flat out int Material;
+#endif
 
 out vec2 TexCoord;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
 void main()
 {
-    // read the multiplication from right to left
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+#ifdef MERGED_DRAWS
+    gl_Position = transformPosition(aModel, aPos);
+    Material = aMaterial;
+#else
+    gl_Position = transformPosition(aPos);
+#endif
     TexCoord = vec2(aTexCoord.x, aTexCoord.y);
-}
\ No newline at end of file
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// glm only runs its SSE/AVX code (detail/*_simd.inl) for types with an aligned qualifier, which exist when
+// GLM_FORCE_INTRINSICS or GLM_FORCE_ALIGNED_GENTYPES is defined, as the SIMD configurations of the project do. the
+// scene math that is worth it uses these types: aligned in those configurations and the plain glm types otherwise.
+// only vec4 and mat4 arithmetic is vectorized, an aligned vec3 is just padded to 16 bytes. glm::vec3 stays packed
+// everywhere, so vertex data and arrays of points keep their layout.
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+const glm::qualifier ALIGNED_QUALIFIER = glm::aligned_highp;
+#else
+const glm::qualifier ALIGNED_QUALIFIER = glm::packed_highp;
+#endif
+
+typedef glm::vec<3, float, ALIGNED_QUALIFIER> AlignedVec3;
+typedef glm::vec<4, float, ALIGNED_QUALIFIER> AlignedVec4;
+typedef glm::mat<4, 4, float, ALIGNED_QUALIFIER> AlignedMat4;
+
+// whether glm was built with intrinsics, for reports
+inline const char* GetGlmSimdName()
+{
+#if GLM_CONFIG_SIMD == GLM_ENABLE
+#   if GLM_ARCH & GLM_ARCH_AVX2_BIT
+    return "glm intrinsics (avx2)";
+#   elif GLM_ARCH & GLM_ARCH_AVX_BIT
+    return "glm intrinsics (avx)";
+#   elif GLM_ARCH & GLM_ARCH_SSE41_BIT
+    return "glm intrinsics (sse4.1)";
+#   else
+    return "glm intrinsics (sse2)";
+#   endif
+#else
+    return "glm scalar";
+#endif
+}
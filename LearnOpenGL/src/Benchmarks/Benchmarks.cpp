@@ -0,0 +1,1015 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmarks.h"
+#include "../Shader.h"
+#include "../ShaderPermutations.h"
+#include "../GLExtensions.h"
+#include "../Json.h"
+#include "../RenderStats.h"
+#include "../TextureCache.h"
+#include "../VertexFormat.h"
+
+namespace Benchmarks
+{
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+    const size_t TEXTURE_BUDGET = 256 * 1024 * 1024;
+    // bumped when the results change meaning, results of another version are not compared
+    const int RESULTS_VERSION = 1;
+    // the texture heavy scenario binds a different one of these for every cube
+    const unsigned int HEAVY_TEXTURES = 64;
+    const int HEAVY_TEXTURE_SIZE = 256;
+    // cubes of the cube scenarios sit in a cube shaped grid, this far apart
+    const float GRID_SPACING = 2.0f;
+    // the texture cache stress run streams this many synthetic textures of this size, so many per frame
+    const unsigned int STRESS_TEXTURES = 4096;
+    const unsigned int STRESS_TEXTURES_PER_FRAME = 16;
+    const int STRESS_TEXTURE_SIZE = 256;
+    // a time regresses only when it grew by this many standard deviations of the baseline, and by this much at
+    // least, below which the timer resolution decides
+    const double NOISE_DEVIATIONS = 2.0;
+    const double MIN_REGRESSION_MILLISECONDS = 0.005;
+
+    // textures
+    const char* CONTAINER_TEXTURE = "textures/Container.jpg";
+    const char* FACE_TEXTURE = "textures/Awesomeface.png";
+
+    // a unit cube from its six faces: position, normal when asked for, and texture coordinate of every vertex
+    std::vector<float> cubeVertices(bool normals)
+    {
+        std::vector<float> vertices;
+        for (int face = 0; face < 6; face++)
+        {
+            int axis = face / 2;
+            float sign = (face % 2) ? -1.0f : 1.0f;
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = sign;
+            u[(axis + 1) % 3] = sign;
+            v[(axis + 2) % 3] = 1.0f;
+            const float corners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+            for (const float* corner : corners)
+            {
+                glm::vec3 position = normal * 0.5f + u * (corner[0] - 0.5f) + v * (corner[1] - 0.5f);
+                vertices.insert(vertices.end(), { position.x, position.y, position.z });
+                if (normals)
+                    vertices.insert(vertices.end(), { normal.x, normal.y, normal.z });
+                vertices.insert(vertices.end(), { corner[0], corner[1] });
+            }
+        }
+        return vertices;
+    }
+
+    unsigned int gridSide(unsigned int count)
+    {
+        unsigned int side = 1;
+        while (side * side * side < count)
+            side++;
+        return side;
+    }
+
+    // cube i of count, turning at one of a few speeds. the angle follows the frame number, not the clock, so every
+    // run draws the same frames
+    glm::mat4 gridModel(unsigned int i, unsigned int count, unsigned int frame)
+    {
+        unsigned int side = gridSide(count);
+        glm::vec3 cell((float)(i % side), (float)(i / side % side), (float)(i / (side * side)));
+        glm::vec3 position = (cell - (side - 1) * 0.5f) * GRID_SPACING;
+        float angle = glm::radians((20.0f + (i % 7) * 10.0f) * frame / 60.0f);
+        return glm::rotate(glm::translate(glm::mat4(1.0f), position), angle, glm::vec3(0.6f, 0.3f, 0.74f));
+    }
+
+    // looking at the whole grid from a corner
+    glm::mat4 gridView(unsigned int count)
+    {
+        glm::vec3 eye = glm::vec3(0.6f, 0.5f, 1.0f) * (gridSide(count) * GRID_SPACING * 1.4f);
+        return glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    glm::mat4 gridProjection(unsigned int count)
+    {
+        return glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, gridSide(count) * GRID_SPACING * 4.0f + 10.0f);
+    }
+
+    // A workload of the demos. it owns its GL objects and submits one frame per Frame(), counting what it submits
+    // in RenderStats; vertex array binds count as buffer binds and uniform uploads as state changes
+    class Scenario
+    {
+    public:
+        virtual ~Scenario() {}
+        virtual const char* Name() const = 0;
+        virtual void Frame(unsigned int frame) = 0;
+    };
+
+    // the two triangles of HelloTriangle, one with the animated gradient
+    class Gradient : public Scenario
+    {
+    public:
+        Gradient() : shaders("shaders/VertexShaders/HelloTriangle.vs", "shaders/FragmentShaders/HelloTriangle.fs", { "VERTEX_COLOR" })
+        {
+            vertexColor = shaders.Mask("VERTEX_COLOR");
+            shaders.Precompile({ vertexColor, 0 });
+
+            float firstTriangle[] = {
+                // positions            // color start      // color middle     // color end
+                 -0.25f,  0.3f, 0.0f,   1.0f, 0.0f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 1.0f, 0.0f,// top
+                -0.5f, -0.3f, 0.0f,     0.0f, 1.0f, 0.0f,   1.0f, 0.0f, 0.0f,   0.0f, 0.0f, 1.0f,// bottom left
+                 0.0f, -0.3f, 0.0f,     0.0f, 0.0f, 1.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f, 0.0f // bottom right
+            };
+            float secondTriangle[] = {
+                0.25f,  0.5f, 0.0f,  // top
+                0.5f, -0.5f, 0.0f,  // bottom left
+                0.0f, -0.5f, 0.0f,  // bottom right
+            };
+
+            glGenVertexArrays(2, VAOs);
+            glGenBuffers(2, VBOs);
+            glBindVertexArray(VAOs[0]);
+            VertexFormat firstFormat;
+            firstFormat.Add(0, AttributeFormat::Float3)
+                .Add(1, AttributeFormat::Unorm8x3)
+                .Add(2, AttributeFormat::Unorm8x3)
+                .Add(3, AttributeFormat::Unorm8x3);
+            std::vector<unsigned char> firstData = firstFormat.Encode(firstTriangle, 3);
+            glBindBuffer(GL_ARRAY_BUFFER, VBOs[0]);
+            glBufferData(GL_ARRAY_BUFFER, firstData.size(), firstData.data(), GL_STATIC_DRAW);
+            firstFormat.Apply();
+
+            glBindVertexArray(VAOs[1]);
+            glBindBuffer(GL_ARRAY_BUFFER, VBOs[1]);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(secondTriangle), secondTriangle, GL_STATIC_DRAW);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+            glEnableVertexAttribArray(0);
+        }
+
+        ~Gradient()
+        {
+            glDeleteVertexArrays(2, VAOs);
+            glDeleteBuffers(2, VBOs);
+        }
+
+        const char* Name() const override { return "gradient"; }
+
+        void Frame(unsigned int frame) override
+        {
+            // the demo's animation as if it ran at 60 frames a second
+            float time = frame / 60.0f;
+
+            Shader& firstShader = shaders.Get(vertexColor);
+            firstShader.use();
+            firstShader.setFloat("gradientValue", fmod(time, 3.0f));
+            glBindVertexArray(VAOs[0]);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+
+            Shader& secondShader = shaders.Get(0);
+            secondShader.use();
+            float sinValue = (sin(time) / 2.0f) + 0.5f;
+            secondShader.setFloat("greenValue", sinValue);
+            secondShader.setFloat("xOffset", sinValue / 2);
+            glBindVertexArray(VAOs[1]);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+
+            RenderStats::Frame.ProgramBinds += 2;
+            RenderStats::Frame.StateChanges += 3;
+            RenderStats::Frame.BufferBinds += 2;
+            RenderStats::Frame.DrawCalls += 2;
+            RenderStats::Frame.Triangles += 2;
+        }
+
+    private:
+        ShaderPermutations shaders;
+        unsigned int vertexColor;
+        unsigned int VAOs[2], VBOs[2];
+    };
+
+    // the Sandbox's textured cubes with its two blended textures and half float vertices, as many as asked for
+    class TexturedCubes : public Scenario
+    {
+    public:
+        TexturedCubes(unsigned int instances) : instances(instances), shader("shaders/VertexShaders/Textures.vs", "shaders/FragmentShaders/Textures.fs"),
+            textures(TEXTURE_BUDGET)
+        {
+            std::vector<float> vertices = cubeVertices(false);
+            VertexFormat format;
+            format.Add(0, AttributeFormat::Half3).Add(1, AttributeFormat::Half2);
+            std::vector<unsigned char> vertexData = format.Encode(vertices.data(), vertices.size() / format.SourceComponents());
+            glGenVertexArrays(1, &VAO);
+            glGenBuffers(1, &VBO);
+            glBindVertexArray(VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, VBO);
+            glBufferData(GL_ARRAY_BUFFER, vertexData.size(), vertexData.data(), GL_STATIC_DRAW);
+            format.Apply();
+
+            containerSampling.WrapS = GL_CLAMP_TO_EDGE;
+            containerSampling.WrapT = GL_MIRRORED_REPEAT;
+            containerSampling.MinFilter = GL_NEAREST;
+            containerSampling.MagFilter = GL_NEAREST;
+            stbi_set_flip_vertically_on_load(true);
+            textures.Get(CONTAINER_TEXTURE, containerSampling);
+            textures.Get(FACE_TEXTURE);
+            textures.WaitForLoads();
+
+            shader.use();
+            shader.setInt("texture0", 0);
+            shader.setInt("texture1", 1);
+        }
+
+        ~TexturedCubes()
+        {
+            glDeleteVertexArrays(1, &VAO);
+            glDeleteBuffers(1, &VBO);
+        }
+
+        const char* Name() const override { return "textured_cubes"; }
+
+        void Frame(unsigned int frame) override
+        {
+            textures.BeginFrame();
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, textures.Get(CONTAINER_TEXTURE, containerSampling));
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, textures.Get(FACE_TEXTURE));
+            RenderStats::Frame.TextureBinds += 2;
+
+            shader.use();
+            shader.setFloat("mixValue", 0.2f);
+            shader.setMat4("projection", gridProjection(instances));
+            shader.setMat4("view", gridView(instances));
+            RenderStats::Frame.ProgramBinds++;
+            RenderStats::Frame.StateChanges += 3;
+
+            glBindVertexArray(VAO);
+            RenderStats::Frame.BufferBinds++;
+            for (unsigned int i = 0; i < instances; i++)
+            {
+                shader.setMat4("model", gridModel(i, instances, frame));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                RenderStats::Frame.StateChanges++;
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += 12;
+            }
+        }
+
+    private:
+        unsigned int instances;
+        Shader shader;
+        TextureCache textures;
+        TextureSampling containerSampling;
+        unsigned int VAO, VBO;
+    };
+
+    // lit cubes with the Model shader, owning the cube and setting the uniforms that stay the same over a frame
+    class LitCubes : public Scenario
+    {
+    public:
+        LitCubes(unsigned int instances) : instances(instances)
+        {
+            std::vector<float> vertices = cubeVertices(true);
+            VertexFormat format;
+            format.Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+            glGenVertexArrays(1, &VAO);
+            glGenBuffers(1, &VBO);
+            glBindVertexArray(VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, VBO);
+            glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+            format.Apply();
+        }
+
+        ~LitCubes()
+        {
+            glDeleteVertexArrays(1, &VAO);
+            glDeleteBuffers(1, &VBO);
+        }
+
+    protected:
+        unsigned int instances;
+        unsigned int VAO, VBO;
+
+        void setup(Shader& shader)
+        {
+            shader.use();
+            shader.setInt("baseColor", 0);
+            shader.setVec4("baseColorFactor", glm::vec4(1.0f));
+            shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+        }
+
+        void setCamera(Shader& shader)
+        {
+            shader.setMat4("projection", gridProjection(instances));
+            shader.setMat4("view", gridView(instances));
+            RenderStats::Frame.StateChanges += 2;
+        }
+    };
+
+    // every cube samples its own texture, so every draw binds one; the textures are checkerboards with mipmaps,
+    // made here so the scenario does not depend on what lies in textures/
+    class TextureHeavy : public LitCubes
+    {
+    public:
+        TextureHeavy(unsigned int instances) : LitCubes(instances), shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs"),
+            textures(HEAVY_TEXTURES)
+        {
+            glGenTextures(HEAVY_TEXTURES, textures.data());
+            std::vector<unsigned char> pixels((size_t)HEAVY_TEXTURE_SIZE * HEAVY_TEXTURE_SIZE * 4);
+            for (unsigned int t = 0; t < HEAVY_TEXTURES; t++)
+            {
+                unsigned char color[3] = { (unsigned char)(64 + t * 37 % 192), (unsigned char)(64 + t * 71 % 192), (unsigned char)(64 + t * 113 % 192) };
+                int square = 8 << (t % 4);
+                for (int y = 0; y < HEAVY_TEXTURE_SIZE; y++)
+                    for (int x = 0; x < HEAVY_TEXTURE_SIZE; x++)
+                    {
+                        unsigned char* pixel = &pixels[((size_t)y * HEAVY_TEXTURE_SIZE + x) * 4];
+                        bool light = ((x / square) + (y / square)) % 2 == 0;
+                        for (int c = 0; c < 3; c++)
+                            pixel[c] = light ? color[c] : color[c] / 2;
+                        pixel[3] = 255;
+                    }
+                glBindTexture(GL_TEXTURE_2D, textures[t]);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, HEAVY_TEXTURE_SIZE, HEAVY_TEXTURE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+                glGenerateMipmap(GL_TEXTURE_2D);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            }
+            setup(shader);
+        }
+
+        ~TextureHeavy()
+        {
+            glDeleteTextures(HEAVY_TEXTURES, textures.data());
+        }
+
+        const char* Name() const override { return "texture_heavy"; }
+
+        void Frame(unsigned int frame) override
+        {
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            setCamera(shader);
+            glActiveTexture(GL_TEXTURE0);
+            glBindVertexArray(VAO);
+            RenderStats::Frame.BufferBinds++;
+            for (unsigned int i = 0; i < instances; i++)
+            {
+                glBindTexture(GL_TEXTURE_2D, textures[i % HEAVY_TEXTURES]);
+                shader.setMat4("model", gridModel(i, instances, frame));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                RenderStats::Frame.TextureBinds++;
+                RenderStats::Frame.StateChanges++;
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += 12;
+            }
+        }
+
+    private:
+        Shader shader;
+        std::vector<unsigned int> textures;
+    };
+
+    // every cube uses another of the Model shader's four NORMAL_MATRIX and PRECOMPUTED_MVP variants than the one
+    // before, so every draw switches programs and uploads the uniforms its variant reads
+    class ShaderSwitch : public LitCubes
+    {
+    public:
+        ShaderSwitch(unsigned int instances) : LitCubes(instances),
+            shaders("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs", { "NORMAL_MATRIX", "PRECOMPUTED_MVP" })
+        {
+            normalMatrix = shaders.Mask("NORMAL_MATRIX");
+            precomputedMvp = shaders.Mask("PRECOMPUTED_MVP");
+            shaders.Precompile({ 0, normalMatrix, precomputedMvp, normalMatrix | precomputedMvp });
+            shaders.ForEachBuilt([&](Shader& shader)
+            {
+                setup(shader);
+            });
+            unsigned char white[] = { 255, 255, 255, 255 };
+            glGenTextures(1, &whiteTexture);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        }
+
+        ~ShaderSwitch()
+        {
+            glDeleteTextures(1, &whiteTexture);
+        }
+
+        const char* Name() const override { return "shader_switch"; }
+
+        void Frame(unsigned int frame) override
+        {
+            // the camera goes to each program once, its uniforms stay with the program
+            shaders.ForEachBuilt([&](Shader& shader)
+            {
+                shader.use();
+                setCamera(shader);
+                RenderStats::Frame.ProgramBinds++;
+            });
+            glm::mat4 viewProjection = gridProjection(instances) * gridView(instances);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            glBindVertexArray(VAO);
+            RenderStats::Frame.BufferBinds++;
+            for (unsigned int i = 0; i < instances; i++)
+            {
+                unsigned int mask = i % 4;
+                Shader& shader = shaders.Get(mask);
+                shader.use();
+                glm::mat4 model = gridModel(i, instances, frame);
+                shader.setMat4("model", model);
+                RenderStats::Frame.StateChanges++;
+                if (mask & normalMatrix)
+                {
+                    shader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
+                    RenderStats::Frame.StateChanges++;
+                }
+                if (mask & precomputedMvp)
+                {
+                    shader.setMat4("modelViewProjection", viewProjection * model);
+                    RenderStats::Frame.StateChanges++;
+                }
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                RenderStats::Frame.ProgramBinds++;
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += 12;
+            }
+        }
+
+    private:
+        ShaderPermutations shaders;
+        unsigned int normalMatrix;
+        unsigned int precomputedMvp;
+        unsigned int whiteTexture;
+    };
+
+    struct Statistics
+    {
+        double Mean = 0.0;
+        double Median = 0.0;
+        double P95 = 0.0;
+        double StandardDeviation = 0.0;
+    };
+
+    struct Result
+    {
+        std::string Name;
+        // the submission on the CPU, the GPU's work from a timer query and the whole frame up to glFinish, in ms
+        Statistics Cpu;
+        Statistics Gpu;
+        Statistics Frame;
+        // the same every frame, the scenarios draw the same things each time
+        RenderStats::Counters Counters;
+    };
+
+    Statistics summarize(std::vector<double> samples)
+    {
+        Statistics statistics;
+        if (samples.empty())
+            return statistics;
+        std::sort(samples.begin(), samples.end());
+        size_t count = samples.size();
+        double sum = 0.0;
+        for (double sample : samples)
+            sum += sample;
+        statistics.Mean = sum / count;
+        statistics.Median = count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) * 0.5;
+        // nearest rank
+        statistics.P95 = samples[std::min(count - 1, (size_t)std::ceil(count * 0.95) - 1)];
+        double squares = 0.0;
+        for (double sample : samples)
+            squares += (sample - statistics.Mean) * (sample - statistics.Mean);
+        statistics.StandardDeviation = std::sqrt(squares / count);
+        return statistics;
+    }
+
+    double millisecondsBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+    {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    // renders the warmup frames, then the measured ones. each frame waits for the GPU before the next starts, so
+    // the frame time is the scenario's alone and nothing of one frame overlaps the next
+    Result measure(Scenario& scenario, const Settings& settings)
+    {
+        std::vector<unsigned int> queries(settings.Frames);
+        glGenQueries(settings.Frames, queries.data());
+        std::vector<double> cpu, frames, gpu;
+        RenderStats::EndFrame();
+        for (unsigned int frame = 0; frame < settings.WarmupFrames + settings.Frames; frame++)
+        {
+            bool measured = frame >= settings.WarmupFrames;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if (measured)
+                glBeginQuery(GL_TIME_ELAPSED, queries[frame - settings.WarmupFrames]);
+
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            scenario.Frame(frame);
+
+            if (measured)
+                glEndQuery(GL_TIME_ELAPSED);
+            std::chrono::steady_clock::time_point submitted = std::chrono::steady_clock::now();
+            glFinish();
+            std::chrono::steady_clock::time_point finished = std::chrono::steady_clock::now();
+            RenderStats::EndFrame();
+            glfwPollEvents();
+            if (measured)
+            {
+                cpu.push_back(millisecondsBetween(start, submitted));
+                frames.push_back(millisecondsBetween(start, finished));
+            }
+        }
+        // every query is done after the last glFinish
+        for (unsigned int query : queries)
+        {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+            gpu.push_back(nanoseconds * 1e-6);
+        }
+        glDeleteQueries(settings.Frames, queries.data());
+
+        Result result;
+        result.Name = scenario.Name();
+        result.Cpu = summarize(cpu);
+        result.Gpu = summarize(gpu);
+        result.Frame = summarize(frames);
+        result.Counters = RenderStats::Last;
+        return result;
+    }
+
+    // text as the contents of a JSON string
+    std::string escape(const char* text)
+    {
+        std::string escaped;
+        for (; *text; text++)
+        {
+            if (*text == '"' || *text == '\\')
+                escaped += '\\';
+            if ((unsigned char)*text < 0x20)
+                escaped += ' ';
+            else
+                escaped += *text;
+        }
+        return escaped;
+    }
+
+    void writeStatistics(FILE* file, const char* name, const Statistics& statistics)
+    {
+        fprintf(file, "      \"%s\": { \"mean\": %.6f, \"median\": %.6f, \"p95\": %.6f, \"stddev\": %.6f },\n", name, statistics.Mean, statistics.Median,
+            statistics.P95, statistics.StandardDeviation);
+    }
+
+    bool writeResults(const std::string& path, const char* renderer, const Settings& settings, const std::vector<Result>& results)
+    {
+        FILE* file = fopen(path.c_str(), "w");
+        if (!file)
+            return false;
+        fprintf(file, "{\n  \"version\": %d,\n  \"renderer\": \"%s\",\n", RESULTS_VERSION, escape(renderer).c_str());
+        fprintf(file, "  \"width\": %u,\n  \"height\": %u,\n  \"frames\": %u,\n  \"instances\": %u,\n", SCR_WIDTH, SCR_HEIGHT, settings.Frames,
+            settings.Instances);
+        fprintf(file, "  \"scenarios\": [\n");
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const Result& result = results[i];
+            fprintf(file, "    {\n      \"name\": \"%s\",\n", result.Name.c_str());
+            writeStatistics(file, "cpu_ms", result.Cpu);
+            writeStatistics(file, "gpu_ms", result.Gpu);
+            writeStatistics(file, "frame_ms", result.Frame);
+            const RenderStats::Counters& counters = result.Counters;
+            fprintf(file, "      \"draw_calls\": %u,\n      \"triangles\": %u,\n      \"texture_binds\": %u,\n", counters.DrawCalls, counters.Triangles,
+                counters.TextureBinds);
+            fprintf(file, "      \"program_binds\": %u,\n      \"buffer_binds\": %u,\n      \"state_changes\": %u\n", counters.ProgramBinds,
+                counters.BufferBinds, counters.StateChanges);
+            fprintf(file, "    }%s\n", i + 1 < results.size() ? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+        bool written = !ferror(file);
+        fclose(file);
+        return written;
+    }
+
+    // a GL context in a window that is never shown, NULL when there is none
+    GLFWwindow* openHiddenWindow()
+    {
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return NULL;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(0);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            glfwTerminate();
+            return NULL;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+        return window;
+    }
+
+    // checks the TextureCache's books with synthetic textures from its loader: the budget, which textures are
+    // downgraded and evicted, the counters, that a texture is never loaded twice for one use and that a failed load is
+    // retried after a back-off. nothing is drawn
+    bool stressTextureCache()
+    {
+        // every texture is RGBA and this size, so the memory expected is easy to tell
+        const int size = STRESS_TEXTURE_SIZE;
+        // as TextureCache counts it, a full mip chain adds a third
+        auto bytes = [](int width) { return (size_t)width * width * 4 * 4 / 3; };
+        const size_t full = bytes(size), half = bytes(size / 2), smallest = bytes(TextureCache::MIN_DOWNGRADED_SIZE);
+
+        std::atomic<unsigned int> loads(0);
+        // loads of paths starting with "held/" wait until the gate opens, to keep them in flight
+        std::atomic<bool> gateOpen(true);
+        // paths starting with "broken/" fail to load while this is set
+        std::atomic<bool> broken(true);
+        TextureCache::Loader loader = [&](const std::string& path, int& width, int& height, int& channels)
+        {
+            while (path.compare(0, 5, "held/") == 0 && !gateOpen)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            if (path.compare(0, 7, "broken/") == 0 && broken)
+            {
+                loads++;
+                return (unsigned char*)NULL;
+            }
+            width = height = size;
+            channels = 4;
+            unsigned char* pixels = (unsigned char*)malloc((size_t)size * size * 4);
+            memset(pixels, (int)(std::hash<std::string>()(path) & 0xff), (size_t)size * size * 4);
+            loads++;
+            return pixels;
+        };
+        auto name = [](const char* prefix, unsigned int i) { return prefix + std::to_string(i); };
+
+        bool passed = true;
+        auto expect = [&](const char* check, size_t actual, size_t expected)
+        {
+            if (actual != expected)
+            {
+                printf("texture cache: %s is %zu instead of %zu, FAILED\n", check, actual, expected);
+                passed = false;
+            }
+        };
+
+        // least recently used first, downgrades before evictions
+        {
+            TextureCache cache(8 * full, 2);
+            cache.SetLoader(loader);
+            cache.BeginFrame();
+            for (unsigned int i = 0; i < 8; i++)
+                cache.Get(name("lru/", i));
+            cache.WaitForLoads();
+            expect("resident bytes at the budget", cache.GetResidentBytes(), 8 * full);
+
+            // after two idle frames a ninth texture goes over: halving the two oldest is enough
+            cache.BeginFrame();
+            cache.BeginFrame();
+            cache.BeginFrame();
+            cache.Get(name("lru/", 8));
+            cache.WaitForLoads();
+            expect("downgrades over the budget", cache.Downgrades, 2);
+            expect("evictions over the budget", cache.Evictions, 0);
+            expect("resident bytes after downgrading", cache.GetResidentBytes(), 7 * full + 2 * half);
+
+            // the halved ones are reloaded at full size once used, and the next two oldest are halved in their place
+            cache.BeginFrame();
+            for (unsigned int i = 0; i < 3; i++)
+                cache.Get(name("lru/", i));
+            cache.WaitForLoads();
+            expect("hits of resident textures", cache.Hits, 3);
+            expect("uploads with the reloads", cache.Uploads, 11);
+            expect("loads with the reloads", loads, 11);
+            expect("downgrades after the reloads", cache.Downgrades, 4);
+            expect("resident bytes after the reloads", cache.GetResidentBytes(), 7 * full + 2 * half);
+
+            // at a quarter of the budget the six unused ones are shrunk to the smallest size, then evicted; the
+            // three used are kept a frame longer, after which the oldest two of them are halved
+            cache.SetBudget(2 * full);
+            cache.BeginFrame();
+            expect("evictions under a smaller budget", cache.Evictions, 6);
+            expect("textures kept in use", cache.GetTextureCount(), 3);
+            cache.BeginFrame();
+            expect("downgrades under a smaller budget", cache.Downgrades, 12);
+            expect("resident bytes under a smaller budget", cache.GetResidentBytes(), full + 2 * half);
+        }
+
+        // a texture still loading is not evicted, so using it again does not load it twice
+        {
+            TextureCache cache(smallest / 2, 4);
+            cache.SetLoader(loader);
+            unsigned int startLoads = loads;
+            gateOpen = false;
+            cache.BeginFrame();
+            cache.Get("held/0");
+            cache.Get("held/1");
+            cache.BeginFrame();
+            cache.Get("free/0");
+            // the free one loads, and once it is two frames old it is over the budget behind the held ones
+            for (int wait = 0; wait < 5000 && cache.Evictions == 0; wait++)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                cache.BeginFrame();
+            }
+            gateOpen = true;
+            expect("evictions with loads in flight", cache.Evictions, 1);
+            expect("textures left loading", cache.GetTextureCount(), 2);
+            cache.BeginFrame();
+            cache.Get("held/0");
+            cache.Get("held/1");
+            cache.WaitForLoads();
+            expect("loads of textures used again while loading", loads - startLoads, 3);
+            expect("uploads of textures used again while loading", cache.Uploads, 3);
+        }
+
+        // a texture that failed to load is not a miss every frame, and is loaded again once the back-off is over
+        {
+            TextureCache cache(8 * full, 1);
+            cache.SetLoader(loader);
+            unsigned int startLoads = loads;
+            cache.BeginFrame();
+            cache.Get("broken/0");
+            cache.WaitForLoads();
+            expect("load failures", cache.LoadFailures, 1);
+            for (unsigned int i = 0; i + 1 < TextureCache::RETRY_FRAMES; i++)
+            {
+                cache.BeginFrame();
+                cache.Get("broken/0");
+            }
+            cache.WaitForLoads();
+            expect("misses while backing off", cache.Misses, 1);
+            expect("loads while backing off", loads - startLoads, 1);
+            broken = false;
+            cache.BeginFrame();
+            cache.Get("broken/0");
+            cache.WaitForLoads();
+            cache.BeginFrame();
+            expect("misses after the retry", cache.Misses, 2);
+            expect("uploads after the retry", cache.Uploads, 1);
+            expect("hits after the retry", cache.Hits, 0);
+            cache.Get("broken/0");
+            expect("hits of the fixed texture", cache.Hits, 1);
+        }
+
+        // thousands of textures streamed through, a frame's worth at a time
+        {
+            const size_t budget = 64 * full;
+            TextureCache cache(budget, 4);
+            cache.SetLoader(loader);
+            unsigned int startLoads = loads;
+            unsigned int framesOverBudget = 0;
+            for (unsigned int first = 0; first < STRESS_TEXTURES; first += STRESS_TEXTURES_PER_FRAME)
+            {
+                cache.BeginFrame();
+                for (unsigned int i = 0; i < STRESS_TEXTURES_PER_FRAME; i++)
+                    cache.Get(name("stream/", first + i));
+                cache.WaitForLoads();
+                framesOverBudget += cache.GetResidentBytes() > budget;
+            }
+            expect("frames over the budget", framesOverBudget, 0);
+            expect("misses of streamed textures", cache.Misses, STRESS_TEXTURES);
+            expect("hits of streamed textures", cache.Hits, 0);
+            expect("uploads of streamed textures", cache.Uploads, STRESS_TEXTURES);
+            expect("loads of streamed textures", loads - startLoads, STRESS_TEXTURES);
+            expect("evicted and resident textures", cache.Evictions + cache.GetTextureCount(), STRESS_TEXTURES);
+            if (cache.Downgrades == 0 || cache.Evictions == 0)
+            {
+                printf("texture cache: %u downgrades and %u evictions while streaming, FAILED\n", cache.Downgrades, cache.Evictions);
+                passed = false;
+            }
+            printf("texture cache: %u textures streamed through %zu MB, %u downgrades, %u evictions\n", STRESS_TEXTURES, budget >> 20,
+                cache.Downgrades, cache.Evictions);
+
+            // the last frame's textures are still there at full size, the first one is long gone
+            cache.BeginFrame();
+            for (unsigned int i = 0; i < STRESS_TEXTURES_PER_FRAME; i++)
+                cache.Get(name("stream/", STRESS_TEXTURES - STRESS_TEXTURES_PER_FRAME + i));
+            cache.Get(name("stream/", 0));
+            cache.WaitForLoads();
+            expect("hits of the last frame's textures", cache.Hits, STRESS_TEXTURES_PER_FRAME);
+            expect("misses with the first texture", cache.Misses, STRESS_TEXTURES + 1);
+            expect("uploads with the first texture", cache.Uploads, STRESS_TEXTURES + 1);
+        }
+
+        printf("texture cache stress %s\n", passed ? "passed" : "FAILED");
+        return passed;
+    }
+
+    int StressTextureCache()
+    {
+        if (!openHiddenWindow())
+            return -1;
+        bool passed = stressTextureCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return passed ? 0 : 1;
+    }
+
+    int Run(const Settings& settings)
+    {
+        if (!openHiddenWindow())
+            return -1;
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        // the frames go to a framebuffer of their own, the same size everywhere, as in the Sandbox's replays
+        unsigned int framebuffer, renderbuffers[2];
+        glGenFramebuffers(1, &framebuffer);
+        glGenRenderbuffers(2, renderbuffers);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, SCR_WIDTH, SCR_HEIGHT);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, SCR_WIDTH, SCR_HEIGHT);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+        glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+
+        const char* renderer = (const char*)glGetString(GL_RENDERER);
+        printf("%u frames per scenario after %u to warm up, %u cubes, on %s\n", settings.Frames, settings.WarmupFrames, settings.Instances, renderer);
+
+        // one scenario at a time, each is gone before the next builds its resources
+        std::vector<Result> results;
+        for (int index = 0; index < 4; index++)
+        {
+            std::unique_ptr<Scenario> scenario;
+            switch (index)
+            {
+            case 0: scenario.reset(new Gradient()); break;
+            case 1: scenario.reset(new TexturedCubes(settings.Instances)); break;
+            case 2: scenario.reset(new TextureHeavy(settings.Instances)); break;
+            default: scenario.reset(new ShaderSwitch(settings.Instances)); break;
+            }
+            Result result = measure(*scenario, settings);
+            printf("%-15s CPU %8.3f ms, GPU %8.3f ms, frame %8.3f ms (medians), %u draws, %u texture binds, %u program binds, %u state changes\n",
+                result.Name.c_str(), result.Cpu.Median, result.Gpu.Median, result.Frame.Median, result.Counters.DrawCalls,
+                result.Counters.TextureBinds, result.Counters.ProgramBinds, result.Counters.StateChanges);
+            results.push_back(result);
+        }
+
+        bool written = writeResults(settings.Results, renderer, settings, results);
+        if (written)
+            printf("results written to %s\n", settings.Results.c_str());
+        else
+            std::cout << "Failed to write benchmark results " << settings.Results << std::endl;
+
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(2, renderbuffers);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return written ? 0 : -1;
+    }
+
+    // results read for comparing, the document points into the text
+    struct LoadedResults
+    {
+        std::vector<char> Text;
+        JsonDocument Document;
+    };
+
+    bool load(const std::string& path, LoadedResults& results)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::cout << "Failed to open benchmark results " << path << std::endl;
+            return false;
+        }
+        results.Text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (!results.Document.Parse(results.Text.data(), results.Text.size()))
+        {
+            std::cout << "Failed to parse benchmark results " << path << ": " << results.Document.GetError() << std::endl;
+            return false;
+        }
+        if (results.Document.Root()["version"].AsInt() != RESULTS_VERSION)
+        {
+            std::cout << "Benchmark results " << path << " are not of version " << RESULTS_VERSION << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // NULL when the results have no scenario of that name
+    const JsonValue* findScenario(const JsonValue& root, const char* name)
+    {
+        const JsonValue& scenarios = root["scenarios"];
+        for (size_t i = 0; i < scenarios.Size(); i++)
+            if (strcmp(scenarios[i]["name"].AsString(), name) == 0)
+                return &scenarios[i];
+        return NULL;
+    }
+
+    int Compare(const std::string& baseline, const std::string& results, double threshold)
+    {
+        LoadedResults before, after;
+        if (!load(baseline, before) || !load(results, after))
+            return -1;
+        const JsonValue& beforeRoot = before.Document.Root();
+        const JsonValue& afterRoot = after.Document.Root();
+        // draw calls, triangles and the times all scale with these, results of different sizes cannot be compared
+        const char* sizes[] = { "width", "height", "instances" };
+        for (const char* size : sizes)
+        {
+            if (beforeRoot[size].AsInt() != afterRoot[size].AsInt())
+            {
+                std::cout << "Benchmark results " << results << " have " << size << " " << afterRoot[size].AsInt() << ", the baseline "
+                    << baseline << " " << beforeRoot[size].AsInt() << ", they cannot be compared" << std::endl;
+                return -1;
+            }
+        }
+
+        printf("%s against the baseline %s, times regress beyond +%.0f%% and %.0f standard deviations\n", results.c_str(), baseline.c_str(),
+            threshold * 100.0, NOISE_DEVIATIONS);
+        // still compared, the counters mean the same anywhere
+        if (strcmp(beforeRoot["renderer"].AsString(), afterRoot["renderer"].AsString()) != 0)
+            printf("warning: measured on %s, the baseline on %s, the times may differ for that alone\n", afterRoot["renderer"].AsString(),
+                beforeRoot["renderer"].AsString());
+
+        const char* times[] = { "cpu_ms", "gpu_ms", "frame_ms" };
+        const char* counters[] = { "draw_calls", "triangles", "texture_binds", "program_binds", "buffer_binds", "state_changes" };
+        unsigned int regressions = 0;
+        printf("%-15s %-14s %12s %12s %8s\n", "scenario", "measure", "baseline", "now", "change");
+        const JsonValue& scenarios = beforeRoot["scenarios"];
+        for (size_t s = 0; s < scenarios.Size(); s++)
+        {
+            const JsonValue& old = scenarios[s];
+            const char* name = old["name"].AsString();
+            const JsonValue* found = findScenario(afterRoot, name);
+            if (!found)
+            {
+                printf("%-15s missing from the results, REGRESSED\n", name);
+                regressions++;
+                continue;
+            }
+            const JsonValue& current = *found;
+            for (const char* time : times)
+            {
+                double was = old[time]["median"].AsNumber();
+                double is = current[time]["median"].AsNumber();
+                double growth = is - was;
+                bool regressed = growth > was * threshold && growth > NOISE_DEVIATIONS * old[time]["stddev"].AsNumber() &&
+                    growth > MIN_REGRESSION_MILLISECONDS;
+                regressions += regressed;
+                printf("%-15s %-14s %12.4f %12.4f %+7.1f%%%s\n", name, time, was, is, was > 0.0 ? growth / was * 100.0 : 0.0, regressed ? " REGRESSED" : "");
+            }
+            for (const char* counter : counters)
+            {
+                int was = old[counter].AsInt();
+                int is = current[counter].AsInt();
+                // the counts are exact, any increase is more work
+                bool regressed = is > was;
+                regressions += regressed;
+                if (is != was)
+                    printf("%-15s %-14s %12d %12d %+7.1f%%%s\n", name, counter, was, is, was > 0 ? (is - was) * 100.0 / was : 0.0,
+                        regressed ? " REGRESSED" : "");
+            }
+        }
+        const JsonValue& currentScenarios = afterRoot["scenarios"];
+        for (size_t s = 0; s < currentScenarios.Size(); s++)
+            if (!findScenario(beforeRoot, currentScenarios[s]["name"].AsString()))
+                printf("%-15s new, not in the baseline\n", currentScenarios[s]["name"].AsString());
+
+        if (regressions > 0)
+            printf("%u regression(s)\n", regressions);
+        else
+            printf("no regressions\n");
+        return regressions > 0 ? 1 : 0;
+    }
+}
@@ -0,0 +1,27 @@
+#include <string>
+
+namespace Benchmarks
+{
+    // what Run() renders and where it writes the results
+    struct Settings
+    {
+        std::string Results = "benchmark.json";
+        // frames rendered before measuring, for the driver to settle (shader builds, uploads, clocks)
+        unsigned int WarmupFrames = 30;
+        unsigned int Frames = 300;
+        // cubes drawn by the cube scenarios
+        unsigned int Instances = 1000;
+    };
+
+    // renders every scenario in a hidden window, each frame on its own with glFinish, and writes the CPU, GPU and
+    // frame times and the RenderStats counters of each scenario as JSON. returns 0 when the results were written
+    int Run(const Settings& settings);
+    // streams thousands of synthetic textures through a TextureCache in a hidden window and checks its budget,
+    // evictions, downgrades and counters. prints what failed and returns 0 when everything matched
+    int StressTextureCache();
+    // compares results with a baseline written by Run(): a time regresses when its median grew by more than
+    // threshold (0.1 is 10%) and by more than the baseline's noise, a counter when it grew at all. prints a table
+    // and returns 0 when nothing regressed, 1 when something did and -1 when a file could not be read or the two were
+    // measured at different sizes (width, height or instances)
+    int Compare(const std::string& baseline, const std::string& results, double threshold);
+};
@@ -0,0 +1,357 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "Bindless.h"
+#include "../ShaderPermutations.h"
+#include "../GLExtensions.h"
+#include "../DrawBatch.h"
+#include "../MaterialTextures.h"
+#include "../RenderStats.h"
+
+namespace Bindless
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // GRID_SIZE x GRID_SIZE cubes, each with one of MATERIAL_COUNT materials
+    const int GRID_SIZE = 32;
+    const int MATERIAL_COUNT = 64;
+    // every material texture is resampled to this size so the texture array path can hold them
+    const int MATERIAL_TEXTURE_SIZE = 256;
+
+    // textures the materials are tinted from
+    const char* CONTAINER_TEXTURE = "textures/Container.jpg";
+    const char* FACE_TEXTURE = "textures/Awesomeface.png";
+
+    // the same scene submitted three ways, switched with the 1/2/3 keys
+    enum SubmitMode
+    {
+        PER_DRAW,       // texture binds and a draw call per cube
+        BINDLESS,       // resident handles in a storage buffer, one multi-draw indirect
+        TEXTURE_ARRAY   // the fallback: one texture array, one instanced draw per mesh
+    };
+    const char* MODE_NAMES[] = { "per-draw binds", "bindless + multi-draw", "texture array fallback" };
+    SubmitMode mode = PER_DRAW;
+
+    // the animation advances by a fixed step per frame so every mode renders the same frames
+    const float SCRIPT_STEP = 1.0f / 60.0f;
+
+    // nearest resample of an RGBA image to MATERIAL_TEXTURE_SIZE, multiplied by tint
+    std::vector<unsigned char> makeMaterialTexture(const unsigned char* pixels, int width, int height, const glm::vec3& tint)
+    {
+        std::vector<unsigned char> result((size_t)MATERIAL_TEXTURE_SIZE * MATERIAL_TEXTURE_SIZE * 4);
+        for (int y = 0; y < MATERIAL_TEXTURE_SIZE; y++)
+            for (int x = 0; x < MATERIAL_TEXTURE_SIZE; x++)
+            {
+                const unsigned char* src = &pixels[((size_t)(y * height / MATERIAL_TEXTURE_SIZE) * width + x * width / MATERIAL_TEXTURE_SIZE) * 4];
+                unsigned char* dst = &result[((size_t)y * MATERIAL_TEXTURE_SIZE + x) * 4];
+                for (int c = 0; c < 3; c++)
+                    dst[c] = (unsigned char)(src[c] * tint[c]);
+                dst[3] = src[3];
+            }
+        return result;
+    }
+
+    // a vertex array over the cube vertices, each submit path gets its own so the per-draw attributes do not leak
+    unsigned int createCubeVertexArray(unsigned int VBO)
+    {
+        unsigned int VAO;
+        glGenVertexArrays(1, &VAO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        // position attribute
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        // texture coordinate attribute
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+        return VAO;
+    }
+
+    int Main()
+    {
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        // unthrottled, the submit time is what is measured
+        glfwSwapInterval(0);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        // load the source images and derive MATERIAL_COUNT tinted materials from them
+        stbi_set_flip_vertically_on_load(true);
+        int containerWidth, containerHeight, faceWidth, faceHeight, channels;
+        unsigned char* container = stbi_load(CONTAINER_TEXTURE, &containerWidth, &containerHeight, &channels, 4);
+        unsigned char* face = stbi_load(FACE_TEXTURE, &faceWidth, &faceHeight, &channels, 4);
+        if (!container || !face)
+        {
+            std::cout << "Failed to load texture" << std::endl;
+            return -1;
+        }
+        MaterialTextures bindlessMaterials(MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE, MATERIAL_COUNT);
+        MaterialTextures arrayMaterials(MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE, MATERIAL_COUNT, false);
+        if (!bindlessMaterials.IsBindless())
+            std::cout << "GL_ARB_bindless_texture or GL_ARB_shader_storage_buffer_object missing, mode 2 uses the texture array" << std::endl;
+        // the per-draw path binds plain textures, two per material
+        std::vector<unsigned int> perDrawTextures(MATERIAL_COUNT * MaterialTextures::TEXTURES_PER_MATERIAL);
+        glGenTextures((GLsizei)perDrawTextures.size(), perDrawTextures.data());
+        std::mt19937 random(7);
+        for (int i = 0; i < MATERIAL_COUNT; i++)
+        {
+            glm::vec3 tint(0.4f + (random() % 61) / 100.0f, 0.4f + (random() % 61) / 100.0f, 0.4f + (random() % 61) / 100.0f);
+            std::vector<unsigned char> images[] = {
+                makeMaterialTexture(container, containerWidth, containerHeight, tint),
+                makeMaterialTexture(face, faceWidth, faceHeight, glm::vec3(1.0f))
+            };
+            const unsigned char* pixels[] = { images[0].data(), images[1].data() };
+            bindlessMaterials.Add(pixels);
+            arrayMaterials.Add(pixels);
+            for (int slot = 0; slot < MaterialTextures::TEXTURES_PER_MATERIAL; slot++)
+            {
+                glBindTexture(GL_TEXTURE_2D, perDrawTextures[i * MaterialTextures::TEXTURES_PER_MATERIAL + slot]);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, MATERIAL_TEXTURE_SIZE, MATERIAL_TEXTURE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels[slot]);
+                glGenerateMipmap(GL_TEXTURE_2D);
+            }
+        }
+        bindlessMaterials.Finish();
+        arrayMaterials.Finish();
+        stbi_image_free(container);
+        stbi_image_free(face);
+
+        // one source, a permutation per submit path
+        ShaderPermutations shaders("shaders/VertexShaders/Textures.vs", "shaders/FragmentShaders/Textures.fs", { "BINDLESS", "TEXTURE_ARRAY" });
+        const unsigned int BINDLESS_MASK = bindlessMaterials.IsBindless() ? shaders.Mask("BINDLESS") : shaders.Mask("TEXTURE_ARRAY");
+        const unsigned int TEXTURE_ARRAY_MASK = shaders.Mask("TEXTURE_ARRAY");
+        shaders.Precompile({ 0, BINDLESS_MASK, TEXTURE_ARRAY_MASK });
+        shaders.ForEachBuilt([](Shader& shader)
+        {
+            shader.use();
+            shader.setFloat("mixValue", 0.2f);
+            shader.setInt("texture0", 0);
+            shader.setInt("texture1", 1);
+        });
+
+        // Set up vertex and indices data (and buffer(s)) and configure vertex attributes
+        float vertices[] = {
+            -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+             0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+             0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+            -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+            -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+            -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+             0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+             0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+            -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+        };
+        unsigned int VBO;
+        glGenBuffers(1, &VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        unsigned int perDrawVAO = createCubeVertexArray(VBO);
+        unsigned int bindlessVAO = createCubeVertexArray(VBO);
+        unsigned int arrayVAO = createCubeVertexArray(VBO);
+        DrawBatch bindlessBatch(bindlessVAO);
+        DrawBatch arrayBatch(arrayVAO, false);
+
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 200.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f, GRID_SIZE * 0.9f, GRID_SIZE * 1.1f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        shaders.ForEachBuilt([&](Shader& shader)
+        {
+            shader.use();
+            shader.setMat4("projection", projection);
+            shader.setMat4("view", view);
+        });
+
+        // render loop
+        float scriptTime = 0.0f;
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        unsigned int reportCalls = 0;
+        double reportSubmit = 0.0;
+        SubmitMode reportMode = mode;
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            processInput(window);
+            // a report covers a single mode
+            if (mode != reportMode)
+            {
+                reportStart = glfwGetTime();
+                reportFrames = 0;
+                reportCalls = 0;
+                reportSubmit = 0.0;
+                reportMode = mode;
+            }
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            // CPU time spent issuing the cubes, from the first state change to the last draw call
+            std::chrono::steady_clock::time_point submitStart = std::chrono::steady_clock::now();
+            DrawBatch& batch = mode == BINDLESS ? bindlessBatch : arrayBatch;
+            if (mode != PER_DRAW)
+                batch.Clear();
+            Shader& shader = shaders.Get(mode == PER_DRAW ? 0 : mode == BINDLESS ? BINDLESS_MASK : TEXTURE_ARRAY_MASK);
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            if (mode == PER_DRAW)
+                glBindVertexArray(perDrawVAO);
+            for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+            {
+                int material = i % MATERIAL_COUNT;
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(i % GRID_SIZE - GRID_SIZE * 0.5f, 0.0f, i / GRID_SIZE - GRID_SIZE * 0.5f) * 1.5f);
+                model = glm::rotate(model, scriptTime * glm::radians(20.0f * (i % 7 + 1)), glm::vec3(1.0f, 0.3f, 0.5f));
+                if (mode != PER_DRAW)
+                {
+                    batch.Add(0, 36, model, material);
+                    continue;
+                }
+                for (int slot = 0; slot < MaterialTextures::TEXTURES_PER_MATERIAL; slot++)
+                {
+                    glActiveTexture(GL_TEXTURE0 + slot);
+                    glBindTexture(GL_TEXTURE_2D, perDrawTextures[material * MaterialTextures::TEXTURES_PER_MATERIAL + slot]);
+                    RenderStats::Frame.TextureBinds++;
+                }
+                shader.setMat4("model", model);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += 12;
+            }
+            if (mode != PER_DRAW)
+            {
+                (mode == BINDLESS ? bindlessMaterials : arrayMaterials).Bind(shader, 0);
+                batch.Submit();
+            }
+            reportSubmit += std::chrono::duration<double>(std::chrono::steady_clock::now() - submitStart).count();
+
+            RenderStats::EndFrame();
+            reportCalls += RenderStats::Last.DrawCalls;
+            reportFrames++;
+            scriptTime += SCRIPT_STEP;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                double calls = (double)reportCalls / reportFrames;
+                printf("%-24s draws %4d, GL draw calls/frame %7.1f (%6.1f draws merged per call), submit %6.3f ms, frame %6.3f ms\n",
+                    MODE_NAMES[reportMode], GRID_SIZE * GRID_SIZE, calls, GRID_SIZE * GRID_SIZE / calls,
+                    reportSubmit * 1000.0 / reportFrames, (now - reportStart) * 1000.0 / reportFrames);
+                reportStart = now;
+                reportFrames = 0;
+                reportCalls = 0;
+                reportSubmit = 0.0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &perDrawVAO);
+        glDeleteVertexArrays(1, &bindlessVAO);
+        glDeleteVertexArrays(1, &arrayVAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures((GLsizei)perDrawTextures.size(), perDrawTextures.data());
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            mode = PER_DRAW;
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+            mode = BINDLESS;
+        if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+            mode = TEXTURE_ARRAY;
+    }
+}
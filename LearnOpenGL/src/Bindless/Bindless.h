@@ -0,0 +1,4 @@
+namespace Bindless
+{
+    int Main();
+};
\ No newline at end of file
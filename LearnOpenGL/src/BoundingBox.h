@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// an axis aligned box, empty (Min above Max) until something is added
+struct BoundingBox
+{
+    glm::vec3 Min = glm::vec3(1e30f);
+    glm::vec3 Max = glm::vec3(-1e30f);
+
+    BoundingBox() = default;
+    BoundingBox(const glm::vec3& min, const glm::vec3& max) : Min(min), Max(max) {}
+
+    bool IsEmpty() const { return Min.x > Max.x || Min.y > Max.y || Min.z > Max.z; }
+    glm::vec3 Center() const { return (Min + Max) * 0.5f; }
+    glm::vec3 Extent() const { return Max - Min; }
+    // of the whole box, the SAH weighs children by it
+    float SurfaceArea() const
+    {
+        glm::vec3 extent = glm::max(Max - Min, glm::vec3(0.0f));
+        return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+
+    void Add(const glm::vec3& point)
+    {
+        Min = glm::min(Min, point);
+        Max = glm::max(Max, point);
+    }
+    void Add(const BoundingBox& box)
+    {
+        Min = glm::min(Min, box.Min);
+        Max = glm::max(Max, box.Max);
+    }
+    bool Overlaps(const BoundingBox& box) const
+    {
+        return Min.x <= box.Max.x && Max.x >= box.Min.x && Min.y <= box.Max.y && Max.y >= box.Min.y && Min.z <= box.Max.z && Max.z >= box.Min.z;
+    }
+    bool Contains(const glm::vec3& point) const
+    {
+        return point.x >= Min.x && point.x <= Max.x && point.y >= Min.y && point.y <= Max.y && point.z >= Min.z && point.z <= Max.z;
+    }
+
+    // the box around this one after transform, e.g. a rotated model
+    BoundingBox Transformed(const glm::mat4& transform) const
+    {
+        // the extent along every world axis is the sum of the absolute matrix entries times the half extent
+        glm::vec3 center = glm::vec3(transform * glm::vec4(Center(), 1.0f));
+        glm::vec3 half = Extent() * 0.5f;
+        glm::vec3 extent(0.0f);
+        for (int column = 0; column < 3; column++)
+            extent += glm::abs(glm::vec3(transform[column])) * half[column];
+        return BoundingBox(center - extent, center + extent);
+    }
+};
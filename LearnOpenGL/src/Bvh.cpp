@@ -0,0 +1,537 @@
+#include "Bvh.h"
+#include <algorithm>
+#include <chrono>
+#include <xmmintrin.h>
+
+namespace
+{
+    // a 4-wide node pushes at most three children more than it pops, at most MAX_DEPTH levels deep
+    const int STACK_SIZE = Bvh::MAX_DEPTH * 3 + 4;
+
+    struct BuildNode
+    {
+        BoundingBox Bounds;
+        // of the object centers, what the bins split
+        BoundingBox CenterBounds;
+        // children in the build array, -1 for leaves
+        int Left = -1;
+        int Right = -1;
+        // range of the sorted references
+        unsigned int First = 0;
+        unsigned int Count = 0;
+    };
+
+    // an object during the build, sorted along with its box so the passes over a node read memory in order.
+    // binning loads Box.Min, Box.Max and Center as four floats each, the fourth lane is whatever follows
+    struct Reference
+    {
+        BoundingBox Box;
+        glm::vec3 Center;
+        unsigned int Object;
+    };
+
+    // the boxes of a bin in SSE registers
+    struct Bin
+    {
+        __m128 Min = _mm_set1_ps(1e30f);
+        __m128 Max = _mm_set1_ps(-1e30f);
+        __m128 CenterMin = _mm_set1_ps(1e30f);
+        __m128 CenterMax = _mm_set1_ps(-1e30f);
+        unsigned int Count = 0;
+
+        BoundingBox Bounds() const { return toBox(Min, Max); }
+        BoundingBox CenterBounds() const { return toBox(CenterMin, CenterMax); }
+        float SurfaceArea() const
+        {
+            float extent[4];
+            _mm_storeu_ps(extent, _mm_max_ps(_mm_sub_ps(Max, Min), _mm_setzero_ps()));
+            return 2.0f * (extent[0] * extent[1] + extent[1] * extent[2] + extent[2] * extent[0]);
+        }
+
+        static BoundingBox toBox(__m128 min, __m128 max)
+        {
+            float lanes[8];
+            _mm_storeu_ps(lanes, min);
+            _mm_storeu_ps(lanes + 4, max);
+            return BoundingBox(glm::vec3(lanes[0], lanes[1], lanes[2]), glm::vec3(lanes[4], lanes[5], lanes[6]));
+        }
+    };
+
+    // lanes of a node that hold a child
+    template <typename Node>
+    int occupiedLanes(const Node& node)
+    {
+        return (node.Children[0] >= 0) | (node.Children[1] >= 0) << 1 | (node.Children[2] >= 0) << 2 | (node.Children[3] >= 0) << 3;
+    }
+
+    bool boxOutside(const BoundingBox& box, const glm::vec4 planes[6])
+    {
+        for (int p = 0; p < 6; p++)
+        {
+            // the corner furthest along the plane normal
+            glm::vec3 corner(planes[p].x >= 0.0f ? box.Max.x : box.Min.x, planes[p].y >= 0.0f ? box.Max.y : box.Min.y, planes[p].z >= 0.0f ? box.Max.z : box.Min.z);
+            if (glm::dot(glm::vec3(planes[p]), corner) + planes[p].w < 0.0f)
+                return true;
+        }
+        return false;
+    }
+
+    bool rayHitsBox(const BoundingBox& box, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& distance)
+    {
+        glm::vec3 t1 = (box.Min - origin) * inverseDirection, t2 = (box.Max - origin) * inverseDirection;
+        glm::vec3 entries = glm::min(t1, t2), exits = glm::max(t1, t2);
+        float enter = std::max(std::max(entries.x, entries.y), std::max(entries.z, 0.0f));
+        float exit = std::min(std::min(exits.x, exits.y), std::min(exits.z, maxDistance));
+        distance = enter;
+        return enter <= exit;
+    }
+}
+
+void Bvh::Build(const std::vector<BoundingBox>& boxes)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    nodes.clear();
+    leafObjects.resize(boxes.size());
+    if (boxes.empty())
+    {
+        leafBoxes.clear();
+        BuildSeconds = 0.0;
+        return;
+    }
+    std::vector<Reference> references(boxes.size());
+    BuildNode root;
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        references[i].Box = boxes[i];
+        references[i].Center = boxes[i].Center();
+        references[i].Object = (unsigned int)i;
+        root.Bounds.Add(boxes[i]);
+        root.CenterBounds.Add(references[i].Center);
+    }
+    root.Count = (unsigned int)boxes.size();
+
+    // binary tree first, split by the binned SAH over the object centers. a node's bounds come from the bins of
+    // its parent, so every node costs one pass over its objects
+    std::vector<BuildNode> build;
+    build.reserve(boxes.size() * 2);
+    build.push_back(root);
+    // node and its depth
+    std::vector<std::pair<int, unsigned int>> pending = { { 0, 0u } };
+    while (!pending.empty())
+    {
+        int index = pending.back().first;
+        unsigned int depth = pending.back().second;
+        pending.pop_back();
+        unsigned int first = build[index].First, count = build[index].Count;
+        BoundingBox centerBounds = build[index].CenterBounds;
+        // a leaf is tested as fast as a node, splitting it further only adds nodes
+        if (count <= MAX_LEAF_SIZE || depth >= MAX_DEPTH)
+            continue;
+
+        // bins along the axis the centers spread most on, testing all three costs three times the passes for
+        // trees that are hardly better
+        glm::vec3 centerExtent = centerBounds.Extent();
+        int axis = centerExtent.x >= centerExtent.y ? (centerExtent.x >= centerExtent.z ? 0 : 2) : (centerExtent.y >= centerExtent.z ? 1 : 2);
+        float minimum = centerBounds.Min[axis];
+        float scale = centerExtent[axis] > 0.0f ? BIN_COUNT / centerExtent[axis] : 0.0f;
+        auto binOf = [&](const Reference& reference)
+        {
+            return std::min((unsigned int)((reference.Center[axis] - minimum) * scale), BIN_COUNT - 1);
+        };
+
+        int bestSplit = -1;
+        Bin bins[BIN_COUNT];
+        if (centerExtent[axis] > 0.0f)
+        {
+            for (unsigned int i = first; i < first + count; i++)
+            {
+                const Reference& reference = references[i];
+                Bin& bin = bins[binOf(reference)];
+                bin.Min = _mm_min_ps(bin.Min, _mm_loadu_ps(&reference.Box.Min.x));
+                bin.Max = _mm_max_ps(bin.Max, _mm_loadu_ps(&reference.Box.Max.x));
+                __m128 center = _mm_loadu_ps(&reference.Center.x);
+                bin.CenterMin = _mm_min_ps(bin.CenterMin, center);
+                bin.CenterMax = _mm_max_ps(bin.CenterMax, center);
+                bin.Count++;
+            }
+
+            // areas and counts of everything left of each split plane, then sweep in from the right
+            float leftArea[BIN_COUNT - 1];
+            unsigned int leftCount[BIN_COUNT - 1];
+            Bin left;
+            for (unsigned int b = 0; b + 1 < BIN_COUNT; b++)
+            {
+                left.Min = _mm_min_ps(left.Min, bins[b].Min);
+                left.Max = _mm_max_ps(left.Max, bins[b].Max);
+                left.Count += bins[b].Count;
+                leftArea[b] = left.SurfaceArea();
+                leftCount[b] = left.Count;
+            }
+            Bin right;
+            float bestCost = 1e30f;
+            for (unsigned int b = BIN_COUNT - 1; b > 0; b--)
+            {
+                right.Min = _mm_min_ps(right.Min, bins[b].Min);
+                right.Max = _mm_max_ps(right.Max, bins[b].Max);
+                right.Count += bins[b].Count;
+                if (leftCount[b - 1] == 0 || right.Count == 0)
+                    continue;
+                float cost = leftArea[b - 1] * leftCount[b - 1] + right.SurfaceArea() * right.Count;
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestSplit = (int)b - 1;
+                }
+            }
+        }
+
+        BuildNode leftNode, rightNode;
+        if (bestSplit < 0)
+        {
+            // every center in one spot, the SAH cannot tell them apart: halve the range
+            leftNode.Count = count / 2;
+            for (unsigned int i = first; i < first + count; i++)
+            {
+                BuildNode& side = i < first + leftNode.Count ? leftNode : rightNode;
+                side.Bounds.Add(references[i].Box);
+                side.CenterBounds.Add(references[i].Center);
+            }
+        }
+        else
+        {
+            for (int b = 0; b < (int)BIN_COUNT; b++)
+            {
+                BuildNode& side = b <= bestSplit ? leftNode : rightNode;
+                side.Bounds.Add(bins[b].Bounds());
+                side.CenterBounds.Add(bins[b].CenterBounds());
+                side.Count += bins[b].Count;
+            }
+            std::partition(&references[first], &references[first] + count, [&](const Reference& reference)
+            {
+                return (int)binOf(reference) <= bestSplit;
+            });
+        }
+        leftNode.First = first;
+        rightNode.First = first + leftNode.Count;
+        rightNode.Count = count - leftNode.Count;
+
+        int leftIndex = (int)build.size();
+        build.push_back(leftNode);
+        build.push_back(rightNode);
+        build[index].Left = leftIndex;
+        build[index].Right = leftIndex + 1;
+        pending.push_back({ leftIndex, depth + 1 });
+        pending.push_back({ leftIndex + 1, depth + 1 });
+    }
+
+    // collapse into 4-wide nodes: a node takes the two children of its binary node, then keeps opening its largest
+    // inner child until it has four
+    std::vector<std::pair<int, int>> collapse = { { 0, (int)nodes.size() } };
+    nodes.push_back(Node());
+    while (!collapse.empty())
+    {
+        int binary = collapse.back().first, target = collapse.back().second;
+        collapse.pop_back();
+        std::vector<int> children;
+        if (build[binary].Left < 0)
+            children.push_back(binary);
+        else
+            children = { build[binary].Left, build[binary].Right };
+        while (children.size() < 4)
+        {
+            int largest = -1;
+            float largestArea = -1.0f;
+            for (size_t c = 0; c < children.size(); c++)
+            {
+                if (build[children[c]].Left >= 0 && build[children[c]].Bounds.SurfaceArea() > largestArea)
+                {
+                    largest = (int)c;
+                    largestArea = build[children[c]].Bounds.SurfaceArea();
+                }
+            }
+            if (largest < 0)
+                break;
+            int opened = children[largest];
+            children[largest] = build[opened].Left;
+            children.push_back(build[opened].Right);
+        }
+
+        Node node;
+        for (int lane = 0; lane < 4; lane++)
+        {
+            BoundingBox box;
+            node.Children[lane] = -1;
+            node.Counts[lane] = 0;
+            if (lane < (int)children.size())
+            {
+                const BuildNode& child = build[children[lane]];
+                box = child.Bounds;
+                if (child.Left < 0)
+                {
+                    node.Children[lane] = (int)child.First;
+                    node.Counts[lane] = child.Count;
+                }
+                else
+                {
+                    node.Children[lane] = (int)nodes.size();
+                    collapse.push_back({ children[lane], (int)nodes.size() });
+                    nodes.push_back(Node());
+                }
+            }
+            node.MinX[lane] = box.Min.x;
+            node.MinY[lane] = box.Min.y;
+            node.MinZ[lane] = box.Min.z;
+            node.MaxX[lane] = box.Max.x;
+            node.MaxY[lane] = box.Max.y;
+            node.MaxZ[lane] = box.Max.z;
+        }
+        nodes[target] = node;
+    }
+
+    leafBoxes.resize(boxes.size());
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        leafObjects[i] = references[i].Object;
+        leafBoxes[i] = references[i].Box;
+    }
+    BuildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Bvh::Refit(const std::vector<BoundingBox>& boxes)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < leafBoxes.size(); i++)
+        leafBoxes[i] = boxes[leafObjects[i]];
+    for (size_t n = nodes.size(); n-- > 0;)
+    {
+        Node& node = nodes[n];
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (node.Children[lane] < 0)
+                continue;
+            BoundingBox box;
+            if (node.Counts[lane] > 0)
+            {
+                for (unsigned int i = 0; i < node.Counts[lane]; i++)
+                    box.Add(leafBoxes[node.Children[lane] + i]);
+            }
+            else
+            {
+                // children are after their parents, so already refitted
+                const Node& child = nodes[node.Children[lane]];
+                box.Min.x = std::min(std::min(child.MinX[0], child.MinX[1]), std::min(child.MinX[2], child.MinX[3]));
+                box.Min.y = std::min(std::min(child.MinY[0], child.MinY[1]), std::min(child.MinY[2], child.MinY[3]));
+                box.Min.z = std::min(std::min(child.MinZ[0], child.MinZ[1]), std::min(child.MinZ[2], child.MinZ[3]));
+                box.Max.x = std::max(std::max(child.MaxX[0], child.MaxX[1]), std::max(child.MaxX[2], child.MaxX[3]));
+                box.Max.y = std::max(std::max(child.MaxY[0], child.MaxY[1]), std::max(child.MaxY[2], child.MaxY[3]));
+                box.Max.z = std::max(std::max(child.MaxZ[0], child.MaxZ[1]), std::max(child.MaxZ[2], child.MaxZ[3]));
+            }
+            node.MinX[lane] = box.Min.x;
+            node.MinY[lane] = box.Min.y;
+            node.MinZ[lane] = box.Min.z;
+            node.MaxX[lane] = box.Max.x;
+            node.MaxY[lane] = box.Max.y;
+            node.MaxZ[lane] = box.Max.z;
+        }
+    }
+    RefitSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Bvh::collect(int node, std::vector<unsigned int>& objects) const
+{
+    const Node& current = nodes[node];
+    for (int lane = 0; lane < 4; lane++)
+    {
+        if (current.Counts[lane] > 0)
+            objects.insert(objects.end(), &leafObjects[current.Children[lane]], &leafObjects[current.Children[lane]] + current.Counts[lane]);
+        else if (current.Children[lane] >= 0)
+            collect(current.Children[lane], objects);
+    }
+}
+
+void Bvh::QueryFrustum(const glm::vec4 planes[6], std::vector<unsigned int>& objects) const
+{
+    if (nodes.empty())
+        return;
+    // per plane the corner furthest along its normal decides outside, the nearest one inside. as offsets from
+    // MinX: the max arrays are 12 floats after the min arrays
+    int farCorner[6][3], nearCorner[6][3];
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int p = 0; p < 6; p++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            bool positive = planes[p][axis] >= 0.0f;
+            farCorner[p][axis] = axis * 4 + (positive ? 12 : 0);
+            nearCorner[p][axis] = axis * 4 + (positive ? 0 : 12);
+        }
+        planeX[p] = _mm_set1_ps(planes[p].x);
+        planeY[p] = _mm_set1_ps(planes[p].y);
+        planeZ[p] = _mm_set1_ps(planes[p].z);
+        planeW[p] = _mm_set1_ps(planes[p].w);
+    }
+    __m128 zero = _mm_setzero_ps();
+
+    int stack[STACK_SIZE];
+    int size = 0;
+    stack[size++] = 0;
+    while (size > 0)
+    {
+        const Node& node = nodes[stack[--size]];
+        const float* bounds = node.MinX;
+        __m128 outside = _mm_setzero_ps();
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 farDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], _mm_loadu_ps(bounds + farCorner[p][0])), _mm_mul_ps(planeY[p], _mm_loadu_ps(bounds + farCorner[p][1]))),
+                _mm_add_ps(_mm_mul_ps(planeZ[p], _mm_loadu_ps(bounds + farCorner[p][2])), planeW[p]));
+            __m128 nearDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], _mm_loadu_ps(bounds + nearCorner[p][0])), _mm_mul_ps(planeY[p], _mm_loadu_ps(bounds + nearCorner[p][1]))),
+                _mm_add_ps(_mm_mul_ps(planeZ[p], _mm_loadu_ps(bounds + nearCorner[p][2])), planeW[p]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(farDistance, zero));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(nearDistance, zero));
+        }
+        int visible = ~_mm_movemask_ps(outside) & occupiedLanes(node);
+        int contained = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (!(visible & (1 << lane)))
+                continue;
+            int child = node.Children[lane];
+            unsigned int count = node.Counts[lane];
+            if (contained & (1 << lane))
+            {
+                // entirely inside, everything below is visible without further tests
+                if (count > 0)
+                    objects.insert(objects.end(), &leafObjects[child], &leafObjects[child] + count);
+                else
+                    collect(child, objects);
+            }
+            else if (count > 0)
+            {
+                for (unsigned int i = child; i < child + count; i++)
+                {
+                    if (!boxOutside(leafBoxes[i], planes))
+                        objects.push_back(leafObjects[i]);
+                }
+            }
+            else
+                stack[size++] = child;
+        }
+    }
+}
+
+void Bvh::QuerySphere(const glm::vec3& center, float radius, std::vector<unsigned int>& objects) const
+{
+    if (nodes.empty())
+        return;
+    __m128 centerX = _mm_set1_ps(center.x), centerY = _mm_set1_ps(center.y), centerZ = _mm_set1_ps(center.z);
+    __m128 radiusSquared = _mm_set1_ps(radius * radius);
+    __m128 zero = _mm_setzero_ps();
+
+    int stack[STACK_SIZE];
+    int size = 0;
+    stack[size++] = 0;
+    while (size > 0)
+    {
+        const Node& node = nodes[stack[--size]];
+        // distance from the center to each box, per axis the part outside the box's range
+        __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(node.MinX), centerX), _mm_sub_ps(centerX, _mm_loadu_ps(node.MaxX))), zero);
+        __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(node.MinY), centerY), _mm_sub_ps(centerY, _mm_loadu_ps(node.MaxY))), zero);
+        __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(node.MinZ), centerZ), _mm_sub_ps(centerZ, _mm_loadu_ps(node.MaxZ))), zero);
+        __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        int touched = _mm_movemask_ps(_mm_cmple_ps(distanceSquared, radiusSquared)) & occupiedLanes(node);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (!(touched & (1 << lane)))
+                continue;
+            int child = node.Children[lane];
+            if (node.Counts[lane] == 0)
+            {
+                stack[size++] = child;
+                continue;
+            }
+            for (unsigned int i = child; i < child + node.Counts[lane]; i++)
+            {
+                glm::vec3 outside = glm::max(glm::max(leafBoxes[i].Min - center, center - leafBoxes[i].Max), glm::vec3(0.0f));
+                if (glm::dot(outside, outside) <= radius * radius)
+                    objects.push_back(leafObjects[i]);
+            }
+        }
+    }
+}
+
+bool Bvh::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, BvhRayHit& hit) const
+{
+    if (nodes.empty())
+        return false;
+    glm::vec3 inverseDirection = 1.0f / direction;
+    __m128 originX = _mm_set1_ps(origin.x), originY = _mm_set1_ps(origin.y), originZ = _mm_set1_ps(origin.z);
+    __m128 inverseX = _mm_set1_ps(inverseDirection.x), inverseY = _mm_set1_ps(inverseDirection.y), inverseZ = _mm_set1_ps(inverseDirection.z);
+    float nearest = maxDistance;
+    bool found = false;
+
+    // nodes with the distance their box was entered at, the nearest on top
+    int stack[STACK_SIZE];
+    float stackDistances[STACK_SIZE];
+    int size = 0;
+    stack[size] = 0;
+    stackDistances[size++] = 0.0f;
+    while (size > 0)
+    {
+        size--;
+        if (stackDistances[size] > nearest)
+            continue;
+        const Node& node = nodes[stack[size]];
+        __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MinX), originX), inverseX), x2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MaxX), originX), inverseX);
+        __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MinY), originY), inverseY), y2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MaxY), originY), inverseY);
+        __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MinZ), originZ), inverseZ), z2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.MaxZ), originZ), inverseZ);
+        __m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(x1, x2), _mm_min_ps(y1, y2)), _mm_max_ps(_mm_min_ps(z1, z2), _mm_setzero_ps()));
+        __m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(x1, x2), _mm_max_ps(y1, y2)), _mm_min_ps(_mm_max_ps(z1, z2), _mm_set1_ps(nearest)));
+        int hits = _mm_movemask_ps(_mm_cmple_ps(enter, exit)) & occupiedLanes(node);
+        if (!hits)
+            continue;
+        float distances[4];
+        _mm_storeu_ps(distances, enter);
+
+        // children by entry distance: leaves are tested at once nearest first, which shrinks nearest for the
+        // rest, inner nodes are pushed farthest first
+        int order[4], hitCount = 0;
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (hits & (1 << lane))
+                order[hitCount++] = lane;
+        }
+        for (int h = 1; h < hitCount; h++)
+        {
+            for (int j = h; j > 0 && distances[order[j]] < distances[order[j - 1]]; j--)
+                std::swap(order[j], order[j - 1]);
+        }
+        for (int h = 0; h < hitCount; h++)
+        {
+            int lane = order[h];
+            if (node.Counts[lane] == 0 || distances[lane] > nearest)
+                continue;
+            for (unsigned int i = node.Children[lane]; i < node.Children[lane] + node.Counts[lane]; i++)
+            {
+                float distance;
+                if (rayHitsBox(leafBoxes[i], origin, inverseDirection, nearest, distance) && distance <= nearest)
+                {
+                    nearest = distance;
+                    hit.Object = leafObjects[i];
+                    hit.Distance = distance;
+                    found = true;
+                }
+            }
+        }
+        for (int h = hitCount; h-- > 0;)
+        {
+            int lane = order[h];
+            if (node.Counts[lane] == 0 && distances[lane] <= nearest)
+            {
+                stack[size] = node.Children[lane];
+                stackDistances[size++] = distances[lane];
+            }
+        }
+    }
+    return found;
+}
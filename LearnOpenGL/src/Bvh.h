@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include "BoundingBox.h"
+
+// the nearest object a ray hits
+struct BvhRayHit
+{
+    unsigned int Object = 0;
+    float Distance = 0.0f;
+};
+
+// Bounding volume hierarchy over object boxes for culling, picking and collision queries. built top down with a
+// binned surface area heuristic, then collapsed into a flat array of 4-wide nodes that keep their children's boxes
+// as a structure of arrays, so one SSE test checks all four children. moving objects only need Refit().
+class Bvh
+{
+public:
+    // objects a leaf holds at most, unless it is at MAX_DEPTH
+    static const unsigned int MAX_LEAF_SIZE = 4;
+    // centroid bins per axis of the SAH
+    static const unsigned int BIN_COUNT = 16;
+    // deeper nodes become leaves whatever their size, which bounds the fixed traversal stacks
+    static const unsigned int MAX_DEPTH = 64;
+
+    // builds over boxes, object i is boxes[i]
+    void Build(const std::vector<BoundingBox>& boxes);
+    // updates the node boxes to the moved boxes without changing the tree, boxes holds the same objects as in
+    // Build(). cheap but the tree gets worse as objects move far from where they were, rebuild now and then
+    void Refit(const std::vector<BoundingBox>& boxes);
+
+    // appends the objects whose box is at least partly inside all planes, planes as ClusterCuller::ExtractFrustumPlanes
+    void QueryFrustum(const glm::vec4 planes[6], std::vector<unsigned int>& objects) const;
+    // appends the objects whose box is within radius of center
+    void QuerySphere(const glm::vec3& center, float radius, std::vector<unsigned int>& objects) const;
+    // the nearest object box the ray hits within maxDistance, direction needs no normalizing (distances are in
+    // units of its length). false when nothing is hit
+    bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, BvhRayHit& hit) const;
+
+    bool IsEmpty() const { return nodes.empty(); }
+    size_t GetNodeCount() const { return nodes.size(); }
+    double BuildSeconds = 0.0;
+    double RefitSeconds = 0.0;
+
+private:
+    // the boxes of up to four children, empty slots have an empty box. a child is another node when Counts is 0
+    // and Children >= 0, a leaf of Counts objects from leafObjects[Children] when Counts is above 0
+    struct Node
+    {
+        float MinX[4], MinY[4], MinZ[4];
+        float MaxX[4], MaxY[4], MaxZ[4];
+        int Children[4];
+        unsigned int Counts[4];
+    };
+
+    // parents come before their children, Refit() walks the array backwards
+    std::vector<Node> nodes;
+    // objects in leaf order and their boxes in the same order, leaves read them contiguously
+    std::vector<unsigned int> leafObjects;
+    std::vector<BoundingBox> leafBoxes;
+
+    // appends every object below node, for subtrees entirely inside the frustum
+    void collect(int node, std::vector<unsigned int>& objects) const;
+};
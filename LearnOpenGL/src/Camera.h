@@ -1,7 +1,11 @@
+#pragma once
+
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "AlignedMath.h"
+
 #include <vector>
 
 // Defines several possible options for camera movement. Used as abstraction to stay away from window-system specific input methods
@@ -24,12 +28,13 @@ const float ZOOM = 45.0f;
 class Camera
 {
 public:
-    // camera Attributes
-    glm::vec3 Position;
-    glm::vec3 Front;
-    glm::vec3 Up;
-    glm::vec3 Right;
-    glm::vec3 WorldUp;
+    // camera Attributes. the aligned vec3 is only padded to 16 bytes in the SIMD configurations, glm has no SIMD code
+    // for vec3 math, so the view matrix is built the same way in every configuration
+    AlignedVec3 Position;
+    AlignedVec3 Front;
+    AlignedVec3 Up;
+    AlignedVec3 Right;
+    AlignedVec3 WorldUp;
     // euler Angles
     float Yaw;
     float Pitch;
@@ -0,0 +1,472 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "Cameras.h"
+#include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../Camera.h"
+#include "../InputQueue.h"
+#include "../QuaternionCamera.h"
+#include "../RenderStats.h"
+#include "../VertexFormat.h"
+
+namespace Cameras
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // mouse events per frame in the benchmark, like a mouse polled at 1000 Hz and more while a frame takes long,
+    // and the frames the fastest of BENCHMARK_ROUNDS runs is averaged over
+    const unsigned int EVENTS_PER_FRAME = 1000;
+    const unsigned int BENCHMARK_FRAMES = 1000;
+    const unsigned int BENCHMARK_ROUNDS = 5;
+    // frames of random mouse offsets the two cameras are compared over
+    const unsigned int TEST_FRAMES = 10000;
+
+    // the scene, a field of cubes of different heights around the orbit target
+    const int CUBES_X = 30;
+    const int CUBES_Z = 30;
+    const float CUBE_SPACING = 3.0f;
+    const float SMOOTH_TIME = 0.08f;
+
+    // switched with the 1/2/3/4 keys: Camera, QuaternionCamera, QuaternionCamera smoothed, and orbiting the center
+    enum class Mode
+    {
+        Euler,
+        Quaternion,
+        Smoothed,
+        Orbit
+    };
+    const char* MODE_NAMES[] = { "Camera, trig per event", "QuaternionCamera", "QuaternionCamera, smoothed", "QuaternionCamera, orbiting" };
+    Mode mode = Mode::Quaternion;
+
+    // camera
+    const glm::vec3 START_POSITION(0.0f, 8.0f, CUBES_Z * CUBE_SPACING * 0.5f + 10.0f);
+    Camera camera(START_POSITION);
+    QuaternionCamera quaternionCamera(START_POSITION);
+
+    bool firstMouse = true;
+    float mouseLastX = SCR_WIDTH / 2.0;
+    float mouseLastY = SCR_HEIGHT / 2.0;
+
+    // the time spent on the camera, in the mouse callback and in its update
+    double cameraSeconds = 0.0;
+    unsigned int mouseEvents = 0;
+
+    // timing
+    float deltaTime = 0.0f;	// Time between current frame and last frame
+    float lastFrame = 0.0f;
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    float largestDifference(glm::vec3 a, glm::vec3 b)
+    {
+        glm::vec3 difference = glm::abs(a - b);
+        return std::max(difference.x, std::max(difference.y, difference.z));
+    }
+
+    float largestDifference(const glm::mat4& a, const glm::mat4& b)
+    {
+        float largest = 0.0f;
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+                largest = std::max(largest, std::fabs(a[column][row] - b[column][row]));
+        return largest;
+    }
+
+    // without smoothing and with one event per frame QuaternionCamera has to follow the same path as Camera, pitch
+    // limits included; then the same with many events per frame, where only the position of the pitch clamp differs,
+    // and the spring, which has to end on the mouse without overshooting. returns whether all passed
+    bool runTests()
+    {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> offset(-60.0f, 60.0f);
+        bool allPassed = true;
+
+        Camera euler(START_POSITION);
+        QuaternionCamera quaternion(START_POSITION);
+        float vectorError = 0.0f, viewError = 0.0f;
+        for (unsigned int frame = 0; frame < TEST_FRAMES; frame++)
+        {
+            float x = offset(random), y = offset(random);
+            euler.ProcessMouseMovement(x, y);
+            quaternion.ProcessMouseMovement(x, y);
+            quaternion.Update(1.0f / 60.0f);
+            vectorError = std::max(vectorError, largestDifference(euler.Front, quaternion.Front));
+            vectorError = std::max(vectorError, largestDifference(euler.Right, quaternion.Right));
+            vectorError = std::max(vectorError, largestDifference(euler.Up, quaternion.Up));
+            viewError = std::max(viewError, largestDifference(euler.GetViewMatrix(), quaternion.GetViewMatrix()));
+        }
+        // the translation is the position dotted with the vectors, so its error grows with the distance from the origin
+        bool passed = vectorError < 1e-5f && viewError < 1e-5f * (1.0f + glm::length(START_POSITION));
+        allPassed &= passed;
+        printf("QuaternionCamera against Camera over %u frames: Front, Right and Up within %.1e, view matrix within %.1e, %s\n",
+            TEST_FRAMES, vectorError, viewError, passed ? "passed" : "FAILED");
+
+        // small offsets that stay clear of the pitch limits, so adding them up first changes nothing
+        std::uniform_real_distribution<float> small(-0.5f, 0.5f);
+        Camera batchedEuler(START_POSITION);
+        QuaternionCamera batched(START_POSITION);
+        for (unsigned int frame = 0; frame < 100; frame++)
+        {
+            for (unsigned int event = 0; event < EVENTS_PER_FRAME; event++)
+            {
+                float x = small(random), y = small(random);
+                batchedEuler.ProcessMouseMovement(x, y);
+                batched.ProcessMouseMovement(x, y);
+            }
+            batched.Update(1.0f / 60.0f);
+        }
+        float batchedError = largestDifference(batchedEuler.Front, batched.Front);
+        passed = batchedError < 1e-4f;
+        allPassed &= passed;
+        printf("  %u events per frame, Front within %.1e, %s\n", EVENTS_PER_FRAME, batchedError, passed ? "passed" : "FAILED");
+
+        // one mouse jump, then the spring alone for two seconds
+        QuaternionCamera smoothed(START_POSITION);
+        smoothed.SmoothTime = SMOOTH_TIME;
+        smoothed.ProcessMouseMovement(300.0f, 200.0f);
+        float overshoot = 0.0f;
+        for (int frame = 0; frame < 120; frame++)
+        {
+            smoothed.Update(1.0f / 60.0f);
+            overshoot = std::max(overshoot, std::max(smoothed.Yaw - (YAW + 30.0f), smoothed.Pitch - 20.0f));
+        }
+        float settled = std::max(std::fabs(smoothed.Yaw - (YAW + 30.0f)), std::fabs(smoothed.Pitch - 20.0f));
+        passed = overshoot <= 1e-4f && settled < 1e-3f;
+        allPassed &= passed;
+        printf("  smoothing over %.2f s, overshoot %.1e degrees, %.1e degrees off after 2 s, %s\n", SMOOTH_TIME, overshoot, settled,
+            passed ? "passed" : "FAILED");
+        return allPassed;
+    }
+
+    // the fastest of BENCHMARK_ROUNDS runs of BENCHMARK_FRAMES frames, in microseconds per frame
+    template<typename Function>
+    double microsecondsPerFrame(Function frame)
+    {
+        double fastest = 1e30;
+        for (unsigned int round = 0; round < BENCHMARK_ROUNDS; round++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (unsigned int i = 0; i < BENCHMARK_FRAMES; i++)
+                frame(i);
+            fastest = std::min(fastest, secondsSince(start));
+        }
+        return fastest / BENCHMARK_FRAMES * 1e6;
+    }
+
+    // EVENTS_PER_FRAME mouse events and one view matrix per frame, the last time with the events going through an
+    // InputQueue as cursor positions, fed by a replay like the window's callbacks would
+    void runBenchmark()
+    {
+        std::mt19937 random(2);
+        std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+        std::vector<glm::vec2> offsets(EVENTS_PER_FRAME);
+        for (glm::vec2& event : offsets)
+            event = glm::vec2(offset(random), offset(random));
+        // read after the loops so the view matrices are not optimized away
+        float sink = 0.0f;
+
+        printf("%u mouse events and a view matrix per frame, microseconds per frame\n", EVENTS_PER_FRAME);
+        Camera euler(START_POSITION);
+        printf("  Camera                      %8.2f\n", microsecondsPerFrame([&](unsigned int)
+        {
+            for (const glm::vec2& event : offsets)
+                euler.ProcessMouseMovement(event.x, event.y);
+            sink += euler.GetViewMatrix()[3][0];
+        }));
+        for (int smoothing = 0; smoothing < 2; smoothing++)
+        {
+            QuaternionCamera quaternion(START_POSITION);
+            quaternion.SmoothTime = smoothing ? SMOOTH_TIME : 0.0f;
+            printf("  QuaternionCamera%-12s%8.2f\n", smoothing ? ", smoothed" : "", microsecondsPerFrame([&](unsigned int)
+            {
+                for (const glm::vec2& event : offsets)
+                    quaternion.ProcessMouseMovement(event.x, event.y);
+                quaternion.Update(1.0f / 60.0f);
+                sink += quaternion.GetViewMatrix()[3][0];
+            }));
+        }
+
+        InputQueue queue;
+        InputReplay replay;
+        glm::dvec2 cursor(SCR_WIDTH / 2.0, SCR_HEIGHT / 2.0);
+        for (const glm::vec2& event : offsets)
+        {
+            cursor += glm::dvec2(event.x, -event.y);
+            replay.Add(0, InputEvent{ InputEventType::CursorPosition, 0, 0, 0, cursor.x, cursor.y, 0.0 });
+        }
+        std::vector<InputEvent> batch;
+        QuaternionCamera queued(START_POSITION);
+        printf("  QuaternionCamera, queued    %8.2f\n", microsecondsPerFrame([&](unsigned int)
+        {
+            replay.Rewind();
+            replay.Feed(queue, 0);
+            batch.clear();
+            queue.Drain(batch);
+            glm::dvec2 last(SCR_WIDTH / 2.0, SCR_HEIGHT / 2.0);
+            for (const InputEvent& event : batch)
+            {
+                queued.ProcessMouseMovement((float)(event.X - last.x), (float)(last.y - event.Y));
+                last = glm::dvec2(event.X, event.Y);
+            }
+            queued.Update(1.0f / 60.0f);
+            sink += queued.GetViewMatrix()[3][0];
+        }));
+        if (sink == 12345.0f)
+            printf("\n");
+    }
+
+    int Main()
+    {
+        runTests();
+        runBenchmark();
+
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        // every movement the mouse reports rather than the accelerated cursor, where the platform has it
+        if (glfwRawMouseMotionSupported())
+            glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        Shader shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs");
+
+        // a unit cube with face normals
+        std::vector<float> vertices;
+        for (int face = 0; face < 6; face++)
+        {
+            int axis = face / 2;
+            float sign = (face % 2) ? -1.0f : 1.0f;
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = sign;
+            u[(axis + 1) % 3] = sign;
+            v[(axis + 2) % 3] = 1.0f;
+            const float corners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+            for (const float* corner : corners)
+            {
+                glm::vec3 position = normal * 0.5f + u * (corner[0] - 0.5f) + v * (corner[1] - 0.5f);
+                vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z, corner[0], corner[1] });
+            }
+        }
+        VertexFormat format;
+        format.Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+        unsigned int VAO, VBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        format.Apply();
+
+        unsigned int whiteTexture;
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        shader.use();
+        shader.setInt("baseColor", 0);
+        shader.setVec4("baseColorFactor", glm::vec4(0.5f, 0.7f, 0.85f, 1.0f));
+        shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> height(0.5f, 4.0f);
+        std::vector<glm::mat4> models;
+        for (int x = 0; x < CUBES_X; x++)
+            for (int z = 0; z < CUBES_Z; z++)
+            {
+                float h = height(random);
+                glm::vec3 position = glm::vec3(x - (CUBES_X - 1) * 0.5f, 0.0f, z - (CUBES_Z - 1) * 0.5f) * CUBE_SPACING;
+                models.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position + glm::vec3(0.0f, h * 0.5f, 0.0f)), glm::vec3(1.0f, h, 1.0f)));
+            }
+
+        // render loop
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            float currentFrame = static_cast<float>(glfwGetTime());
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            processInput(window);
+
+            // the mouse events since the last frame have only been added up, now they turn the camera once
+            glm::mat4 view;
+            float zoom;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if (mode == Mode::Euler)
+            {
+                view = camera.GetViewMatrix();
+                zoom = camera.Zoom;
+            }
+            else
+            {
+                quaternionCamera.Update(deltaTime);
+                view = quaternionCamera.GetViewMatrix();
+                zoom = quaternionCamera.Zoom;
+            }
+            cameraSeconds += secondsSince(start);
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            shader.setMat4("projection", glm::perspective(glm::radians(zoom), (float)width / (float)std::max(height, 1), 0.1f, 300.0f));
+            shader.setMat4("view", view);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            glBindVertexArray(VAO);
+            for (const glm::mat4& model : models)
+            {
+                shader.setMat4("model", model);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += 12;
+            }
+
+            RenderStats::EndFrame();
+            reportFrames++;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                printf("%s: %.1f mouse events and %.2f us of camera work per frame\n", MODE_NAMES[(int)mode], (double)mouseEvents / reportFrames,
+                    cameraSeconds * 1e6 / reportFrames);
+                reportStart = now;
+                reportFrames = 0;
+                mouseEvents = 0;
+                cameraSeconds = 0.0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures(1, &whiteTexture);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        for (int key = 0; key < 4; key++)
+            if (glfwGetKey(window, GLFW_KEY_1 + key) == GLFW_PRESS && mode != (Mode)key)
+            {
+                mode = (Mode)key;
+                quaternionCamera.SmoothTime = mode == Mode::Smoothed || mode == Mode::Orbit ? SMOOTH_TIME : 0.0f;
+                if (mode == Mode::Orbit)
+                    quaternionCamera.StartOrbit(glm::vec3(0.0f));
+                else
+                    quaternionCamera.StopOrbit();
+            }
+
+        Camera_Movement directions[] = { FORWARD, BACKWARD, LEFT, RIGHT };
+        int keys[] = { GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D };
+        for (int i = 0; i < 4; i++)
+            if (glfwGetKey(window, keys[i]) == GLFW_PRESS)
+            {
+                if (mode == Mode::Euler)
+                    camera.ProcessKeyboard(directions[i], deltaTime);
+                else
+                    quaternionCamera.ProcessKeyboard(directions[i], deltaTime);
+            }
+    }
+
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+    {
+        if (firstMouse)
+        {
+            mouseLastX = xpos;
+            mouseLastY = ypos;
+            firstMouse = false;
+        }
+
+        float xoffset = xpos - mouseLastX;
+        float yoffset = mouseLastY - ypos; // reversed since y-coordinates range from bottom to top
+
+        mouseLastX = xpos;
+        mouseLastY = ypos;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (mode == Mode::Euler)
+            camera.ProcessMouseMovement(xoffset, yoffset);
+        else
+            quaternionCamera.ProcessMouseMovement(xoffset, yoffset);
+        cameraSeconds += secondsSince(start);
+        mouseEvents++;
+    }
+}
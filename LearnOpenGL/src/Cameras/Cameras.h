@@ -0,0 +1,4 @@
+namespace Cameras
+{
+    int Main();
+};
\ No newline at end of file
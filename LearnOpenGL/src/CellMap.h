@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Open addressing hash map from a packed cell key to an index, for the spatial indices that look cells up whenever an
+// object changes cell. linear probing, it doubles when half full and erasing shifts the following keys back instead
+// of leaving tombstones; far faster than std::unordered_map for millions of small keys. keys with every bit set are
+// reserved
+class CellMap
+{
+public:
+    CellMap() { Clear(); }
+
+    // the index stored for key, -1 when there is none
+    int Find(uint64_t key) const
+    {
+        for (size_t slot = hash(key) & mask;; slot = (slot + 1) & mask)
+        {
+            if (keys[slot] == key)
+                return values[slot];
+            if (keys[slot] == EMPTY)
+                return -1;
+        }
+    }
+
+    // stores value for key, replacing what was there
+    void Insert(uint64_t key, int value)
+    {
+        if ((count + 1) * 2 > keys.size())
+            resize(keys.size() * 2);
+        size_t slot = hash(key) & mask;
+        while (keys[slot] != key && keys[slot] != EMPTY)
+            slot = (slot + 1) & mask;
+        if (keys[slot] == EMPTY)
+            count++;
+        keys[slot] = key;
+        values[slot] = value;
+    }
+
+    void Erase(uint64_t key)
+    {
+        size_t slot = hash(key) & mask;
+        while (keys[slot] != key)
+        {
+            if (keys[slot] == EMPTY)
+                return;
+            slot = (slot + 1) & mask;
+        }
+        // moves later keys of the probe run into the hole unless that would put them before their home slot
+        for (size_t next = (slot + 1) & mask; keys[next] != EMPTY; next = (next + 1) & mask)
+        {
+            size_t home = hash(keys[next]) & mask;
+            if (((next - home) & mask) >= ((next - slot) & mask))
+            {
+                keys[slot] = keys[next];
+                values[slot] = values[next];
+                slot = next;
+            }
+        }
+        keys[slot] = EMPTY;
+        values[slot] = -1;
+        count--;
+    }
+
+    // empties the map, sized so expected keys fit without growing
+    void Clear(size_t expected = 0)
+    {
+        size_t capacity = 16;
+        while (capacity < expected * 2)
+            capacity *= 2;
+        keys.assign(capacity, uint64_t(EMPTY));
+        values.assign(capacity, -1);
+        mask = capacity - 1;
+        count = 0;
+    }
+
+    size_t GetCount() const { return count; }
+
+private:
+    // a header-only class has no place for a C++14 out-of-line definition, so EMPTY is passed to the vector
+    // functions, which take it by reference, as a copy: uint64_t(EMPTY)
+    static constexpr uint64_t EMPTY = ~0ull;
+    std::vector<uint64_t> keys;
+    std::vector<int> values;
+    size_t mask;
+    size_t count;
+
+    static size_t hash(uint64_t key)
+    {
+        // murmur3 finalizer
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdull;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ull;
+        key ^= key >> 33;
+        return (size_t)key;
+    }
+
+    void resize(size_t capacity)
+    {
+        std::vector<uint64_t> oldKeys(capacity, uint64_t(EMPTY));
+        std::vector<int> oldValues(capacity, -1);
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        mask = capacity - 1;
+        for (size_t i = 0; i < oldKeys.size(); i++)
+        {
+            if (oldKeys[i] == EMPTY)
+                continue;
+            size_t slot = hash(oldKeys[i]) & mask;
+            while (keys[slot] != EMPTY)
+                slot = (slot + 1) & mask;
+            keys[slot] = oldKeys[i];
+            values[slot] = oldValues[i];
+        }
+    }
+};
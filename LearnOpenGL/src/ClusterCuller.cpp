@@ -0,0 +1,137 @@
+#include "ClusterCuller.h"
+#include "Meshlets.h"
+#include <chrono>
+#include <cmath>
+#include <xmmintrin.h>
+
+void ClusterCuller::SetClusters(const MeshletMesh& mesh)
+{
+    count = (unsigned int)mesh.Bounds.size();
+    size_t padded = (count + 3) & ~3u;
+    for (std::vector<float>* field : { &centerX, &centerY, &centerZ, &radius, &axisX, &axisY, &axisZ, &cutoff })
+        field->assign(padded, 0.0f);
+    triangleCounts.resize(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const MeshletBounds& bounds = mesh.Bounds[i];
+        centerX[i] = bounds.Center.x;
+        centerY[i] = bounds.Center.y;
+        centerZ[i] = bounds.Center.z;
+        radius[i] = bounds.Radius;
+        axisX[i] = bounds.ConeAxis.x;
+        axisY[i] = bounds.ConeAxis.y;
+        axisZ[i] = bounds.ConeAxis.z;
+        cutoff[i] = bounds.ConeCutoff;
+        triangleCounts[i] = mesh.Meshlets[i].TriangleCount;
+    }
+}
+
+void ClusterCuller::ExtractFrustumPlanes(const glm::mat4& m, glm::vec4 planes[6])
+{
+    // rows of the matrix, glm is column major
+    glm::vec4 rows[4];
+    for (int r = 0; r < 4; r++)
+        rows[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+    for (int axis = 0; axis < 3; axis++)
+    {
+        planes[axis * 2] = rows[3] + rows[axis];
+        planes[axis * 2 + 1] = rows[3] - rows[axis];
+    }
+    for (int p = 0; p < 6; p++)
+        planes[p] /= glm::length(glm::vec3(planes[p]));
+}
+
+void ClusterCuller::Cull(const glm::mat4& modelViewProjection, const glm::vec3& eye, std::vector<unsigned int>& visible)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    glm::vec4 planes[6];
+    ExtractFrustumPlanes(modelViewProjection, planes);
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int p = 0; p < 6; p++)
+    {
+        planeX[p] = _mm_set1_ps(planes[p].x);
+        planeY[p] = _mm_set1_ps(planes[p].y);
+        planeZ[p] = _mm_set1_ps(planes[p].z);
+        planeW[p] = _mm_set1_ps(planes[p].w);
+    }
+    __m128 eyeX = _mm_set1_ps(eye.x), eyeY = _mm_set1_ps(eye.y), eyeZ = _mm_set1_ps(eye.z);
+
+    visible.clear();
+    Stats = ClusterCullStats();
+    Stats.Clusters = count;
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(&centerX[i]), y = _mm_loadu_ps(&centerY[i]), z = _mm_loadu_ps(&centerZ[i]);
+        __m128 r = _mm_loadu_ps(&radius[i]);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), r);
+
+        // outside when the center is further than the radius behind any plane
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)), _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+        }
+
+        // facing away when dot(center - eye, axis) >= cutoff * length(center - eye) + radius
+        __m128 dx = _mm_sub_ps(x, eyeX), dy = _mm_sub_ps(y, eyeY), dz = _mm_sub_ps(z, eyeZ);
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+        __m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(&axisX[i])), _mm_mul_ps(dy, _mm_loadu_ps(&axisY[i]))), _mm_mul_ps(dz, _mm_loadu_ps(&axisZ[i])));
+        __m128 backface = _mm_cmpge_ps(along, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&cutoff[i]), length), r));
+
+        // the lanes past count are padding
+        int lanes = count - i < 4 ? (1 << (count - i)) - 1 : 0xf;
+        int outsideMask = _mm_movemask_ps(outside) & lanes;
+        int backfaceMask = _mm_movemask_ps(backface) & lanes & ~outsideMask;
+        int visibleMask = lanes & ~(outsideMask | backfaceMask);
+        Stats.FrustumCulled += (outsideMask & 1) + (outsideMask >> 1 & 1) + (outsideMask >> 2 & 1) + (outsideMask >> 3 & 1);
+        Stats.BackfaceCulled += (backfaceMask & 1) + (backfaceMask >> 1 & 1) + (backfaceMask >> 2 & 1) + (backfaceMask >> 3 & 1);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (visibleMask & (1 << lane))
+            {
+                visible.push_back(i + lane);
+                Stats.VisibleTriangles += triangleCounts[i + lane];
+            }
+        }
+    }
+    Stats.Visible = (unsigned int)visible.size();
+    for (unsigned int triangles : triangleCounts)
+        Stats.Triangles += triangles;
+    Stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ClusterCuller::CullScalar(const glm::mat4& modelViewProjection, const glm::vec3& eye, std::vector<unsigned int>& visible)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    glm::vec4 planes[6];
+    ExtractFrustumPlanes(modelViewProjection, planes);
+
+    visible.clear();
+    Stats = ClusterCullStats();
+    Stats.Clusters = count;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        glm::vec3 center(centerX[i], centerY[i], centerZ[i]);
+        bool outside = false;
+        for (int p = 0; p < 6; p++)
+            outside = outside || glm::dot(glm::vec3(planes[p]), center) + planes[p].w < -radius[i];
+        if (outside)
+        {
+            Stats.FrustumCulled++;
+            continue;
+        }
+        glm::vec3 toCenter = center - eye;
+        if (glm::dot(toCenter, glm::vec3(axisX[i], axisY[i], axisZ[i])) >= cutoff[i] * glm::length(toCenter) + radius[i])
+        {
+            Stats.BackfaceCulled++;
+            continue;
+        }
+        visible.push_back(i);
+        Stats.VisibleTriangles += triangleCounts[i];
+    }
+    Stats.Visible = (unsigned int)visible.size();
+    for (unsigned int triangles : triangleCounts)
+        Stats.Triangles += triangles;
+    Stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
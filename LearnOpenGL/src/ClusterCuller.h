@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+class MeshletMesh;
+
+// what the last Cull() did
+struct ClusterCullStats
+{
+    unsigned int Clusters = 0;
+    unsigned int Visible = 0;
+    unsigned int FrustumCulled = 0;
+    // facing away, counted only for clusters inside the frustum
+    unsigned int BackfaceCulled = 0;
+    size_t Triangles = 0;
+    size_t VisibleTriangles = 0;
+    double Seconds = 0.0;
+};
+
+// Culls the meshlets of a MeshletMesh by their bounding spheres against the view frustum and by their normal cones
+// against the eye. the bounds are kept as a structure of arrays so SSE tests four clusters per instruction.
+class ClusterCuller
+{
+public:
+    // copies the bounds of mesh, call again when the mesh changes
+    void SetClusters(const MeshletMesh& mesh);
+    // fills visible with the indices of the clusters that pass. modelViewProjection takes the mesh positions to
+    // clip space and eye is the camera position in mesh space (Camera::Position through the inverse model matrix);
+    // the model matrix must not scale, the radii are not scaled with it
+    void Cull(const glm::mat4& modelViewProjection, const glm::vec3& eye, std::vector<unsigned int>& visible);
+    // the same one cluster at a time, the reference the SSE path is checked and timed against
+    void CullScalar(const glm::mat4& modelViewProjection, const glm::vec3& eye, std::vector<unsigned int>& visible);
+
+    // left, right, bottom, top, near and far planes of a view projection matrix, normalized and facing inwards:
+    // a point p is inside all of them when dot(plane.xyz, p) + plane.w >= 0
+    static void ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]);
+
+    ClusterCullStats Stats;
+
+private:
+    // padded to a multiple of 4, the padding is masked out
+    std::vector<float> centerX, centerY, centerZ, radius;
+    std::vector<float> axisX, axisY, axisZ, cutoff;
+    std::vector<unsigned int> triangleCounts;
+    unsigned int count = 0;
+};
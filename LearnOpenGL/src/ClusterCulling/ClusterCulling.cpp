@@ -0,0 +1,433 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "ClusterCulling.h"
+#include "../Shader.h"
+#include "../ComputeShader.h"
+#include "../GLExtensions.h"
+#include "../ClusterCuller.h"
+#include "../Meshlets.h"
+#include "../RenderStats.h"
+#include "../VertexFormat.h"
+
+namespace ClusterCulling
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // a bumpy unit sphere of RINGS x SEGMENTS quads, about 2.4M triangles
+    const int RINGS = 768;
+    const int SEGMENTS = 1536;
+
+    enum class CullMode
+    {
+        None,
+        Cpu,
+        Gpu
+    };
+    // switched with the 1/2/3 keys, 3 only with GL_ARB_compute_shader and GL_ARB_multi_draw_indirect
+    CullMode mode = CullMode::Cpu;
+    bool gpuCulling = false;
+
+    // the orbit advances by a fixed step per frame, so every mode sees the same camera path
+    const float SCRIPT_STEP = 1.0f / 60.0f;
+    // the distance swings between close up, most of the sphere off screen, and all of it in view
+    const float ORBIT_SPEED = 0.3f;
+    const float ORBIT_NEAR = 1.3f;
+    const float ORBIT_FAR = 4.0f;
+
+    struct Vertex
+    {
+        glm::vec3 Position;
+        glm::vec3 Normal;
+        glm::vec2 TexCoord;
+    };
+
+    // layout fixed by GL for indirect draws
+    struct DrawElementsCommand
+    {
+        GLuint Count;
+        GLuint InstanceCount;
+        GLuint FirstIndex;
+        GLint BaseVertex;
+        GLuint BaseInstance;
+    };
+
+    // std430 Cluster of ClusterCull.comp
+    struct GpuCluster
+    {
+        glm::vec4 Sphere;
+        glm::vec4 Cone;
+        GLuint FirstIndex;
+        GLuint IndexCount;
+        GLuint Padding[2];
+    };
+
+    void buildSphere(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+    {
+        vertices.resize((size_t)(RINGS + 1) * (SEGMENTS + 1));
+        for (int i = 0; i <= RINGS; i++)
+            for (int j = 0; j <= SEGMENTS; j++)
+            {
+                float theta = glm::pi<float>() * i / RINGS, phi = glm::two_pi<float>() * j / SEGMENTS;
+                float radius = 1.0f + 0.02f * sin(theta * 40.0f) * sin(phi * 40.0f);
+                Vertex& vertex = vertices[(size_t)i * (SEGMENTS + 1) + j];
+                vertex.Position = radius * glm::vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+                vertex.Normal = glm::vec3(0.0f);
+                vertex.TexCoord = glm::vec2((float)j / SEGMENTS, (float)i / RINGS);
+            }
+        indices.clear();
+        indices.reserve((size_t)RINGS * SEGMENTS * 6);
+        for (int i = 0; i < RINGS; i++)
+            for (int j = 0; j < SEGMENTS; j++)
+            {
+                unsigned int a = i * (SEGMENTS + 1) + j, b = a + SEGMENTS + 1;
+                indices.insert(indices.end(), { a, a + 1, b, a + 1, b + 1, b });
+            }
+        // area weighted face normals, so the bumps are shaded
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            Vertex& v0 = vertices[indices[i]];
+            Vertex& v1 = vertices[indices[i + 1]];
+            Vertex& v2 = vertices[indices[i + 2]];
+            glm::vec3 normal = glm::cross(v1.Position - v0.Position, v2.Position - v0.Position);
+            v0.Normal += normal;
+            v1.Normal += normal;
+            v2.Normal += normal;
+        }
+        for (Vertex& vertex : vertices)
+            vertex.Normal = glm::length(vertex.Normal) > 0.0f ? glm::normalize(vertex.Normal) : glm::normalize(vertex.Position);
+    }
+
+    const char* modeName(CullMode cullMode)
+    {
+        switch (cullMode)
+        {
+        case CullMode::Cpu: return "cpu simd";
+        case CullMode::Gpu: return "gpu compute";
+        default: return "no culling";
+        }
+    }
+
+    int Main()
+    {
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        Shader shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs");
+
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        buildSphere(vertices, indices);
+        MeshletMesh meshlets;
+        meshlets.Build(indices, &vertices[0].Position.x, sizeof(Vertex), vertices.size());
+        printf("%zu triangles in %zu meshlets (%.1f triangles each), built in %.1f ms\n", indices.size() / 3, meshlets.Meshlets.size(),
+            (double)indices.size() / 3 / meshlets.Meshlets.size(), meshlets.BuildSeconds * 1000.0);
+        ClusterCuller culler;
+        culler.SetClusters(meshlets);
+
+        VertexFormat format;
+        format.Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+        unsigned int VAO, VBO, EBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        // the meshlet order, so every meshlet is one contiguous range
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshlets.Indices.size() * sizeof(unsigned int), meshlets.Indices.data(), GL_STATIC_DRAW);
+        format.Apply();
+
+        // the CPU path writes the commands of the visible meshlets here, the GPU path one per meshlet
+        unsigned int commandBuffer = 0;
+        if (GLExtensions::ARB_multi_draw_indirect)
+        {
+            glGenBuffers(1, &commandBuffer);
+            glBindBuffer(GLExtensions::DRAW_INDIRECT_BUFFER, commandBuffer);
+            glBufferData(GLExtensions::DRAW_INDIRECT_BUFFER, meshlets.Meshlets.size() * sizeof(DrawElementsCommand), NULL, GL_STREAM_DRAW);
+            glBindBuffer(GLExtensions::DRAW_INDIRECT_BUFFER, 0);
+        }
+
+        ComputeShader* cullShader = NULL;
+        unsigned int clusterBuffer = 0, counterBuffer = 0;
+        if (GLExtensions::ARB_compute_shader && GLExtensions::ARB_shader_storage_buffer_object && GLExtensions::ARB_multi_draw_indirect)
+        {
+            cullShader = new ComputeShader("shaders/ComputeShaders/ClusterCull.comp");
+            gpuCulling = cullShader->IsValid();
+        }
+        if (gpuCulling)
+        {
+            std::vector<GpuCluster> clusters(meshlets.Meshlets.size());
+            for (size_t i = 0; i < clusters.size(); i++)
+            {
+                const MeshletBounds& bounds = meshlets.Bounds[i];
+                clusters[i].Sphere = glm::vec4(bounds.Center, bounds.Radius);
+                clusters[i].Cone = glm::vec4(bounds.ConeAxis, bounds.ConeCutoff);
+                clusters[i].FirstIndex = meshlets.Meshlets[i].TriangleOffset * 3;
+                clusters[i].IndexCount = meshlets.Meshlets[i].TriangleCount * 3;
+            }
+            glGenBuffers(1, &clusterBuffer);
+            glBindBuffer(GLExtensions::SHADER_STORAGE_BUFFER, clusterBuffer);
+            glBufferData(GLExtensions::SHADER_STORAGE_BUFFER, clusters.size() * sizeof(GpuCluster), clusters.data(), GL_STATIC_DRAW);
+            glGenBuffers(1, &counterBuffer);
+            glBindBuffer(GLExtensions::SHADER_STORAGE_BUFFER, counterBuffer);
+            glBufferData(GLExtensions::SHADER_STORAGE_BUFFER, 4 * sizeof(GLuint), NULL, GL_DYNAMIC_READ);
+            glBindBuffer(GLExtensions::SHADER_STORAGE_BUFFER, 0);
+        }
+        else
+            std::cout << "GPU culling needs GL_ARB_compute_shader, GL_ARB_shader_storage_buffer_object and GL_ARB_multi_draw_indirect, key 3 is disabled" << std::endl;
+
+        // untextured, a white texel
+        unsigned int whiteTexture;
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        shader.use();
+        shader.setInt("baseColor", 0);
+        shader.setVec4("baseColorFactor", glm::vec4(1.0f));
+        shader.setMat4("model", glm::mat4(1.0f));
+        shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+
+        std::vector<unsigned int> visible;
+        std::vector<DrawElementsCommand> commands;
+        // glMultiDrawElements arguments, without GL_ARB_multi_draw_indirect
+        std::vector<GLsizei> counts;
+        std::vector<const void*> offsets;
+
+        // render loop
+        float scriptTime = 0.0f;
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        double reportTriangles = 0.0, reportCullSeconds = 0.0;
+        ClusterCullStats reportStats;
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            processInput(window);
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            float distance = ORBIT_NEAR + (ORBIT_FAR - ORBIT_NEAR) * (0.5f + 0.5f * sin(scriptTime * 0.5f));
+            float angle = scriptTime * ORBIT_SPEED;
+            glm::vec3 eye = distance * glm::normalize(glm::vec3(cos(angle), 0.4f * sin(scriptTime * 0.2f), sin(angle)));
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / (float)std::max(height, 1), 0.05f, 100.0f);
+            glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            // the model matrix is the identity, so the mesh space the bounds are in is world space
+            glm::mat4 viewProjection = projection * view;
+
+            if (mode == CullMode::Cpu)
+            {
+                culler.Cull(viewProjection, eye, visible);
+                reportCullSeconds += culler.Stats.Seconds;
+                reportStats = culler.Stats;
+            }
+            else if (mode == CullMode::Gpu)
+            {
+                glm::vec4 planes[6];
+                ClusterCuller::ExtractFrustumPlanes(viewProjection, planes);
+                const GLuint zero[4] = { 0, 0, 0, 0 };
+                glBindBuffer(GLExtensions::SHADER_STORAGE_BUFFER, counterBuffer);
+                glBufferSubData(GLExtensions::SHADER_STORAGE_BUFFER, 0, sizeof(zero), zero);
+                glBindBufferBase(GLExtensions::SHADER_STORAGE_BUFFER, 0, clusterBuffer);
+                glBindBufferBase(GLExtensions::SHADER_STORAGE_BUFFER, 1, commandBuffer);
+                glBindBufferBase(GLExtensions::SHADER_STORAGE_BUFFER, 2, counterBuffer);
+                RenderStats::Frame.BufferBinds += 3;
+                cullShader->use();
+                RenderStats::Frame.ProgramBinds++;
+                cullShader->setVec4Array("frustumPlanes", planes, 6);
+                cullShader->setVec3("cameraPosition", eye);
+                cullShader->setUint("clusterCount", (unsigned int)meshlets.Meshlets.size());
+                cullShader->dispatch(((unsigned int)meshlets.Meshlets.size() + 63) / 64);
+                // the draw reads the commands as indirect arguments, the report reads the counters
+                GLExtensions::glMemoryBarrier(GLExtensions::COMMAND_BARRIER_BIT | GLExtensions::BUFFER_UPDATE_BARRIER_BIT);
+            }
+
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            shader.setMat4("projection", projection);
+            shader.setMat4("view", view);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            glBindVertexArray(VAO);
+            if (mode == CullMode::None)
+            {
+                glDrawElements(GL_TRIANGLES, (GLsizei)meshlets.Indices.size(), GL_UNSIGNED_INT, 0);
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += (unsigned int)(meshlets.Indices.size() / 3);
+            }
+            else if (mode == CullMode::Cpu && !visible.empty())
+            {
+                if (GLExtensions::ARB_multi_draw_indirect)
+                {
+                    commands.clear();
+                    for (unsigned int cluster : visible)
+                    {
+                        const Meshlet& meshlet = meshlets.Meshlets[cluster];
+                        commands.push_back({ meshlet.TriangleCount * 3, 1, meshlet.TriangleOffset * 3, 0, 0 });
+                    }
+                    glBindBuffer(GLExtensions::DRAW_INDIRECT_BUFFER, commandBuffer);
+                    glBufferSubData(GLExtensions::DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawElementsCommand), commands.data());
+                    GLExtensions::glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, NULL, (GLsizei)commands.size(), 0);
+                    glBindBuffer(GLExtensions::DRAW_INDIRECT_BUFFER, 0);
+                    RenderStats::Frame.BufferBinds++;
+                }
+                else
+                {
+                    counts.clear();
+                    offsets.clear();
+                    for (unsigned int cluster : visible)
+                    {
+                        const Meshlet& meshlet = meshlets.Meshlets[cluster];
+                        counts.push_back(meshlet.TriangleCount * 3);
+                        offsets.push_back((const void*)(meshlet.TriangleOffset * 3 * sizeof(unsigned int)));
+                    }
+                    glMultiDrawElements(GL_TRIANGLES, counts.data(), GL_UNSIGNED_INT, offsets.data(), (GLsizei)counts.size());
+                }
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += (unsigned int)culler.Stats.VisibleTriangles;
+            }
+            else if (mode == CullMode::Gpu)
+            {
+                // culled meshlets are in the buffer with no instances
+                glBindBuffer(GLExtensions::DRAW_INDIRECT_BUFFER, commandBuffer);
+                GLExtensions::glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, NULL, (GLsizei)meshlets.Meshlets.size(), 0);
+                glBindBuffer(GLExtensions::DRAW_INDIRECT_BUFFER, 0);
+                RenderStats::Frame.BufferBinds++;
+                RenderStats::Frame.DrawCalls++;
+            }
+
+            RenderStats::EndFrame();
+            reportTriangles += RenderStats::Last.Triangles;
+            reportFrames++;
+            scriptTime += SCRIPT_STEP;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                size_t totalTriangles = meshlets.Indices.size() / 3;
+                if (mode == CullMode::Gpu)
+                {
+                    // waits for this frame's dispatch, once per report
+                    GLuint counters[4];
+                    glBindBuffer(GLExtensions::SHADER_STORAGE_BUFFER, counterBuffer);
+                    glGetBufferSubData(GLExtensions::SHADER_STORAGE_BUFFER, 0, sizeof(counters), counters);
+                    reportStats.Clusters = (unsigned int)meshlets.Meshlets.size();
+                    reportStats.Visible = counters[0];
+                    reportStats.FrustumCulled = counters[1];
+                    reportStats.BackfaceCulled = counters[2];
+                    reportStats.VisibleTriangles = counters[3];
+                    reportTriangles = (double)counters[3] * reportFrames;
+                }
+                if (mode == CullMode::None)
+                    printf("%-11s triangles/frame %8.0f, frame %6.3f ms\n", modeName(mode), reportTriangles / reportFrames, (now - reportStart) * 1000.0 / reportFrames);
+                else
+                {
+                    printf("%-11s clusters %5u visible, %5u frustum culled, %5u backface culled of %u, triangles saved %5.1f%%, frame %6.3f ms",
+                        modeName(mode), reportStats.Visible, reportStats.FrustumCulled, reportStats.BackfaceCulled, reportStats.Clusters,
+                        100.0 - reportTriangles / reportFrames * 100.0 / totalTriangles, (now - reportStart) * 1000.0 / reportFrames);
+                    if (mode == CullMode::Cpu)
+                    {
+                        // the scalar reference on the same view, for the SIMD speedup
+                        culler.CullScalar(viewProjection, eye, visible);
+                        printf(", cull %.3f ms (scalar %.3f ms)", reportCullSeconds * 1000.0 / reportFrames, culler.Stats.Seconds * 1000.0);
+                    }
+                    printf("\n");
+                }
+                reportStart = now;
+                reportFrames = 0;
+                reportTriangles = 0.0;
+                reportCullSeconds = 0.0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        delete cullShader;
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        glDeleteBuffers(1, &commandBuffer);
+        glDeleteBuffers(1, &clusterBuffer);
+        glDeleteBuffers(1, &counterBuffer);
+        glDeleteTextures(1, &whiteTexture);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            mode = CullMode::None;
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+            mode = CullMode::Cpu;
+        if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS && gpuCulling)
+            mode = CullMode::Gpu;
+    }
+}
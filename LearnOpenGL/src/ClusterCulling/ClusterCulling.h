@@ -0,0 +1,4 @@
+namespace ClusterCulling
+{
+    int Main();
+};
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "ComputeShader.h"
+#include <iostream>
+#include <glm/glm.hpp>
+#include "GLExtensions.h"
+#include "ShaderPreprocessor.h"
+
+ComputeShader::ComputeShader(const char* path, const std::vector<std::string>& defines) : path(path)
+{
+    if (!GLExtensions::ARB_compute_shader)
+    {
+        std::cout << "ERROR::COMPUTE_SHADER: GL_ARB_compute_shader is not supported, " << path << " is not built" << std::endl;
+        return;
+    }
+
+    const ShaderPreprocessor::Result& preprocessed = ShaderPreprocessor::Get().Process(path, defines);
+    const char* code = preprocessed.Source.c_str();
+    unsigned int stage = glCreateShader(GLExtensions::COMPUTE_SHADER);
+    glShaderSource(stage, 1, &code, NULL);
+    glCompileShader(stage);
+
+    int success;
+    char infoLog[1024];
+    glGetShaderiv(stage, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(stage, 1024, NULL, infoLog);
+        std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: COMPUTE\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+        glDeleteShader(stage);
+        return;
+    }
+
+    ID = glCreateProgram();
+    glAttachShader(ID, stage);
+    glLinkProgram(ID);
+    glDeleteShader(stage);
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(ID, 1024, NULL, infoLog);
+        std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: PROGRAM\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+        glDeleteProgram(ID);
+        ID = 0;
+    }
+}
+
+ComputeShader::~ComputeShader()
+{
+    if (ID)
+        glDeleteProgram(ID);
+}
+
+void ComputeShader::use()
+{
+    glUseProgram(ID);
+}
+
+void ComputeShader::dispatch(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ)
+{
+    GLExtensions::glDispatchCompute(groupsX, groupsY, groupsZ);
+}
+
+void ComputeShader::setInt(const std::string& name, int value) const
+{
+    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+}
+
+void ComputeShader::setUint(const std::string& name, unsigned int value) const
+{
+    glUniform1ui(glGetUniformLocation(ID, name.c_str()), value);
+}
+
+void ComputeShader::setFloat(const std::string& name, float value) const
+{
+    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+}
+
+void ComputeShader::setVec2(const std::string& name, const glm::vec2& value) const
+{
+    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+}
+
+void ComputeShader::setVec3(const std::string& name, const glm::vec3& value) const
+{
+    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+}
+
+void ComputeShader::setVec4(const std::string& name, const glm::vec4& value) const
+{
+    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+}
+
+void ComputeShader::setVec4Array(const std::string& name, const glm::vec4* values, int count) const
+{
+    glUniform4fv(glGetUniformLocation(ID, name.c_str()), count, &values[0][0]);
+}
+
+void ComputeShader::setMat4(const std::string& name, const glm::mat4& mat) const
+{
+    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/fwd.hpp>
+
+#include <string>
+#include <vector>
+
+// A compute program (GL_ARB_compute_shader), preprocessed like Shader so it can #include the Common files.
+// only valid when GLExtensions::ARB_compute_shader is set.
+class ComputeShader
+{
+public:
+    // the program ID, 0 when the source failed to build
+    unsigned int ID = 0;
+
+    // builds the program from path with extra #define lines ("NAME" or "NAME VALUE")
+    ComputeShader(const char* path, const std::vector<std::string>& defines = std::vector<std::string>());
+    ~ComputeShader();
+    ComputeShader(const ComputeShader&) = delete;
+    ComputeShader& operator=(const ComputeShader&) = delete;
+
+    bool IsValid() const { return ID != 0; }
+    void use();
+    // runs groupsX x groupsY x groupsZ work groups of the program, which has to be in use
+    void dispatch(unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1);
+
+    // utility uniform functions
+    void setInt(const std::string& name, int value) const;
+    void setUint(const std::string& name, unsigned int value) const;
+    void setFloat(const std::string& name, float value) const;
+    void setVec2(const std::string& name, const glm::vec2& value) const;
+    void setVec3(const std::string& name, const glm::vec3& value) const;
+    void setVec4(const std::string& name, const glm::vec4& value) const;
+    void setVec4Array(const std::string& name, const glm::vec4* values, int count) const;
+    void setMat4(const std::string& name, const glm::mat4& mat) const;
+
+private:
+    std::string path;
+};
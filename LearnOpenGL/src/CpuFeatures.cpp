@@ -0,0 +1,64 @@
+#include "CpuFeatures.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+namespace
+{
+    void cpuid(int leaf, int subleaf, unsigned int registers[4])
+    {
+#ifdef _MSC_VER
+        __cpuidex((int*)registers, leaf, subleaf);
+#else
+        __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+    }
+
+    // the register state the OS saves on context switches, XCR0
+    unsigned long long savedRegisterState()
+    {
+#ifdef _MSC_VER
+        return _xgetbv(0);
+#else
+        unsigned int low, high;
+        __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        return (unsigned long long)high << 32 | low;
+#endif
+    }
+
+    CpuFeatures detect()
+    {
+        CpuFeatures features;
+        unsigned int registers[4];
+        cpuid(0, 0, registers);
+        unsigned int maxLeaf = registers[0];
+        cpuid(1, 0, registers);
+        features.Sse41 = (registers[2] & (1u << 19)) != 0;
+        bool osSavesAvx = false, osSavesAvx512 = false;
+        // OSXSAVE, then XMM and YMM state, then opmask and both halves of ZMM state
+        if (registers[2] & (1u << 27))
+        {
+            unsigned long long state = savedRegisterState();
+            osSavesAvx = (state & 0x6) == 0x6;
+            osSavesAvx512 = (state & 0xe6) == 0xe6;
+        }
+        features.Avx = osSavesAvx && (registers[2] & (1u << 28));
+        features.Fma = osSavesAvx && (registers[2] & (1u << 12));
+        if (maxLeaf >= 7)
+        {
+            cpuid(7, 0, registers);
+            features.Avx2 = osSavesAvx && (registers[1] & (1u << 5));
+            features.Avx512F = osSavesAvx512 && (registers[1] & (1u << 16));
+        }
+        return features;
+    }
+}
+
+const CpuFeatures& CpuFeatures::Get()
+{
+    static const CpuFeatures features = detect();
+    return features;
+}
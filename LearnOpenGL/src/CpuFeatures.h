@@ -0,0 +1,15 @@
+#pragma once
+
+// Instruction sets of the CPU the program runs on, for code that picks a SIMD path at run time. the AVX ones also
+// need the OS to save the wider registers, which is checked too
+struct CpuFeatures
+{
+    bool Sse41 = false;
+    bool Avx = false;
+    bool Avx2 = false;
+    bool Fma = false;
+    bool Avx512F = false;
+
+    // detected once on first use
+    static const CpuFeatures& Get();
+};
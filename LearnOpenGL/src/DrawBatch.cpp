@@ -0,0 +1,99 @@
+#include "DrawBatch.h"
+#include <cstddef>
+#include "GLExtensions.h"
+#include "RenderStats.h"
+
+DrawBatch::DrawBatch(unsigned int vao, bool preferIndirect) : vao(vao)
+{
+    indirect = preferIndirect && GLExtensions::ARB_multi_draw_indirect;
+
+    glGenBuffers(1, &perDrawBuffer);
+    if (indirect)
+        glGenBuffers(1, &commandBuffer);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, perDrawBuffer);
+    for (unsigned int column = 0; column < 4; column++)
+    {
+        glEnableVertexAttribArray(MODEL_ATTRIBUTE + column);
+        glVertexAttribDivisor(MODEL_ATTRIBUTE + column, 1);
+    }
+    glEnableVertexAttribArray(MATERIAL_ATTRIBUTE);
+    glVertexAttribDivisor(MATERIAL_ATTRIBUTE, 1);
+    setAttributes(0);
+    glBindVertexArray(0);
+}
+
+DrawBatch::~DrawBatch()
+{
+    glDeleteBuffers(1, &perDrawBuffer);
+    if (commandBuffer)
+        glDeleteBuffers(1, &commandBuffer);
+}
+
+void DrawBatch::Add(int first, int count, const glm::mat4& model, int material)
+{
+    // baseInstance is the draw's own index, the fallback ignores it
+    DrawArraysCommand command = { (GLuint)count, 1, (GLuint)first, (GLuint)commands.size() };
+    commands.push_back(command);
+    PerDraw draw = { model, material };
+    perDraw.push_back(draw);
+}
+
+void DrawBatch::Submit()
+{
+    submittedCalls = 0;
+    if (commands.empty())
+        return;
+
+    glBindVertexArray(vao);
+    // orphan and refill, the previous frame's draws may still read the old storage
+    glBindBuffer(GL_ARRAY_BUFFER, perDrawBuffer);
+    glBufferData(GL_ARRAY_BUFFER, perDraw.size() * sizeof(PerDraw), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, perDraw.size() * sizeof(PerDraw), perDraw.data());
+    RenderStats::Frame.BufferBinds++;
+
+    if (indirect)
+    {
+        glBindBuffer(GLExtensions::DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GLExtensions::DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawArraysCommand), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GLExtensions::DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawArraysCommand), commands.data());
+        RenderStats::Frame.BufferBinds++;
+        GLExtensions::glMultiDrawArraysIndirect(GL_TRIANGLES, NULL, (GLsizei)commands.size(), 0);
+        glBindBuffer(GLExtensions::DRAW_INDIRECT_BUFFER, 0);
+        submittedCalls = 1;
+    }
+    else
+    {
+        // GL 3.3 has no baseInstance, the attributes are re-pointed at the start of every run instead
+        for (size_t start = 0; start < commands.size();)
+        {
+            size_t end = start + 1;
+            while (end < commands.size() && commands[end].First == commands[start].First && commands[end].Count == commands[start].Count)
+                end++;
+            setAttributes(start);
+            glDrawArraysInstanced(GL_TRIANGLES, commands[start].First, commands[start].Count, (GLsizei)(end - start));
+            submittedCalls++;
+            start = end;
+        }
+    }
+
+    RenderStats::Frame.DrawCalls += submittedCalls;
+    for (const DrawArraysCommand& command : commands)
+        RenderStats::Frame.Triangles += command.Count / 3;
+    glBindVertexArray(0);
+}
+
+void DrawBatch::Clear()
+{
+    commands.clear();
+    perDraw.clear();
+}
+
+void DrawBatch::setAttributes(size_t index)
+{
+    const char* base = (const char*)(index * sizeof(PerDraw));
+    for (unsigned int column = 0; column < 4; column++)
+        glVertexAttribPointer(MODEL_ATTRIBUTE + column, 4, GL_FLOAT, GL_FALSE, sizeof(PerDraw), base + column * sizeof(glm::vec4));
+    glVertexAttribIPointer(MATERIAL_ATTRIBUTE, 1, GL_INT, sizeof(PerDraw), base + offsetof(PerDraw, Material));
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Collects draws of one vertex array that differ only in mesh range, model matrix and material, and submits
+// them merged. the model matrix and material of each draw are instanced vertex attributes: with
+// GL_ARB_multi_draw_indirect the whole batch is one glMultiDrawArraysIndirect whose baseInstance selects the
+// draw's attributes, without it every run of draws sharing a mesh range is one glDrawArraysInstanced.
+// vertex shaders read aModel and aMaterial at the locations below (Textures.vs with BINDLESS or TEXTURE_ARRAY).
+class DrawBatch
+{
+public:
+    // mat4 takes four consecutive locations
+    static const unsigned int MODEL_ATTRIBUTE = 2;
+    static const unsigned int MATERIAL_ATTRIBUTE = 6;
+
+    // adds the per-draw attributes to vao, its other attributes stay as they are
+    DrawBatch(unsigned int vao, bool preferIndirect = true);
+    ~DrawBatch();
+
+    // true when Submit() uses multi-draw indirect
+    bool IsIndirect() const { return indirect; }
+    // queues count vertices from first as GL_TRIANGLES
+    void Add(int first, int count, const glm::mat4& model, int material);
+    // uploads the queued draws and issues them, the queue is kept until Clear()
+    void Submit();
+    void Clear();
+
+    // draws queued
+    unsigned int GetDrawCount() const { return (unsigned int)commands.size(); }
+    // GL draw calls the last Submit() issued
+    unsigned int GetSubmittedCalls() const { return submittedCalls; }
+
+private:
+    // layout fixed by GL for indirect draws
+    struct DrawArraysCommand
+    {
+        GLuint Count;
+        GLuint InstanceCount;
+        GLuint First;
+        GLuint BaseInstance;
+    };
+
+    struct PerDraw
+    {
+        glm::mat4 Model;
+        GLint Material;
+    };
+
+    unsigned int vao;
+    unsigned int perDrawBuffer = 0;
+    unsigned int commandBuffer = 0;
+    bool indirect;
+    unsigned int submittedCalls = 0;
+    std::vector<DrawArraysCommand> commands;
+    std::vector<PerDraw> perDraw;
+
+    // points the per-draw attributes at draw index of the buffer, vao and the buffer must be bound
+    void setAttributes(size_t index);
+};
@@ -0,0 +1,471 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "DynamicObjects.h"
+#include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../Camera.h"
+#include "../ClusterCuller.h"
+#include "../HashedGrid.h"
+#include "../LooseOctree.h"
+#include "../RenderStats.h"
+#include "../VertexFormat.h"
+
+namespace DynamicObjects
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // the startup benchmark moves every object each frame, then runs one frustum and BENCHMARK_SPHERES sphere queries
+    const unsigned int BENCHMARK_SIZES[] = { 10000, 100000, 1000000 };
+    const unsigned int BENCHMARK_FRAMES = 10;
+    const unsigned int BENCHMARK_SPHERES = 100;
+    const glm::vec3 BENCHMARK_VOLUME(1000.0f, 100.0f, 1000.0f);
+    // units per second, a sixth of the smallest object per frame at 60 fps
+    const float BENCHMARK_SPEED = 3.0f;
+
+    // the scene, cubes wandering inside a box and bouncing off its sides
+    const unsigned int CUBE_COUNT = 20000;
+    const glm::vec3 CUBE_VOLUME(200.0f, 40.0f, 200.0f);
+    const float CUBE_SPEED = 4.0f;
+    // cubes near the camera are tinted
+    const float NEARBY_RADIUS = 10.0f;
+
+    // switched with the 1/2/3 keys
+    enum class Index
+    {
+        Linear,
+        Octree,
+        Grid
+    };
+    Index index = Index::Octree;
+    const char* INDEX_NAMES[] = { "linear", "octree", "grid" };
+
+    // camera
+    Camera camera(glm::vec3(0.0f, CUBE_VOLUME.y * 0.5f, CUBE_VOLUME.z * 0.5f + 20.0f));
+
+    bool firstMouse = true;
+    float mouseLastX = SCR_WIDTH / 2.0;
+    float mouseLastY = SCR_HEIGHT / 2.0;
+
+    // timing
+    float deltaTime = 0.0f;	// Time between current frame and last frame
+    float lastFrame = 0.0f;
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // objects as bounding spheres moving in a straight line, turned back at the sides of volume
+    struct MovingObjects
+    {
+        std::vector<glm::vec3> Centers;
+        std::vector<glm::vec3> Velocities;
+        std::vector<float> Radii;
+
+        void Spawn(unsigned int count, const glm::vec3& volume, float speed, std::mt19937& random)
+        {
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            Centers.resize(count);
+            Velocities.resize(count);
+            Radii.resize(count);
+            for (unsigned int i = 0; i < count; i++)
+            {
+                Centers[i] = glm::vec3(unit(random), unit(random), unit(random)) * volume - glm::vec3(volume.x, 0.0f, volume.z) * 0.5f;
+                Velocities[i] = glm::normalize(glm::vec3(unit(random) - 0.5f, (unit(random) - 0.5f) * 0.2f, unit(random) - 0.5f)) * speed;
+                Radii[i] = 0.3f + unit(random) * 0.6f;
+            }
+        }
+
+        void Move(float seconds, const glm::vec3& volume)
+        {
+            glm::vec3 min(-volume.x * 0.5f, 0.0f, -volume.z * 0.5f);
+            glm::vec3 max = min + volume;
+            for (size_t i = 0; i < Centers.size(); i++)
+            {
+                Centers[i] += Velocities[i] * seconds;
+                for (int axis = 0; axis < 3; axis++)
+                    if ((Centers[i][axis] < min[axis] && Velocities[i][axis] < 0.0f) || (Centers[i][axis] > max[axis] && Velocities[i][axis] > 0.0f))
+                        Velocities[i][axis] = -Velocities[i][axis];
+            }
+        }
+    };
+
+    // the brute force references, updating them is the move itself
+    void linearFrustum(const MovingObjects& scene, const glm::vec4 planes[6], std::vector<unsigned int>& objects)
+    {
+        for (unsigned int i = 0; i < scene.Centers.size(); i++)
+        {
+            bool outside = false;
+            for (int p = 0; p < 6 && !outside; p++)
+                outside = glm::dot(glm::vec3(planes[p]), scene.Centers[i]) + planes[p].w < -scene.Radii[i];
+            if (!outside)
+                objects.push_back(i);
+        }
+    }
+
+    void linearSphere(const MovingObjects& scene, const glm::vec3& center, float radius, std::vector<unsigned int>& objects)
+    {
+        for (unsigned int i = 0; i < scene.Centers.size(); i++)
+        {
+            glm::vec3 offset = scene.Centers[i] - center;
+            float reach = scene.Radii[i] + radius;
+            if (glm::dot(offset, offset) <= reach * reach)
+                objects.push_back(i);
+        }
+    }
+
+    // every index against the linear scan for each of BENCHMARK_SIZES moving objects
+    void runBenchmark()
+    {
+        std::vector<unsigned int> found, expected;
+        for (unsigned int count : BENCHMARK_SIZES)
+        {
+            std::mt19937 random(1);
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            MovingObjects scene;
+            scene.Spawn(count, BENCHMARK_VOLUME, BENCHMARK_SPEED, random);
+            LooseOctree octree(BoundingBox(glm::vec3(-BENCHMARK_VOLUME.x * 0.5f, 0.0f, -BENCHMARK_VOLUME.z * 0.5f), glm::vec3(BENCHMARK_VOLUME.x * 0.5f, BENCHMARK_VOLUME.y, BENCHMARK_VOLUME.z * 0.5f)));
+            HashedGrid grid(4.0f);
+            for (unsigned int i = 0; i < count; i++)
+            {
+                octree.Update(i, scene.Centers[i], scene.Radii[i]);
+                grid.Update(i, scene.Centers[i], scene.Radii[i]);
+            }
+            octree.CellChanges = grid.CellChanges = 0;
+
+            double updateSeconds[3] = {}, frustumSeconds[3] = {}, sphereSeconds[3] = {};
+            unsigned int mismatches = 0;
+            for (unsigned int frame = 0; frame < BENCHMARK_FRAMES; frame++)
+            {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                scene.Move(1.0f / 60.0f, BENCHMARK_VOLUME);
+                updateSeconds[0] += secondsSince(start);
+                start = std::chrono::steady_clock::now();
+                for (unsigned int i = 0; i < count; i++)
+                    octree.Update(i, scene.Centers[i], scene.Radii[i]);
+                updateSeconds[1] += secondsSince(start);
+                start = std::chrono::steady_clock::now();
+                for (unsigned int i = 0; i < count; i++)
+                    grid.Update(i, scene.Centers[i], scene.Radii[i]);
+                updateSeconds[2] += secondsSince(start);
+
+                glm::vec3 eye(unit(random) * BENCHMARK_VOLUME.x - BENCHMARK_VOLUME.x * 0.5f, BENCHMARK_VOLUME.y * 0.5f, unit(random) * BENCHMARK_VOLUME.z - BENCHMARK_VOLUME.z * 0.5f);
+                glm::vec3 forward(unit(random) - 0.5f, -0.2f, unit(random) - 0.5f);
+                glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 150.0f) * glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+                glm::vec4 planes[6];
+                ClusterCuller::ExtractFrustumPlanes(viewProjection, planes);
+                for (unsigned int q = 0; q <= BENCHMARK_SPHERES; q++)
+                {
+                    // query 0 is the frustum, the rest are spheres
+                    glm::vec3 center = glm::vec3(unit(random), unit(random), unit(random)) * BENCHMARK_VOLUME - glm::vec3(BENCHMARK_VOLUME.x, 0.0f, BENCHMARK_VOLUME.z) * 0.5f;
+                    double* seconds = q == 0 ? frustumSeconds : sphereSeconds;
+                    expected.clear();
+                    start = std::chrono::steady_clock::now();
+                    if (q == 0)
+                        linearFrustum(scene, planes, expected);
+                    else
+                        linearSphere(scene, center, 5.0f, expected);
+                    seconds[0] += secondsSince(start);
+                    for (int i = 1; i < 3; i++)
+                    {
+                        found.clear();
+                        start = std::chrono::steady_clock::now();
+                        if (i == 1 && q == 0)
+                            octree.QueryFrustum(planes, found);
+                        else if (i == 1)
+                            octree.QuerySphere(center, 5.0f, found);
+                        else if (q == 0)
+                            grid.QueryFrustum(planes, found);
+                        else
+                            grid.QuerySphere(center, 5.0f, found);
+                        seconds[i] += secondsSince(start);
+                        std::sort(found.begin(), found.end());
+                        mismatches += found != expected;
+                    }
+                }
+            }
+
+            printf("%u moving objects, %u%% changed cell per frame, %zu octree nodes, %zu grid cells, %u mismatches\n", count,
+                octree.CellChanges * 100 / (count * BENCHMARK_FRAMES), octree.GetNodeCount(), grid.GetCellCount(), mismatches);
+            for (int i = 0; i < 3; i++)
+            {
+                double update = updateSeconds[i] * 1000.0 / BENCHMARK_FRAMES;
+                double frustum = frustumSeconds[i] * 1000.0 / BENCHMARK_FRAMES;
+                double sphere = sphereSeconds[i] * 1000.0 / (BENCHMARK_FRAMES * BENCHMARK_SPHERES);
+                printf("  %-6s update %8.3f ms, frustum %7.3f ms, sphere %7.4f ms, frame with %u spheres %8.3f ms\n", INDEX_NAMES[i], update, frustum,
+                    sphere, BENCHMARK_SPHERES, update + frustum + sphere * BENCHMARK_SPHERES);
+            }
+        }
+    }
+
+    int Main()
+    {
+        runBenchmark();
+
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwSetCursorPosCallback(window, mouse_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        Shader shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs");
+
+        // a unit cube with face normals
+        std::vector<float> vertices;
+        for (int face = 0; face < 6; face++)
+        {
+            int axis = face / 2;
+            float sign = (face % 2) ? -1.0f : 1.0f;
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = sign;
+            u[(axis + 1) % 3] = sign;
+            v[(axis + 2) % 3] = 1.0f;
+            const float corners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+            for (const float* corner : corners)
+            {
+                glm::vec3 position = normal * 0.5f + u * (corner[0] - 0.5f) + v * (corner[1] - 0.5f);
+                vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z, corner[0], corner[1] });
+            }
+        }
+        VertexFormat format;
+        format.Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+        unsigned int VAO, VBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        format.Apply();
+
+        unsigned int whiteTexture;
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        shader.use();
+        shader.setInt("baseColor", 0);
+        shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+
+        std::mt19937 random(7);
+        MovingObjects scene;
+        scene.Spawn(CUBE_COUNT, CUBE_VOLUME, CUBE_SPEED, random);
+        LooseOctree octree(BoundingBox(glm::vec3(-CUBE_VOLUME.x * 0.5f, 0.0f, -CUBE_VOLUME.z * 0.5f), glm::vec3(CUBE_VOLUME.x * 0.5f, CUBE_VOLUME.y, CUBE_VOLUME.z * 0.5f)));
+        HashedGrid grid(4.0f);
+        std::vector<unsigned int> visible, nearby;
+        std::vector<unsigned char> isNearby(CUBE_COUNT);
+
+        // render loop
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        double reportVisible = 0.0, reportNearby = 0.0, reportUpdateSeconds = 0.0, reportQuerySeconds = 0.0;
+        Index lastIndex = Index::Linear;
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            float currentFrame = static_cast<float>(glfwGetTime());
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            processInput(window);
+
+            scene.Move(std::min(deltaTime, 0.1f), CUBE_VOLUME);
+            // an index that was idle is out of date and gets refilled
+            if (index != lastIndex)
+            {
+                octree.Clear();
+                grid.Clear();
+                lastIndex = index;
+            }
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (unsigned int i = 0; i < CUBE_COUNT; i++)
+            {
+                if (index == Index::Octree)
+                    octree.Update(i, scene.Centers[i], scene.Radii[i]);
+                else if (index == Index::Grid)
+                    grid.Update(i, scene.Centers[i], scene.Radii[i]);
+            }
+            reportUpdateSeconds += secondsSince(start);
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)width / (float)std::max(height, 1), 0.1f, 300.0f);
+            glm::mat4 view = camera.GetViewMatrix();
+            glm::vec4 planes[6];
+            ClusterCuller::ExtractFrustumPlanes(projection * view, planes);
+
+            start = std::chrono::steady_clock::now();
+            visible.clear();
+            nearby.clear();
+            if (index == Index::Octree)
+            {
+                octree.QueryFrustum(planes, visible);
+                octree.QuerySphere(camera.Position, NEARBY_RADIUS, nearby);
+            }
+            else if (index == Index::Grid)
+            {
+                grid.QueryFrustum(planes, visible);
+                grid.QuerySphere(camera.Position, NEARBY_RADIUS, nearby);
+            }
+            else
+            {
+                linearFrustum(scene, planes, visible);
+                linearSphere(scene, camera.Position, NEARBY_RADIUS, nearby);
+            }
+            reportQuerySeconds += secondsSince(start);
+            for (unsigned int cube : nearby)
+                isNearby[cube] = 1;
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            shader.setMat4("projection", projection);
+            shader.setMat4("view", view);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            glBindVertexArray(VAO);
+            for (unsigned int cube : visible)
+            {
+                // a cube inside its sphere
+                float size = scene.Radii[cube] * 1.1547f;
+                shader.setMat4("model", glm::scale(glm::translate(glm::mat4(1.0f), scene.Centers[cube]), glm::vec3(size)));
+                shader.setVec4("baseColorFactor", isNearby[cube] ? glm::vec4(1.0f, 0.3f, 0.2f, 1.0f) : glm::vec4(0.8f, 0.8f, 0.75f, 1.0f));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += 12;
+            }
+            for (unsigned int cube : nearby)
+                isNearby[cube] = 0;
+
+            RenderStats::EndFrame();
+            reportVisible += visible.size();
+            reportNearby += nearby.size();
+            reportFrames++;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                printf("%-6s %5.0f of %u cubes visible, %3.0f nearby, update %6.3f ms, queries %6.3f ms, frame %6.3f ms\n", INDEX_NAMES[(int)index],
+                    reportVisible / reportFrames, CUBE_COUNT, reportNearby / reportFrames, reportUpdateSeconds * 1000.0 / reportFrames,
+                    reportQuerySeconds * 1000.0 / reportFrames, (now - reportStart) * 1000.0 / reportFrames);
+                reportStart = now;
+                reportFrames = 0;
+                reportVisible = 0.0;
+                reportNearby = 0.0;
+                reportUpdateSeconds = 0.0;
+                reportQuerySeconds = 0.0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures(1, &whiteTexture);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            index = Index::Linear;
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+            index = Index::Octree;
+        if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+            index = Index::Grid;
+
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            camera.ProcessKeyboard(FORWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            camera.ProcessKeyboard(BACKWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            camera.ProcessKeyboard(LEFT, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            camera.ProcessKeyboard(RIGHT, deltaTime);
+    }
+
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+    {
+        if (firstMouse)
+        {
+            mouseLastX = xpos;
+            mouseLastY = ypos;
+            firstMouse = false;
+        }
+
+        float xoffset = xpos - mouseLastX;
+        float yoffset = mouseLastY - ypos; // reversed since y-coordinates range from bottom to top
+
+        mouseLastX = xpos;
+        mouseLastY = ypos;
+
+        camera.ProcessMouseMovement(xoffset, yoffset);
+    }
+}
@@ -0,0 +1,4 @@
+namespace DynamicObjects
+{
+    int Main();
+};
\ No newline at end of file
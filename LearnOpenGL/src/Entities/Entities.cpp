@@ -0,0 +1,546 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <vector>
+#include "Entities.h"
+#include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../AlignedMath.h"
+#include "../Camera.h"
+#include "../ClusterCuller.h"
+#include "../EntityWorld.h"
+#include "../RenderStats.h"
+#include "../ThreadPool.h"
+#include "../VertexFormat.h"
+
+namespace Entities
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // the startup benchmark runs every system over BENCHMARK_COUNT objects, a quarter of them not spinning
+    const unsigned int BENCHMARK_COUNT = 1000000;
+    const unsigned int BENCHMARK_FRAMES = 10;
+    const glm::vec3 BENCHMARK_VOLUME(1000.0f, 100.0f, 1000.0f);
+
+    // the scene, a block of spinning cubes
+    const int CUBES_X = 24;
+    const int CUBES_Y = 8;
+    const int CUBES_Z = 24;
+    const float CUBE_SPACING = 3.0f;
+
+    // the components
+    struct Transform
+    {
+        glm::vec3 Position;
+        float Scale;
+        glm::quat Rotation;
+    };
+    // radians per second about Axis
+    struct Spin
+    {
+        glm::vec3 Axis;
+        float Speed;
+    };
+    struct LocalToWorld
+    {
+        AlignedMat4 Matrix;
+    };
+    // a sphere around the mesh at unit scale, Visible is written by cull()
+    struct Bounds
+    {
+        float Radius;
+        unsigned int Visible;
+    };
+    struct Mesh
+    {
+        unsigned int VertexArray;
+        unsigned int VertexCount;
+    };
+    struct Material
+    {
+        glm::vec4 Color;
+    };
+
+    struct DrawItem
+    {
+        const AlignedMat4* Matrix;
+        unsigned int VertexArray;
+        unsigned int VertexCount;
+        glm::vec4 Color;
+    };
+
+    // all of the components in one object, the way the scene would be kept without the entity world
+    struct SceneObject
+    {
+        Entities::Transform Transform;
+        bool Spins;
+        Entities::Spin Spin;
+        Entities::LocalToWorld LocalToWorld;
+        Entities::Bounds Bounds;
+        Entities::Mesh Mesh;
+        Entities::Material Material;
+        char Name[32];
+    };
+
+    // switched with the 1/2 keys
+    bool threaded = true;
+    // R stops or restarts a random tenth of the cubes, moving them between archetypes
+    bool toggleKeyDown = false;
+    bool toggleRequested = false;
+
+    // camera
+    Camera camera(glm::vec3(0.0f, 10.0f, CUBES_Z * CUBE_SPACING * 0.5f + 25.0f));
+
+    bool firstMouse = true;
+    float mouseLastX = SCR_WIDTH / 2.0;
+    float mouseLastY = SCR_HEIGHT / 2.0;
+
+    // timing
+    float deltaTime = 0.0f;	// Time between current frame and last frame
+    float lastFrame = 0.0f;
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // the systems, each over one chunk so they run the same alone or on the pool
+
+    void spin(unsigned int count, Transform* transforms, const Spin* spins, float deltaSeconds)
+    {
+        for (unsigned int i = 0; i < count; i++)
+            transforms[i].Rotation = glm::normalize(glm::angleAxis(spins[i].Speed * deltaSeconds, spins[i].Axis) * transforms[i].Rotation);
+    }
+
+    void localToWorld(unsigned int count, const Transform* transforms, LocalToWorld* matrices)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            AlignedMat4 matrix = glm::mat4_cast(transforms[i].Rotation);
+            matrix[0] *= transforms[i].Scale;
+            matrix[1] *= transforms[i].Scale;
+            matrix[2] *= transforms[i].Scale;
+            matrix[3] = AlignedVec4(transforms[i].Position, 1.0f);
+            matrices[i].Matrix = matrix;
+        }
+    }
+
+    void cull(unsigned int count, const Transform* transforms, Bounds* bounds, const glm::vec4 planes[6])
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            float radius = bounds[i].Radius * transforms[i].Scale;
+            bool outside = false;
+            for (int p = 0; p < 6 && !outside; p++)
+                outside = glm::dot(glm::vec3(planes[p]), transforms[i].Position) + planes[p].w < -radius;
+            bounds[i].Visible = !outside;
+        }
+    }
+
+    void buildDrawList(unsigned int count, const LocalToWorld* matrices, const Bounds* bounds, const Mesh* meshes, const Material* materials,
+        std::vector<DrawItem>& drawList)
+    {
+        for (unsigned int i = 0; i < count; i++)
+            if (bounds[i].Visible)
+                drawList.push_back(DrawItem{ &matrices[i].Matrix, meshes[i].VertexArray, meshes[i].VertexCount, materials[i].Color });
+    }
+
+    // runs the systems over the whole world, on pool's threads unless pool is NULL. seconds gets the time of each
+    void runSystems(EntityWorld& world, ThreadPool* pool, float deltaSeconds, const glm::vec4 planes[6], std::vector<DrawItem>& drawList,
+        double seconds[4])
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        auto spinChunk = [&](unsigned int count, const Entity*, Transform* transforms, const Spin* spins)
+        {
+            spin(count, transforms, spins, deltaSeconds);
+        };
+        if (pool)
+            world.View<Transform, const Spin>().ParallelEachChunk(*pool, spinChunk);
+        else
+            world.View<Transform, const Spin>().EachChunk(spinChunk);
+        seconds[0] += secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        auto matrixChunk = [&](unsigned int count, const Entity*, const Transform* transforms, LocalToWorld* matrices)
+        {
+            localToWorld(count, transforms, matrices);
+        };
+        if (pool)
+            world.View<const Transform, LocalToWorld>().ParallelEachChunk(*pool, matrixChunk);
+        else
+            world.View<const Transform, LocalToWorld>().EachChunk(matrixChunk);
+        seconds[1] += secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        auto cullChunk = [&](unsigned int count, const Entity*, const Transform* transforms, Bounds* bounds)
+        {
+            cull(count, transforms, bounds, planes);
+        };
+        if (pool)
+            world.View<const Transform, Bounds>().ParallelEachChunk(*pool, cullChunk);
+        else
+            world.View<const Transform, Bounds>().EachChunk(cullChunk);
+        seconds[2] += secondsSince(start);
+
+        // every chunk builds its own list, appended to the shared one under the lock
+        start = std::chrono::steady_clock::now();
+        drawList.clear();
+        std::mutex drawListMutex;
+        auto drawChunk = [&](unsigned int count, const Entity*, const LocalToWorld* matrices, const Bounds* bounds, const Mesh* meshes,
+            const Material* materials)
+        {
+            if (!pool)
+            {
+                buildDrawList(count, matrices, bounds, meshes, materials, drawList);
+                return;
+            }
+            std::vector<DrawItem> chunkList;
+            buildDrawList(count, matrices, bounds, meshes, materials, chunkList);
+            std::lock_guard<std::mutex> lock(drawListMutex);
+            drawList.insert(drawList.end(), chunkList.begin(), chunkList.end());
+        };
+        if (pool)
+            world.View<const LocalToWorld, const Bounds, const Mesh, const Material>().ParallelEachChunk(*pool, drawChunk);
+        else
+            world.View<const LocalToWorld, const Bounds, const Mesh, const Material>().EachChunk(drawChunk);
+        seconds[3] += secondsSince(start);
+    }
+
+    Entity spawn(EntityWorld& world, const Transform& transform, bool spins, const Spin& spinning, const Mesh& mesh, const Material& material)
+    {
+        Bounds bounds = { 0.87f, 0 };
+        if (spins)
+            return world.Create(transform, spinning, LocalToWorld(), bounds, mesh, material);
+        return world.Create(transform, LocalToWorld(), bounds, mesh, material);
+    }
+
+    // the systems over the entity world on one thread and on all of them, against the same work on an array of
+    // objects holding every component
+    void runBenchmark()
+    {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        EntityWorld world;
+        std::vector<SceneObject> objects(BENCHMARK_COUNT);
+        for (SceneObject& object : objects)
+        {
+            object.Transform.Position = glm::vec3(unit(random), unit(random), unit(random)) * BENCHMARK_VOLUME - glm::vec3(BENCHMARK_VOLUME.x, 0.0f, BENCHMARK_VOLUME.z) * 0.5f;
+            object.Transform.Scale = 0.5f + unit(random);
+            object.Transform.Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+            object.Spins = unit(random) < 0.75f;
+            object.Spin.Axis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.1f));
+            object.Spin.Speed = 0.5f + unit(random);
+            object.LocalToWorld.Matrix = AlignedMat4(1.0f);
+            object.Bounds = { 0.87f, 0 };
+            object.Mesh = { 1, 36 };
+            object.Material.Color = glm::vec4(unit(random), unit(random), unit(random), 1.0f);
+            object.Name[0] = 0;
+            spawn(world, object.Transform, object.Spins, object.Spin, object.Mesh, object.Material);
+        }
+
+        // from the middle of one side towards the center
+        glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 600.0f)
+            * glm::lookAt(glm::vec3(0.0f, 50.0f, -BENCHMARK_VOLUME.z * 0.5f), glm::vec3(0.0f, 40.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::vec4 planes[6];
+        ClusterCuller::ExtractFrustumPlanes(viewProjection, planes);
+        const float deltaSeconds = 1.0f / 60.0f;
+
+        double objectSeconds[4] = {};
+        std::vector<DrawItem> objectDrawList;
+        for (unsigned int frame = 0; frame < BENCHMARK_FRAMES; frame++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (SceneObject& object : objects)
+                if (object.Spins)
+                    spin(1, &object.Transform, &object.Spin, deltaSeconds);
+            objectSeconds[0] += secondsSince(start);
+            start = std::chrono::steady_clock::now();
+            for (SceneObject& object : objects)
+                localToWorld(1, &object.Transform, &object.LocalToWorld);
+            objectSeconds[1] += secondsSince(start);
+            start = std::chrono::steady_clock::now();
+            for (SceneObject& object : objects)
+                cull(1, &object.Transform, &object.Bounds, planes);
+            objectSeconds[2] += secondsSince(start);
+            start = std::chrono::steady_clock::now();
+            objectDrawList.clear();
+            for (SceneObject& object : objects)
+                buildDrawList(1, &object.LocalToWorld, &object.Bounds, &object.Mesh, &object.Material, objectDrawList);
+            objectSeconds[3] += secondsSince(start);
+        }
+
+        ThreadPool pool;
+        printf("%u entities in %zu archetypes and %zu chunks, %zu visible, %u threads\n", BENCHMARK_COUNT, world.GetArchetypeCount(),
+            world.GetChunkCount(), objectDrawList.size(), pool.GetThreadCount());
+        auto print = [](const char* name, const double seconds[4], size_t drawn)
+        {
+            double total = seconds[0] + seconds[1] + seconds[2] + seconds[3];
+            printf("  %-16s spin %7.2f ms, matrices %7.2f ms, cull %7.2f ms, draw list %7.2f ms, %6.1f M entities/s, %zu drawn\n", name,
+                seconds[0] * 1000.0 / BENCHMARK_FRAMES, seconds[1] * 1000.0 / BENCHMARK_FRAMES, seconds[2] * 1000.0 / BENCHMARK_FRAMES,
+                seconds[3] * 1000.0 / BENCHMARK_FRAMES, BENCHMARK_COUNT * BENCHMARK_FRAMES / total / 1e6, drawn);
+        };
+        print("objects", objectSeconds, objectDrawList.size());
+
+        for (int run = 0; run < 2; run++)
+        {
+            if (run == 1 && pool.GetThreadCount() == 1)
+                break;
+            double seconds[4] = {};
+            std::vector<DrawItem> drawList;
+            for (unsigned int frame = 0; frame < BENCHMARK_FRAMES; frame++)
+                runSystems(world, run == 1 ? &pool : NULL, deltaSeconds, planes, drawList, seconds);
+            print(run == 1 ? "entities, pool" : "entities", seconds, drawList.size());
+        }
+    }
+
+    int Main()
+    {
+        runBenchmark();
+
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwSetCursorPosCallback(window, mouse_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        Shader shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs");
+
+        // a unit cube with face normals
+        std::vector<float> vertices;
+        for (int face = 0; face < 6; face++)
+        {
+            int axis = face / 2;
+            float sign = (face % 2) ? -1.0f : 1.0f;
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = sign;
+            u[(axis + 1) % 3] = sign;
+            v[(axis + 2) % 3] = 1.0f;
+            const float corners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+            for (const float* corner : corners)
+            {
+                glm::vec3 position = normal * 0.5f + u * (corner[0] - 0.5f) + v * (corner[1] - 0.5f);
+                vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z, corner[0], corner[1] });
+            }
+        }
+        VertexFormat format;
+        format.Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+        unsigned int VAO, VBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        format.Apply();
+
+        unsigned int whiteTexture;
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        shader.use();
+        shader.setInt("baseColor", 0);
+        shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+
+        std::mt19937 random(2);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        EntityWorld world;
+        std::vector<Entity> cubes;
+        for (int x = 0; x < CUBES_X; x++)
+            for (int y = 0; y < CUBES_Y; y++)
+                for (int z = 0; z < CUBES_Z; z++)
+                {
+                    Transform transform = { glm::vec3(x - (CUBES_X - 1) * 0.5f, y, z - (CUBES_Z - 1) * 0.5f) * CUBE_SPACING, 0.6f + 0.8f * unit(random),
+                        glm::quat(1.0f, 0.0f, 0.0f, 0.0f) };
+                    Spin spinning = { glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.1f)), 0.5f + 2.0f * unit(random) };
+                    Material material = { glm::vec4(0.3f + 0.7f * (float)x / CUBES_X, 0.3f + 0.7f * (float)y / CUBES_Y, 0.3f + 0.7f * (float)z / CUBES_Z, 1.0f) };
+                    cubes.push_back(spawn(world, transform, true, spinning, Mesh{ VAO, 36 }, material));
+                }
+        ThreadPool pool;
+        std::vector<DrawItem> drawList;
+
+        // render loop
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        double reportSeconds[4] = {};
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            float currentFrame = static_cast<float>(glfwGetTime());
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            processInput(window);
+            if (toggleRequested)
+            {
+                toggleRequested = false;
+                for (const Entity& cube : cubes)
+                {
+                    if (unit(random) >= 0.1f)
+                        continue;
+                    if (world.Has<Spin>(cube))
+                        world.Remove<Spin>(cube);
+                    else
+                        world.Add(cube, Spin{ glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.1f)), 0.5f + 2.0f * unit(random) });
+                }
+            }
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)width / (float)std::max(height, 1), 0.1f, 300.0f);
+            glm::mat4 view = camera.GetViewMatrix();
+            glm::vec4 planes[6];
+            ClusterCuller::ExtractFrustumPlanes(projection * view, planes);
+            runSystems(world, threaded ? &pool : NULL, deltaTime, planes, drawList, reportSeconds);
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            shader.setMat4("projection", projection);
+            shader.setMat4("view", view);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            unsigned int boundVertexArray = 0;
+            for (const DrawItem& item : drawList)
+            {
+                if (item.VertexArray != boundVertexArray)
+                {
+                    glBindVertexArray(item.VertexArray);
+                    boundVertexArray = item.VertexArray;
+                }
+                shader.setMat4("model", *item.Matrix);
+                shader.setVec4("baseColorFactor", item.Color);
+                glDrawArrays(GL_TRIANGLES, 0, item.VertexCount);
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += item.VertexCount / 3;
+            }
+
+            RenderStats::EndFrame();
+            reportFrames++;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                printf("%s, %zu entities in %zu archetypes, %zu drawn, spin %.3f ms, matrices %.3f ms, cull %.3f ms, draw list %.3f ms\n",
+                    threaded ? "pool" : "1 thread", world.GetEntityCount(), world.GetArchetypeCount(), drawList.size(), reportSeconds[0] * 1000.0 / reportFrames,
+                    reportSeconds[1] * 1000.0 / reportFrames, reportSeconds[2] * 1000.0 / reportFrames, reportSeconds[3] * 1000.0 / reportFrames);
+                reportStart = now;
+                reportFrames = 0;
+                std::fill(reportSeconds, reportSeconds + 4, 0.0);
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures(1, &whiteTexture);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            threaded = false;
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+            threaded = true;
+        bool toggleKey = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+        if (toggleKey && !toggleKeyDown)
+            toggleRequested = true;
+        toggleKeyDown = toggleKey;
+
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            camera.ProcessKeyboard(FORWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            camera.ProcessKeyboard(BACKWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            camera.ProcessKeyboard(LEFT, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            camera.ProcessKeyboard(RIGHT, deltaTime);
+    }
+
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+    {
+        if (firstMouse)
+        {
+            mouseLastX = xpos;
+            mouseLastY = ypos;
+            firstMouse = false;
+        }
+
+        float xoffset = xpos - mouseLastX;
+        float yoffset = mouseLastY - ypos; // reversed since y-coordinates range from bottom to top
+
+        mouseLastX = xpos;
+        mouseLastY = ypos;
+
+        camera.ProcessMouseMovement(xoffset, yoffset);
+    }
+}
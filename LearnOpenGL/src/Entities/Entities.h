@@ -0,0 +1,4 @@
+namespace Entities
+{
+    int Main();
+};
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "EntityWorld.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <xmmintrin.h>
+
+namespace
+{
+    std::vector<size_t>& componentSizes()
+    {
+        static std::vector<size_t> sizes;
+        return sizes;
+    }
+
+    size_t alignUp(size_t value)
+    {
+        return (value + 63) & ~(size_t)63;
+    }
+}
+
+unsigned int EntityComponents::Register(size_t size)
+{
+    // ids are taken from function local statics, which C++11 initializes one at a time
+    std::vector<size_t>& sizes = componentSizes();
+    assert(sizes.size() < MAX_COMPONENTS);
+    sizes.push_back(size);
+    return (unsigned int)sizes.size() - 1;
+}
+
+size_t EntityComponents::GetSize(unsigned int id)
+{
+    return componentSizes()[id];
+}
+
+const size_t EntityWorld::CHUNK_SIZE;
+
+EntityWorld::EntityWorld()
+{
+}
+
+EntityWorld::~EntityWorld()
+{
+    for (const std::unique_ptr<EntityArchetype>& archetype : archetypes)
+        for (EntityChunk& chunk : archetype->Chunks)
+            _mm_free(chunk.Data);
+}
+
+Entity EntityWorld::Create()
+{
+    return createIn(findArchetype(0));
+}
+
+void EntityWorld::Destroy(Entity entity)
+{
+    if (!IsAlive(entity))
+        return;
+    Record& record = records[entity.Index];
+    removeRow(record.Archetype, record.Chunk, record.Row);
+    record.Archetype = NONE;
+    record.Generation++;
+    freeIndices.push_back(entity.Index);
+}
+
+size_t EntityWorld::GetChunkCount() const
+{
+    size_t count = 0;
+    for (const std::unique_ptr<EntityArchetype>& archetype : archetypes)
+        count += archetype->Chunks.size();
+    return count;
+}
+
+unsigned int EntityWorld::findArchetype(uint64_t mask)
+{
+    auto found = archetypesByMask.find(mask);
+    if (found != archetypesByMask.end())
+        return found->second;
+
+    std::unique_ptr<EntityArchetype> archetype(new EntityArchetype());
+    archetype->Mask = mask;
+    size_t rowBytes = sizeof(Entity);
+    for (unsigned int component = 0; component < EntityComponents::MAX_COMPONENTS; component++)
+    {
+        archetype->Offsets[component] = -1;
+        if (mask & (1ull << component))
+        {
+            archetype->Components.push_back(component);
+            rowBytes += EntityComponents::GetSize(component);
+        }
+    }
+    // every array starts on a cache line, which costs up to 63 bytes each
+    size_t padding = 64 * (archetype->Components.size() + 1);
+    archetype->Capacity = (unsigned int)std::max((CHUNK_SIZE - std::min(padding, CHUNK_SIZE)) / rowBytes, (size_t)1);
+    size_t offset = alignUp(sizeof(Entity) * archetype->Capacity);
+    for (unsigned int component : archetype->Components)
+    {
+        archetype->Offsets[component] = (int)offset;
+        offset = alignUp(offset + EntityComponents::GetSize(component) * archetype->Capacity);
+    }
+    // an entity too large for a chunk gets a larger one to itself
+    archetype->ChunkBytes = std::max(offset, CHUNK_SIZE);
+
+    archetypes.push_back(std::move(archetype));
+    archetypesByMask[mask] = (unsigned int)archetypes.size() - 1;
+    return (unsigned int)archetypes.size() - 1;
+}
+
+std::vector<EntityArchetype*> EntityWorld::matchingArchetypes(uint64_t mask) const
+{
+    std::vector<EntityArchetype*> matching;
+    for (const std::unique_ptr<EntityArchetype>& archetype : archetypes)
+        if ((archetype->Mask & mask) == mask)
+            matching.push_back(archetype.get());
+    return matching;
+}
+
+Entity EntityWorld::createIn(unsigned int archetype)
+{
+    Entity entity;
+    if (!freeIndices.empty())
+    {
+        entity.Index = freeIndices.back();
+        freeIndices.pop_back();
+    }
+    else
+    {
+        entity.Index = (unsigned int)records.size();
+        records.push_back(Record{ NONE, 0, 0, 0 });
+    }
+    entity.Generation = records[entity.Index].Generation;
+    appendRow(archetype, entity.Index);
+    // new components start zeroed rather than with whatever the last occupant of the row left
+    const Record& record = records[entity.Index];
+    const EntityArchetype& target = *archetypes[archetype];
+    for (unsigned int component : target.Components)
+    {
+        size_t size = EntityComponents::GetSize(component);
+        std::memset(target.Chunks[record.Chunk].Data + target.Offsets[component] + size * record.Row, 0, size);
+    }
+    return entity;
+}
+
+void EntityWorld::appendRow(unsigned int archetype, unsigned int index)
+{
+    EntityArchetype& target = *archetypes[archetype];
+    if (target.Chunks.empty() || target.Chunks.back().Count == target.Capacity)
+        target.Chunks.push_back(EntityChunk{ (unsigned char*)_mm_malloc(target.ChunkBytes, 64), 0 });
+
+    EntityChunk& chunk = target.Chunks.back();
+    Record& record = records[index];
+    record.Archetype = archetype;
+    record.Chunk = (unsigned int)target.Chunks.size() - 1;
+    record.Row = chunk.Count++;
+    ((Entity*)chunk.Data)[record.Row] = Entity{ index, record.Generation };
+}
+
+void EntityWorld::removeRow(unsigned int archetype, unsigned int chunk, unsigned int row)
+{
+    EntityArchetype& source = *archetypes[archetype];
+    EntityChunk& last = source.Chunks.back();
+    unsigned int lastChunk = (unsigned int)source.Chunks.size() - 1;
+    unsigned int lastRow = last.Count - 1;
+    if (chunk != lastChunk || row != lastRow)
+    {
+        EntityChunk& gap = source.Chunks[chunk];
+        Entity moved = ((Entity*)last.Data)[lastRow];
+        ((Entity*)gap.Data)[row] = moved;
+        for (unsigned int component : source.Components)
+        {
+            size_t size = EntityComponents::GetSize(component);
+            int offset = source.Offsets[component];
+            std::memcpy(gap.Data + offset + size * row, last.Data + offset + size * lastRow, size);
+        }
+        records[moved.Index].Chunk = chunk;
+        records[moved.Index].Row = row;
+    }
+    if (--last.Count == 0)
+    {
+        _mm_free(last.Data);
+        source.Chunks.pop_back();
+    }
+}
+
+const EntityWorld::Record& EntityWorld::moveTo(Entity entity, uint64_t mask)
+{
+    Record from = records[entity.Index];
+    unsigned int archetype = findArchetype(mask);
+    appendRow(archetype, entity.Index);
+
+    const EntityArchetype& source = *archetypes[from.Archetype];
+    const EntityArchetype& target = *archetypes[archetype];
+    const Record& to = records[entity.Index];
+    const unsigned char* sourceData = source.Chunks[from.Chunk].Data;
+    unsigned char* targetData = target.Chunks[to.Chunk].Data;
+    for (unsigned int component : target.Components)
+    {
+        size_t size = EntityComponents::GetSize(component);
+        if (source.Offsets[component] >= 0)
+            std::memcpy(targetData + target.Offsets[component] + size * to.Row, sourceData + source.Offsets[component] + size * from.Row, size);
+        else
+            std::memset(targetData + target.Offsets[component] + size * to.Row, 0, size);
+    }
+    removeRow(from.Archetype, from.Chunk, from.Row);
+    return to;
+}
+
+void* EntityWorld::addComponent(Entity entity, unsigned int component)
+{
+    assert(IsAlive(entity));
+    const Record* record = &records[entity.Index];
+    uint64_t mask = archetypes[record->Archetype]->Mask;
+    if (!(mask & (1ull << component)))
+        record = &moveTo(entity, mask | (1ull << component));
+    const EntityArchetype& archetype = *archetypes[record->Archetype];
+    return archetype.Chunks[record->Chunk].Data + archetype.Offsets[component] + EntityComponents::GetSize(component) * record->Row;
+}
+
+void EntityWorld::removeComponent(Entity entity, unsigned int component)
+{
+    if (!IsAlive(entity))
+        return;
+    uint64_t mask = archetypes[records[entity.Index].Archetype]->Mask;
+    if (mask & (1ull << component))
+        moveTo(entity, mask & ~(1ull << component));
+}
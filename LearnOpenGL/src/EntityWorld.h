@@ -0,0 +1,250 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "ThreadPool.h"
+
+// names an entity. Generation tells a destroyed entity from a later one reusing its Index
+struct Entity
+{
+    unsigned int Index;
+    unsigned int Generation;
+
+    bool operator==(const Entity& other) const { return Index == other.Index && Generation == other.Generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+// component types get an id on first use. components are plain data, they are moved between chunks with memcpy
+namespace EntityComponents
+{
+    const unsigned int MAX_COMPONENTS = 64;
+
+    unsigned int Register(size_t size);
+    size_t GetSize(unsigned int id);
+
+    template<typename T>
+    struct Type
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "components must be trivially copyable");
+        static_assert(alignof(T) <= 64, "components can be aligned to at most 64 bytes");
+
+        static unsigned int Id()
+        {
+            static const unsigned int id = Register(sizeof(T));
+            return id;
+        }
+    };
+
+    // T and const T share an id
+    template<typename T>
+    unsigned int Id()
+    {
+        return Type<typename std::remove_const<T>::type>::Id();
+    }
+
+    template<typename... T>
+    uint64_t Mask()
+    {
+        uint64_t mask = 0;
+        int expand[] = { 0, (mask |= 1ull << Id<T>(), 0)... };
+        (void)expand;
+        return mask;
+    }
+}
+
+// ChunkBytes of its archetype, 64 byte aligned, holding the chunk's entities followed by each component's array
+struct EntityChunk
+{
+    unsigned char* Data;
+    unsigned int Count;
+};
+
+// all entities with exactly the same set of components. every chunk but the last is full
+struct EntityArchetype
+{
+    uint64_t Mask;
+    std::vector<unsigned int> Components;
+    // byte offset of each component's array in a chunk, -1 for the components the archetype lacks. the Entity
+    // array is at 0
+    int Offsets[EntityComponents::MAX_COMPONENTS];
+    unsigned int Capacity;
+    size_t ChunkBytes;
+    std::vector<EntityChunk> Chunks;
+};
+
+template<typename... T>
+class EntityView;
+
+// Entities and their components, stored by archetype in 16 KB chunks so a system reading a few components walks
+// contiguous arrays of just those. adding or removing a component moves the entity to another archetype; this and
+// Create()/Destroy() must not happen while a view is being iterated.
+class EntityWorld
+{
+public:
+    static const size_t CHUNK_SIZE = 16384;
+
+    EntityWorld();
+    ~EntityWorld();
+
+    EntityWorld(const EntityWorld&) = delete;
+    EntityWorld& operator=(const EntityWorld&) = delete;
+
+    Entity Create();
+    template<typename... T>
+    Entity Create(const T&... components)
+    {
+        Entity entity = createIn(findArchetype(EntityComponents::Mask<T...>()));
+        int expand[] = { 0, (*Get<T>(entity) = components, 0)... };
+        (void)expand;
+        return entity;
+    }
+    void Destroy(Entity entity);
+    bool IsAlive(Entity entity) const
+    {
+        return entity.Index < records.size() && records[entity.Index].Generation == entity.Generation && records[entity.Index].Archetype != NONE;
+    }
+
+    // replaces the component when the entity already has one
+    template<typename T>
+    void Add(Entity entity, const T& component)
+    {
+        *(T*)addComponent(entity, EntityComponents::Id<T>()) = component;
+    }
+    template<typename T>
+    void Remove(Entity entity)
+    {
+        removeComponent(entity, EntityComponents::Id<T>());
+    }
+    template<typename T>
+    bool Has(Entity entity) const
+    {
+        return IsAlive(entity) && (archetypes[records[entity.Index].Archetype]->Mask & (1ull << EntityComponents::Id<T>())) != 0;
+    }
+    // NULL when the entity is gone or lacks the component. valid until the next structural change
+    template<typename T>
+    T* Get(Entity entity)
+    {
+        if (!IsAlive(entity))
+            return NULL;
+        const Record& record = records[entity.Index];
+        const EntityArchetype& archetype = *archetypes[record.Archetype];
+        int offset = archetype.Offsets[EntityComponents::Id<T>()];
+        if (offset < 0)
+            return NULL;
+        return (T*)(archetype.Chunks[record.Chunk].Data + offset) + record.Row;
+    }
+
+    // the entities having all of T, and maybe more. const T gives read-only access
+    template<typename... T>
+    EntityView<T...> View()
+    {
+        return EntityView<T...>(matchingArchetypes(EntityComponents::Mask<T...>()));
+    }
+
+    size_t GetEntityCount() const { return records.size() - freeIndices.size(); }
+    size_t GetArchetypeCount() const { return archetypes.size(); }
+    size_t GetChunkCount() const;
+
+private:
+    static const unsigned int NONE = ~0u;
+
+    // where an entity lives, by entity index
+    struct Record
+    {
+        unsigned int Archetype;
+        unsigned int Chunk;
+        unsigned int Row;
+        unsigned int Generation;
+    };
+
+    std::vector<Record> records;
+    std::vector<unsigned int> freeIndices;
+    // by pointer so views keep theirs when more are created
+    std::vector<std::unique_ptr<EntityArchetype>> archetypes;
+    std::unordered_map<uint64_t, unsigned int> archetypesByMask;
+
+    unsigned int findArchetype(uint64_t mask);
+    std::vector<EntityArchetype*> matchingArchetypes(uint64_t mask) const;
+    Entity createIn(unsigned int archetype);
+    // appends the entity to the archetype's last chunk, updating its record
+    void appendRow(unsigned int archetype, unsigned int index);
+    // fills the gap with the archetype's last row
+    void removeRow(unsigned int archetype, unsigned int chunk, unsigned int row);
+    // moves the entity to the archetype of mask, keeping the components both have, returns its new record
+    const Record& moveTo(Entity entity, uint64_t mask);
+    void* addComponent(Entity entity, unsigned int component);
+    void removeComponent(Entity entity, unsigned int component);
+};
+
+// The archetypes matching a query when the view was made. iterating calls a function per entity or per chunk with
+// the component arrays; chunks are independent, so the Parallel versions hand them to a thread pool.
+template<typename... T>
+class EntityView
+{
+public:
+    explicit EntityView(std::vector<EntityArchetype*> archetypes) : archetypes(std::move(archetypes)) {}
+
+    // function(unsigned int count, const Entity* entities, T* components...) for every chunk
+    template<typename Function>
+    void EachChunk(Function function) const
+    {
+        for (EntityArchetype* archetype : archetypes)
+            for (const EntityChunk& chunk : archetype->Chunks)
+                callChunk(*archetype, chunk, function);
+    }
+    // function(Entity entity, T& components...) for every entity
+    template<typename Function>
+    void Each(Function function) const
+    {
+        EachChunk([&](unsigned int count, const Entity* entities, T*... components)
+        {
+            for (unsigned int i = 0; i < count; i++)
+                function(entities[i], components[i]...);
+        });
+    }
+    // EachChunk() with the chunks split between pool's threads, so function must be safe to call concurrently
+    template<typename Function>
+    void ParallelEachChunk(ThreadPool& pool, Function function) const
+    {
+        std::vector<std::pair<EntityArchetype*, const EntityChunk*>> chunks;
+        for (EntityArchetype* archetype : archetypes)
+            for (const EntityChunk& chunk : archetype->Chunks)
+                chunks.push_back(std::make_pair(archetype, &chunk));
+        pool.ParallelFor(chunks.size(), 1, [&](size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; i++)
+                callChunk(*chunks[i].first, *chunks[i].second, function);
+        });
+    }
+    template<typename Function>
+    void ParallelEach(ThreadPool& pool, Function function) const
+    {
+        ParallelEachChunk(pool, [&](unsigned int count, const Entity* entities, T*... components)
+        {
+            for (unsigned int i = 0; i < count; i++)
+                function(entities[i], components[i]...);
+        });
+    }
+
+    size_t GetCount() const
+    {
+        size_t count = 0;
+        for (EntityArchetype* archetype : archetypes)
+            if (!archetype->Chunks.empty())
+                count += (archetype->Chunks.size() - 1) * archetype->Capacity + archetype->Chunks.back().Count;
+        return count;
+    }
+
+private:
+    std::vector<EntityArchetype*> archetypes;
+
+    template<typename Function>
+    static void callChunk(const EntityArchetype& archetype, const EntityChunk& chunk, Function& function)
+    {
+        function(chunk.Count, (const Entity*)chunk.Data, (T*)(chunk.Data + archetype.Offsets[EntityComponents::Id<T>()])...);
+    }
+};
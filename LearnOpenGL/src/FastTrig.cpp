@@ -0,0 +1,177 @@
+#include "FastTrig.h"
+
+#include "CpuFeatures.h"
+#include "FastTrigKernels.h"
+
+namespace
+{
+    // rounded up from what the demo in Rotations measures
+    const float MAX_ERRORS[] = { 2e-5f, 1.5e-7f, 1e-7f };
+
+    FastTrig::Path detectBestPath()
+    {
+        const CpuFeatures& cpu = CpuFeatures::Get();
+        return cpu.Avx2 && cpu.Fma ? FastTrig::Path::Avx2 : FastTrig::Path::Scalar;
+    }
+
+    FastTrig::Path currentPath = detectBestPath();
+
+    const FastTrigKernels::Polynomial& polynomial(FastTrig::Accuracy accuracy)
+    {
+        return FastTrigKernels::POLYNOMIALS[(int)accuracy];
+    }
+
+    // adding and subtracting 1.5 * 2^23 rounds a float below 2^22 to the nearest integer, without the library call
+    // std::nearbyint is without SSE4.1
+    const float ROUNDING = 12582912.0f;
+
+    const double PIO2 = 1.57079632679489661923;
+
+    // the same steps as sinCos8() in FastTrigKernelsAvx2.cpp, one angle at a time. without fused multiply-adds the
+    // products of the three part reduction are not exact for large angles, so it is done in double instead
+    template<int SinTerms, int CosTerms>
+    inline void sinCos(float angle, float& sine, float& cosine, const FastTrigKernels::Polynomial& polynomial)
+    {
+        float j = (angle * FastTrigKernels::TWO_OVER_PI + ROUNDING) - ROUNDING;
+        float r = (float)(angle - j * PIO2);
+
+        float z = r * r;
+        float sinSum = polynomial.Sin[SinTerms - 1];
+        for (int i = SinTerms - 2; i >= 0; i--)
+            sinSum = sinSum * z + polynomial.Sin[i];
+        float cosSum = polynomial.Cos[CosTerms - 1];
+        for (int i = CosTerms - 2; i >= 0; i--)
+            cosSum = cosSum * z + polynomial.Cos[i];
+        float s = r + z * r * sinSum;
+        float c = 1.0f + z * cosSum;
+
+        // odd quadrants swap sine and cosine, the sign of the sine flips in quadrants 2 and 3 and of the cosine in 1
+        // and 2; multiplied rather than branched on, the quadrants are random in a batch
+        int quadrant = (int)j;
+        sine = ((quadrant & 1) ? c : s) * (float)(1 - (quadrant & 2));
+        cosine = ((quadrant & 1) ? s : c) * (float)(1 - ((quadrant + 1) & 2));
+    }
+
+    template<int SinTerms, int CosTerms>
+    void sinCosArray(const float* angles, float* sines, float* cosines, size_t count, const FastTrigKernels::Polynomial& polynomial)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            float sine, cosine;
+            sinCos<SinTerms, CosTerms>(angles[i], sine, cosine, polynomial);
+            if (sines)
+                sines[i] = sine;
+            if (cosines)
+                cosines[i] = cosine;
+        }
+    }
+
+    template<int SinTerms, int CosTerms>
+    void axisAnglesArray(const glm::vec3* axes, const float* angles, glm::quat* out, size_t count, const FastTrigKernels::Polynomial& polynomial)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            float sine, cosine;
+            sinCos<SinTerms, CosTerms>(angles[i] * 0.5f, sine, cosine, polynomial);
+            out[i] = glm::quat(cosine, axes[i] * sine);
+        }
+    }
+}
+
+FastTrig::Path FastTrig::GetBestPath()
+{
+    static const Path best = detectBestPath();
+    return best;
+}
+
+FastTrig::Path FastTrig::GetPath()
+{
+    return currentPath;
+}
+
+void FastTrig::SetPath(Path path)
+{
+    currentPath = (int)path <= (int)GetBestPath() ? path : GetBestPath();
+}
+
+const char* FastTrig::GetPathName(Path path)
+{
+    return path == Path::Avx2 ? "avx2" : "scalar";
+}
+
+const char* FastTrig::GetAccuracyName(Accuracy accuracy)
+{
+    switch (accuracy)
+    {
+    case Accuracy::Low:
+        return "low";
+    case Accuracy::Medium:
+        return "medium";
+    default:
+        return "high";
+    }
+}
+
+float FastTrig::GetMaxError(Accuracy accuracy)
+{
+    return MAX_ERRORS[(int)accuracy];
+}
+
+void FastTrig::SinCos(float angle, float& sine, float& cosine, Accuracy accuracy)
+{
+    const FastTrigKernels::Polynomial& terms = polynomial(accuracy);
+    switch (accuracy)
+    {
+    case Accuracy::Low:
+        sinCos<2, 2>(angle, sine, cosine, terms);
+        return;
+    case Accuracy::Medium:
+        sinCos<3, 3>(angle, sine, cosine, terms);
+        return;
+    default:
+        sinCos<3, 4>(angle, sine, cosine, terms);
+    }
+}
+
+void FastTrig::SinCos(const float* angles, float* sines, float* cosines, size_t count, Accuracy accuracy)
+{
+    const FastTrigKernels::Polynomial& terms = polynomial(accuracy);
+    if (currentPath == Path::Avx2)
+    {
+        FastTrigKernels::SinCosAvx2(angles, sines, cosines, count, terms);
+        return;
+    }
+    switch (accuracy)
+    {
+    case Accuracy::Low:
+        sinCosArray<2, 2>(angles, sines, cosines, count, terms);
+        return;
+    case Accuracy::Medium:
+        sinCosArray<3, 3>(angles, sines, cosines, count, terms);
+        return;
+    default:
+        sinCosArray<3, 4>(angles, sines, cosines, count, terms);
+    }
+}
+
+void FastTrig::AxisAngles(const glm::vec3* axes, const float* angles, glm::quat* out, size_t count, Accuracy accuracy)
+{
+    const FastTrigKernels::Polynomial& terms = polynomial(accuracy);
+    if (currentPath == Path::Avx2)
+    {
+        // glm::quat keeps x, y, z, w in that order unless GLM_FORCE_QUAT_DATA_WXYZ is defined
+        FastTrigKernels::AxisAnglesAvx2(count ? &axes[0][0] : NULL, angles, count ? &out[0].x : NULL, count, terms);
+        return;
+    }
+    switch (accuracy)
+    {
+    case Accuracy::Low:
+        axisAnglesArray<2, 2>(axes, angles, out, count, terms);
+        return;
+    case Accuracy::Medium:
+        axisAnglesArray<3, 3>(axes, angles, out, count, terms);
+        return;
+    default:
+        axisAnglesArray<3, 4>(axes, angles, out, count, terms);
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+
+// Polynomial sines and cosines for animation, where std::sin and std::cos per object and frame add up: angles are
+// reduced to [-pi/4, pi/4] around a multiple of pi/2 and fed to minimax polynomials of one of three sizes. the
+// arrays go through an 8 wide AVX2 loop when the CPU has it, like MatrixBatch. the largest absolute errors against
+// sin and cos in double, for |angle| up to MAX_ANGLE, on the AVX2 path (fused multiply-adds) and the scalar one:
+//   Low     1.5e-5, 1.5e-5 (sin degree 5, cos degree 4)
+//   Medium  1.1e-7, 1.2e-7 (sin degree 7, cos degree 6)
+//   High    6.9e-8, 8.5e-8 (sin degree 7, cos degree 8), as close as the float rounding of the reduction allows
+// GetMaxError() has them rounded up.
+namespace FastTrig
+{
+    enum class Accuracy
+    {
+        Low,
+        Medium,
+        High
+    };
+
+    enum class Path
+    {
+        Scalar,
+        Avx2
+    };
+
+    // the errors above are measured up to here, hours of animation at a few turns per second
+    const float MAX_ANGLE = 65536.0f;
+
+    // the best path the CPU has
+    Path GetBestPath();
+    Path GetPath();
+    // a path the CPU lacks falls back to GetBestPath(). not to be changed while another thread uses the functions
+    void SetPath(Path path);
+    const char* GetPathName(Path path);
+    const char* GetAccuracyName(Accuracy accuracy);
+    // the bound documented above, for both paths
+    float GetMaxError(Accuracy accuracy);
+
+    // one angle, always scalar, e.g. the camera's yaw and pitch
+    void SinCos(float angle, float& sine, float& cosine, Accuracy accuracy = Accuracy::High);
+    // sines[i] and cosines[i] of angles[i], either output may be NULL
+    void SinCos(const float* angles, float* sines, float* cosines, size_t count, Accuracy accuracy = Accuracy::High);
+    // out[i] = glm::angleAxis(angles[i], axes[i]) for unit axes, which are not normalized again. the components are
+    // off by at most GetMaxError() of the half angle
+    void AxisAngles(const glm::vec3* axes, const float* angles, glm::quat* out, size_t count, Accuracy accuracy = Accuracy::High);
+}
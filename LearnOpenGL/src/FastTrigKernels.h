@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+// The polynomials behind FastTrig and its AVX2 loops, which live in their own file compiled for AVX2 and are only
+// called when CpuFeatures says so. no glm here for the same reason as in TransformKernels.h
+namespace FastTrigKernels
+{
+    // angle = j * pi / 2 + r with |r| <= pi / 4, pi / 2 split in three so j * PIO2_1 is exact for |j| < 2^16
+    const float TWO_OVER_PI = 0.636619772367581343f;
+    const float PIO2_1 = 1.5703125f;
+    const float PIO2_2 = 4.837512969970703125e-4f;
+    const float PIO2_3 = 7.54978995489188216e-8f;
+
+    // minimax on [0, pi / 4]: sin r = r + r^3 * (Sin[0] + Sin[1] r^2 + ...) and cos r = 1 + r^2 * (Cos[0] + Cos[1] r^2 + ...),
+    // SinTerms and CosTerms of them, one per FastTrig::Accuracy
+    struct Polynomial
+    {
+        int SinTerms;
+        int CosTerms;
+        float Sin[4];
+        float Cos[4];
+    };
+
+    const Polynomial POLYNOMIALS[3] =
+    {
+        { 2, 2, { -0.166647993f, 0.00818171306f }, { -0.499776307f, 0.0404889358f } },
+        { 3, 3, { -0.166666507f, 0.00833197866f, -0.000194956362f }, { -0.499998948f, 0.0416562946f, -0.00135978231f } },
+        { 3, 4, { -0.166666507f, 0.00833197866f, -0.000194956362f }, { -0.499999997f, 0.0416666233f, -0.00138867638f, 2.43904507e-05f } },
+    };
+
+    // sines[i] and cosines[i] of angles[i], either output may be NULL
+    void SinCosAvx2(const float* angles, float* sines, float* cosines, size_t count, const Polynomial& polynomial);
+    // quats[i] = (axes[i] * sin(angles[i] / 2), cos(angles[i] / 2)), 3 floats per axis and x, y, z, w per quaternion
+    void AxisAnglesAvx2(const float* axes, const float* angles, float* quats, size_t count, const Polynomial& polynomial);
+}
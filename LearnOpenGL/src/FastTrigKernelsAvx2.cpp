@@ -0,0 +1,132 @@
+// compiled with /arch:AVX2 (see the project file), only reached when CpuFeatures reports AVX2 and FMA
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2,fma")
+#endif
+
+#include "FastTrigKernels.h"
+#include <immintrin.h>
+
+namespace
+{
+    template<int Terms>
+    inline __m256 horner(__m256 z, const float* coefficients)
+    {
+        __m256 result = _mm256_set1_ps(coefficients[Terms - 1]);
+        for (int i = Terms - 2; i >= 0; i--)
+            result = _mm256_fmadd_ps(result, z, _mm256_set1_ps(coefficients[i]));
+        return result;
+    }
+
+    // the sines and cosines of 8 angles, the same steps as the scalar version in FastTrig.cpp
+    template<int SinTerms, int CosTerms>
+    inline void sinCos8(__m256 angles, const FastTrigKernels::Polynomial& polynomial, __m256& sines, __m256& cosines)
+    {
+        __m256 j = _mm256_round_ps(_mm256_mul_ps(angles, _mm256_set1_ps(FastTrigKernels::TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256 r = _mm256_fnmadd_ps(j, _mm256_set1_ps(FastTrigKernels::PIO2_1), angles);
+        r = _mm256_fnmadd_ps(j, _mm256_set1_ps(FastTrigKernels::PIO2_2), r);
+        r = _mm256_fnmadd_ps(j, _mm256_set1_ps(FastTrigKernels::PIO2_3), r);
+
+        __m256 z = _mm256_mul_ps(r, r);
+        __m256 sine = _mm256_fmadd_ps(_mm256_mul_ps(z, r), horner<SinTerms>(z, polynomial.Sin), r);
+        __m256 cosine = _mm256_fmadd_ps(z, horner<CosTerms>(z, polynomial.Cos), _mm256_set1_ps(1.0f));
+
+        // odd quadrants swap sine and cosine, the sign of the sine flips in quadrants 2 and 3 and of the cosine in 1 and 2
+        __m256i quadrant = _mm256_cvtps_epi32(j);
+        __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+        __m256 sineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+        __m256 cosineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)),
+            _mm256_set1_epi32(2)), 30));
+        sines = _mm256_xor_ps(_mm256_blendv_ps(sine, cosine, swap), sineSign);
+        cosines = _mm256_xor_ps(_mm256_blendv_ps(cosine, sine, swap), cosineSign);
+    }
+
+    template<int SinTerms, int CosTerms>
+    void sinCos(const float* angles, float* sines, float* cosines, size_t count, const FastTrigKernels::Polynomial& polynomial)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 sine, cosine;
+            sinCos8<SinTerms, CosTerms>(_mm256_loadu_ps(angles + i), polynomial, sine, cosine);
+            if (sines)
+                _mm256_storeu_ps(sines + i, sine);
+            if (cosines)
+                _mm256_storeu_ps(cosines + i, cosine);
+        }
+        // the tail through masked loads and stores
+        if (i < count)
+        {
+            __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(count - i)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            __m256 sine, cosine;
+            sinCos8<SinTerms, CosTerms>(_mm256_maskload_ps(angles + i, mask), polynomial, sine, cosine);
+            if (sines)
+                _mm256_maskstore_ps(sines + i, mask, sine);
+            if (cosines)
+                _mm256_maskstore_ps(cosines + i, mask, cosine);
+        }
+    }
+
+    template<int SinTerms, int CosTerms>
+    void axisAngles(const float* axes, const float* angles, float* quats, size_t count, const FastTrigKernels::Polynomial& polynomial)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8, axes += 24, quats += 32)
+        {
+            __m256 sine, cosine;
+            sinCos8<SinTerms, CosTerms>(_mm256_mul_ps(_mm256_loadu_ps(angles + i), _mm256_set1_ps(0.5f)), polynomial, sine, cosine);
+
+            // x, y and z of 8 axes into their own registers, like TransformPointsAvx2
+            __m256 axes03 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(axes)), _mm_loadu_ps(axes + 12), 1);
+            __m256 axes14 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(axes + 4)), _mm_loadu_ps(axes + 16), 1);
+            __m256 axes25 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(axes + 8)), _mm_loadu_ps(axes + 20), 1);
+            __m256 xy = _mm256_shuffle_ps(axes14, axes25, _MM_SHUFFLE(2, 1, 3, 2));
+            __m256 yz = _mm256_shuffle_ps(axes03, axes14, _MM_SHUFFLE(1, 0, 2, 1));
+            __m256 x = _mm256_mul_ps(_mm256_shuffle_ps(axes03, xy, _MM_SHUFFLE(2, 0, 3, 0)), sine);
+            __m256 y = _mm256_mul_ps(_mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0)), sine);
+            __m256 z = _mm256_mul_ps(_mm256_shuffle_ps(yz, axes25, _MM_SHUFFLE(3, 0, 3, 1)), sine);
+
+            // transposed into x, y, z, w per quaternion, each register first holds quaternions i and i + 4
+            __m256 xy0145 = _mm256_unpacklo_ps(x, y), xy2367 = _mm256_unpackhi_ps(x, y);
+            __m256 zw0145 = _mm256_unpacklo_ps(z, cosine), zw2367 = _mm256_unpackhi_ps(z, cosine);
+            __m256 quats04 = _mm256_shuffle_ps(xy0145, zw0145, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 quats15 = _mm256_shuffle_ps(xy0145, zw0145, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 quats26 = _mm256_shuffle_ps(xy2367, zw2367, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 quats37 = _mm256_shuffle_ps(xy2367, zw2367, _MM_SHUFFLE(3, 2, 3, 2));
+            _mm256_storeu_ps(quats, _mm256_permute2f128_ps(quats04, quats15, 0x20));
+            _mm256_storeu_ps(quats + 8, _mm256_permute2f128_ps(quats26, quats37, 0x20));
+            _mm256_storeu_ps(quats + 16, _mm256_permute2f128_ps(quats04, quats15, 0x31));
+            _mm256_storeu_ps(quats + 24, _mm256_permute2f128_ps(quats26, quats37, 0x31));
+        }
+        // the rest one at a time through the 8 wide code
+        for (; i < count; i++, axes += 3, quats += 4)
+        {
+            __m256 sine, cosine;
+            sinCos8<SinTerms, CosTerms>(_mm256_set1_ps(angles[i] * 0.5f), polynomial, sine, cosine);
+            float s = _mm256_cvtss_f32(sine);
+            quats[0] = axes[0] * s;
+            quats[1] = axes[1] * s;
+            quats[2] = axes[2] * s;
+            quats[3] = _mm256_cvtss_f32(cosine);
+        }
+    }
+}
+
+void FastTrigKernels::SinCosAvx2(const float* angles, float* sines, float* cosines, size_t count, const Polynomial& polynomial)
+{
+    if (polynomial.SinTerms == 2 && polynomial.CosTerms == 2)
+        sinCos<2, 2>(angles, sines, cosines, count, polynomial);
+    else if (polynomial.CosTerms == 3)
+        sinCos<3, 3>(angles, sines, cosines, count, polynomial);
+    else
+        sinCos<3, 4>(angles, sines, cosines, count, polynomial);
+}
+
+void FastTrigKernels::AxisAnglesAvx2(const float* axes, const float* angles, float* quats, size_t count, const Polynomial& polynomial)
+{
+    if (polynomial.SinTerms == 2 && polynomial.CosTerms == 2)
+        axisAngles<2, 2>(axes, angles, quats, count, polynomial);
+    else if (polynomial.CosTerms == 3)
+        axisAngles<3, 3>(axes, angles, quats, count, polynomial);
+    else
+        axisAngles<3, 4>(axes, angles, quats, count, polynomial);
+}
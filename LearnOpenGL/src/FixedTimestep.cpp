@@ -0,0 +1,32 @@
+#include "FixedTimestep.h"
+
+#include <cmath>
+
+FixedTimestep::FixedTimestep(double stepsPerSecond, unsigned int maxSteps) : stepSeconds(1.0 / stepsPerSecond), maxSteps(maxSteps)
+{
+}
+
+unsigned int FixedTimestep::Advance(double frameSeconds)
+{
+    if (frameSeconds > 0.0)
+        accumulator += frameSeconds;
+    unsigned int count = (unsigned int)std::floor(accumulator / stepSeconds);
+    if (count > maxSteps)
+    {
+        droppedSteps += count - maxSteps;
+        count = maxSteps;
+        // keep the fraction so the blend doesn't jump, drop the whole steps beyond the cap
+        accumulator = std::fmod(accumulator, stepSeconds) + count * stepSeconds;
+    }
+    accumulator -= count * stepSeconds;
+    time += count * stepSeconds;
+    steps += count;
+    return count;
+}
+
+void FixedTimestep::SetStepsPerSecond(double stepsPerSecond)
+{
+    // the leftover time stays the same, as a fraction of the new step it may be a whole step, which the next
+    // Advance() takes
+    stepSeconds = 1.0 / stepsPerSecond;
+}
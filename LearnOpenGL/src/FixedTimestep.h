@@ -0,0 +1,35 @@
+#pragma once
+
+// Runs the simulation in steps of a fixed length, however long the frames are: each frame's time goes into an
+// accumulator and every whole step in it is taken out and simulated. what is left over, a fraction of a step, is
+// GetAlpha(), the weight to blend the last two simulated states with for display, which lags the simulation by at
+// most one step but moves smoothly at any frame rate.
+class FixedTimestep
+{
+public:
+    // maxSteps caps the steps of one frame: after a stall the simulation slows down rather than taking ever longer
+    // frames to catch up
+    explicit FixedTimestep(double stepsPerSecond = 60.0, unsigned int maxSteps = 8);
+
+    // adds a frame of frameSeconds and returns the steps to simulate now, each GetStepSeconds() long
+    unsigned int Advance(double frameSeconds);
+
+    void SetStepsPerSecond(double stepsPerSecond);
+    double GetStepsPerSecond() const { return 1.0 / stepSeconds; }
+    double GetStepSeconds() const { return stepSeconds; }
+    // the simulated time after the steps Advance() returned
+    double GetTime() const { return time; }
+    // how far the display is from the second to last towards the last simulated state, in [0, 1)
+    float GetAlpha() const { return (float)(accumulator / stepSeconds); }
+    // steps simulated and steps dropped by maxSteps so far
+    unsigned long long GetSteps() const { return steps; }
+    unsigned long long GetDroppedSteps() const { return droppedSteps; }
+
+private:
+    double stepSeconds;
+    unsigned int maxSteps;
+    double accumulator = 0.0;
+    double time = 0.0;
+    unsigned long long steps = 0;
+    unsigned long long droppedSteps = 0;
+};
@@ -0,0 +1,161 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#else
+#include <time.h>
+#endif
+
+namespace
+{
+    // where the spin margin starts and the range it is kept in, in seconds
+    const double INITIAL_SPIN_MARGIN = 0.002;
+    const double MIN_SPIN_MARGIN = 0.0002;
+    // share of the frame time the margin may grow to, so the pacer still sleeps most of a frame on a bad scheduler
+    const double MAX_SPIN_SHARE = 0.5;
+    // the margin is the latest wake-up times this, and shrinks by MARGIN_DECAY per frame while wake-ups are prompt
+    const double LATENESS_FACTOR = 1.25;
+    const double MARGIN_DECAY = 0.995;
+
+    double seconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double>(duration).count();
+    }
+
+    std::chrono::steady_clock::duration duration(double seconds)
+    {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    }
+}
+
+FramePacer::FramePacer(double framesPerSecond, Method method) : frameSeconds(1.0 / framesPerSecond), method(method),
+    spinMargin(INITIAL_SPIN_MARGIN)
+{
+#ifdef _WIN32
+    // sleeps end on the scheduler's tick, 15.6 ms unless asked for 1 ms
+    timeBeginPeriod(1);
+#endif
+    frameStart = Clock::now();
+    reportStart = frameStart;
+    reportCpuStart = GetProcessCpuSeconds();
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::Wait()
+{
+    Clock::time_point deadline = frameStart + duration(frameSeconds);
+    if (method == Method::Sleep)
+    {
+        Clock::time_point now = Clock::now();
+        if (now < deadline)
+            std::this_thread::sleep_for(deadline - now);
+    }
+    else if (method == Method::SleepAndSpin)
+    {
+        Clock::time_point wakeUp = deadline - duration(spinMargin);
+        Clock::time_point now = Clock::now();
+        if (now < wakeUp)
+        {
+            std::this_thread::sleep_for(wakeUp - now);
+            double lateness = seconds(Clock::now() - wakeUp);
+            spinMargin = std::max(spinMargin * MARGIN_DECAY, lateness * LATENESS_FACTOR);
+            spinMargin = std::min(std::max(spinMargin, MIN_SPIN_MARGIN), frameSeconds * MAX_SPIN_SHARE);
+        }
+        while (Clock::now() < deadline)
+            std::this_thread::yield();
+    }
+
+    Clock::time_point now = Clock::now();
+    double elapsed = seconds(now - frameStart);
+    frames++;
+    sum += elapsed;
+    sumOfSquares += elapsed * elapsed;
+    longest = std::max(longest, elapsed);
+
+    // the next frame starts at the deadline rather than now so small overshoots don't add up, unless this one ran
+    // over by so much that the following ones would be rushed to catch up
+    if (method != Method::None && now < deadline + duration(frameSeconds))
+        frameStart = deadline;
+    else
+        frameStart = now;
+}
+
+void FramePacer::SetFramesPerSecond(double framesPerSecond)
+{
+    frameSeconds = 1.0 / framesPerSecond;
+    spinMargin = std::min(spinMargin, frameSeconds * MAX_SPIN_SHARE);
+}
+
+const char* FramePacer::GetMethodName(Method method)
+{
+    switch (method)
+    {
+    case Method::None:
+        return "unpaced";
+    case Method::Sleep:
+        return "sleep";
+    default:
+        return "sleep and spin";
+    }
+}
+
+FramePacer::Report FramePacer::TakeReport()
+{
+    Report report;
+    Clock::time_point now = Clock::now();
+    double cpu = GetProcessCpuSeconds();
+    report.Frames = frames;
+    if (frames > 0)
+    {
+        double mean = sum / frames;
+        report.MeanMilliseconds = mean * 1000.0;
+        report.StandardDeviationMilliseconds = std::sqrt(std::max(sumOfSquares / frames - mean * mean, 0.0)) * 1000.0;
+        report.MaxMilliseconds = longest * 1000.0;
+    }
+    double wall = seconds(now - reportStart);
+    report.CpuUsage = wall > 0.0 ? (cpu - reportCpuStart) / wall : 0.0;
+    report.SpinMarginMilliseconds = method == Method::SleepAndSpin ? spinMargin * 1000.0 : 0.0;
+
+    frames = 0;
+    sum = 0.0;
+    sumOfSquares = 0.0;
+    longest = 0.0;
+    reportStart = now;
+    reportCpuStart = cpu;
+    return report;
+}
+
+double FramePacer::GetProcessCpuSeconds()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0.0;
+    // in 100 ns units
+    ULARGE_INTEGER kernelTime, userTime;
+    kernelTime.LowPart = kernel.dwLowDateTime;
+    kernelTime.HighPart = kernel.dwHighDateTime;
+    userTime.LowPart = user.dwLowDateTime;
+    userTime.HighPart = user.dwHighDateTime;
+    return (kernelTime.QuadPart + userTime.QuadPart) * 1e-7;
+#else
+    timespec time;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0)
+        return 0.0;
+    return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+}
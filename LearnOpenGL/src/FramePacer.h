@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+
+// Holds frames to a target frame time when vsync doesn't, without burning a core on it. Wait() at the end of a frame
+// sleeps through most of what is left of it and spins through the rest: the OS wakes sleepers late by a varying
+// amount, so the pacer learns how late and wakes up that much early. it also keeps frame time and CPU time
+// statistics for the reports.
+class FramePacer
+{
+public:
+    enum class Method
+    {
+        // no waiting, frames as fast as the GPU and vsync allow
+        None,
+        // sleeping the whole remaining time, cheapest but as precise as the OS scheduler
+        Sleep,
+        // sleeping and spinning the last bit
+        SleepAndSpin
+    };
+
+    // frame times, their spread and the share of one core the process used, since the last TakeReport()
+    struct Report
+    {
+        unsigned int Frames = 0;
+        double MeanMilliseconds = 0.0;
+        double StandardDeviationMilliseconds = 0.0;
+        double MaxMilliseconds = 0.0;
+        // process CPU time over wall time, above 1 when several threads are busy
+        double CpuUsage = 0.0;
+        // how early the sleeps end before the target at the moment
+        double SpinMarginMilliseconds = 0.0;
+    };
+
+    explicit FramePacer(double framesPerSecond = 60.0, Method method = Method::SleepAndSpin);
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // waits until the current frame has taken the target frame time, then starts timing the next one. a frame that
+    // ran over starts the next one right away instead of shortening it
+    void Wait();
+
+    void SetFramesPerSecond(double framesPerSecond);
+    double GetFramesPerSecond() const { return 1.0 / frameSeconds; }
+    void SetMethod(Method method) { this->method = method; }
+    Method GetMethod() const { return method; }
+    static const char* GetMethodName(Method method);
+
+    Report TakeReport();
+
+    // CPU time of the whole process so far, user and kernel
+    static double GetProcessCpuSeconds();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    double frameSeconds;
+    Method method;
+    Clock::time_point frameStart;
+    // how much earlier than the target sleeps end, grown to the latest wake-ups seen and slowly shrunk again
+    double spinMargin;
+
+    // for the report
+    unsigned int frames = 0;
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+    double longest = 0.0;
+    Clock::time_point reportStart;
+    double reportCpuStart;
+};
@@ -0,0 +1,61 @@
+#include "GLExtensions.h"
+#include <cstring>
+
+namespace GLExtensions
+{
+    bool KHR_parallel_shader_compile = false;
+    PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glMaxShaderCompilerThreadsKHR = NULL;
+    bool ARB_bindless_texture = false;
+    PFNGLGETTEXTUREHANDLEARBPROC glGetTextureHandleARB = NULL;
+    PFNGLMAKETEXTUREHANDLERESIDENTARBPROC glMakeTextureHandleResidentARB = NULL;
+    PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC glMakeTextureHandleNonResidentARB = NULL;
+    bool ARB_shader_storage_buffer_object = false;
+    bool ARB_multi_draw_indirect = false;
+    PFNGLMULTIDRAWARRAYSINDIRECTPROC glMultiDrawArraysIndirect = NULL;
+    PFNGLMULTIDRAWELEMENTSINDIRECTPROC glMultiDrawElementsIndirect = NULL;
+    bool ARB_compute_shader = false;
+    PFNGLDISPATCHCOMPUTEPROC glDispatchCompute = NULL;
+    PFNGLMEMORYBARRIERPROC glMemoryBarrier = NULL;
+
+    void Load(GLADloadproc load)
+    {
+        if (Has("GL_KHR_parallel_shader_compile"))
+        {
+            glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+            KHR_parallel_shader_compile = glMaxShaderCompilerThreadsKHR != NULL;
+        }
+        if (Has("GL_ARB_bindless_texture"))
+        {
+            glGetTextureHandleARB = (PFNGLGETTEXTUREHANDLEARBPROC)load("glGetTextureHandleARB");
+            glMakeTextureHandleResidentARB = (PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)load("glMakeTextureHandleResidentARB");
+            glMakeTextureHandleNonResidentARB = (PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)load("glMakeTextureHandleNonResidentARB");
+            ARB_bindless_texture = glGetTextureHandleARB && glMakeTextureHandleResidentARB && glMakeTextureHandleNonResidentARB;
+        }
+        ARB_shader_storage_buffer_object = Has("GL_ARB_shader_storage_buffer_object");
+        if (Has("GL_ARB_multi_draw_indirect") && Has("GL_ARB_base_instance"))
+        {
+            glMultiDrawArraysIndirect = (PFNGLMULTIDRAWARRAYSINDIRECTPROC)load("glMultiDrawArraysIndirect");
+            glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+            ARB_multi_draw_indirect = glMultiDrawArraysIndirect && glMultiDrawElementsIndirect;
+        }
+        if (Has("GL_ARB_compute_shader") && Has("GL_ARB_shader_image_load_store"))
+        {
+            glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+            glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+            ARB_compute_shader = glDispatchCompute && glMemoryBarrier;
+        }
+    }
+
+    bool Has(const char* name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (extension && strcmp(extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// glad is generated for core 3.3 without extensions, entry points of the optional extensions we use are loaded here.
+// every flag is false and every pointer NULL until Load() found the extension on the current context.
+namespace GLExtensions
+{
+    // GL_KHR_parallel_shader_compile
+    const GLenum COMPLETION_STATUS_KHR = 0x91B1;
+    typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+    extern bool KHR_parallel_shader_compile;
+    extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glMaxShaderCompilerThreadsKHR;
+
+    // GL_ARB_bindless_texture
+    typedef GLuint64 (APIENTRYP PFNGLGETTEXTUREHANDLEARBPROC)(GLuint texture);
+    typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)(GLuint64 handle);
+    typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)(GLuint64 handle);
+    extern bool ARB_bindless_texture;
+    extern PFNGLGETTEXTUREHANDLEARBPROC glGetTextureHandleARB;
+    extern PFNGLMAKETEXTUREHANDLERESIDENTARBPROC glMakeTextureHandleResidentARB;
+    extern PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC glMakeTextureHandleNonResidentARB;
+
+    // GL_ARB_shader_storage_buffer_object, the buffer is bound with the core glBindBufferBase
+    const GLenum SHADER_STORAGE_BUFFER = 0x90D2;
+    extern bool ARB_shader_storage_buffer_object;
+
+    // GL_ARB_multi_draw_indirect (with GL_ARB_draw_indirect and the baseInstance of GL_ARB_base_instance)
+    const GLenum DRAW_INDIRECT_BUFFER = 0x8F3F;
+    typedef void (APIENTRYP PFNGLMULTIDRAWARRAYSINDIRECTPROC)(GLenum mode, const void* indirect, GLsizei drawcount, GLsizei stride);
+    typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+    extern bool ARB_multi_draw_indirect;
+    extern PFNGLMULTIDRAWARRAYSINDIRECTPROC glMultiDrawArraysIndirect;
+    extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC glMultiDrawElementsIndirect;
+
+    // GL_ARB_compute_shader, plus glMemoryBarrier of GL_ARB_shader_image_load_store to make its writes visible
+    const GLenum COMPUTE_SHADER = 0x91B9;
+    const GLbitfield COMMAND_BARRIER_BIT = 0x00000040;
+    const GLbitfield BUFFER_UPDATE_BARRIER_BIT = 0x00000200;
+    const GLbitfield SHADER_STORAGE_BARRIER_BIT = 0x00002000;
+    typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+    typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+    extern bool ARB_compute_shader;
+    extern PFNGLDISPATCHCOMPUTEPROC glDispatchCompute;
+    extern PFNGLMEMORYBARRIERPROC glMemoryBarrier;
+
+    // queries the extension string and loads the entry points, call once after gladLoadGLLoader with the same loader
+    void Load(GLADloadproc load);
+    // true when the current context advertises the extension
+    bool Has(const char* name);
+}
@@ -0,0 +1,464 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "GlmSimd.h"
+#include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../AlignedMath.h"
+#include "../Camera.h"
+#include "../RenderStats.h"
+#include "../VertexFormat.h"
+
+namespace GlmSimd
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // inputs per test and per benchmark batch, the batch stays in the caches; every operation runs BENCHMARK_TOTAL times
+    // in BENCHMARK_ROUNDS rounds, the fastest round counts
+    const unsigned int TEST_COUNT = 100003;
+    const unsigned int BENCHMARK_COUNT = 4096;
+    const unsigned int BENCHMARK_TOTAL = 10000000;
+    const unsigned int BENCHMARK_ROUNDS = 5;
+    // largest difference between the aligned and the packed results allowed, relative to the largest element of the
+    // matrix; the translation of a view matrix is a dot product with the eye that can cancel down to almost nothing
+    const double TOLERANCE = 1e-5;
+
+    // the scene, spinning boxes whose matrices are built every frame with the packed or the aligned types
+    const int BOXES_X = 40;
+    const int BOXES_Z = 40;
+    const float BOX_SPACING = 3.0f;
+
+    // switched with the 1/2 keys
+    bool useAligned = true;
+
+    // camera
+    Camera camera(glm::vec3(0.0f, 15.0f, BOXES_Z * BOX_SPACING * 0.5f + 20.0f));
+
+    bool firstMouse = true;
+    float mouseLastX = SCR_WIDTH / 2.0;
+    float mouseLastY = SCR_HEIGHT / 2.0;
+
+    // timing
+    float deltaTime = 0.0f;	// Time between current frame and last frame
+    float lastFrame = 0.0f;
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // the inputs of every operation, as one qualifier. glm picks its SIMD code by the qualifier of the types, so the
+    // same functions instantiated with glm::packed_highp and ALIGNED_QUALIFIER are the scalar and the SIMD build
+    // side by side in one program
+    template<glm::qualifier Q>
+    struct Inputs
+    {
+        std::vector<glm::vec<3, float, Q>> Eyes, Targets, Axes;
+        std::vector<glm::mat<4, 4, float, Q>> Matrices;
+        std::vector<float> Angles, Fovs;
+
+        template<glm::qualifier P>
+        void CopyFrom(const Inputs<P>& other)
+        {
+            Eyes.assign(other.Eyes.begin(), other.Eyes.end());
+            Targets.assign(other.Targets.begin(), other.Targets.end());
+            Axes.assign(other.Axes.begin(), other.Axes.end());
+            Matrices.assign(other.Matrices.begin(), other.Matrices.end());
+            Angles = other.Angles;
+            Fovs = other.Fovs;
+        }
+    };
+
+    Inputs<glm::packed_highp> randomInputs(std::mt19937& random, unsigned int count)
+    {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        Inputs<glm::packed_highp> inputs;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            inputs.Eyes.push_back(glm::vec3(unit(random), unit(random), unit(random)) * 10.0f);
+            inputs.Targets.push_back(inputs.Eyes.back() + glm::vec3(unit(random), unit(random) * 0.5f, unit(random) + 1.5f));
+            inputs.Axes.push_back(glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 0.01f)));
+            glm::mat4 matrix;
+            for (int column = 0; column < 4; column++)
+                for (int row = 0; row < 4; row++)
+                    matrix[column][row] = unit(random) * 10.0f;
+            inputs.Matrices.push_back(matrix);
+            inputs.Angles.push_back(glm::pi<float>() * unit(random));
+            inputs.Fovs.push_back(glm::radians(50.0f + 20.0f * unit(random)));
+        }
+        return inputs;
+    }
+
+    // the operations, each over a batch, results in out
+
+    template<glm::qualifier Q>
+    void lookAts(const Inputs<Q>& inputs, size_t count, glm::mat<4, 4, float, Q>* out)
+    {
+        const glm::vec<3, float, Q> up(0.0f, 1.0f, 0.0f);
+        for (size_t i = 0; i < count; i++)
+            out[i] = glm::lookAt(inputs.Eyes[i], inputs.Targets[i], up);
+    }
+
+    // glm::perspective always returns defaultp, it only changes with GLM_FORCE_DEFAULT_ALIGNED_GENTYPES; it writes
+    // single elements and has nothing to vectorize anyway
+    template<glm::qualifier Q>
+    void perspectives(const Inputs<Q>& inputs, size_t count, glm::mat<4, 4, float, Q>* out)
+    {
+        for (size_t i = 0; i < count; i++)
+            out[i] = glm::mat<4, 4, float, Q>(glm::perspective(inputs.Fovs[i], 1.5f, 0.1f, 1000.0f));
+    }
+
+    template<glm::qualifier Q>
+    void rotates(const Inputs<Q>& inputs, size_t count, glm::mat<4, 4, float, Q>* out)
+    {
+        for (size_t i = 0; i < count; i++)
+            out[i] = glm::rotate(inputs.Matrices[i], inputs.Angles[i], inputs.Axes[i]);
+    }
+
+    template<glm::qualifier Q>
+    void multiplies(const Inputs<Q>& inputs, size_t count, glm::mat<4, 4, float, Q>* out)
+    {
+        const glm::mat<4, 4, float, Q> left = inputs.Matrices[count - 1];
+        for (size_t i = 0; i < count; i++)
+            out[i] = left * inputs.Matrices[i];
+    }
+
+    const char* const OPERATION_NAMES[] = { "lookAt", "perspective", "rotate", "multiply" };
+
+    template<glm::qualifier Q>
+    void runOperation(int operation, const Inputs<Q>& inputs, size_t count, glm::mat<4, 4, float, Q>* out)
+    {
+        switch (operation)
+        {
+        case 0:
+            lookAts(inputs, count, out);
+            break;
+        case 1:
+            perspectives(inputs, count, out);
+            break;
+        case 2:
+            rotates(inputs, count, out);
+            break;
+        default:
+            multiplies(inputs, count, out);
+        }
+    }
+
+    // |a - b| over the largest element of b, the worst element
+    double matrixError(const AlignedMat4& a, const glm::mat4& b)
+    {
+        double largest = 0.0, worst = 0.0;
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+            {
+                largest = std::max(largest, (double)std::fabs(b[column][row]));
+                worst = std::max(worst, (double)std::fabs(a[column][row] - b[column][row]));
+            }
+        return worst / std::max(largest, 1e-30);
+    }
+
+    // every operation with the aligned types against the packed ones. returns whether all passed
+    bool runAccuracyTests()
+    {
+        std::mt19937 random(1);
+        Inputs<glm::packed_highp> packedInputs = randomInputs(random, TEST_COUNT);
+        Inputs<ALIGNED_QUALIFIER> alignedInputs;
+        alignedInputs.CopyFrom(packedInputs);
+        std::vector<glm::mat4> packed(TEST_COUNT);
+        std::vector<AlignedMat4> aligned(TEST_COUNT);
+
+        bool allPassed = true;
+        printf("%s, aligned types against packed ones, %u inputs\n", GetGlmSimdName(), TEST_COUNT);
+        for (int operation = 0; operation < 4; operation++)
+        {
+            runOperation(operation, packedInputs, TEST_COUNT, packed.data());
+            runOperation(operation, alignedInputs, TEST_COUNT, aligned.data());
+            double worst = 0.0;
+            for (unsigned int i = 0; i < TEST_COUNT; i++)
+                worst = std::max(worst, matrixError(aligned[i], packed[i]));
+            bool passed = worst <= TOLERANCE;
+            allPassed &= passed;
+            printf("  %-11s %.1e, %s\n", OPERATION_NAMES[operation], worst, passed ? "passed" : "FAILED");
+        }
+        return allPassed;
+    }
+
+    template<glm::qualifier Q>
+    double benchmarkOperation(int operation, const Inputs<Q>& inputs, std::vector<glm::mat<4, 4, float, Q>>& out)
+    {
+        unsigned int repeats = BENCHMARK_TOTAL / BENCHMARK_ROUNDS / BENCHMARK_COUNT;
+        double fastest = 1e30;
+        for (unsigned int round = 0; round < BENCHMARK_ROUNDS; round++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (unsigned int repeat = 0; repeat < repeats; repeat++)
+                runOperation(operation, inputs, BENCHMARK_COUNT, out.data());
+            fastest = std::min(fastest, secondsSince(start));
+        }
+        return fastest * 1e9 / ((double)repeats * BENCHMARK_COUNT);
+    }
+
+    void runBenchmark()
+    {
+        std::mt19937 random(2);
+        Inputs<glm::packed_highp> packedInputs = randomInputs(random, BENCHMARK_COUNT);
+        Inputs<ALIGNED_QUALIFIER> alignedInputs;
+        alignedInputs.CopyFrom(packedInputs);
+        std::vector<glm::mat4> packed(BENCHMARK_COUNT);
+        std::vector<AlignedMat4> aligned(BENCHMARK_COUNT);
+
+        // in the scalar configurations both columns run the same code, compare them with the SIMD configurations
+        printf("%s, nanoseconds per matrix in batches of %u\n", GetGlmSimdName(), BENCHMARK_COUNT);
+        float checksum = 0.0f;
+        for (int operation = 0; operation < 4; operation++)
+        {
+            double packedNanoseconds = benchmarkOperation(operation, packedInputs, packed);
+            double alignedNanoseconds = benchmarkOperation(operation, alignedInputs, aligned);
+            checksum += packed[BENCHMARK_COUNT / 2][3][3] + aligned[BENCHMARK_COUNT / 2][3][3];
+            printf("  %-11s packed %6.2f, aligned %6.2f, %.2fx\n", OPERATION_NAMES[operation], packedNanoseconds, alignedNanoseconds,
+                packedNanoseconds / alignedNanoseconds);
+        }
+        // keeps the results alive
+        printf("  (checksum %g)\n", checksum);
+    }
+
+    // model and model-view-projection matrix of every box
+    template<glm::qualifier Q>
+    void buildMatrices(float time, const glm::mat4& viewProjection, std::vector<glm::mat<4, 4, float, Q>>& models,
+        std::vector<glm::mat<4, 4, float, Q>>& mvps)
+    {
+        typedef glm::mat<4, 4, float, Q> Mat4;
+        typedef glm::vec<3, float, Q> Vec3;
+        const Mat4 leftSide = Mat4(viewProjection);
+        const Vec3 axis = glm::normalize(Vec3(0.3f, 1.0f, 0.2f));
+        for (int x = 0; x < BOXES_X; x++)
+            for (int z = 0; z < BOXES_Z; z++)
+            {
+                size_t i = x * BOXES_Z + z;
+                float phase = time + 0.3f * x + 0.2f * z;
+                Mat4 model = glm::translate(Mat4(1.0f), Vec3(x - (BOXES_X - 1) * 0.5f, 0.5f * glm::sin(phase), z - (BOXES_Z - 1) * 0.5f) * BOX_SPACING);
+                models[i] = glm::rotate(model, phase * 0.5f, axis);
+                mvps[i] = leftSide * models[i];
+            }
+    }
+
+    int Main()
+    {
+        runAccuracyTests();
+        runBenchmark();
+
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwSetCursorPosCallback(window, mouse_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        // the model-view-projection matrices come from buildMatrices(), model is still needed for the normals
+        Shader shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs", { "PRECOMPUTED_MVP" });
+
+        // a unit cube with face normals
+        std::vector<float> vertices;
+        for (int face = 0; face < 6; face++)
+        {
+            int axis = face / 2;
+            float sign = (face % 2) ? -1.0f : 1.0f;
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = sign;
+            u[(axis + 1) % 3] = sign;
+            v[(axis + 2) % 3] = 1.0f;
+            const float corners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+            for (const float* corner : corners)
+            {
+                glm::vec3 position = normal * 0.5f + u * (corner[0] - 0.5f) + v * (corner[1] - 0.5f);
+                vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z, corner[0], corner[1] });
+            }
+        }
+        VertexFormat format;
+        format.Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+        unsigned int VAO, VBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        format.Apply();
+
+        unsigned int whiteTexture;
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        shader.use();
+        shader.setInt("baseColor", 0);
+        shader.setVec4("baseColorFactor", glm::vec4(0.5f, 0.75f, 0.9f, 1.0f));
+        shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+
+        const size_t boxCount = BOXES_X * BOXES_Z;
+        std::vector<glm::mat4> packedModels(boxCount), packedMvps(boxCount);
+        std::vector<AlignedMat4> alignedModels(boxCount), alignedMvps(boxCount);
+
+        // render loop
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        double reportSeconds = 0.0;
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            float currentFrame = static_cast<float>(glfwGetTime());
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            processInput(window);
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)width / (float)std::max(height, 1), 0.1f, 300.0f);
+            glm::mat4 viewProjection = projection * camera.GetViewMatrix();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if (useAligned)
+                buildMatrices(currentFrame, viewProjection, alignedModels, alignedMvps);
+            else
+                buildMatrices(currentFrame, viewProjection, packedModels, packedMvps);
+            reportSeconds += secondsSince(start);
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            glBindVertexArray(VAO);
+            for (size_t i = 0; i < boxCount; i++)
+            {
+                shader.setMat4("model", useAligned ? glm::mat4(alignedModels[i]) : packedModels[i]);
+                shader.setMat4("modelViewProjection", useAligned ? glm::mat4(alignedMvps[i]) : packedMvps[i]);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += 12;
+            }
+
+            RenderStats::EndFrame();
+            reportFrames++;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                printf("%s, %s types, %zu model and model-view-projection matrices in %.4f ms\n", GetGlmSimdName(), useAligned ? "aligned" : "packed",
+                    boxCount, reportSeconds * 1000.0 / reportFrames);
+                reportStart = now;
+                reportFrames = 0;
+                reportSeconds = 0.0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures(1, &whiteTexture);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        // 1 builds the matrices with the packed types, 2 with the aligned ones
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            useAligned = false;
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+            useAligned = true;
+
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            camera.ProcessKeyboard(FORWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            camera.ProcessKeyboard(BACKWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            camera.ProcessKeyboard(LEFT, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            camera.ProcessKeyboard(RIGHT, deltaTime);
+    }
+
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+    {
+        if (firstMouse)
+        {
+            mouseLastX = xpos;
+            mouseLastY = ypos;
+            firstMouse = false;
+        }
+
+        float xoffset = xpos - mouseLastX;
+        float yoffset = mouseLastY - ypos; // reversed since y-coordinates range from bottom to top
+
+        mouseLastX = xpos;
+        mouseLastY = ypos;
+
+        camera.ProcessMouseMovement(xoffset, yoffset);
+    }
+}
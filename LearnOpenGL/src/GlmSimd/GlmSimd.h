@@ -0,0 +1,4 @@
+namespace GlmSimd
+{
+    int Main();
+};
\ No newline at end of file
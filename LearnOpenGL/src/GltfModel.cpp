@@ -0,0 +1,801 @@
+#include "GltfModel.h"
+#include <stb_image.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include "Json.h"
+#include "MappedFile.h"
+#include "Shader.h"
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // glTF enums
+    const int BYTE = 5120;
+    const int UNSIGNED_BYTE = 5121;
+    const int SHORT = 5122;
+    const int UNSIGNED_SHORT = 5123;
+    const int UNSIGNED_INT = 5125;
+    const int FLOAT = 5126;
+    const int TRIANGLES = 4;
+
+    // GLB container
+    const unsigned int GLB_MAGIC = 0x46546C67;        // "glTF"
+    const unsigned int GLB_CHUNK_JSON = 0x4E4F534A;   // "JSON"
+    const unsigned int GLB_CHUNK_BIN = 0x004E4942;    // "BIN\0"
+
+    double secondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    struct Buffer
+    {
+        const unsigned char* Data = NULL;
+        size_t Size = 0;
+    };
+
+    struct BufferView
+    {
+        const unsigned char* Data = NULL;
+        size_t Size = 0;
+        size_t Stride = 0;
+    };
+
+    // an accessor resolved to memory, Data is NULL when it has no buffer view (all zeros)
+    struct Accessor
+    {
+        const unsigned char* Data = NULL;
+        size_t Count = 0;
+        size_t Stride = 0;
+        int ComponentType = 0;
+        int Components = 0;
+        bool Normalized = false;
+    };
+
+    // a range of one primitive decoded by one task
+    struct DecodeTask
+    {
+        GltfPrimitive* Primitive;
+        const Accessor* Position;
+        const Accessor* Normal;
+        const Accessor* TexCoord;
+        const Accessor* Indices;   // NULL for a primitive without indices
+        bool IndexTask;
+        size_t Begin;
+        size_t End;
+    };
+
+    int componentCount(const char* type)
+    {
+        if (strcmp(type, "SCALAR") == 0) return 1;
+        if (strcmp(type, "VEC2") == 0) return 2;
+        if (strcmp(type, "VEC3") == 0) return 3;
+        if (strcmp(type, "VEC4") == 0) return 4;
+        if (strcmp(type, "MAT2") == 0) return 4;
+        if (strcmp(type, "MAT3") == 0) return 9;
+        if (strcmp(type, "MAT4") == 0) return 16;
+        return 0;
+    }
+
+    size_t componentSize(int componentType)
+    {
+        switch (componentType)
+        {
+        case BYTE: case UNSIGNED_BYTE: return 1;
+        case SHORT: case UNSIGNED_SHORT: return 2;
+        case UNSIGNED_INT: case FLOAT: return 4;
+        default: return 0;
+        }
+    }
+
+    float readComponent(const unsigned char* p, int componentType, bool normalized)
+    {
+        switch (componentType)
+        {
+        case FLOAT:
+        {
+            float value;
+            memcpy(&value, p, 4);
+            return value;
+        }
+        case BYTE:
+        {
+            signed char value = (signed char)*p;
+            return normalized ? std::max(value / 127.0f, -1.0f) : value;
+        }
+        case UNSIGNED_BYTE:
+            return normalized ? *p / 255.0f : *p;
+        case SHORT:
+        {
+            short value;
+            memcpy(&value, p, 2);
+            return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+        }
+        case UNSIGNED_SHORT:
+        {
+            unsigned short value;
+            memcpy(&value, p, 2);
+            return normalized ? value / 65535.0f : value;
+        }
+        case UNSIGNED_INT:
+        {
+            unsigned int value;
+            memcpy(&value, p, 4);
+            return (float)value;
+        }
+        default:
+            return 0.0f;
+        }
+    }
+
+    // reads up to components values of element index into out, missing components stay untouched
+    void readElement(const Accessor& accessor, size_t index, float* out, int components)
+    {
+        if (!accessor.Data)
+            return;
+        const unsigned char* element = accessor.Data + index * accessor.Stride;
+        int count = std::min(components, accessor.Components);
+        if (accessor.ComponentType == FLOAT)
+        {
+            memcpy(out, element, count * sizeof(float));
+            return;
+        }
+        size_t size = componentSize(accessor.ComponentType);
+        for (int i = 0; i < count; i++)
+            out[i] = readComponent(element + i * size, accessor.ComponentType, accessor.Normalized);
+    }
+
+    // an accessor without a buffer view reads as zeros, like in readElement
+    unsigned int readIndex(const Accessor& accessor, size_t index)
+    {
+        if (!accessor.Data)
+            return 0;
+        const unsigned char* p = accessor.Data + index * accessor.Stride;
+        switch (accessor.ComponentType)
+        {
+        case UNSIGNED_BYTE:
+            return *p;
+        case UNSIGNED_SHORT:
+        {
+            unsigned short value;
+            memcpy(&value, p, 2);
+            return value;
+        }
+        default:
+        {
+            unsigned int value;
+            memcpy(&value, p, 4);
+            return value;
+        }
+        }
+    }
+
+    void decode(const DecodeTask& task)
+    {
+        GltfPrimitive& primitive = *task.Primitive;
+        if (task.IndexTask)
+        {
+            unsigned int vertexCount = (unsigned int)primitive.Vertices.size();
+            for (size_t i = task.Begin; i < task.End; i++)
+            {
+                unsigned int index = task.Indices ? readIndex(*task.Indices, i) : (unsigned int)i;
+                // an out of range index would read past the vertex buffer on the GPU
+                primitive.Indices[i] = index < vertexCount ? index : 0;
+            }
+            return;
+        }
+        for (size_t i = task.Begin; i < task.End; i++)
+        {
+            GltfVertex& vertex = primitive.Vertices[i];
+            readElement(*task.Position, i, glm::value_ptr(vertex.Position), 3);
+            if (task.Normal)
+                readElement(*task.Normal, i, glm::value_ptr(vertex.Normal), 3);
+            if (task.TexCoord)
+                readElement(*task.TexCoord, i, glm::value_ptr(vertex.TexCoord), 2);
+        }
+    }
+
+    // runs task(0 .. count-1) on threads new worker threads. the calling thread only waits, so thread local
+    // settings made by a task (like stb_image's flip flag) never leak into it
+    void parallelFor(size_t count, unsigned int threads, const std::function<void(size_t)>& task)
+    {
+        std::atomic<size_t> next(0);
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < std::min((size_t)threads, count); i++)
+        {
+            workers.emplace_back([&]()
+            {
+                for (size_t index = next++; index < count; index = next++)
+                    task(index);
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    bool decodeBase64(const char* text, std::vector<unsigned char>& out)
+    {
+        static signed char table[256];
+        static bool initialized = false;
+        if (!initialized)
+        {
+            memset(table, -1, sizeof(table));
+            const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (int i = 0; i < 64; i++)
+                table[(unsigned char)alphabet[i]] = (signed char)i;
+            initialized = true;
+        }
+        out.clear();
+        out.reserve(strlen(text) / 4 * 3);
+        unsigned int bits = 0;
+        int bitCount = 0;
+        for (const char* c = text; *c && *c != '='; c++)
+        {
+            int value = table[(unsigned char)*c];
+            if (value < 0)
+                return false;
+            bits = bits << 6 | value;
+            bitCount += 6;
+            if (bitCount >= 8)
+            {
+                bitCount -= 8;
+                out.push_back((unsigned char)(bits >> bitCount));
+            }
+        }
+        return true;
+    }
+
+    // "data:<mime>;base64,<payload>" URIs embed the buffer or image in the JSON
+    bool decodeDataUri(const char* uri, std::vector<unsigned char>& out)
+    {
+        const char* comma = strchr(uri, ',');
+        if (!comma || !strstr(uri, ";base64"))
+            return false;
+        return decodeBase64(comma + 1, out);
+    }
+
+    // relative URIs are percent-encoded
+    std::string decodeUri(const char* uri)
+    {
+        std::string result;
+        for (const char* c = uri; *c; c++)
+        {
+            if (c[0] == '%' && isxdigit((unsigned char)c[1]) && isxdigit((unsigned char)c[2]))
+            {
+                char hex[3] = { c[1], c[2], 0 };
+                result += (char)strtol(hex, NULL, 16);
+                c += 2;
+            }
+            else
+                result += *c;
+        }
+        return result;
+    }
+
+    glm::mat4 nodeTransform(const JsonValue& node)
+    {
+        const JsonValue& matrix = node["matrix"];
+        if (matrix.Size() == 16)
+        {
+            glm::mat4 result;
+            for (int i = 0; i < 16; i++)
+                glm::value_ptr(result)[i] = (float)matrix[i].AsNumber();   // column major like glm
+            return result;
+        }
+        glm::vec3 translation(0.0f), scale(1.0f);
+        glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+        const JsonValue& t = node["translation"];
+        const JsonValue& r = node["rotation"];
+        const JsonValue& s = node["scale"];
+        if (t.Size() == 3)
+            translation = glm::vec3(t[0].AsNumber(), t[1].AsNumber(), t[2].AsNumber());
+        if (r.Size() == 4)
+            rotation = glm::quat((float)r[3].AsNumber(), (float)r[0].AsNumber(), (float)r[1].AsNumber(), (float)r[2].AsNumber());
+        if (s.Size() == 3)
+            scale = glm::vec3(s[0].AsNumber(), s[1].AsNumber(), s[2].AsNumber());
+        return glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+    }
+
+    GLint wrapMode(int mode)
+    {
+        return mode == 33071 ? GL_CLAMP_TO_EDGE : mode == 33648 ? GL_MIRRORED_REPEAT : GL_REPEAT;
+    }
+}
+
+GltfModel::~GltfModel()
+{
+    release();
+}
+
+void GltfModel::release()
+{
+    for (GltfMesh& mesh : Meshes)
+    {
+        for (GltfPrimitive& primitive : mesh.Primitives)
+        {
+            if (primitive.VAO)
+            {
+                glDeleteVertexArrays(1, &primitive.VAO);
+                glDeleteBuffers(1, &primitive.VBO);
+                glDeleteBuffers(1, &primitive.EBO);
+            }
+        }
+    }
+    for (GltfImage& image : Images)
+    {
+        if (image.Pixels)
+            stbi_image_free(image.Pixels);
+        if (image.Texture)
+            glDeleteTextures(1, &image.Texture);
+    }
+    if (whiteTexture)
+        glDeleteTextures(1, &whiteTexture);
+    whiteTexture = 0;
+    Meshes.clear();
+    Materials.clear();
+    Textures.clear();
+    Images.clear();
+    Instances.clear();
+}
+
+bool GltfModel::Load(const std::string& path, unsigned int threads)
+{
+    release();
+    Stats = GltfLoadStats();
+    Stats.Threads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    Clock::time_point start = Clock::now();
+    std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+
+    MappedFile file(path);
+    if (!file.IsOpen())
+    {
+        std::cout << "ERROR::GLTF::FILE_NOT_FOUND: " << path << std::endl;
+        return false;
+    }
+
+    // .glb: 12 byte header then a JSON chunk and an optional binary chunk, .gltf: the whole file is JSON.
+    // the JSON is copied because the parser works in place and the mapping is read-only
+    std::vector<char> json;
+    Buffer glbBinary;
+    unsigned int magic = 0;
+    if (file.Size() >= 4)
+        memcpy(&magic, file.Data(), 4);
+    if (magic == GLB_MAGIC)
+    {
+        size_t offset = 12;
+        while (offset + 8 <= file.Size())
+        {
+            unsigned int length, type;
+            memcpy(&length, file.Data() + offset, 4);
+            memcpy(&type, file.Data() + offset + 4, 4);
+            const unsigned char* chunk = file.Data() + offset + 8;
+            if (offset + 8 + length > file.Size())
+                break;
+            if (type == GLB_CHUNK_JSON)
+                json.assign(chunk, chunk + length);
+            else if (type == GLB_CHUNK_BIN)
+            {
+                glbBinary.Data = chunk;
+                glbBinary.Size = length;
+            }
+            offset += 8 + ((length + 3) & ~3u);
+        }
+    }
+    else if (file.Size() > 0)
+        json.assign(file.Data(), file.Data() + file.Size());
+
+    JsonDocument document;
+    if (json.empty() || !document.Parse(json.data(), json.size()))
+    {
+        std::cout << "ERROR::GLTF::INVALID_JSON: " << path << " " << document.GetError() << std::endl;
+        return false;
+    }
+    const JsonValue& root = document.Root();
+    if (root["asset"]["version"].AsString()[0] != '2')
+    {
+        std::cout << "ERROR::GLTF::UNSUPPORTED_VERSION: " << root["asset"]["version"].AsString() << std::endl;
+        return false;
+    }
+
+    // buffers: the GLB chunk, an embedded data: URI or a mapped file next to the .gltf
+    std::vector<Buffer> buffers;
+    std::vector<std::unique_ptr<MappedFile>> mappedBuffers;
+    std::vector<std::vector<unsigned char>> embeddedBuffers;
+    for (size_t i = 0; i < root["buffers"].Size(); i++)
+    {
+        const JsonValue& source = root["buffers"][i];
+        Buffer buffer;
+        if (!source.Has("uri"))
+            buffer = glbBinary;
+        else if (strncmp(source["uri"].AsString(), "data:", 5) == 0)
+        {
+            embeddedBuffers.emplace_back();
+            if (!decodeDataUri(source["uri"].AsString(), embeddedBuffers.back()))
+            {
+                std::cout << "ERROR::GLTF::INVALID_DATA_URI: buffer " << i << std::endl;
+                return false;
+            }
+            buffer.Data = embeddedBuffers.back().data();
+            buffer.Size = embeddedBuffers.back().size();
+        }
+        else
+        {
+            mappedBuffers.emplace_back(new MappedFile(directory + decodeUri(source["uri"].AsString())));
+            if (!mappedBuffers.back()->IsOpen())
+            {
+                std::cout << "ERROR::GLTF::BUFFER_NOT_FOUND: " << source["uri"].AsString() << std::endl;
+                return false;
+            }
+            buffer.Data = mappedBuffers.back()->Data();
+            buffer.Size = mappedBuffers.back()->Size();
+        }
+        if (buffer.Size < (size_t)source["byteLength"].AsNumber())
+        {
+            std::cout << "ERROR::GLTF::BUFFER_TOO_SHORT: buffer " << i << std::endl;
+            return false;
+        }
+        buffers.push_back(buffer);
+        Stats.BufferBytes += buffer.Size;
+    }
+
+    std::vector<BufferView> views;
+    for (size_t i = 0; i < root["bufferViews"].Size(); i++)
+    {
+        const JsonValue& source = root["bufferViews"][i];
+        size_t buffer = (size_t)source["buffer"].AsInt(-1);
+        size_t offset = (size_t)source["byteOffset"].AsNumber();
+        size_t length = (size_t)source["byteLength"].AsNumber();
+        if (buffer >= buffers.size() || offset + length > buffers[buffer].Size)
+        {
+            std::cout << "ERROR::GLTF::INVALID_BUFFER_VIEW: " << i << std::endl;
+            return false;
+        }
+        BufferView view;
+        view.Data = buffers[buffer].Data + offset;
+        view.Size = length;
+        view.Stride = (size_t)source["byteStride"].AsNumber();
+        views.push_back(view);
+    }
+
+    std::vector<Accessor> accessors;
+    for (size_t i = 0; i < root["accessors"].Size(); i++)
+    {
+        const JsonValue& source = root["accessors"][i];
+        Accessor accessor;
+        accessor.Count = (size_t)source["count"].AsNumber();
+        accessor.ComponentType = source["componentType"].AsInt();
+        accessor.Components = componentCount(source["type"].AsString());
+        accessor.Normalized = source["normalized"].AsBool();
+        size_t elementSize = componentSize(accessor.ComponentType) * accessor.Components;
+        if (source.Has("sparse") || elementSize == 0)
+        {
+            std::cout << "ERROR::GLTF::UNSUPPORTED_ACCESSOR: " << i << std::endl;
+            return false;
+        }
+        if (source.Has("bufferView"))
+        {
+            size_t viewIndex = (size_t)source["bufferView"].AsInt(-1);
+            size_t offset = (size_t)source["byteOffset"].AsNumber();
+            if (viewIndex >= views.size())
+            {
+                std::cout << "ERROR::GLTF::INVALID_ACCESSOR: " << i << std::endl;
+                return false;
+            }
+            const BufferView& view = views[viewIndex];
+            accessor.Stride = view.Stride ? view.Stride : elementSize;
+            if (accessor.Count > 0 && offset + accessor.Stride * (accessor.Count - 1) + elementSize > view.Size)
+            {
+                std::cout << "ERROR::GLTF::ACCESSOR_OUT_OF_BOUNDS: " << i << std::endl;
+                return false;
+            }
+            accessor.Data = view.Data + offset;
+        }
+        accessors.push_back(accessor);
+    }
+
+    for (size_t i = 0; i < root["textures"].Size(); i++)
+    {
+        const JsonValue& source = root["textures"][i];
+        GltfTexture texture;
+        texture.Image = source["source"].AsInt(-1);
+        if (source.Has("sampler"))
+        {
+            const JsonValue& sampler = root["samplers"][(size_t)source["sampler"].AsInt()];
+            texture.Sampling.WrapS = wrapMode(sampler["wrapS"].AsInt(10497));
+            texture.Sampling.WrapT = wrapMode(sampler["wrapT"].AsInt(10497));
+            // the GL enums are used as they are, glTF takes them from GL
+            texture.Sampling.MinFilter = sampler["minFilter"].AsInt(GL_LINEAR_MIPMAP_LINEAR);
+            texture.Sampling.MagFilter = sampler["magFilter"].AsInt(GL_LINEAR);
+        }
+        Textures.push_back(texture);
+    }
+
+    for (size_t i = 0; i < root["materials"].Size(); i++)
+    {
+        const JsonValue& pbr = root["materials"][i]["pbrMetallicRoughness"];
+        GltfMaterial material;
+        const JsonValue& factor = pbr["baseColorFactor"];
+        if (factor.Size() == 4)
+            material.BaseColorFactor = glm::vec4(factor[0].AsNumber(), factor[1].AsNumber(), factor[2].AsNumber(), factor[3].AsNumber());
+        material.BaseColorTexture = pbr["baseColorTexture"]["index"].AsInt(-1);
+        if (material.BaseColorTexture >= (int)Textures.size())
+            material.BaseColorTexture = -1;
+        Materials.push_back(material);
+    }
+
+    // meshes: size every primitive, then cut the accessors into tasks
+    struct Allocation
+    {
+        GltfPrimitive* Primitive;
+        size_t VertexCount;
+        size_t IndexCount;
+    };
+    std::vector<Allocation> allocations;
+    std::vector<DecodeTask> tasks;
+    Meshes.resize(root["meshes"].Size());
+    for (size_t m = 0; m < Meshes.size(); m++)
+    {
+        const JsonValue& source = root["meshes"][m];
+        Meshes[m].Name = source["name"].AsString();
+        // the tasks keep pointers to the primitives, they must not move
+        Meshes[m].Primitives.reserve(source["primitives"].Size());
+        for (size_t p = 0; p < source["primitives"].Size(); p++)
+        {
+            const JsonValue& primitiveSource = source["primitives"][p];
+            const JsonValue& attributes = primitiveSource["attributes"];
+            size_t position = (size_t)attributes["POSITION"].AsInt(-1);
+            if (primitiveSource["mode"].AsInt(TRIANGLES) != TRIANGLES || position >= accessors.size())
+            {
+                std::cout << "WARNING::GLTF::SKIPPED_PRIMITIVE: mesh " << m << " primitive " << p << " is not indexed triangles with positions" << std::endl;
+                continue;
+            }
+            size_t normal = (size_t)attributes["NORMAL"].AsInt(-1);
+            size_t texCoord = (size_t)attributes["TEXCOORD_0"].AsInt(-1);
+            size_t indices = (size_t)primitiveSource["indices"].AsInt(-1);
+
+            Meshes[m].Primitives.emplace_back();
+            GltfPrimitive& primitive = Meshes[m].Primitives.back();
+            primitive.Material = primitiveSource["material"].AsInt(-1);
+            size_t vertexCount = accessors[position].Count;
+            size_t indexCount = indices < accessors.size() ? accessors[indices].Count : vertexCount;
+            // allocated by the workers, touching hundreds of MB is not free either
+            allocations.push_back({ &primitive, vertexCount, indexCount });
+            Stats.VertexCount += vertexCount;
+            Stats.IndexCount += indexCount;
+
+            // the attributes are read for every position, one with fewer elements would be read past its end
+            auto attribute = [&](size_t accessor, const char* name) -> const Accessor*
+            {
+                if (accessor >= accessors.size())
+                    return NULL;
+                if (accessors[accessor].Count < vertexCount)
+                {
+                    std::cout << "WARNING::GLTF::SKIPPED_ATTRIBUTE: mesh " << m << " primitive " << p << " has fewer " << name
+                        << " than positions" << std::endl;
+                    return NULL;
+                }
+                return &accessors[accessor];
+            };
+            DecodeTask task;
+            task.Primitive = &primitive;
+            task.Position = &accessors[position];
+            task.Normal = attribute(normal, "NORMAL");
+            task.TexCoord = attribute(texCoord, "TEXCOORD_0");
+            task.Indices = indices < accessors.size() ? &accessors[indices] : NULL;
+            task.IndexTask = false;
+            for (size_t begin = 0; begin < vertexCount; begin += DECODE_CHUNK)
+            {
+                task.Begin = begin;
+                task.End = std::min(begin + DECODE_CHUNK, vertexCount);
+                tasks.push_back(task);
+            }
+            task.IndexTask = true;
+            for (size_t begin = 0; begin < indexCount; begin += DECODE_CHUNK)
+            {
+                task.Begin = begin;
+                task.End = std::min(begin + DECODE_CHUNK, indexCount);
+                tasks.push_back(task);
+            }
+        }
+    }
+
+    // scene graph flattened into instances, every mesh once when the file has no nodes
+    const JsonValue& nodes = root["nodes"];
+    std::function<void(size_t, const glm::mat4&, int)> visit = [&](size_t node, const glm::mat4& parent, int depth)
+    {
+        if (node >= nodes.Size() || depth > 64)
+            return;
+        glm::mat4 transform = parent * nodeTransform(nodes[node]);
+        int mesh = nodes[node]["mesh"].AsInt(-1);
+        if (mesh >= 0 && mesh < (int)Meshes.size())
+            Instances.push_back({ mesh, transform });
+        for (size_t i = 0; i < nodes[node]["children"].Size(); i++)
+            visit((size_t)nodes[node]["children"][i].AsInt(-1), transform, depth + 1);
+    };
+    const JsonValue& scene = root["scenes"][(size_t)root["scene"].AsInt(0)];
+    if (scene.Has("nodes"))
+    {
+        for (size_t i = 0; i < scene["nodes"].Size(); i++)
+            visit((size_t)scene["nodes"][i].AsInt(-1), glm::mat4(1.0f), 0);
+    }
+    else if (nodes.Size() == 0)
+    {
+        for (size_t i = 0; i < Meshes.size(); i++)
+            Instances.push_back({ (int)i, glm::mat4(1.0f) });
+    }
+
+    // images: external files go through stbi_load, embedded ones through stbi_load_from_memory
+    struct ImageSource
+    {
+        std::string Path;
+        const unsigned char* Data = NULL;
+        size_t Size = 0;
+        std::vector<unsigned char> Embedded;
+    };
+    std::vector<ImageSource> imageSources(root["images"].Size());
+    Images.resize(imageSources.size());
+    for (size_t i = 0; i < imageSources.size(); i++)
+    {
+        const JsonValue& source = root["images"][i];
+        ImageSource& image = imageSources[i];
+        if (source.Has("bufferView"))
+        {
+            size_t view = (size_t)source["bufferView"].AsInt(-1);
+            if (view < views.size())
+            {
+                image.Data = views[view].Data;
+                image.Size = views[view].Size;
+            }
+        }
+        else if (strncmp(source["uri"].AsString(), "data:", 5) == 0)
+        {
+            if (decodeDataUri(source["uri"].AsString(), image.Embedded))
+            {
+                image.Data = image.Embedded.data();
+                image.Size = image.Embedded.size();
+            }
+        }
+        else
+            image.Path = directory + decodeUri(source["uri"].AsString());
+    }
+    Stats.ParseSeconds = secondsSince(start);
+
+    Clock::time_point decodeStart = Clock::now();
+    parallelFor(allocations.size(), Stats.Threads, [&](size_t i)
+    {
+        allocations[i].Primitive->Vertices.resize(allocations[i].VertexCount, GltfVertex{ glm::vec3(0.0f), glm::vec3(0.0f), glm::vec2(0.0f) });
+        allocations[i].Primitive->Indices.resize(allocations[i].IndexCount);
+    });
+    parallelFor(tasks.size(), Stats.Threads, [&](size_t i) { decode(tasks[i]); });
+    Stats.DecodeSeconds = secondsSince(decodeStart);
+
+    Clock::time_point imageStart = Clock::now();
+    parallelFor(imageSources.size(), Stats.Threads, [&](size_t i)
+    {
+        // glTF puts the first row at the top, which is where GL expects uv (0, 0) of an unflipped image
+        stbi_set_flip_vertically_on_load_thread(0);
+        ImageSource& source = imageSources[i];
+        GltfImage& image = Images[i];
+        if (source.Data)
+            image.Pixels = stbi_load_from_memory(source.Data, (int)source.Size, &image.Width, &image.Height, &image.Channels, 4);
+        else if (!source.Path.empty())
+            image.Pixels = stbi_load(source.Path.c_str(), &image.Width, &image.Height, &image.Channels, 4);
+    });
+    for (size_t i = 0; i < Images.size(); i++)
+    {
+        if (!Images[i].Pixels)
+            std::cout << "WARNING::GLTF::IMAGE_NOT_LOADED: " << i << " " << imageSources[i].Path << std::endl;
+    }
+    Stats.ImageSeconds = secondsSince(imageStart);
+    Stats.TotalSeconds = secondsSince(start);
+    return true;
+}
+
+void GltfModel::Upload()
+{
+    GLint previousTexture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+    if (!whiteTexture)
+    {
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    }
+
+    for (GltfMesh& mesh : Meshes)
+    {
+        for (GltfPrimitive& primitive : mesh.Primitives)
+        {
+            if (primitive.VAO)
+                continue;
+            glGenVertexArrays(1, &primitive.VAO);
+            glGenBuffers(1, &primitive.VBO);
+            glGenBuffers(1, &primitive.EBO);
+            glBindVertexArray(primitive.VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, primitive.VBO);
+            glBufferData(GL_ARRAY_BUFFER, primitive.Vertices.size() * sizeof(GltfVertex), primitive.Vertices.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, primitive.EBO);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, primitive.Indices.size() * sizeof(unsigned int), primitive.Indices.data(), GL_STATIC_DRAW);
+            // position attribute
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GltfVertex), (void*)offsetof(GltfVertex, Position));
+            glEnableVertexAttribArray(0);
+            // normal attribute
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GltfVertex), (void*)offsetof(GltfVertex, Normal));
+            glEnableVertexAttribArray(1);
+            // texture coordinate attribute
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(GltfVertex), (void*)offsetof(GltfVertex, TexCoord));
+            glEnableVertexAttribArray(2);
+            glBindVertexArray(0);
+
+            primitive.IndexCount = (unsigned int)primitive.Indices.size();
+            std::vector<GltfVertex>().swap(primitive.Vertices);
+            std::vector<unsigned int>().swap(primitive.Indices);
+        }
+    }
+
+    for (GltfTexture& texture : Textures)
+    {
+        if (texture.Image < 0 || texture.Image >= (int)Images.size())
+            continue;
+        GltfImage& image = Images[texture.Image];
+        if (image.Texture || !image.Pixels)
+            continue;
+        glGenTextures(1, &image.Texture);
+        glBindTexture(GL_TEXTURE_2D, image.Texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.Width, image.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.Pixels);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        // an image shared by several textures keeps the sampling of the first
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texture.Sampling.WrapS);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texture.Sampling.WrapT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture.Sampling.MinFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texture.Sampling.MagFilter);
+        stbi_image_free(image.Pixels);
+        image.Pixels = NULL;
+    }
+    glBindTexture(GL_TEXTURE_2D, previousTexture);
+}
+
+void GltfModel::Draw(Shader& shader) const
+{
+    shader.setInt("baseColor", 0);
+    glActiveTexture(GL_TEXTURE0);
+    for (const GltfInstance& instance : Instances)
+    {
+        shader.setMat4("model", instance.Transform);
+        for (const GltfPrimitive& primitive : Meshes[instance.Mesh].Primitives)
+        {
+            if (!primitive.VAO)
+                continue;
+            glm::vec4 factor(1.0f);
+            unsigned int texture = whiteTexture;
+            if (primitive.Material >= 0 && primitive.Material < (int)Materials.size())
+            {
+                const GltfMaterial& material = Materials[primitive.Material];
+                factor = material.BaseColorFactor;
+                int image = material.BaseColorTexture >= 0 ? Textures[material.BaseColorTexture].Image : -1;
+                if (image >= 0 && image < (int)Images.size() && Images[image].Texture)
+                    texture = Images[image].Texture;
+            }
+            shader.setVec4("baseColorFactor", factor);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glBindVertexArray(primitive.VAO);
+            glDrawElements(GL_TRIANGLES, primitive.IndexCount, GL_UNSIGNED_INT, 0);
+        }
+    }
+    glBindVertexArray(0);
+}
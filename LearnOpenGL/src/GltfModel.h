@@ -0,0 +1,120 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TextureCache.h"
+
+class Shader;
+
+// interleaved vertex of a loaded mesh: position (location 0), normal (1), texture coordinates (2)
+struct GltfVertex
+{
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    glm::vec2 TexCoord;
+};
+
+// one draw: indexed triangles with a single material
+struct GltfPrimitive
+{
+    std::vector<GltfVertex> Vertices;
+    std::vector<unsigned int> Indices;
+    int Material = -1;
+    // set by Upload()
+    unsigned int VAO = 0;
+    unsigned int VBO = 0;
+    unsigned int EBO = 0;
+    unsigned int IndexCount = 0;
+};
+
+struct GltfMesh
+{
+    std::string Name;
+    std::vector<GltfPrimitive> Primitives;
+};
+
+struct GltfMaterial
+{
+    glm::vec4 BaseColorFactor = glm::vec4(1.0f);
+    // index into Textures, -1 for none
+    int BaseColorTexture = -1;
+};
+
+struct GltfTexture
+{
+    // index into Images
+    int Image = -1;
+    TextureSampling Sampling;
+};
+
+struct GltfImage
+{
+    // decoded by stb_image, released by Upload()
+    unsigned char* Pixels = NULL;
+    int Width = 0;
+    int Height = 0;
+    int Channels = 0;
+    // set by Upload()
+    unsigned int Texture = 0;
+};
+
+// a mesh placed in the scene, node hierarchies are flattened into world transforms
+struct GltfInstance
+{
+    int Mesh;
+    glm::mat4 Transform;
+};
+
+// where the time of the last Load() went
+struct GltfLoadStats
+{
+    double ParseSeconds = 0.0;    // reading and parsing the JSON, mapping the buffers
+    double DecodeSeconds = 0.0;   // accessors into interleaved vertices and indices
+    double ImageSeconds = 0.0;    // decoding the images
+    double TotalSeconds = 0.0;
+    size_t BufferBytes = 0;
+    size_t VertexCount = 0;
+    size_t IndexCount = 0;
+    unsigned int Threads = 0;
+};
+
+// Loads a glTF 2.0 scene (.gltf with external or data: URI buffers and images, or binary .glb) into vertex
+// and index arrays ready for glBufferData. the JSON is parsed in place with JsonDocument, the binary buffers
+// are memory mapped, and the accessors (split into ranges) and images are decoded on worker threads.
+// only triangle primitives are loaded; POSITION, NORMAL and TEXCOORD_0 are read, sparse accessors are not supported.
+class GltfModel
+{
+public:
+    // vertices or indices decoded per task, big accessors are split so one large mesh still uses every thread
+    static const size_t DECODE_CHUNK = 64 * 1024;
+
+    GltfModel() {}
+    ~GltfModel();
+    GltfModel(const GltfModel&) = delete;
+    GltfModel& operator=(const GltfModel&) = delete;
+
+    // loads path with threads workers (0 for one per hardware thread), returns false and prints why on failure
+    bool Load(const std::string& path, unsigned int threads = 0);
+    // creates the vertex arrays and textures and releases the CPU copies of the vertices, indices and pixels
+    void Upload();
+    // draws every instance, setting the "model" matrix, "baseColorFactor" and the "baseColor" texture on unit 0
+    void Draw(Shader& shader) const;
+
+    std::vector<GltfMesh> Meshes;
+    std::vector<GltfMaterial> Materials;
+    std::vector<GltfTexture> Textures;
+    std::vector<GltfImage> Images;
+    std::vector<GltfInstance> Instances;
+    GltfLoadStats Stats;
+
+private:
+    // bound for primitives without a base color texture
+    unsigned int whiteTexture = 0;
+
+    void release();
+};
@@ -0,0 +1,233 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "GltfViewer.h"
+#include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../GltfModel.h"
+
+namespace GltfViewer
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // the scene to load, generated on first run when it does not exist
+    const char* MODEL_PATH = "models/Synthetic.gltf";
+    const char* MODEL_BUFFER = "Synthetic.bin";
+    // SYNTHETIC_MESHES height fields of SYNTHETIC_GRID x SYNTHETIC_GRID vertices, about 117 MB of buffers
+    const int SYNTHETIC_MESHES = 32;
+    const int SYNTHETIC_GRID = 256;
+    const float SYNTHETIC_TILE = 10.0f;
+
+    // the camera orbits the scene by a fixed step per frame
+    const float SCRIPT_STEP = 1.0f / 60.0f;
+
+    // writes a .gltf with one .bin: every mesh a wavy height field with separate position, normal, uv and index
+    // views, so the loader has to interleave them, textured with the container through an external image
+    bool writeSyntheticScene(const std::string& path)
+    {
+        std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+        FILE* bin = fopen((directory + MODEL_BUFFER).c_str(), "wb");
+        if (!bin)
+        {
+            std::cout << "Failed to write " << directory + MODEL_BUFFER << " (does the models directory exist?)" << std::endl;
+            return false;
+        }
+
+        size_t vertexCount = (size_t)SYNTHETIC_GRID * SYNTHETIC_GRID;
+        size_t indexCount = (size_t)(SYNTHETIC_GRID - 1) * (SYNTHETIC_GRID - 1) * 6;
+        std::string views, accessors, meshes, nodes, sceneNodes;
+        size_t offset = 0;
+        char text[512];
+        for (int m = 0; m < SYNTHETIC_MESHES; m++)
+        {
+            std::vector<float> positions, normals, uvs;
+            std::vector<unsigned int> indices;
+            float phase = m * 0.7f;
+            for (int y = 0; y < SYNTHETIC_GRID; y++)
+                for (int x = 0; x < SYNTHETIC_GRID; x++)
+                {
+                    float u = (float)x / (SYNTHETIC_GRID - 1), v = (float)y / (SYNTHETIC_GRID - 1);
+                    float px = (u - 0.5f) * SYNTHETIC_TILE, pz = (v - 0.5f) * SYNTHETIC_TILE;
+                    float height = 0.5f * sin(px + phase) * cos(pz * 1.3f + phase);
+                    // derivative of the height for the normal
+                    float dx = 0.5f * cos(px + phase) * cos(pz * 1.3f + phase);
+                    float dz = -0.65f * sin(px + phase) * sin(pz * 1.3f + phase);
+                    glm::vec3 normal = glm::normalize(glm::vec3(-dx, 1.0f, -dz));
+                    positions.insert(positions.end(), { px, height, pz });
+                    normals.insert(normals.end(), { normal.x, normal.y, normal.z });
+                    uvs.insert(uvs.end(), { u * 4.0f, v * 4.0f });
+                }
+            for (int y = 0; y + 1 < SYNTHETIC_GRID; y++)
+                for (int x = 0; x + 1 < SYNTHETIC_GRID; x++)
+                {
+                    unsigned int i = y * SYNTHETIC_GRID + x;
+                    indices.insert(indices.end(), { i, i + SYNTHETIC_GRID, i + 1, i + 1, i + SYNTHETIC_GRID, i + SYNTHETIC_GRID + 1 });
+                }
+
+            const void* arrays[] = { positions.data(), normals.data(), uvs.data(), indices.data() };
+            size_t sizes[] = { positions.size() * 4, normals.size() * 4, uvs.size() * 4, indices.size() * 4 };
+            const char* types[] = { "VEC3", "VEC3", "VEC2", "SCALAR" };
+            int componentTypes[] = { 5126, 5126, 5126, 5125 };
+            for (int a = 0; a < 4; a++)
+            {
+                fwrite(arrays[a], 1, sizes[a], bin);
+                int view = m * 4 + a;
+                snprintf(text, sizeof(text), "%s{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu}", view ? "," : "", offset, sizes[a]);
+                views += text;
+                snprintf(text, sizeof(text), "%s{\"bufferView\":%d,\"componentType\":%d,\"count\":%zu,\"type\":\"%s\"}",
+                    view ? "," : "", view, componentTypes[a], a == 3 ? indexCount : vertexCount, types[a]);
+                accessors += text;
+                offset += sizes[a];
+            }
+            snprintf(text, sizeof(text), "%s{\"name\":\"tile%d\",\"primitives\":[{\"attributes\":{\"POSITION\":%d,\"NORMAL\":%d,\"TEXCOORD_0\":%d},\"indices\":%d,\"material\":0}]}",
+                m ? "," : "", m, m * 4, m * 4 + 1, m * 4 + 2, m * 4 + 3);
+            meshes += text;
+            snprintf(text, sizeof(text), "%s{\"mesh\":%d,\"translation\":[%g,0,%g]}", m ? "," : "", m,
+                (m % 8 - 3.5f) * SYNTHETIC_TILE, (m / 8 - 1.5f) * SYNTHETIC_TILE);
+            nodes += text;
+            snprintf(text, sizeof(text), "%s%d", m ? "," : "", m);
+            sceneNodes += text;
+        }
+        fclose(bin);
+
+        FILE* gltf = fopen(path.c_str(), "w");
+        if (!gltf)
+            return false;
+        fprintf(gltf, "{\"asset\":{\"version\":\"2.0\",\"generator\":\"LearnOpenGL GltfViewer\"},\n\"scene\":0,\"scenes\":[{\"nodes\":[%s]}],\n", sceneNodes.c_str());
+        fprintf(gltf, "\"nodes\":[%s],\n\"meshes\":[%s],\n", nodes.c_str(), meshes.c_str());
+        fprintf(gltf, "\"materials\":[{\"pbrMetallicRoughness\":{\"baseColorTexture\":{\"index\":0}}}],\n");
+        fprintf(gltf, "\"textures\":[{\"source\":0}],\"images\":[{\"uri\":\"../textures/Container.jpg\"}],\n");
+        fprintf(gltf, "\"buffers\":[{\"uri\":\"%s\",\"byteLength\":%zu}],\n", MODEL_BUFFER, offset);
+        fprintf(gltf, "\"bufferViews\":[%s],\n\"accessors\":[%s]}\n", views.c_str(), accessors.c_str());
+        fclose(gltf);
+        return true;
+    }
+
+    void printStats(const GltfLoadStats& stats)
+    {
+        printf("%2u thread(s): total %8.2f ms (parse + map %7.2f, decode %7.2f, images %7.2f) %8.1f MB/s, %zu vertices, %zu indices\n",
+            stats.Threads, stats.TotalSeconds * 1000.0, stats.ParseSeconds * 1000.0, stats.DecodeSeconds * 1000.0, stats.ImageSeconds * 1000.0,
+            stats.BufferBytes / (1024.0 * 1024.0) / stats.TotalSeconds, stats.VertexCount, stats.IndexCount);
+    }
+
+    int Main()
+    {
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        FILE* existing = fopen(MODEL_PATH, "rb");
+        if (existing)
+            fclose(existing);
+        else
+        {
+            std::cout << "Writing " << MODEL_PATH << "..." << std::endl;
+            if (!writeSyntheticScene(MODEL_PATH))
+                return -1;
+        }
+
+        // load benchmark: one thread against every hardware thread, the first run also pays for the disk reads
+        GltfModel model;
+        unsigned int threadCounts[] = { 1, std::max(1u, std::thread::hardware_concurrency()) };
+        for (unsigned int threads : threadCounts)
+        {
+            if (!model.Load(MODEL_PATH, threads))
+                return -1;
+            printStats(model.Stats);
+        }
+        model.Upload();
+
+        Shader shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs");
+        shader.use();
+        shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+
+        // render loop
+        float scriptTime = 0.0f;
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            processInput(window);
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            float radius = SYNTHETIC_TILE * 6.0f;
+            glm::vec3 eye(radius * cos(scriptTime * 0.2f), SYNTHETIC_TILE * 2.5f, radius * sin(scriptTime * 0.2f));
+            shader.use();
+            shader.setMat4("projection", glm::perspective(glm::radians(45.0f), (float)width / (float)std::max(height, 1), 0.1f, 500.0f));
+            shader.setMat4("view", glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+            model.Draw(shader);
+            scriptTime += SCRIPT_STEP;
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+    }
+}
@@ -0,0 +1,4 @@
+namespace GltfViewer
+{
+    int Main();
+};
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "GoldenImage.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+GoldenImage::Image GoldenImage::ReadFramebuffer(int width, int height)
+{
+    std::vector<unsigned char> rgba((size_t)width * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+
+    Image image;
+    image.Width = width;
+    image.Height = height;
+    image.Pixels.resize((size_t)width * height * 3);
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* source = &rgba[(size_t)(height - 1 - y) * width * 4];
+        unsigned char* target = &image.Pixels[(size_t)y * width * 3];
+        for (int x = 0; x < width; x++)
+        {
+            target[x * 3] = source[x * 4];
+            target[x * 3 + 1] = source[x * 4 + 1];
+            target[x * 3 + 2] = source[x * 4 + 2];
+        }
+    }
+    return image;
+}
+
+bool GoldenImage::Write(const std::string& path, const Image& image)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    file << "P6\n" << image.Width << " " << image.Height << "\n255\n";
+    file.write((const char*)image.Pixels.data(), image.Pixels.size());
+    return (bool)file;
+}
+
+bool GoldenImage::Read(const std::string& path, Image& image)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    std::string format;
+    int maxValue = 0;
+    file >> format >> image.Width >> image.Height >> maxValue;
+    // one whitespace byte between the header and the pixels
+    file.get();
+    if (!file || format != "P6" || maxValue != 255 || image.Width <= 0 || image.Height <= 0)
+        return false;
+    image.Pixels.resize((size_t)image.Width * image.Height * 3);
+    file.read((char*)image.Pixels.data(), image.Pixels.size());
+    return (bool)file;
+}
+
+GoldenImage::Difference GoldenImage::Compare(const Image& a, const Image& b, int tolerance)
+{
+    Difference difference;
+    if (a.Width != b.Width || a.Height != b.Height)
+        return difference;
+    difference.SameSize = true;
+    for (size_t pixel = 0; pixel < a.Pixels.size(); pixel += 3)
+    {
+        int largest = 0;
+        for (int channel = 0; channel < 3; channel++)
+            largest = std::max(largest, std::abs(a.Pixels[pixel + channel] - b.Pixels[pixel + channel]));
+        difference.MaxChannel = std::max(difference.MaxChannel, largest);
+        if (largest > tolerance)
+            difference.Pixels++;
+    }
+    return difference;
+}
+
+bool GoldenImage::Check(const std::string& path, const Image& image, int tolerance)
+{
+    Image golden;
+    // only a missing reference is written, a broken one is left for someone to look at
+    if (!std::ifstream(path, std::ios::binary))
+    {
+        bool written = Write(path, image);
+        printf("golden image %s %s\n", path.c_str(), written ? "written" : "could not be written");
+        return written;
+    }
+    if (!Read(path, golden))
+    {
+        printf("golden image %s is not a readable binary PPM, FAILED\n", path.c_str());
+        return false;
+    }
+    Difference difference = Compare(golden, image, tolerance);
+    if (!difference.SameSize)
+    {
+        printf("golden image %s is %dx%d, the frame %dx%d, FAILED\n", path.c_str(), golden.Width, golden.Height, image.Width, image.Height);
+        return false;
+    }
+    bool matched = difference.Pixels == 0;
+    printf("golden image %s: %zu pixels differ by more than %d, largest difference %d, %s\n", path.c_str(), difference.Pixels, tolerance,
+        difference.MaxChannel, matched ? "matched" : "FAILED");
+    return matched;
+}
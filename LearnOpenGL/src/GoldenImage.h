@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Frames compared against stored reference images, to catch a change that alters what is rendered. the references
+// are binary PPM files, 8 bit RGB top row first, which any image viewer opens and which need no library to write.
+namespace GoldenImage
+{
+    struct Image
+    {
+        int Width = 0;
+        int Height = 0;
+        // RGB, top row first
+        std::vector<unsigned char> Pixels;
+    };
+
+    struct Difference
+    {
+        // false when the sizes differ, then the rest is unset
+        bool SameSize = false;
+        // the largest difference of one channel and the pixels differing by more than the tolerance
+        int MaxChannel = 0;
+        size_t Pixels = 0;
+    };
+
+    // the RGB of the bound read framebuffer, flipped so the top row comes first
+    Image ReadFramebuffer(int width, int height);
+
+    bool Write(const std::string& path, const Image& image);
+    bool Read(const std::string& path, Image& image);
+
+    Difference Compare(const Image& a, const Image& b, int tolerance);
+
+    // compares image with the reference at path, or makes it the reference when there is none yet. returns whether
+    // it matched or was written, and prints the outcome. a reference that exists but cannot be read fails
+    bool Check(const std::string& path, const Image& image, int tolerance);
+}
@@ -0,0 +1,187 @@
+#include "HashedGrid.h"
+#include <algorithm>
+
+namespace
+{
+    // 21 bits per coordinate, cells up to a million either side of the origin
+    uint64_t cellKey(const glm::ivec3& cell)
+    {
+        const int offset = 1 << 20;
+        const uint64_t mask = (1 << 21) - 1;
+        return ((uint64_t)(cell.x + offset) & mask) << 42 | ((uint64_t)(cell.y + offset) & mask) << 21 | ((uint64_t)(cell.z + offset) & mask);
+    }
+
+    // 0 when the box is outside a plane, 2 when it is inside all of them, 1 otherwise
+    int classifyBox(const glm::vec3& min, const glm::vec3& max, const glm::vec4 planes[6])
+    {
+        int result = 2;
+        for (int p = 0; p < 6; p++)
+        {
+            glm::vec3 normal(planes[p]);
+            glm::vec3 farCorner(normal.x >= 0.0f ? max.x : min.x, normal.y >= 0.0f ? max.y : min.y, normal.z >= 0.0f ? max.z : min.z);
+            glm::vec3 nearCorner(normal.x >= 0.0f ? min.x : max.x, normal.y >= 0.0f ? min.y : max.y, normal.z >= 0.0f ? min.z : max.z);
+            if (glm::dot(normal, farCorner) + planes[p].w < 0.0f)
+                return 0;
+            if (glm::dot(normal, nearCorner) + planes[p].w < 0.0f)
+                result = 1;
+        }
+        return result;
+    }
+}
+
+HashedGrid::HashedGrid(float cellSize) : cellSize(cellSize), inverseCellSize(1.0f / cellSize)
+{
+}
+
+void HashedGrid::Update(unsigned int object, const glm::vec3& center, float radius)
+{
+    glm::ivec3 coordinates(glm::floor(center * inverseCellSize));
+    uint64_t key = cellKey(coordinates);
+
+    if (object >= locations.size())
+        locations.resize(object + 1);
+    Location& location = locations[object];
+    if (location.Cell >= 0 && location.Key == key)
+    {
+        Cell& cell = cells[location.Cell];
+        cell.Entries[location.Slot].Center = center;
+        cell.Entries[location.Slot].Radius = radius;
+        cell.MaxRadius = std::max(cell.MaxRadius, radius);
+        maxRadius = std::max(maxRadius, radius);
+        return;
+    }
+    if (location.Cell >= 0)
+    {
+        // may move the target cell when the old one empties, it is looked up after
+        removeEntry(location.Cell, location.Slot);
+        CellChanges++;
+    }
+    else
+        objectCount++;
+
+    int index = lookup.Find(key);
+    if (index < 0)
+    {
+        index = (int)cells.size();
+        cells.push_back({ coordinates, 0.0f, std::vector<Entry>() });
+        if (!spareEntries.empty())
+        {
+            cells.back().Entries.swap(spareEntries.back());
+            spareEntries.pop_back();
+        }
+        lookup.Insert(key, index);
+    }
+    Cell& cell = cells[index];
+    location.Cell = index;
+    location.Slot = (unsigned int)cell.Entries.size();
+    location.Key = key;
+    cell.Entries.push_back({ center, radius, object });
+    cell.MaxRadius = std::max(cell.MaxRadius, radius);
+    maxRadius = std::max(maxRadius, radius);
+}
+
+void HashedGrid::Remove(unsigned int object)
+{
+    if (object >= locations.size() || locations[object].Cell < 0)
+        return;
+    Location location = locations[object];
+    locations[object].Cell = -1;
+    removeEntry(location.Cell, location.Slot);
+    objectCount--;
+}
+
+void HashedGrid::Clear()
+{
+    cells.clear();
+    spareEntries.clear();
+    lookup.Clear();
+    locations.clear();
+    maxRadius = 0.0f;
+    objectCount = 0;
+}
+
+void HashedGrid::QueryFrustum(const glm::vec4 planes[6], std::vector<unsigned int>& objects) const
+{
+    for (const Cell& cell : cells)
+    {
+        glm::vec3 min = glm::vec3(cell.Coordinates) * cellSize - cell.MaxRadius;
+        int inside = classifyBox(min, min + cellSize + 2.0f * cell.MaxRadius, planes);
+        if (inside == 0)
+            continue;
+        if (inside == 2)
+        {
+            for (const Entry& entry : cell.Entries)
+                objects.push_back(entry.Object);
+            continue;
+        }
+        for (const Entry& entry : cell.Entries)
+        {
+            bool outside = false;
+            for (int p = 0; p < 6 && !outside; p++)
+                outside = glm::dot(glm::vec3(planes[p]), entry.Center) + planes[p].w < -entry.Radius;
+            if (!outside)
+                objects.push_back(entry.Object);
+        }
+    }
+}
+
+void HashedGrid::QuerySphere(const glm::vec3& center, float radius, std::vector<unsigned int>& objects) const
+{
+    // centers within reach of the query can hit it
+    float reach = radius + maxRadius;
+    glm::ivec3 first(glm::floor((center - reach) / cellSize));
+    glm::ivec3 last(glm::floor((center + reach) / cellSize));
+    glm::vec3 range = glm::vec3(last - first) + 1.0f;
+    // a query wider than the occupied cells walks them instead of looking up every cell in range
+    if (range.x * range.y * range.z > (float)cells.size())
+    {
+        for (const Cell& cell : cells)
+            if (glm::all(glm::greaterThanEqual(cell.Coordinates, first)) && glm::all(glm::lessThanEqual(cell.Coordinates, last)))
+                testCell(cell, center, radius, objects);
+        return;
+    }
+    for (int z = first.z; z <= last.z; z++)
+        for (int y = first.y; y <= last.y; y++)
+            for (int x = first.x; x <= last.x; x++)
+            {
+                int found = lookup.Find(cellKey(glm::ivec3(x, y, z)));
+                if (found >= 0)
+                    testCell(cells[found], center, radius, objects);
+            }
+}
+
+void HashedGrid::removeEntry(int cell, unsigned int slot)
+{
+    std::vector<Entry>& entries = cells[cell].Entries;
+    if (slot + 1 != entries.size())
+    {
+        entries[slot] = entries.back();
+        locations[entries[slot].Object].Slot = slot;
+    }
+    entries.pop_back();
+    if (!entries.empty())
+        return;
+
+    // the last cell takes the empty one's place
+    lookup.Erase(cellKey(cells[cell].Coordinates));
+    spareEntries.push_back(std::move(entries));
+    if (cell != (int)cells.size() - 1)
+    {
+        cells[cell] = std::move(cells.back());
+        lookup.Insert(cellKey(cells[cell].Coordinates), cell);
+        for (const Entry& entry : cells[cell].Entries)
+            locations[entry.Object].Cell = cell;
+    }
+    cells.pop_back();
+}
+
+void HashedGrid::testCell(const Cell& cell, const glm::vec3& center, float radius, std::vector<unsigned int>& objects) const
+{
+    for (const Entry& entry : cell.Entries)
+    {
+        glm::vec3 offset = entry.Center - center;
+        float reach = entry.Radius + radius;
+        if (glm::dot(offset, offset) <= reach * reach)
+            objects.push_back(entry.Object);
+    }
+}
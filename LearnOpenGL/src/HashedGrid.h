@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include "CellMap.h"
+
+// Sparse uniform grid over object bounding spheres, the flat alternative to LooseOctree. an object is in the cell
+// holding its center, cells exist only while they hold something and are found through a hash of their coordinates.
+// queries widen cells by the largest radius seen, so cellSize works best around the typical object diameter or a
+// few times it; a few huge objects make every query look further
+class HashedGrid
+{
+public:
+    explicit HashedGrid(float cellSize);
+
+    // adds object or moves it when it is already in. objects are indices, storage grows to the largest one
+    void Update(unsigned int object, const glm::vec3& center, float radius);
+    void Remove(unsigned int object);
+    void Clear();
+
+    // appends the objects whose sphere is at least partly inside all planes, planes as ClusterCuller::ExtractFrustumPlanes
+    void QueryFrustum(const glm::vec4 planes[6], std::vector<unsigned int>& objects) const;
+    // appends the objects whose sphere overlaps the sphere of radius around center
+    void QuerySphere(const glm::vec3& center, float radius, std::vector<unsigned int>& objects) const;
+
+    float GetCellSize() const { return cellSize; }
+    size_t GetCellCount() const { return cells.size(); }
+    size_t GetObjectCount() const { return objectCount; }
+    // Update() calls that moved an object to another cell, the ones that cost more than a write
+    unsigned int CellChanges = 0;
+
+private:
+    struct Entry
+    {
+        glm::vec3 Center;
+        float Radius;
+        unsigned int Object;
+    };
+
+    struct Cell
+    {
+        glm::ivec3 Coordinates;
+        // largest radius the cell held since it was created, its entries are within this of the cell
+        float MaxRadius;
+        std::vector<Entry> Entries;
+    };
+
+    // where an object's entry is, Cell is -1 for objects that are not in. Key is the cell's, an object that stays
+    // in its cell is found without the hash
+    struct Location
+    {
+        int Cell = -1;
+        unsigned int Slot = 0;
+        uint64_t Key = 0;
+    };
+
+    float cellSize;
+    float inverseCellSize;
+    float maxRadius = 0.0f;
+    // occupied cells only, frustum queries walk all of them
+    std::vector<Cell> cells;
+    CellMap lookup;
+    // entry arrays of removed cells, new cells take them instead of allocating
+    std::vector<std::vector<Entry>> spareEntries;
+    std::vector<Location> locations;
+    size_t objectCount = 0;
+
+    // removes the entry in slot of cell and the cell when it empties
+    void removeEntry(int cell, unsigned int slot);
+    void testCell(const Cell& cell, const glm::vec3& center, float radius, std::vector<unsigned int>& objects) const;
+};
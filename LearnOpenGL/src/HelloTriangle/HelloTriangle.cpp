@@ -2,8 +2,12 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
+#include <vector>
 #include "HelloTriangle.h"
-#include "../Shader.h"
+#include "../ShaderPermutations.h"
+#include "../GLExtensions.h"
+#include "../ShaderWatcher.h"
+#include "../VertexFormat.h"
 
 namespace HelloTriangle
 {
@@ -43,9 +47,15 @@ namespace HelloTriangle
             std::cout << "Failed to initialize GLAD" << std::endl;
             return -1;
         }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
 
-        Shader firstShader("shaders/VertexShaders/HelloTriangle.vs", "shaders/FragmentShaders/HelloTriangle1.fs");
-        Shader secondShader("shaders/VertexShaders/HelloTriangle.vs", "shaders/FragmentShaders/HelloTriangle2.fs");
+        // both triangles use the same sources, the gradient one is the VERTEX_COLOR permutation
+        ShaderPermutations shaders("shaders/VertexShaders/HelloTriangle.vs", "shaders/FragmentShaders/HelloTriangle.fs", { "VERTEX_COLOR" });
+        const unsigned int VERTEX_COLOR = shaders.Mask("VERTEX_COLOR");
+        shaders.Precompile({ VERTEX_COLOR, 0 });
+        // recompile on edits instead of restarting
+        ShaderWatcher shaderWatcher({ "shaders/VertexShaders", "shaders/FragmentShaders", "shaders/Common" });
+        shaderWatcher.Watch(shaders);
 
         // Set up vertex and indices data (and buffer(s)) and configure vertex attributes
         float firstTriangle[] = {
@@ -68,20 +78,18 @@ namespace HelloTriangle
         // bind the Vertex Array Oject first, then bind and set vertex buffer(s), and then configure vertex attribute(s)
         glBindVertexArray(VAOs[0]);
 
+        // the gradient colors as unorm8, 24 bytes per vertex instead of 48
+        VertexFormat firstFormat;
+        firstFormat.Add(0, AttributeFormat::Float3)
+            .Add(1, AttributeFormat::Unorm8x3)
+            .Add(2, AttributeFormat::Unorm8x3)
+            .Add(3, AttributeFormat::Unorm8x3);
+        std::vector<unsigned char> firstData = firstFormat.Encode(firstTriangle, 3);
+
         glBindBuffer(GL_ARRAY_BUFFER, VBOs[0]);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(firstTriangle), firstTriangle, GL_STATIC_DRAW);
-        // position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-        // color attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-        // color attribute
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
-        // color attribute
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(9 * sizeof(float)));
-        glEnableVertexAttribArray(3);
+        glBufferData(GL_ARRAY_BUFFER, firstData.size(), firstData.data(), GL_STATIC_DRAW);
+        // position attribute and the start, middle and end color attributes
+        firstFormat.Apply();
 
         glBindVertexArray(VAOs[1]);
 
@@ -96,6 +104,7 @@ namespace HelloTriangle
         {
             // input
             processInput(window);
+            shaderWatcher.Poll();
 
             // render
             glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
@@ -104,6 +113,7 @@ namespace HelloTriangle
             float time = glfwGetTime();
 
             // draw our first triangle
+            Shader& firstShader = shaders.Get(VERTEX_COLOR);
             firstShader.use();
             firstShader.setFloat("gradientValue", fmod(time, 3));
 
@@ -113,6 +123,7 @@ namespace HelloTriangle
             glDrawArrays(GL_TRIANGLES, 0, 3);
 
             // be sure to activate the shader
+            Shader& secondShader = shaders.Get(0);
             secondShader.use();
             // update the uniform color
             float sinValue = (sin(time) / 2.0f) + 0.5f;
@@ -132,6 +143,9 @@ namespace HelloTriangle
         glDeleteVertexArrays(2, VAOs);
         glDeleteBuffers(2, VBOs);
 
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
         // glfw: terminate, clearing all previously allocated GLFW resources.
         glfwTerminate();
         return 0;
@@ -0,0 +1,112 @@
+#include "Input.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+
+Input::Input(size_t capacity) : queue(capacity), keys(GLFW_KEY_LAST + 1, false), buttons(GLFW_MOUSE_BUTTON_LAST + 1, false)
+{
+}
+
+void Input::Attach(GLFWwindow* window)
+{
+    if (this->window)
+    {
+        glfwSetKeyCallback(this->window, NULL);
+        glfwSetMouseButtonCallback(this->window, NULL);
+        glfwSetCursorPosCallback(this->window, NULL);
+        glfwSetScrollCallback(this->window, NULL);
+        glfwSetWindowUserPointer(this->window, NULL);
+    }
+    this->window = window;
+    if (window)
+    {
+        glfwSetWindowUserPointer(window, this);
+        glfwSetKeyCallback(window, keyCallback);
+        glfwSetMouseButtonCallback(window, mouseButtonCallback);
+        glfwSetCursorPosCallback(window, cursorPositionCallback);
+        glfwSetScrollCallback(window, scrollCallback);
+    }
+}
+
+const std::vector<InputEvent>& Input::ProcessEvents()
+{
+    batch.clear();
+    queue.Drain(batch);
+    for (const InputEvent& event : batch)
+    {
+        // repeats keep a key down
+        if (event.Type == InputEventType::Key && event.Code >= 0 && event.Code < (int)keys.size())
+            keys[event.Code] = event.Action != GLFW_RELEASE;
+        if (event.Type == InputEventType::MouseButton && event.Code >= 0 && event.Code < (int)buttons.size())
+            buttons[event.Code] = event.Action != GLFW_RELEASE;
+    }
+    return batch;
+}
+
+bool Input::IsKeyDown(int key) const
+{
+    return key >= 0 && key < (int)keys.size() && keys[key];
+}
+
+bool Input::IsButtonDown(int button) const
+{
+    return button >= 0 && button < (int)buttons.size() && buttons[button];
+}
+
+void Input::Presented()
+{
+    if (batch.empty())
+        return;
+    double now = InputQueue::Now();
+    for (const InputEvent& event : batch)
+    {
+        double latency = now - event.Time;
+        sum += latency;
+        longest = std::max(longest, latency);
+    }
+    frames++;
+    events += (unsigned int)batch.size();
+}
+
+Input::LatencyReport Input::TakeLatencyReport()
+{
+    LatencyReport report;
+    report.Frames = frames;
+    report.Events = events;
+    if (events > 0)
+    {
+        report.MeanMilliseconds = sum / events * 1000.0;
+        report.MaxMilliseconds = longest * 1000.0;
+    }
+    report.Dropped = queue.GetDroppedCount();
+    frames = 0;
+    events = 0;
+    sum = 0.0;
+    longest = 0.0;
+    return report;
+}
+
+void Input::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    Input* input = (Input*)glfwGetWindowUserPointer(window);
+    input->queue.Push(InputEvent{ InputEventType::Key, key, action, mods, 0.0, 0.0, 0.0 });
+}
+
+void Input::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+    Input* input = (Input*)glfwGetWindowUserPointer(window);
+    input->queue.Push(InputEvent{ InputEventType::MouseButton, button, action, mods, 0.0, 0.0, 0.0 });
+}
+
+void Input::cursorPositionCallback(GLFWwindow* window, double x, double y)
+{
+    Input* input = (Input*)glfwGetWindowUserPointer(window);
+    input->queue.Push(InputEvent{ InputEventType::CursorPosition, 0, 0, 0, x, y, 0.0 });
+}
+
+void Input::scrollCallback(GLFWwindow* window, double x, double y)
+{
+    Input* input = (Input*)glfwGetWindowUserPointer(window);
+    input->queue.Push(InputEvent{ InputEventType::Scroll, 0, 0, 0, x, y, 0.0 });
+}
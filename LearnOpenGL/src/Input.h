@@ -0,0 +1,71 @@
+#pragma once
+
+#include "InputQueue.h"
+
+#include <vector>
+
+struct GLFWwindow;
+
+// The input of a window as a queue of events instead of callbacks that act right away and keys polled one by one:
+// the GLFW callbacks only push timestamped events, and ProcessEvents() at one chosen point of the frame takes all of
+// them at once and updates the key and button state. Presented() after the swap measures how long the events of the
+// frame waited from being queued until they reached the screen. the timestamps are taken in the callbacks, during
+// glfwPollEvents(), so the time the OS held the events before that is not included. events can come from an
+// InputReplay instead of the window.
+class Input
+{
+public:
+    // time events of the frames since the last TakeLatencyReport() waited until they were presented
+    struct LatencyReport
+    {
+        // frames that had events, and the events
+        unsigned int Frames = 0;
+        unsigned int Events = 0;
+        double MeanMilliseconds = 0.0;
+        double MaxMilliseconds = 0.0;
+        // dropped by a full queue, in total
+        size_t Dropped = 0;
+    };
+
+    explicit Input(size_t capacity = 4096);
+
+    Input(const Input&) = delete;
+    Input& operator=(const Input&) = delete;
+
+    // routes the window's key, mouse button, cursor position and scroll callbacks into the queue, through its user
+    // pointer. nullptr detaches; an Input has to be detached or outlive the window
+    void Attach(GLFWwindow* window);
+
+    // where replayed events go
+    InputQueue& GetQueue() { return queue; }
+
+    // the batch point: drains the queue and updates the key and button state, returns the events in order. valid
+    // until the next call
+    const std::vector<InputEvent>& ProcessEvents();
+
+    // key and mouse button state as of the last ProcessEvents()
+    bool IsKeyDown(int key) const;
+    bool IsButtonDown(int button) const;
+
+    // right after the frame that used the events of the last ProcessEvents() was presented
+    void Presented();
+    LatencyReport TakeLatencyReport();
+
+private:
+    InputQueue queue;
+    std::vector<InputEvent> batch;
+    std::vector<bool> keys;
+    std::vector<bool> buttons;
+    GLFWwindow* window = nullptr;
+
+    // for the report
+    unsigned int frames = 0;
+    unsigned int events = 0;
+    double sum = 0.0;
+    double longest = 0.0;
+
+    static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+    static void cursorPositionCallback(GLFWwindow* window, double x, double y);
+    static void scrollCallback(GLFWwindow* window, double x, double y);
+};
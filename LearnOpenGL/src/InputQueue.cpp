@@ -0,0 +1,62 @@
+#include "InputQueue.h"
+
+#include <chrono>
+
+InputQueue::InputQueue(size_t capacity) : head(0), tail(0), dropped(0)
+{
+    size_t size = 1;
+    while (size < capacity)
+        size *= 2;
+    ring.resize(size);
+    mask = size - 1;
+}
+
+bool InputQueue::Push(InputEvent event, bool stamp)
+{
+    size_t write = head.load(std::memory_order_relaxed);
+    // the consumer's progress is acquired, so the slot it freed is really done being read
+    if (IsFull())
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (stamp)
+        event.Time = Now();
+    ring[write & mask] = event;
+    // released so the consumer sees the event once it sees the new head
+    head.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+size_t InputQueue::Drain(std::vector<InputEvent>& events)
+{
+    size_t read = tail.load(std::memory_order_relaxed);
+    size_t write = head.load(std::memory_order_acquire);
+    for (size_t i = read; i != write; i++)
+        events.push_back(ring[i & mask]);
+    tail.store(write, std::memory_order_release);
+    return write - read;
+}
+
+double InputQueue::Now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void InputReplay::Add(unsigned int frame, const InputEvent& event)
+{
+    entries.push_back(Entry{ frame, event });
+}
+
+size_t InputReplay::Feed(InputQueue& queue, unsigned int frame)
+{
+    size_t pushed = 0;
+    double now = InputQueue::Now();
+    for (; next < entries.size() && entries[next].Frame <= frame && !queue.IsFull(); next++, pushed++)
+    {
+        InputEvent event = entries[next].Event;
+        event.Time = now;
+        queue.Push(event, false);
+    }
+    return pushed;
+}
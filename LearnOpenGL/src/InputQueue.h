@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+enum class InputEventType : unsigned char
+{
+    Key,
+    MouseButton,
+    CursorPosition,
+    Scroll
+};
+
+// One input event as GLFW reports it, stamped when it was queued
+struct InputEvent
+{
+    InputEventType Type;
+    // GLFW_KEY_* or GLFW_MOUSE_BUTTON_*, GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT, and GLFW_MOD_* bits
+    int Code;
+    int Action;
+    int Mods;
+    // the cursor position or the scroll offsets
+    double X;
+    double Y;
+    // InputQueue::Now() when it was pushed
+    double Time;
+};
+
+// A fixed size ring of input events between one thread that pushes them, the GLFW callbacks or a replay, and one
+// that drains them once per frame. neither side takes a lock or allocates: each only writes its own index, and the
+// other one reads it with acquire/release ordering. a full ring drops new events and counts them.
+class InputQueue
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit InputQueue(size_t capacity = 4096);
+
+    InputQueue(const InputQueue&) = delete;
+    InputQueue& operator=(const InputQueue&) = delete;
+
+    // producer side. stamps event with Now() unless stamp is false, returns false if the ring is full
+    bool Push(InputEvent event, bool stamp = true);
+
+    // consumer side. appends every queued event to events in the order they were pushed, returns how many
+    size_t Drain(std::vector<InputEvent>& events);
+
+    // producer side, whether the next Push() would fail
+    bool IsFull() const { return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire) == ring.size(); }
+
+    size_t GetCapacity() const { return ring.size(); }
+    size_t GetDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+    // seconds on the clock the events are stamped with
+    static double Now();
+
+private:
+    std::vector<InputEvent> ring;
+    size_t mask;
+    // the next slot to write, written by the producer only, and the next to read, by the consumer only. apart so the
+    // two threads don't share a cache line
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    alignas(64) std::atomic<size_t> dropped;
+};
+
+// Recorded or generated events handed to a queue frame by frame in place of a window, so the code that consumes
+// input runs the same without anyone at the keyboard, e.g. in headless benchmarks
+class InputReplay
+{
+public:
+    // frames must not decrease from one call to the next
+    void Add(unsigned int frame, const InputEvent& event);
+
+    // pushes the events up to and including frame that haven't been pushed yet, stamped now, returns how many.
+    // stops early if the queue is full and carries on from there next time
+    size_t Feed(InputQueue& queue, unsigned int frame);
+
+    // starts from the first event again
+    void Rewind() { next = 0; }
+    bool IsFinished() const { return next == entries.size(); }
+    // one past the last frame with events
+    unsigned int GetFrameCount() const { return entries.empty() ? 0 : entries.back().Frame + 1; }
+    size_t GetEventCount() const { return entries.size(); }
+
+private:
+    struct Entry
+    {
+        unsigned int Frame;
+        InputEvent Event;
+    };
+    std::vector<Entry> entries;
+    size_t next = 0;
+};
@@ -0,0 +1,134 @@
+#include "InputRecording.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    const char MAGIC[8] = { 'L', 'O', 'G', 'L', 'I', 'N', 'P', 'T' };
+    const uint32_t VERSION = 1;
+
+    // the bytes of an event in the file: type, code, action and mods, then the two doubles
+    const size_t EVENT_BYTES = 1 + 2 + 1 + 1 + 2 * sizeof(double);
+
+    template<typename T>
+    void write(std::vector<unsigned char>& out, T value)
+    {
+        const unsigned char* bytes = (const unsigned char*)&value;
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<typename T>
+    T read(const unsigned char*& in)
+    {
+        T value;
+        memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+}
+
+void InputRecording::BeginFrame(double seconds)
+{
+    frames.push_back(Frame{ seconds, (unsigned int)events.size(), 0 });
+}
+
+void InputRecording::Add(const InputEvent& event)
+{
+    if (frames.empty())
+        BeginFrame(0.0);
+    events.push_back(event);
+    frames.back().EventCount++;
+}
+
+void InputRecording::Clear()
+{
+    frames.clear();
+    events.clear();
+}
+
+bool InputRecording::Save(const std::string& path) const
+{
+    std::vector<unsigned char> out(MAGIC, MAGIC + sizeof(MAGIC));
+    write<uint32_t>(out, VERSION);
+    write<uint32_t>(out, (uint32_t)frames.size());
+    out.reserve(out.size() + frames.size() * (sizeof(double) + sizeof(uint32_t)) + events.size() * EVENT_BYTES);
+    for (const Frame& frame : frames)
+    {
+        write<double>(out, frame.Seconds);
+        write<uint32_t>(out, frame.EventCount);
+        for (unsigned int i = frame.FirstEvent; i < frame.FirstEvent + frame.EventCount; i++)
+        {
+            const InputEvent& event = events[i];
+            write<uint8_t>(out, (uint8_t)event.Type);
+            // key codes go up to 348, actions to 2 and the mods fit a byte
+            write<int16_t>(out, (int16_t)event.Code);
+            write<uint8_t>(out, (uint8_t)event.Action);
+            write<uint8_t>(out, (uint8_t)event.Mods);
+            write<double>(out, event.X);
+            write<double>(out, event.Y);
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    file.write((const char*)out.data(), out.size());
+    return (bool)file;
+}
+
+bool InputRecording::Load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const size_t headerBytes = sizeof(MAGIC) + 2 * sizeof(uint32_t);
+    if (data.size() < headerBytes || memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0)
+        return false;
+    const unsigned char* in = data.data() + sizeof(MAGIC);
+    const unsigned char* end = data.data() + data.size();
+    if (read<uint32_t>(in) != VERSION)
+        return false;
+    uint32_t frameCount = read<uint32_t>(in);
+    // every frame takes at least its time and event count, a larger count is not a recording
+    if ((size_t)(end - in) / (sizeof(double) + sizeof(uint32_t)) < frameCount)
+        return false;
+
+    std::vector<Frame> loadedFrames;
+    std::vector<InputEvent> loadedEvents;
+    loadedFrames.reserve(frameCount);
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        if ((size_t)(end - in) < sizeof(double) + sizeof(uint32_t))
+            return false;
+        double seconds = read<double>(in);
+        uint32_t eventCount = read<uint32_t>(in);
+        if ((size_t)(end - in) / EVENT_BYTES < eventCount)
+            return false;
+        loadedFrames.push_back(Frame{ seconds, (unsigned int)loadedEvents.size(), eventCount });
+        for (uint32_t i = 0; i < eventCount; i++)
+        {
+            InputEvent event;
+            event.Type = (InputEventType)read<uint8_t>(in);
+            event.Code = read<int16_t>(in);
+            event.Action = read<uint8_t>(in);
+            event.Mods = read<uint8_t>(in);
+            event.X = read<double>(in);
+            event.Y = read<double>(in);
+            event.Time = 0.0;
+            loadedEvents.push_back(event);
+        }
+    }
+    frames.swap(loadedFrames);
+    events.swap(loadedEvents);
+    return true;
+}
+
+void InputRecording::FillReplay(InputReplay& replay) const
+{
+    for (unsigned int frame = 0; frame < frames.size(); frame++)
+        for (unsigned int i = frames[frame].FirstEvent; i < frames[frame].FirstEvent + frames[frame].EventCount; i++)
+            replay.Add(frame, events[i]);
+}
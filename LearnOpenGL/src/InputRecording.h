@@ -0,0 +1,42 @@
+#pragma once
+
+#include "InputQueue.h"
+
+#include <string>
+#include <vector>
+
+// The input of a run frame by frame, with each frame's length, so a replay feeds the same events into the same
+// frames and steps the simulation by the same times as the recorded run. saved as a small binary file: a header,
+// then per frame its length as a double and its events, 21 bytes each without timestamps, which a replay sets anew.
+// the numbers are written in the byte order of the machine, which every target of this project shares.
+class InputRecording
+{
+public:
+    struct Frame
+    {
+        double Seconds;
+        unsigned int FirstEvent;
+        unsigned int EventCount;
+    };
+
+    // starts a frame of the given length, the events added next belong to it
+    void BeginFrame(double seconds);
+    void Add(const InputEvent& event);
+    void Clear();
+
+    bool Save(const std::string& path) const;
+    // replaces the contents, false if the file is missing or not a recording
+    bool Load(const std::string& path);
+
+    unsigned int GetFrameCount() const { return (unsigned int)frames.size(); }
+    const Frame& GetFrame(unsigned int frame) const { return frames[frame]; }
+    const InputEvent& GetEvent(unsigned int event) const { return events[event]; }
+    size_t GetEventCount() const { return events.size(); }
+
+    // every event into replay, under its frame's number
+    void FillReplay(InputReplay& replay) const;
+
+private:
+    std::vector<Frame> frames;
+    std::vector<InputEvent> events;
+};
@@ -0,0 +1,312 @@
+#include "Json.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    // nesting deeper than this is treated as malformed instead of overflowing the stack
+    const int MAX_DEPTH = 256;
+
+    int hexDigit(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    // writes code point as UTF-8 at out, returns the byte count
+    int encodeUtf8(unsigned int codePoint, char* out)
+    {
+        if (codePoint < 0x80)
+        {
+            out[0] = (char)codePoint;
+            return 1;
+        }
+        if (codePoint < 0x800)
+        {
+            out[0] = (char)(0xC0 | (codePoint >> 6));
+            out[1] = (char)(0x80 | (codePoint & 0x3F));
+            return 2;
+        }
+        if (codePoint < 0x10000)
+        {
+            out[0] = (char)(0xE0 | (codePoint >> 12));
+            out[1] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+            out[2] = (char)(0x80 | (codePoint & 0x3F));
+            return 3;
+        }
+        out[0] = (char)(0xF0 | (codePoint >> 18));
+        out[1] = (char)(0x80 | ((codePoint >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (codePoint & 0x3F));
+        return 4;
+    }
+}
+
+const JsonValue JsonValue::null;
+
+const JsonValue& JsonValue::operator[](size_t index) const
+{
+    return index < Size() ? items[index] : null;
+}
+
+const JsonValue& JsonValue::operator[](const char* name) const
+{
+    if (type != OBJECT)
+        return null;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (strcmp(items[i].key, name) == 0)
+            return items[i];
+    }
+    return null;
+}
+
+bool JsonDocument::Parse(char* text, size_t length)
+{
+    root = JsonValue();
+    error.clear();
+    blocks.clear();
+    blockUsed = BLOCK_SIZE;
+    stack.clear();
+    begin = cursor = text;
+    end = text + length;
+
+    if (!parseValue(root, 0))
+    {
+        root = JsonValue();
+        return false;
+    }
+    skipWhitespace();
+    if (cursor != end)
+        return fail("trailing characters");
+    return true;
+}
+
+JsonValue* JsonDocument::allocate(size_t count)
+{
+    if (count == 0)
+        return NULL;
+    // large arrays get a block of their own, the shared block keeps filling
+    if (count > BLOCK_SIZE / 4)
+    {
+        blocks.insert(blocks.begin(), std::unique_ptr<JsonValue[]>(new JsonValue[count]));
+        return blocks.front().get();
+    }
+    if (blockUsed + count > BLOCK_SIZE)
+    {
+        blocks.push_back(std::unique_ptr<JsonValue[]>(new JsonValue[BLOCK_SIZE]));
+        blockUsed = 0;
+    }
+    JsonValue* result = blocks.back().get() + blockUsed;
+    blockUsed += count;
+    return result;
+}
+
+void JsonDocument::skipWhitespace()
+{
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r'))
+        cursor++;
+}
+
+bool JsonDocument::fail(const char* message)
+{
+    if (error.empty())
+        error = std::string(message) + " at offset " + std::to_string(cursor - begin);
+    return false;
+}
+
+bool JsonDocument::parseValue(JsonValue& value, int depth)
+{
+    skipWhitespace();
+    if (cursor >= end)
+        return fail("unexpected end of input");
+
+    switch (*cursor)
+    {
+    case '{':
+        return parseContainer(value, true, depth);
+    case '[':
+        return parseContainer(value, false, depth);
+    case '"':
+        value.type = JsonValue::STRING;
+        return parseString(value.string);
+    case 't':
+        if (end - cursor < 4 || strncmp(cursor, "true", 4) != 0)
+            return fail("invalid literal");
+        cursor += 4;
+        value.type = JsonValue::BOOLEAN;
+        value.boolean = true;
+        return true;
+    case 'f':
+        if (end - cursor < 5 || strncmp(cursor, "false", 5) != 0)
+            return fail("invalid literal");
+        cursor += 5;
+        value.type = JsonValue::BOOLEAN;
+        value.boolean = false;
+        return true;
+    case 'n':
+        if (end - cursor < 4 || strncmp(cursor, "null", 4) != 0)
+            return fail("invalid literal");
+        cursor += 4;
+        value.type = JsonValue::NUL;
+        return true;
+    default:
+    {
+        char* numberEnd = cursor;
+        while (numberEnd < end && ((*numberEnd && strchr("+-.eE", *numberEnd)) || (*numberEnd >= '0' && *numberEnd <= '9')))
+            numberEnd++;
+        if (numberEnd == cursor)
+            return fail("unexpected character");
+        // strtod needs a terminator and the text may end right after the number, so it parses a terminated copy
+        size_t length = numberEnd - cursor;
+        char shortNumber[64];
+        std::string longNumber;
+        const char* number = shortNumber;
+        if (length < sizeof(shortNumber))
+        {
+            memcpy(shortNumber, cursor, length);
+            shortNumber[length] = 0;
+        }
+        else
+        {
+            longNumber.assign(cursor, numberEnd);
+            number = longNumber.c_str();
+        }
+        char* parsed;
+        value.type = JsonValue::NUMBER;
+        value.number = strtod(number, &parsed);
+        if (parsed != number + length)
+            return fail("invalid number");
+        cursor = numberEnd;
+        return true;
+    }
+    }
+}
+
+bool JsonDocument::parseString(const char*& result)
+{
+    // unescaping only ever shrinks the string, so it is written over itself and terminated where it ends
+    char* out = ++cursor;
+    result = out;
+    while (cursor < end)
+    {
+        char c = *cursor++;
+        if (c == '"')
+        {
+            *out = 0;
+            return true;
+        }
+        if (c != '\\')
+        {
+            *out++ = c;
+            continue;
+        }
+        if (cursor >= end)
+            break;
+        switch (*cursor++)
+        {
+        case '"': *out++ = '"'; break;
+        case '\\': *out++ = '\\'; break;
+        case '/': *out++ = '/'; break;
+        case 'b': *out++ = '\b'; break;
+        case 'f': *out++ = '\f'; break;
+        case 'n': *out++ = '\n'; break;
+        case 'r': *out++ = '\r'; break;
+        case 't': *out++ = '\t'; break;
+        case 'u':
+        {
+            unsigned int codePoint = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                int digit = cursor < end ? hexDigit(*cursor++) : -1;
+                if (digit < 0)
+                    return fail("invalid \\u escape");
+                codePoint = codePoint << 4 | digit;
+            }
+            // a surrogate pair is two escapes, 12 characters for 4 bytes of UTF-8
+            if (codePoint >= 0xD800 && codePoint < 0xDC00 && end - cursor >= 6 && cursor[0] == '\\' && cursor[1] == 'u')
+            {
+                unsigned int low = 0;
+                bool valid = true;
+                for (int i = 2; i < 6; i++)
+                {
+                    int digit = hexDigit(cursor[i]);
+                    valid = valid && digit >= 0;
+                    low = low << 4 | (digit & 0xF);
+                }
+                if (valid && low >= 0xDC00 && low < 0xE000)
+                {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    cursor += 6;
+                }
+            }
+            out += encodeUtf8(codePoint, out);
+            break;
+        }
+        default:
+            return fail("invalid escape");
+        }
+    }
+    return fail("unterminated string");
+}
+
+bool JsonDocument::parseContainer(JsonValue& value, bool object, int depth)
+{
+    if (depth >= MAX_DEPTH)
+        return fail("nesting too deep");
+    char close = object ? '}' : ']';
+    cursor++;
+    size_t mark = stack.size();
+
+    skipWhitespace();
+    if (cursor < end && *cursor == close)
+        cursor++;
+    else
+    {
+        while (true)
+        {
+            JsonValue item;
+            if (object)
+            {
+                skipWhitespace();
+                if (cursor >= end || *cursor != '"')
+                    return fail("expected member name");
+                if (!parseString(item.key))
+                    return false;
+                skipWhitespace();
+                if (cursor >= end || *cursor != ':')
+                    return fail("expected ':'");
+                cursor++;
+            }
+            if (!parseValue(item, depth + 1))
+                return false;
+            stack.push_back(item);
+
+            skipWhitespace();
+            if (cursor < end && *cursor == ',')
+            {
+                cursor++;
+                continue;
+            }
+            if (cursor < end && *cursor == close)
+            {
+                cursor++;
+                break;
+            }
+            return fail(object ? "expected ',' or '}'" : "expected ',' or ']'");
+        }
+    }
+
+    value.type = object ? JsonValue::OBJECT : JsonValue::ARRAY;
+    value.count = stack.size() - mark;
+    value.items = allocate(value.count);
+    std::copy(stack.begin() + mark, stack.end(), value.items);
+    stack.resize(mark);
+    return true;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A parsed JSON value. strings point into the text given to JsonDocument::Parse and children live in the
+// document, so values are only valid while both are alive. lookups never fail: a missing member or an
+// out of range index returns a null value, and the As* accessors return the fallback on a type mismatch.
+class JsonValue
+{
+public:
+    enum Type
+    {
+        NUL,
+        BOOLEAN,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+
+    Type GetType() const { return type; }
+    bool IsNull() const { return type == NUL; }
+    bool IsNumber() const { return type == NUMBER; }
+    bool IsString() const { return type == STRING; }
+    bool IsArray() const { return type == ARRAY; }
+    bool IsObject() const { return type == OBJECT; }
+
+    bool AsBool(bool fallback = false) const { return type == BOOLEAN ? boolean : fallback; }
+    double AsNumber(double fallback = 0.0) const { return type == NUMBER ? number : fallback; }
+    int AsInt(int fallback = 0) const { return type == NUMBER ? (int)number : fallback; }
+    const char* AsString(const char* fallback = "") const { return type == STRING ? string : fallback; }
+
+    // elements of an array or members of an object, 0 for anything else
+    size_t Size() const { return type == ARRAY || type == OBJECT ? count : 0; }
+    // element of an array or member of an object by position
+    const JsonValue& operator[](size_t index) const;
+    const JsonValue& operator[](int index) const { return (*this)[(size_t)index]; }
+    // member of an object, linear search (glTF objects have a handful of members)
+    const JsonValue& operator[](const char* key) const;
+    bool Has(const char* key) const { return !(*this)[key].IsNull(); }
+    // name of the member at index in an object
+    const char* KeyAt(size_t index) const { return index < Size() ? items[index].key : ""; }
+
+private:
+    friend class JsonDocument;
+
+    Type type = NUL;
+    const char* key = "";
+    union
+    {
+        bool boolean;
+        double number = 0.0;
+        const char* string;
+        JsonValue* items;
+    };
+    size_t count = 0;
+
+    static const JsonValue null;
+};
+
+// In-situ JSON parser: strings are unescaped inside the caller's buffer instead of being copied, and the values
+// of each array/object are stored contiguously in large blocks, so a parse does few allocations.
+class JsonDocument
+{
+public:
+    // parses length bytes of text, which is modified and must outlive the document. returns false on malformed
+    // input, GetError() tells where
+    bool Parse(char* text, size_t length);
+
+    const JsonValue& Root() const { return root; }
+    const std::string& GetError() const { return error; }
+
+private:
+    static const size_t BLOCK_SIZE = 4096;
+
+    JsonValue root;
+    std::string error;
+    std::vector<std::unique_ptr<JsonValue[]>> blocks;
+    size_t blockUsed = BLOCK_SIZE;
+    // children of the containers being parsed, moved into a block when their container closes
+    std::vector<JsonValue> stack;
+
+    char* cursor = NULL;
+    char* end = NULL;
+    char* begin = NULL;
+
+    JsonValue* allocate(size_t count);
+    bool parseValue(JsonValue& value, int depth);
+    bool parseString(const char*& result);
+    bool parseContainer(JsonValue& value, bool object, int depth);
+    void skipWhitespace();
+    bool fail(const char* message);
+};
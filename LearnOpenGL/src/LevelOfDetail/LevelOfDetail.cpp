@@ -0,0 +1,280 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "LevelOfDetail.h"
+#include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../Camera.h"
+#include "../MeshLod.h"
+#include "../RenderStats.h"
+#include "../VertexFormat.h"
+
+namespace LevelOfDetail
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // TILES x TILES copies of one GRID x GRID height field
+    const int GRID = 256;
+    const int TILES = 12;
+    const float TILE_SIZE = 10.0f;
+
+    // a level is drawn once its error covers at most this many pixels
+    const float PIXEL_THRESHOLD = 1.0f;
+    const float HYSTERESIS = 0.25f;
+
+    // switched with the 1/2 keys
+    bool useLod = true;
+
+    // the fly-through advances by a fixed step per frame, so both modes see the same camera path
+    const float SCRIPT_STEP = 1.0f / 60.0f;
+    // circle of FLIGHT_RADIUS around the center at FLIGHT_SPEED units per second
+    const float FLIGHT_RADIUS = 40.0f;
+    const float FLIGHT_SPEED = 6.0f;
+
+    // tint of every level, so the switches can be seen
+    const glm::vec4 LEVEL_TINTS[MeshLod::MAX_LEVELS] = {
+        glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), glm::vec4(0.6f, 1.0f, 0.6f, 1.0f), glm::vec4(0.6f, 0.6f, 1.0f, 1.0f), glm::vec4(1.0f, 1.0f, 0.5f, 1.0f),
+        glm::vec4(1.0f, 0.6f, 1.0f, 1.0f), glm::vec4(0.5f, 1.0f, 1.0f, 1.0f), glm::vec4(1.0f, 0.7f, 0.4f, 1.0f), glm::vec4(1.0f, 0.4f, 0.4f, 1.0f)
+    };
+
+    // camera
+    Camera camera(glm::vec3(-FLIGHT_RADIUS, 3.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), YAW, -15.0f);
+
+    struct Vertex
+    {
+        glm::vec3 Position;
+        glm::vec3 Normal;
+        glm::vec2 TexCoord;
+    };
+
+    // a bumpy height field, bumpier in one corner so the simplifier has flat and detailed parts to tell apart
+    void buildHeightField(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+    {
+        vertices.resize((size_t)GRID * GRID);
+        auto height = [](float x, float z)
+        {
+            float detail = glm::smoothstep(-5.0f, 5.0f, x + z);
+            return 0.6f * sin(x * 0.8f) * cos(z * 0.6f) + detail * 0.15f * sin(x * 5.0f) * sin(z * 4.0f);
+        };
+        for (int y = 0; y < GRID; y++)
+            for (int x = 0; x < GRID; x++)
+            {
+                float u = (float)x / (GRID - 1), v = (float)y / (GRID - 1);
+                float px = (u - 0.5f) * TILE_SIZE, pz = (v - 0.5f) * TILE_SIZE;
+                Vertex& vertex = vertices[(size_t)y * GRID + x];
+                vertex.Position = glm::vec3(px, height(px, pz), pz);
+                // central differences for the normal
+                float step = TILE_SIZE / (GRID - 1);
+                float dx = (height(px + step, pz) - height(px - step, pz)) / (2.0f * step);
+                float dz = (height(px, pz + step) - height(px, pz - step)) / (2.0f * step);
+                vertex.Normal = glm::normalize(glm::vec3(-dx, 1.0f, -dz));
+                vertex.TexCoord = glm::vec2(u, v);
+            }
+        indices.clear();
+        for (int y = 0; y + 1 < GRID; y++)
+            for (int x = 0; x + 1 < GRID; x++)
+            {
+                unsigned int i = y * GRID + x;
+                indices.insert(indices.end(), { i, i + GRID, i + 1, i + 1, i + GRID, i + GRID + 1 });
+            }
+    }
+
+    int Main()
+    {
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        Shader shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs");
+
+        // the chain is built at startup here, the same call works offline with the result saved next to the mesh
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        buildHeightField(vertices, indices);
+        MeshLod lod;
+        lod.Build(indices, &vertices[0].Position.x, sizeof(Vertex), vertices.size(), &vertices[0].Normal.x, sizeof(Vertex), 5);
+        printf("built %zu levels in %.1f ms\n", lod.Levels.size(), lod.BuildSeconds * 1000.0);
+        for (size_t l = 0; l < lod.Levels.size(); l++)
+            printf("  level %zu: %7u triangles, error %.5f\n", l, lod.Levels[l].IndexCount / 3, lod.Levels[l].Error);
+
+        VertexFormat format;
+        format.Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+        unsigned int VAO, VBO, EBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        // every level in one index buffer
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, lod.Indices.size() * sizeof(unsigned int), lod.Indices.data(), GL_STATIC_DRAW);
+        format.Apply();
+
+        // untextured, the level tints only color a white texel
+        unsigned int whiteTexture;
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        shader.use();
+        shader.setInt("baseColor", 0);
+        shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+
+        // level drawn last frame per tile, for the hysteresis
+        std::vector<int> tileLevels(TILES * TILES, -1);
+        const unsigned int fullTriangles = lod.Levels[0].IndexCount / 3 * TILES * TILES;
+
+        // render loop
+        float scriptTime = 0.0f;
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        double reportTriangles = 0.0;
+        unsigned int reportSwitches = 0;
+        unsigned int reportLevels[MeshLod::MAX_LEVELS] = {};
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            processInput(window);
+
+            // fly a circle around the center, bobbing up and down
+            camera.ProcessMouseMovement(FLIGHT_SPEED * SCRIPT_STEP / FLIGHT_RADIUS * glm::degrees(1.0f) / camera.MouseSensitivity, 0.0f);
+            camera.ProcessKeyboard(FORWARD, SCRIPT_STEP * FLIGHT_SPEED / camera.MovementSpeed);
+            camera.Position.y = 2.5f + 1.5f * sin(scriptTime * 0.4f);
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            shader.setMat4("projection", glm::perspective(glm::radians(camera.Zoom), (float)width / (float)std::max(height, 1), 0.1f, 500.0f));
+            shader.setMat4("view", camera.GetViewMatrix());
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            glBindVertexArray(VAO);
+            for (int tile = 0; tile < TILES * TILES; tile++)
+            {
+                glm::vec3 offset((tile % TILES - (TILES - 1) * 0.5f) * TILE_SIZE, 0.0f, (tile / TILES - (TILES - 1) * 0.5f) * TILE_SIZE);
+                int level = 0;
+                if (useLod)
+                {
+                    level = lod.Select(lod.Distance(camera.Position, offset), camera.Zoom, (float)height, PIXEL_THRESHOLD, tileLevels[tile], HYSTERESIS);
+                    if (tileLevels[tile] >= 0 && level != tileLevels[tile])
+                        reportSwitches++;
+                    tileLevels[tile] = level;
+                }
+                else
+                    tileLevels[tile] = -1;
+                const LodLevel& range = lod.Levels[level];
+                shader.setMat4("model", glm::translate(glm::mat4(1.0f), offset));
+                shader.setVec4("baseColorFactor", LEVEL_TINTS[level]);
+                glDrawElements(GL_TRIANGLES, range.IndexCount, GL_UNSIGNED_INT, (void*)(range.FirstIndex * sizeof(unsigned int)));
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += range.IndexCount / 3;
+                reportLevels[level]++;
+            }
+
+            RenderStats::EndFrame();
+            reportTriangles += RenderStats::Last.Triangles;
+            reportFrames++;
+            scriptTime += SCRIPT_STEP;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                double triangles = reportTriangles / reportFrames;
+                printf("%-11s triangles/frame %9.0f of %u full detail (%5.1f%%), %3u switches/s, frame %6.3f ms, tiles per level:",
+                    useLod ? "lod" : "full detail", triangles, fullTriangles, triangles * 100.0 / fullTriangles,
+                    (unsigned int)(reportSwitches / (now - reportStart)), (now - reportStart) * 1000.0 / reportFrames);
+                for (size_t l = 0; l < lod.Levels.size(); l++)
+                    printf(" %5.1f", (double)reportLevels[l] / reportFrames);
+                printf("\n");
+                reportStart = now;
+                reportFrames = 0;
+                reportTriangles = 0.0;
+                reportSwitches = 0;
+                std::fill(reportLevels, reportLevels + MeshLod::MAX_LEVELS, 0);
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        glDeleteTextures(1, &whiteTexture);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            useLod = false;
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+            useLod = true;
+    }
+}
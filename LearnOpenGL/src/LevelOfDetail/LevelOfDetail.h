@@ -0,0 +1,4 @@
+namespace LevelOfDetail
+{
+    int Main();
+};
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "LooseOctree.h"
+#include <algorithm>
+
+namespace
+{
+    // a node pushes at most seven children more than it pops, once per level
+    const int STACK_SIZE = LooseOctree::MAX_DEPTH * 7 + 9;
+
+    uint64_t nodeKey(unsigned int level, const glm::ivec3& cell)
+    {
+        return (uint64_t)level << 48 | (uint64_t)cell.x << 32 | (uint64_t)cell.y << 16 | (uint64_t)cell.z;
+    }
+
+    // 0 when the box is outside a plane, 2 when it is inside all of them, 1 otherwise
+    int classifyBox(const glm::vec3& min, const glm::vec3& max, const glm::vec4 planes[6])
+    {
+        int result = 2;
+        for (int p = 0; p < 6; p++)
+        {
+            glm::vec3 normal(planes[p]);
+            // the corners furthest along and against the plane normal
+            glm::vec3 farCorner(normal.x >= 0.0f ? max.x : min.x, normal.y >= 0.0f ? max.y : min.y, normal.z >= 0.0f ? max.z : min.z);
+            glm::vec3 nearCorner(normal.x >= 0.0f ? min.x : max.x, normal.y >= 0.0f ? min.y : max.y, normal.z >= 0.0f ? min.z : max.z);
+            if (glm::dot(normal, farCorner) + planes[p].w < 0.0f)
+                return 0;
+            if (glm::dot(normal, nearCorner) + planes[p].w < 0.0f)
+                result = 1;
+        }
+        return result;
+    }
+
+    bool sphereInside(const glm::vec3& center, float radius, const glm::vec4 planes[6])
+    {
+        for (int p = 0; p < 6; p++)
+            if (glm::dot(glm::vec3(planes[p]), center) + planes[p].w < -radius)
+                return false;
+        return true;
+    }
+
+    float boxDistanceSquared(const glm::vec3& min, const glm::vec3& max, const glm::vec3& point)
+    {
+        glm::vec3 outside = glm::max(glm::max(min - point, point - max), glm::vec3(0.0f));
+        return glm::dot(outside, outside);
+    }
+}
+
+// std::min takes it by reference
+constexpr unsigned int LooseOctree::MAX_DEPTH;
+
+LooseOctree::LooseOctree(const BoundingBox& bounds, unsigned int depth)
+    : origin(bounds.Min), rootSize(std::max(std::max(bounds.Extent().x, bounds.Extent().y), bounds.Extent().z)),
+      depth(std::min(depth, MAX_DEPTH))
+{
+    for (unsigned int level = 0; level <= MAX_DEPTH; level++)
+    {
+        cellSizes[level] = rootSize / (float)(1 << level);
+        inverseCellSizes[level] = 1.0f / cellSizes[level];
+    }
+    Clear();
+}
+
+void LooseOctree::Update(unsigned int object, const glm::vec3& center, float radius)
+{
+    // the deepest level whose cells are at least twice the radius wide
+    unsigned int level = depth;
+    while (level > 0 && cellSizes[level] < 2.0f * radius)
+        level--;
+    glm::ivec3 cell(0);
+    if (level > 0)
+    {
+        glm::vec3 local = glm::floor((center - origin) * inverseCellSizes[level]);
+        float cellCount = (float)(1 << level);
+        if (local.x >= 0.0f && local.y >= 0.0f && local.z >= 0.0f && local.x < cellCount && local.y < cellCount && local.z < cellCount)
+            cell = glm::ivec3(local);
+        else
+            level = 0;
+    }
+    uint64_t key = nodeKey(level, cell);
+
+    if (object >= locations.size())
+        locations.resize(object + 1);
+    Location& location = locations[object];
+    if (location.Node >= 0 && location.Key == key)
+    {
+        Entry& entry = nodes[location.Node].Entries[location.Slot];
+        entry.Center = center;
+        entry.Radius = radius;
+        return;
+    }
+    // the new node is counted first, so removing the entry cannot recycle a parent the two share
+    Location previous = location;
+    int node = findNode(level, cell);
+    location.Node = node;
+    location.Slot = (unsigned int)nodes[node].Entries.size();
+    location.Key = key;
+    nodes[node].Entries.push_back({ center, radius, object });
+    addToSubtreeCounts(node);
+    if (previous.Node >= 0)
+    {
+        removeEntry(previous.Node, previous.Slot);
+        CellChanges++;
+    }
+    else
+        objectCount++;
+}
+
+void LooseOctree::Remove(unsigned int object)
+{
+    if (object >= locations.size() || locations[object].Node < 0)
+        return;
+    Location location = locations[object];
+    locations[object].Node = -1;
+    removeEntry(location.Node, location.Slot);
+    objectCount--;
+}
+
+void LooseOctree::Clear()
+{
+    nodes.clear();
+    freeNodes.clear();
+    lookup.Clear();
+    locations.clear();
+    objectCount = 0;
+    findNode(0, glm::ivec3(0));
+}
+
+void LooseOctree::QueryFrustum(const glm::vec4 planes[6], std::vector<unsigned int>& objects) const
+{
+    int stack[STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0)
+    {
+        int index = stack[--stackSize];
+        const Node& node = nodes[index];
+        if (node.SubtreeCount == 0)
+            continue;
+        // the root also holds whatever is outside the bounds, its box says nothing
+        if (index != 0)
+        {
+            int inside = classifyBox(node.Min - node.Size * 0.5f, node.Min + node.Size * 1.5f, planes);
+            if (inside == 0)
+                continue;
+            if (inside == 2)
+            {
+                collect(index, objects);
+                continue;
+            }
+        }
+        for (const Entry& entry : node.Entries)
+            if (sphereInside(entry.Center, entry.Radius, planes))
+                objects.push_back(entry.Object);
+        for (int child : node.Children)
+            if (child >= 0)
+                stack[stackSize++] = child;
+    }
+}
+
+void LooseOctree::QuerySphere(const glm::vec3& center, float radius, std::vector<unsigned int>& objects) const
+{
+    int stack[STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0)
+    {
+        int index = stack[--stackSize];
+        const Node& node = nodes[index];
+        if (node.SubtreeCount == 0)
+            continue;
+        if (index != 0 && boxDistanceSquared(node.Min - node.Size * 0.5f, node.Min + node.Size * 1.5f, center) > radius * radius)
+            continue;
+        for (const Entry& entry : node.Entries)
+        {
+            glm::vec3 offset = entry.Center - center;
+            float reach = entry.Radius + radius;
+            if (glm::dot(offset, offset) <= reach * reach)
+                objects.push_back(entry.Object);
+        }
+        for (int child : node.Children)
+            if (child >= 0)
+                stack[stackSize++] = child;
+    }
+}
+
+int LooseOctree::findNode(unsigned int level, const glm::ivec3& cell)
+{
+    uint64_t key = nodeKey(level, cell);
+    int found = lookup.Find(key);
+    if (found >= 0)
+        return found;
+
+    int parent = level > 0 ? findNode(level - 1, cell >> 1) : -1;
+    int index;
+    if (freeNodes.empty())
+    {
+        index = (int)nodes.size();
+        nodes.emplace_back();
+    }
+    else
+    {
+        index = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    Node& node = nodes[index];
+    node.Size = cellSizes[level];
+    node.Min = origin + glm::vec3(cell) * node.Size;
+    node.Key = key;
+    node.Parent = parent;
+    std::fill(node.Children, node.Children + 8, -1);
+    node.SubtreeCount = 0;
+    lookup.Insert(key, index);
+    if (parent >= 0)
+        nodes[parent].Children[(cell.x & 1) | (cell.y & 1) << 1 | (cell.z & 1) << 2] = index;
+    return index;
+}
+
+void LooseOctree::addToSubtreeCounts(int node)
+{
+    for (; node >= 0; node = nodes[node].Parent)
+        nodes[node].SubtreeCount++;
+}
+
+void LooseOctree::removeEntry(int node, unsigned int slot)
+{
+    std::vector<Entry>& entries = nodes[node].Entries;
+    if (slot + 1 != entries.size())
+    {
+        entries[slot] = entries.back();
+        locations[entries[slot].Object].Slot = slot;
+    }
+    entries.pop_back();
+
+    for (; node >= 0; node = nodes[node].Parent)
+    {
+        // an empty subtree has no children left, those were recycled as they emptied
+        if (--nodes[node].SubtreeCount > 0 || node == 0)
+            continue;
+        int parent = nodes[node].Parent;
+        std::replace(nodes[parent].Children, nodes[parent].Children + 8, node, -1);
+        lookup.Erase(nodes[node].Key);
+        freeNodes.push_back(node);
+    }
+}
+
+void LooseOctree::collect(int node, std::vector<unsigned int>& objects) const
+{
+    int stack[STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = node;
+    while (stackSize > 0)
+    {
+        const Node& current = nodes[stack[--stackSize]];
+        if (current.SubtreeCount == 0)
+            continue;
+        for (const Entry& entry : current.Entries)
+            objects.push_back(entry.Object);
+        for (int child : current.Children)
+            if (child >= 0)
+                stack[stackSize++] = child;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include "BoundingBox.h"
+#include "CellMap.h"
+
+// Loose octree over object bounding spheres, for objects that move every frame. a cell's loose box reaches half a
+// cell past every side, so an object goes in the cell holding its center on the deepest level whose cells are at
+// least as wide as its diameter. both come straight from the center and radius, without descending from the root,
+// and cells are found through a hash of their level and coordinates, so moving an object is an in-place write or a
+// swap-remove and an append plus a walk up the counts of the parents. nodes are created on demand and recycled when
+// their subtree empties
+class LooseOctree
+{
+public:
+    // levels below the root, cell coordinates have to fit the hash key
+    static constexpr unsigned int MAX_DEPTH = 16;
+
+    // bounds is where objects are expected, its largest side is the root cell. objects outside it still work but
+    // sit in the root, which every query tests one by one
+    explicit LooseOctree(const BoundingBox& bounds, unsigned int depth = 8);
+
+    // adds object or moves it when it is already in. objects are indices, storage grows to the largest one
+    void Update(unsigned int object, const glm::vec3& center, float radius);
+    void Remove(unsigned int object);
+    void Clear();
+
+    // appends the objects whose sphere is at least partly inside all planes, planes as ClusterCuller::ExtractFrustumPlanes
+    void QueryFrustum(const glm::vec4 planes[6], std::vector<unsigned int>& objects) const;
+    // appends the objects whose sphere overlaps the sphere of radius around center
+    void QuerySphere(const glm::vec3& center, float radius, std::vector<unsigned int>& objects) const;
+
+    size_t GetNodeCount() const { return nodes.size() - freeNodes.size(); }
+    size_t GetObjectCount() const { return objectCount; }
+    // Update() calls that moved an object to another cell, the ones that cost more than a write
+    unsigned int CellChanges = 0;
+
+private:
+    // an object's sphere is kept in its node so queries read it without another lookup
+    struct Entry
+    {
+        glm::vec3 Center;
+        float Radius;
+        unsigned int Object;
+    };
+
+    struct Node
+    {
+        // of the cell, the loose box is Min - Size / 2 to Min + Size * 1.5
+        glm::vec3 Min;
+        float Size;
+        uint64_t Key;
+        int Parent;
+        int Children[8];
+        // objects in this node and below it
+        unsigned int SubtreeCount;
+        std::vector<Entry> Entries;
+    };
+
+    // where an object's entry is, Node is -1 for objects that are not in. Key is the node's, an object that stays
+    // in its cell is found without the hash
+    struct Location
+    {
+        int Node = -1;
+        unsigned int Slot = 0;
+        uint64_t Key = 0;
+    };
+
+    glm::vec3 origin;
+    float rootSize;
+    unsigned int depth;
+    // per level, Update() runs for every moving object every frame
+    float cellSizes[MAX_DEPTH + 1];
+    float inverseCellSizes[MAX_DEPTH + 1];
+    // the root is node 0
+    std::vector<Node> nodes;
+    // recycled nodes, they keep the capacity of their entries
+    std::vector<int> freeNodes;
+    CellMap lookup;
+    std::vector<Location> locations;
+    size_t objectCount = 0;
+
+    // the node of cell on level, created with its missing parents
+    int findNode(unsigned int level, const glm::ivec3& cell);
+    // adds 1 to the counts of node and its parents
+    void addToSubtreeCounts(int node);
+    // removes the entry in slot of node, recycling the nodes whose count drops to 0
+    void removeEntry(int node, unsigned int slot);
+    // appends every object in node and below it, for nodes entirely inside the frustum
+    void collect(int node, std::vector<unsigned int>& objects) const;
+};
@@ -1,10 +1,62 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <cstdlib>
+#include <cstring>
+
+#include "Benchmarks/Benchmarks.h"
+#include "Bindless/Bindless.h"
+#include "Cameras/Cameras.h"
+#include "ClusterCulling/ClusterCulling.h"
+#include "DynamicObjects/DynamicObjects.h"
+#include "Entities/Entities.h"
+#include "GlmSimd/GlmSimd.h"
+#include "GltfViewer/GltfViewer.h"
 #include "HelloTriangle/HelloTriangle.h"
+#include "LevelOfDetail/LevelOfDetail.h"
+#include "MatrixMath/MatrixMath.h"
+#include "ObjViewer/ObjViewer.h"
+#include "OcclusionCulling/OcclusionCulling.h"
+#include "Rotations/Rotations.h"
 #include "Sandbox/Sandbox.h"
+#include "SceneQueries/SceneQueries.h"
+#include "Sprites/Sprites.h"
+#include "Transforms/Transforms.h"
+#include "VertexFormats/VertexFormats.h"
+#include "VirtualTexturing/VirtualTexturing.h"
 
-int main()
+// LearnOpenGL --replay <recording> [<trace>] [<golden directory>] plays back input recorded in the Sandbox with F5
+// without showing a window, writes the frame times to the trace and compares every 60th frame with the golden images.
+// LearnOpenGL --benchmark [<results>] [<cubes>] times the benchmark scenarios without showing a window and writes the
+// results as JSON, LearnOpenGL --compare <baseline> <results> [<threshold>] checks them against earlier ones.
+// LearnOpenGL --texture-stress checks the texture cache under memory pressure
+int main(int argc, char** argv)
 {
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+    {
+        Benchmarks::Settings settings;
+        if (argc > 2)
+            settings.Results = argv[2];
+        if (argc > 3)
+            settings.Instances = (unsigned int)atoi(argv[3]);
+        return Benchmarks::Run(settings);
+    }
+    if (argc > 1 && strcmp(argv[1], "--texture-stress") == 0)
+        return Benchmarks::StressTextureCache();
+    if (argc > 3 && strcmp(argv[1], "--compare") == 0)
+        return Benchmarks::Compare(argv[2], argv[3], argc > 4 ? atof(argv[4]) : 0.1);
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0)
+    {
+        Sandbox::ReplaySettings settings;
+        settings.Recording = argv[2];
+        if (argc > 3)
+            settings.Trace = argv[3];
+        if (argc > 4)
+        {
+            settings.GoldenDirectory = argv[4];
+            settings.GoldenInterval = 60;
+        }
+        return Sandbox::Replay(settings);
+    }
     return Sandbox::Main();
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(handle, &fileSize);
+    file = handle;
+    size = (size_t)fileSize.QuadPart;
+    open = true;
+    if (size == 0)
+        return true;
+    mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping)
+        data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+        return false;
+    struct stat info;
+    if (fstat(descriptor, &info) != 0)
+    {
+        ::close(descriptor);
+        return false;
+    }
+    size = (size_t)info.st_size;
+    open = true;
+    if (size > 0)
+    {
+        void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapped != MAP_FAILED)
+        {
+            data = (const unsigned char*)mapped;
+            // read front to back, let the kernel read ahead aggressively
+            madvise(mapped, size, MADV_SEQUENTIAL);
+        }
+    }
+    // the mapping keeps its own reference to the file
+    ::close(descriptor);
+#endif
+    if (size > 0 && !data)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (data)
+        UnmapViewOfFile(data);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file)
+        CloseHandle(file);
+    mapping = NULL;
+    file = NULL;
+#else
+    if (data)
+        munmap((void*)data, size);
+#endif
+    data = NULL;
+    size = 0;
+    open = false;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file (mmap, MapViewOfFile on Windows). the pages are loaded by the OS
+// on first touch, so large files are not copied and untouched parts are never read.
+class MappedFile
+{
+public:
+    MappedFile() {}
+    explicit MappedFile(const std::string& path) { Open(path); }
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // maps path, returns false if it cannot be opened. an empty file maps to a NULL Data() of size 0
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return open; }
+    const unsigned char* Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    const unsigned char* data = NULL;
+    size_t size = 0;
+    bool open = false;
+#ifdef _WIN32
+    void* file = NULL;
+    void* mapping = NULL;
+#endif
+};
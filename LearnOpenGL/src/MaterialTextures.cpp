@@ -0,0 +1,88 @@
+#include "MaterialTextures.h"
+#include "GLExtensions.h"
+#include "RenderStats.h"
+#include "Shader.h"
+
+MaterialTextures::MaterialTextures(int width, int height, int maxMaterials, bool preferBindless)
+    : width(width), height(height), maxMaterials(maxMaterials)
+{
+    // the handles are only reachable through a storage buffer
+    bindless = preferBindless && GLExtensions::ARB_bindless_texture && GLExtensions::ARB_shader_storage_buffer_object;
+    if (!bindless)
+        array.reset(new TextureArray(width, height, maxMaterials * TEXTURES_PER_MATERIAL));
+}
+
+MaterialTextures::~MaterialTextures()
+{
+    for (GLuint64 handle : handles)
+        GLExtensions::glMakeTextureHandleNonResidentARB(handle);
+    if (!textures.empty())
+        glDeleteTextures((GLsizei)textures.size(), textures.data());
+    if (handleBuffer)
+        glDeleteBuffers(1, &handleBuffer);
+}
+
+int MaterialTextures::Add(const unsigned char* const images[TEXTURES_PER_MATERIAL])
+{
+    if (count >= maxMaterials)
+        return -1;
+    if (!bindless)
+    {
+        for (int i = 0; i < TEXTURES_PER_MATERIAL; i++)
+            array->Add(images[i], width, height);
+        return count++;
+    }
+
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    for (int i = 0; i < TEXTURES_PER_MATERIAL; i++)
+    {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, images[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        textures.push_back(texture);
+    }
+    glBindTexture(GL_TEXTURE_2D, previous);
+    return count++;
+}
+
+void MaterialTextures::Finish()
+{
+    if (!bindless)
+    {
+        array->Finish();
+        return;
+    }
+
+    // a handle freezes the texture's parameters, so they are only taken once every texture is complete
+    handles.clear();
+    for (unsigned int texture : textures)
+    {
+        GLuint64 handle = GLExtensions::glGetTextureHandleARB(texture);
+        GLExtensions::glMakeTextureHandleResidentARB(handle);
+        handles.push_back(handle);
+    }
+    if (!handleBuffer)
+        glGenBuffers(1, &handleBuffer);
+    glBindBuffer(GLExtensions::SHADER_STORAGE_BUFFER, handleBuffer);
+    glBufferData(GLExtensions::SHADER_STORAGE_BUFFER, handles.size() * sizeof(GLuint64), handles.data(), GL_STATIC_DRAW);
+    glBindBuffer(GLExtensions::SHADER_STORAGE_BUFFER, 0);
+}
+
+void MaterialTextures::Bind(Shader& shader, int unit) const
+{
+    if (bindless)
+    {
+        glBindBufferBase(GLExtensions::SHADER_STORAGE_BUFFER, HANDLE_BINDING, handleBuffer);
+        RenderStats::Frame.BufferBinds++;
+        return;
+    }
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, array->GetTexture());
+    RenderStats::Frame.TextureBinds++;
+    shader.setInt("materialTextures", unit);
+}
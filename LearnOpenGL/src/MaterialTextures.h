@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <memory>
+#include <vector>
+
+#include "TextureAtlas.h"
+
+class Shader;
+
+// The textures of every material reachable from a single draw, so draws with different materials can be merged.
+// with GL_ARB_bindless_texture each image stays its own texture and its 64-bit handle is made resident and
+// stored in a shader storage buffer indexed by material (shaders define BINDLESS). without it the images go
+// into one TextureArray at layer material * TEXTURES_PER_MATERIAL + slot (shaders define TEXTURE_ARRAY).
+// every image has the same size so both paths accept the same input.
+class MaterialTextures
+{
+public:
+    static const int TEXTURES_PER_MATERIAL = 2;
+    // shader storage binding of the handles, matches Textures.fs
+    static const unsigned int HANDLE_BINDING = 0;
+
+    // width x height is the size of every image, maxMaterials sizes the fallback array
+    MaterialTextures(int width, int height, int maxMaterials, bool preferBindless = true);
+    ~MaterialTextures();
+
+    // true when the bindless path is used, pick the BINDLESS shader permutation then
+    bool IsBindless() const { return bindless; }
+    // adds a material from TEXTURES_PER_MATERIAL RGBA images, returns its index or -1 when full
+    int Add(const unsigned char* const images[TEXTURES_PER_MATERIAL]);
+    // makes the handles resident and uploads them, or finishes the array, call after the last Add
+    void Finish();
+    // binds the handle buffer, or the array to unit and points the "materialTextures" sampler of shader at it
+    void Bind(Shader& shader, int unit) const;
+
+    int GetMaterialCount() const { return count; }
+
+private:
+    int width;
+    int height;
+    int maxMaterials;
+    int count = 0;
+    bool bindless;
+
+    // bindless path
+    std::vector<unsigned int> textures;
+    std::vector<GLuint64> handles;
+    unsigned int handleBuffer = 0;
+    // fallback path
+    std::unique_ptr<TextureArray> array;
+};
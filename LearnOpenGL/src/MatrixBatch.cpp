@@ -0,0 +1,115 @@
+#include "MatrixBatch.h"
+
+#include "CpuFeatures.h"
+#include "MatrixKernels.h"
+
+namespace
+{
+    MatrixBatch::Path detectBestPath()
+    {
+        const CpuFeatures& cpu = CpuFeatures::Get();
+        if (cpu.Avx512F && cpu.Avx2 && cpu.Fma)
+            return MatrixBatch::Path::Avx512;
+        if (cpu.Avx2 && cpu.Fma)
+            return MatrixBatch::Path::Avx2;
+        if (cpu.Sse41)
+            return MatrixBatch::Path::Sse41;
+        return MatrixBatch::Path::Scalar;
+    }
+
+    MatrixBatch::Path currentPath = detectBestPath();
+}
+
+MatrixBatch::Path MatrixBatch::GetBestPath()
+{
+    static const Path best = detectBestPath();
+    return best;
+}
+
+MatrixBatch::Path MatrixBatch::GetPath()
+{
+    return currentPath;
+}
+
+void MatrixBatch::SetPath(Path path)
+{
+    currentPath = (int)path <= (int)GetBestPath() ? path : GetBestPath();
+}
+
+const char* MatrixBatch::GetPathName(Path path)
+{
+    switch (path)
+    {
+    case Path::Sse41:
+        return "sse4.1";
+    case Path::Avx2:
+        return "avx2";
+    case Path::Avx512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+void MatrixBatch::Multiply(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, size_t count)
+{
+    const float* leftFloats = &left[0][0];
+    const float* rightFloats = count ? &right[0][0][0] : NULL;
+    float* outFloats = count ? &out[0][0][0] : NULL;
+    switch (currentPath)
+    {
+    case Path::Avx512:
+        MatrixKernels::MultiplyAvx512(leftFloats, rightFloats, outFloats, count);
+        return;
+    case Path::Avx2:
+        MatrixKernels::MultiplyAvx2(leftFloats, rightFloats, outFloats, count);
+        return;
+    case Path::Sse41:
+        MatrixKernels::MultiplySse41(leftFloats, rightFloats, outFloats, count);
+        return;
+    default:
+        for (size_t i = 0; i < count; i++)
+            out[i] = left * right[i];
+    }
+}
+
+void MatrixBatch::TransformPoints(const glm::mat4& matrix, const glm::vec3* points, glm::vec3* out, size_t count)
+{
+    const float* matrixFloats = &matrix[0][0];
+    const float* pointFloats = count ? &points[0][0] : NULL;
+    float* outFloats = count ? &out[0][0] : NULL;
+    switch (currentPath)
+    {
+    case Path::Avx512:
+        MatrixKernels::TransformPointsAvx512(matrixFloats, pointFloats, outFloats, count);
+        return;
+    case Path::Avx2:
+        MatrixKernels::TransformPointsAvx2(matrixFloats, pointFloats, outFloats, count);
+        return;
+    case Path::Sse41:
+        MatrixKernels::TransformPointsSse41(matrixFloats, pointFloats, outFloats, count);
+        return;
+    default:
+        for (size_t i = 0; i < count; i++)
+            out[i] = glm::vec3(matrix * glm::vec4(points[i], 1.0f));
+    }
+}
+
+void MatrixBatch::NormalMatrices(const glm::mat4* models, glm::mat3* out, size_t count)
+{
+    const float* modelFloats = count ? &models[0][0][0] : NULL;
+    float* outFloats = count ? &out[0][0][0] : NULL;
+    switch (currentPath)
+    {
+    case Path::Avx512:
+    case Path::Avx2:
+        MatrixKernels::NormalMatricesAvx2(modelFloats, outFloats, count);
+        return;
+    case Path::Sse41:
+        MatrixKernels::NormalMatricesSse41(modelFloats, outFloats, count);
+        return;
+    default:
+        for (size_t i = 0; i < count; i++)
+            out[i] = glm::transpose(glm::inverse(glm::mat3(models[i])));
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+// Matrix math over arrays, for work that would otherwise be one glm call per draw or per vertex: model-view-projection
+// matrices for every object, points through one matrix, normal matrices. every function has a scalar glm loop and
+// SSE4.1, AVX2 and AVX-512 versions, the best one the CPU has is used unless SetPath() says otherwise. the SIMD
+// versions round differently from glm (fused multiply-adds, another order of additions), by a few float ulps.
+namespace MatrixBatch
+{
+    enum class Path
+    {
+        Scalar,
+        Sse41,
+        Avx2,
+        Avx512
+    };
+
+    // the best path the CPU has
+    Path GetBestPath();
+    Path GetPath();
+    // a path the CPU lacks falls back to GetBestPath(). not to be changed while another thread uses the functions
+    void SetPath(Path path);
+    const char* GetPathName(Path path);
+
+    // out[i] = left * right[i], e.g. projection * view times every model matrix. out may be right
+    void Multiply(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, size_t count);
+    // out[i] = glm::vec3(matrix * glm::vec4(points[i], 1.0f)), no perspective divide. out may be points
+    void TransformPoints(const glm::mat4& matrix, const glm::vec3* points, glm::vec3* out, size_t count);
+    // out[i] = glm::transpose(glm::inverse(glm::mat3(models[i]))), for normals under non-uniform scale. AVX-512
+    // uses the AVX2 loop, a 3 x 3 inverse does not fill the wider registers
+    void NormalMatrices(const glm::mat4* models, glm::mat3* out, size_t count);
+}
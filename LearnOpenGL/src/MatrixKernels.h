@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+// The SIMD loops behind MatrixBatch, one file per instruction set, each compiled for its own and only called when
+// CpuFeatures says so. matrices are 16 floats, column major like glm::mat4, and need no alignment. no glm here for
+// the same reason as in TransformKernels.h
+namespace MatrixKernels
+{
+    // out[i] = left * right[i], out may be right
+    void MultiplySse41(const float* left, const float* right, float* out, size_t count);
+    void MultiplyAvx2(const float* left, const float* right, float* out, size_t count);
+    void MultiplyAvx512(const float* left, const float* right, float* out, size_t count);
+
+    // out[i] = xyz of matrix * (points[i], 1), 3 floats per point, out may be points
+    void TransformPointsSse41(const float* matrix, const float* points, float* out, size_t count);
+    void TransformPointsAvx2(const float* matrix, const float* points, float* out, size_t count);
+    void TransformPointsAvx512(const float* matrix, const float* points, float* out, size_t count);
+
+    // out[i] = transpose(inverse(upper left 3 x 3 of models[i])), 9 floats per result like glm::mat3
+    void NormalMatricesSse41(const float* models, float* out, size_t count);
+    void NormalMatricesAvx2(const float* models, float* out, size_t count);
+}
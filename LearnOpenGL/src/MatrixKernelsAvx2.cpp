@@ -0,0 +1,119 @@
+// compiled with /arch:AVX2 (see the project file), only reached when CpuFeatures reports AVX2 and FMA
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2,fma")
+#endif
+
+#include "MatrixKernels.h"
+#include <immintrin.h>
+
+namespace
+{
+    // both halves of a register hold a column
+    inline __m256 broadcastColumn(const float* column)
+    {
+        return _mm256_broadcast_ps((const __m128*)column);
+    }
+
+    // per half, like the SSE cross product
+    inline __m256 cross(__m256 a, __m256 b)
+    {
+        __m256 aYzx = _mm256_permute_ps(a, _MM_SHUFFLE(3, 0, 2, 1));
+        __m256 bYzx = _mm256_permute_ps(b, _MM_SHUFFLE(3, 0, 2, 1));
+        __m256 zxy = _mm256_fmsub_ps(a, bYzx, _mm256_mul_ps(aYzx, b));
+        return _mm256_permute_ps(zxy, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    inline __m256 loadPair(const float* low, const float* high)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+    }
+
+    inline void storeXyz(float* out, __m128 value)
+    {
+        _mm_storel_pi((__m64*)out, value);
+        _mm_store_ss(out + 2, _mm_movehl_ps(value, value));
+    }
+}
+
+void MatrixKernels::MultiplyAvx2(const float* left, const float* right, float* out, size_t count)
+{
+    const __m256 left0 = broadcastColumn(left), left1 = broadcastColumn(left + 4);
+    const __m256 left2 = broadcastColumn(left + 8), left3 = broadcastColumn(left + 12);
+    // two columns of the result per register, each the left columns weighted by one column of right
+    for (size_t i = 0; i < count; i++, right += 16, out += 16)
+    {
+        __m256 right01 = _mm256_loadu_ps(right), right23 = _mm256_loadu_ps(right + 8);
+        __m256 result01 = _mm256_mul_ps(left0, _mm256_permute_ps(right01, _MM_SHUFFLE(0, 0, 0, 0)));
+        __m256 result23 = _mm256_mul_ps(left0, _mm256_permute_ps(right23, _MM_SHUFFLE(0, 0, 0, 0)));
+        result01 = _mm256_fmadd_ps(left1, _mm256_permute_ps(right01, _MM_SHUFFLE(1, 1, 1, 1)), result01);
+        result23 = _mm256_fmadd_ps(left1, _mm256_permute_ps(right23, _MM_SHUFFLE(1, 1, 1, 1)), result23);
+        result01 = _mm256_fmadd_ps(left2, _mm256_permute_ps(right01, _MM_SHUFFLE(2, 2, 2, 2)), result01);
+        result23 = _mm256_fmadd_ps(left2, _mm256_permute_ps(right23, _MM_SHUFFLE(2, 2, 2, 2)), result23);
+        result01 = _mm256_fmadd_ps(left3, _mm256_permute_ps(right01, _MM_SHUFFLE(3, 3, 3, 3)), result01);
+        result23 = _mm256_fmadd_ps(left3, _mm256_permute_ps(right23, _MM_SHUFFLE(3, 3, 3, 3)), result23);
+        _mm256_storeu_ps(out, result01);
+        _mm256_storeu_ps(out + 8, result23);
+    }
+}
+
+void MatrixKernels::TransformPointsAvx2(const float* matrix, const float* points, float* out, size_t count)
+{
+    __m256 m[12];
+    for (int column = 0; column < 4; column++)
+        for (int row = 0; row < 3; row++)
+            m[column * 3 + row] = _mm256_set1_ps(matrix[column * 4 + row]);
+
+    // 8 points at a time: x, y and z of each into their own register, in the same shuffled lane order, and back
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, points += 24, out += 24)
+    {
+        __m256 points03 = loadPair(points, points + 12);
+        __m256 points14 = loadPair(points + 4, points + 16);
+        __m256 points25 = loadPair(points + 8, points + 20);
+        __m256 xy = _mm256_shuffle_ps(points14, points25, _MM_SHUFFLE(2, 1, 3, 2));
+        __m256 yz = _mm256_shuffle_ps(points03, points14, _MM_SHUFFLE(1, 0, 2, 1));
+        __m256 x = _mm256_shuffle_ps(points03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+        __m256 y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 z = _mm256_shuffle_ps(yz, points25, _MM_SHUFFLE(3, 0, 3, 1));
+
+        __m256 resultX = _mm256_fmadd_ps(m[0], x, _mm256_fmadd_ps(m[3], y, _mm256_fmadd_ps(m[6], z, m[9])));
+        __m256 resultY = _mm256_fmadd_ps(m[1], x, _mm256_fmadd_ps(m[4], y, _mm256_fmadd_ps(m[7], z, m[10])));
+        __m256 resultZ = _mm256_fmadd_ps(m[2], x, _mm256_fmadd_ps(m[5], y, _mm256_fmadd_ps(m[8], z, m[11])));
+
+        __m256 rxy = _mm256_shuffle_ps(resultX, resultY, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 ryz = _mm256_shuffle_ps(resultY, resultZ, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 rzx = _mm256_shuffle_ps(resultZ, resultX, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 result03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 result14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 result25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(out, _mm256_castps256_ps128(result03));
+        _mm_storeu_ps(out + 4, _mm256_castps256_ps128(result14));
+        _mm_storeu_ps(out + 8, _mm256_castps256_ps128(result25));
+        _mm_storeu_ps(out + 12, _mm256_extractf128_ps(result03, 1));
+        _mm_storeu_ps(out + 16, _mm256_extractf128_ps(result14, 1));
+        _mm_storeu_ps(out + 20, _mm256_extractf128_ps(result25, 1));
+    }
+    TransformPointsSse41(matrix, points, out, count - i);
+}
+
+void MatrixKernels::NormalMatricesAvx2(const float* models, float* out, size_t count)
+{
+    // two matrices at a time, one per half, the same way as the SSE version
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2, models += 32, out += 18)
+    {
+        __m256 a = loadPair(models, models + 16), b = loadPair(models + 4, models + 20), c = loadPair(models + 8, models + 24);
+        __m256 bc = cross(b, c), ca = cross(c, a), ab = cross(a, b);
+        __m256 inverseDeterminant = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_dp_ps(a, bc, 0x7f));
+        bc = _mm256_mul_ps(bc, inverseDeterminant);
+        ca = _mm256_mul_ps(ca, inverseDeterminant);
+        ab = _mm256_mul_ps(ab, inverseDeterminant);
+        _mm_storeu_ps(out, _mm256_castps256_ps128(bc));
+        _mm_storeu_ps(out + 3, _mm256_castps256_ps128(ca));
+        _mm_storeu_ps(out + 6, _mm256_castps256_ps128(ab));
+        _mm_storeu_ps(out + 9, _mm256_extractf128_ps(bc, 1));
+        _mm_storeu_ps(out + 12, _mm256_extractf128_ps(ca, 1));
+        storeXyz(out + 15, _mm256_extractf128_ps(ab, 1));
+    }
+    NormalMatricesSse41(models, out, count - i);
+}
@@ -0,0 +1,101 @@
+// compiled with /arch:AVX512 (see the project file), only reached when CpuFeatures reports AVX-512F, AVX2 and FMA
+#if defined(__GNUC__) && !defined(__AVX512F__)
+#pragma GCC target("avx512f,avx2,fma")
+#endif
+
+#include "MatrixKernels.h"
+#include <immintrin.h>
+
+namespace
+{
+    // lane j of x, y or z as a 16 lane register gathers float 3 * j + component of 48 floats in three registers,
+    // first from the first two, then the rest from the third
+    struct Deinterleave
+    {
+        __m512i FirstTwo[3];
+        __m512i Third[3];
+    };
+
+    // lane j of the output register part gets float 16 * part + j of the interleaved points, first x and y, then z
+    struct Interleave
+    {
+        __m512i XY[3];
+        __m512i Z[3];
+    };
+
+    void makeIndices(Deinterleave& deinterleave, Interleave& interleave)
+    {
+        alignas(64) int first[16], second[16];
+        for (int component = 0; component < 3; component++)
+        {
+            for (int lane = 0; lane < 16; lane++)
+            {
+                int source = 3 * lane + component;
+                first[lane] = source < 32 ? source : 0;
+                second[lane] = source < 32 ? lane : 16 + source - 32;
+            }
+            deinterleave.FirstTwo[component] = _mm512_load_si512(first);
+            deinterleave.Third[component] = _mm512_load_si512(second);
+        }
+        for (int part = 0; part < 3; part++)
+        {
+            for (int lane = 0; lane < 16; lane++)
+            {
+                int point = (16 * part + lane) / 3, component = (16 * part + lane) % 3;
+                first[lane] = component == 0 ? point : component == 1 ? 16 + point : 0;
+                second[lane] = component == 2 ? 16 + point : lane;
+            }
+            interleave.XY[part] = _mm512_load_si512(first);
+            interleave.Z[part] = _mm512_load_si512(second);
+        }
+    }
+}
+
+void MatrixKernels::MultiplyAvx512(const float* left, const float* right, float* out, size_t count)
+{
+    // a whole matrix per register, every quarter a column
+    const __m512 left0 = _mm512_broadcast_f32x4(_mm_loadu_ps(left)), left1 = _mm512_broadcast_f32x4(_mm_loadu_ps(left + 4));
+    const __m512 left2 = _mm512_broadcast_f32x4(_mm_loadu_ps(left + 8)), left3 = _mm512_broadcast_f32x4(_mm_loadu_ps(left + 12));
+    for (size_t i = 0; i < count; i++, right += 16, out += 16)
+    {
+        __m512 columns = _mm512_loadu_ps(right);
+        __m512 result = _mm512_mul_ps(left0, _mm512_permute_ps(columns, _MM_SHUFFLE(0, 0, 0, 0)));
+        result = _mm512_fmadd_ps(left1, _mm512_permute_ps(columns, _MM_SHUFFLE(1, 1, 1, 1)), result);
+        result = _mm512_fmadd_ps(left2, _mm512_permute_ps(columns, _MM_SHUFFLE(2, 2, 2, 2)), result);
+        result = _mm512_fmadd_ps(left3, _mm512_permute_ps(columns, _MM_SHUFFLE(3, 3, 3, 3)), result);
+        _mm512_storeu_ps(out, result);
+    }
+}
+
+void MatrixKernels::TransformPointsAvx512(const float* matrix, const float* points, float* out, size_t count)
+{
+    size_t i = 0;
+    if (count >= 16)
+    {
+        __m512 m[12];
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 3; row++)
+                m[column * 3 + row] = _mm512_set1_ps(matrix[column * 4 + row]);
+        Deinterleave deinterleave;
+        Interleave interleave;
+        makeIndices(deinterleave, interleave);
+
+        for (; i + 16 <= count; i += 16, points += 48, out += 48)
+        {
+            __m512 points0 = _mm512_loadu_ps(points), points1 = _mm512_loadu_ps(points + 16), points2 = _mm512_loadu_ps(points + 32);
+            __m512 xyz[3];
+            for (int component = 0; component < 3; component++)
+                xyz[component] = _mm512_permutex2var_ps(_mm512_permutex2var_ps(points0, deinterleave.FirstTwo[component], points1),
+                    deinterleave.Third[component], points2);
+
+            __m512 resultX = _mm512_fmadd_ps(m[0], xyz[0], _mm512_fmadd_ps(m[3], xyz[1], _mm512_fmadd_ps(m[6], xyz[2], m[9])));
+            __m512 resultY = _mm512_fmadd_ps(m[1], xyz[0], _mm512_fmadd_ps(m[4], xyz[1], _mm512_fmadd_ps(m[7], xyz[2], m[10])));
+            __m512 resultZ = _mm512_fmadd_ps(m[2], xyz[0], _mm512_fmadd_ps(m[5], xyz[1], _mm512_fmadd_ps(m[8], xyz[2], m[11])));
+
+            for (int part = 0; part < 3; part++)
+                _mm512_storeu_ps(out + 16 * part, _mm512_permutex2var_ps(_mm512_permutex2var_ps(resultX, interleave.XY[part], resultY),
+                    interleave.Z[part], resultZ));
+        }
+    }
+    TransformPointsSse41(matrix, points, out, count - i);
+}
@@ -0,0 +1,86 @@
+// only reached when CpuFeatures reports SSE4.1, MSVC needs no switch for its intrinsics
+#if defined(__GNUC__) && !defined(__SSE4_1__)
+#pragma GCC target("sse4.1")
+#endif
+
+#include "MatrixKernels.h"
+#include <smmintrin.h>
+
+namespace
+{
+    template<int Lane>
+    inline __m128 splat(__m128 value)
+    {
+        return _mm_shuffle_ps(value, value, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+    }
+
+    // the columns of a matrix weighted by the elements of weights
+    inline __m128 combine(__m128 column0, __m128 column1, __m128 column2, __m128 column3, __m128 weights)
+    {
+        __m128 result = _mm_mul_ps(column0, splat<0>(weights));
+        result = _mm_add_ps(result, _mm_mul_ps(column1, splat<1>(weights)));
+        result = _mm_add_ps(result, _mm_mul_ps(column2, splat<2>(weights)));
+        return _mm_add_ps(result, _mm_mul_ps(column3, splat<3>(weights)));
+    }
+
+    // cross product of the xyz of a and b, w is garbage
+    inline __m128 cross(__m128 a, __m128 b)
+    {
+        __m128 aYzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 bYzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 zxy = _mm_sub_ps(_mm_mul_ps(a, bYzx), _mm_mul_ps(aYzx, b));
+        return _mm_shuffle_ps(zxy, zxy, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+
+    // the xyz of value, leaving out[3] alone
+    inline void storeXyz(float* out, __m128 value)
+    {
+        _mm_storel_pi((__m64*)out, value);
+        _mm_store_ss(out + 2, _mm_movehl_ps(value, value));
+    }
+}
+
+void MatrixKernels::MultiplySse41(const float* left, const float* right, float* out, size_t count)
+{
+    const __m128 left0 = _mm_loadu_ps(left), left1 = _mm_loadu_ps(left + 4);
+    const __m128 left2 = _mm_loadu_ps(left + 8), left3 = _mm_loadu_ps(left + 12);
+    for (size_t i = 0; i < count; i++, right += 16, out += 16)
+    {
+        // all of right is loaded before out is written, out may be right
+        __m128 column0 = _mm_loadu_ps(right), column1 = _mm_loadu_ps(right + 4);
+        __m128 column2 = _mm_loadu_ps(right + 8), column3 = _mm_loadu_ps(right + 12);
+        _mm_storeu_ps(out, combine(left0, left1, left2, left3, column0));
+        _mm_storeu_ps(out + 4, combine(left0, left1, left2, left3, column1));
+        _mm_storeu_ps(out + 8, combine(left0, left1, left2, left3, column2));
+        _mm_storeu_ps(out + 12, combine(left0, left1, left2, left3, column3));
+    }
+}
+
+void MatrixKernels::TransformPointsSse41(const float* matrix, const float* points, float* out, size_t count)
+{
+    const __m128 column0 = _mm_loadu_ps(matrix), column1 = _mm_loadu_ps(matrix + 4);
+    const __m128 column2 = _mm_loadu_ps(matrix + 8), column3 = _mm_loadu_ps(matrix + 12);
+    for (size_t i = 0; i < count; i++, points += 3, out += 3)
+    {
+        __m128 result = _mm_add_ps(_mm_mul_ps(column0, _mm_set1_ps(points[0])), column3);
+        result = _mm_add_ps(result, _mm_mul_ps(column1, _mm_set1_ps(points[1])));
+        result = _mm_add_ps(result, _mm_mul_ps(column2, _mm_set1_ps(points[2])));
+        storeXyz(out, result);
+    }
+}
+
+void MatrixKernels::NormalMatricesSse41(const float* models, float* out, size_t count)
+{
+    // with columns a, b and c the inverse has rows b x c, c x a and a x b over the determinant, the inverse
+    // transpose has them as columns
+    for (size_t i = 0; i < count; i++, models += 16, out += 9)
+    {
+        __m128 a = _mm_loadu_ps(models), b = _mm_loadu_ps(models + 4), c = _mm_loadu_ps(models + 8);
+        __m128 bc = cross(b, c), ca = cross(c, a), ab = cross(a, b);
+        __m128 inverseDeterminant = _mm_div_ps(_mm_set1_ps(1.0f), _mm_dp_ps(a, bc, 0x7f));
+        // the first two overlap the next column, which is written after them
+        _mm_storeu_ps(out, _mm_mul_ps(bc, inverseDeterminant));
+        _mm_storeu_ps(out + 3, _mm_mul_ps(ca, inverseDeterminant));
+        storeXyz(out + 6, _mm_mul_ps(ab, inverseDeterminant));
+    }
+}
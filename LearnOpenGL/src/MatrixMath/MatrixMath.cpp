@@ -0,0 +1,447 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "MatrixMath.h"
+#include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../Camera.h"
+#include "../MatrixBatch.h"
+#include "../RenderStats.h"
+#include "../VertexFormat.h"
+
+namespace MatrixMath
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // the accuracy tests run every count up to TEST_SMALL_COUNTS, for the tails of the SIMD loops, then one large batch
+    const unsigned int TEST_SMALL_COUNTS = 70;
+    const unsigned int TEST_LARGE_COUNT = 100003;
+    // largest difference to glm allowed, relative to the sizes of the terms summed; twice the error bound of a sum of
+    // four products in float, glm has its own rounding errors too
+    const double TOLERANCE = 8.0 * 1.2e-7;
+    // normal matrices are compared relative to their largest element, an inverse loses more digits
+    const double NORMAL_TOLERANCE = 1e-5;
+
+    // a batch that stays in the caches and one that streams from memory, BENCHMARK_TOTAL matrices each
+    const unsigned int BENCHMARK_COUNTS[] = { 4096, 1000000 };
+    const unsigned int BENCHMARK_TOTAL = 10000000;
+
+    // the scene, boxes squashed and stretched along their own axes, which needs real normal matrices
+    const int BOXES_X = 40;
+    const int BOXES_Z = 40;
+    const float BOX_SPACING = 3.0f;
+
+    const MatrixBatch::Path PATHS[] = { MatrixBatch::Path::Scalar, MatrixBatch::Path::Sse41, MatrixBatch::Path::Avx2, MatrixBatch::Path::Avx512 };
+
+    // camera
+    Camera camera(glm::vec3(0.0f, 15.0f, BOXES_Z * BOX_SPACING * 0.5f + 20.0f));
+
+    bool firstMouse = true;
+    float mouseLastX = SCR_WIDTH / 2.0;
+    float mouseLastY = SCR_HEIGHT / 2.0;
+
+    // timing
+    float deltaTime = 0.0f;	// Time between current frame and last frame
+    float lastFrame = 0.0f;
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // a rotation, a non-uniform scale of up to maxScale either way and a translation of up to 1000
+    glm::mat4 randomModel(std::mt19937& random, float maxScale)
+    {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        glm::vec3 axis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 0.01f));
+        glm::vec3 scale(std::pow(maxScale, unit(random)), std::pow(maxScale, unit(random)), std::pow(maxScale, unit(random)));
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(unit(random), unit(random), unit(random)) * 1000.0f);
+        model = glm::rotate(model, glm::pi<float>() * unit(random), axis);
+        return glm::scale(model, scale);
+    }
+
+    // every element of a matrix with no structure
+    glm::mat4 randomMatrix(std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> unit(-10.0f, 10.0f);
+        glm::mat4 matrix;
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+                matrix[column][row] = unit(random);
+        return matrix;
+    }
+
+    // |a - b| over the sum of the absolute values of the products that make up b, the worst element
+    double productError(const glm::mat4& left, const glm::mat4& right, const glm::mat4& a, const glm::mat4& b)
+    {
+        double worst = 0.0;
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+            {
+                double size = 0.0;
+                for (int k = 0; k < 4; k++)
+                    size += std::fabs((double)left[k][row] * right[column][k]);
+                worst = std::max(worst, std::fabs((double)a[column][row] - b[column][row]) / std::max(size, 1e-30));
+            }
+        return worst;
+    }
+
+    double pointError(const glm::mat4& matrix, const glm::vec3& point, const glm::vec3& a, const glm::vec3& b)
+    {
+        double worst = 0.0;
+        for (int row = 0; row < 3; row++)
+        {
+            double size = std::fabs(matrix[3][row]);
+            for (int k = 0; k < 3; k++)
+                size += std::fabs((double)matrix[k][row] * point[k]);
+            worst = std::max(worst, std::fabs((double)a[row] - b[row]) / std::max(size, 1e-30));
+        }
+        return worst;
+    }
+
+    double normalError(const glm::mat3& a, const glm::mat3& b)
+    {
+        double largest = 0.0, worst = 0.0;
+        for (int column = 0; column < 3; column++)
+            for (int row = 0; row < 3; row++)
+            {
+                largest = std::max(largest, (double)std::fabs(b[column][row]));
+                worst = std::max(worst, (double)std::fabs(a[column][row] - b[column][row]));
+            }
+        return worst / std::max(largest, 1e-30);
+    }
+
+    // every path against glm, for every count up to TEST_SMALL_COUNTS and a large one, with a sentinel after the
+    // output that must stay untouched. returns whether all passed
+    bool runAccuracyTests()
+    {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> unit(-100.0f, 100.0f);
+        std::vector<unsigned int> counts;
+        for (unsigned int count = 0; count <= TEST_SMALL_COUNTS; count++)
+            counts.push_back(count);
+        counts.push_back(TEST_LARGE_COUNT);
+
+        const glm::mat4 sentinel(12345.0f);
+        bool allPassed = true;
+        printf("accuracy against glm, %zu batch sizes up to %u\n", counts.size(), TEST_LARGE_COUNT);
+        for (MatrixBatch::Path path : PATHS)
+        {
+            if ((int)path > (int)MatrixBatch::GetBestPath())
+            {
+                printf("  %-7s not supported by this CPU\n", MatrixBatch::GetPathName(path));
+                continue;
+            }
+            MatrixBatch::SetPath(path);
+            double multiplyError = 0.0, pointsError = 0.0, normalsError = 0.0;
+            bool overrun = false;
+            for (unsigned int count : counts)
+            {
+                // half structured model matrices, half anything, and a view projection in front of them
+                glm::mat4 left = glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 1000.0f)
+                    * glm::lookAt(glm::vec3(unit(random), unit(random), unit(random)), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+                std::vector<glm::mat4> models(count + 1), products(count + 1);
+                std::vector<glm::vec3> points(count + 1), transformed(count + 1);
+                std::vector<glm::mat3> normals(count + 1);
+                for (unsigned int i = 0; i < count; i++)
+                {
+                    models[i] = i % 2 ? randomModel(random, 100.0f) : randomMatrix(random);
+                    points[i] = glm::vec3(unit(random), unit(random), unit(random));
+                }
+                products[count] = sentinel;
+                transformed[count] = glm::vec3(sentinel[0]);
+                normals[count] = glm::mat3(sentinel);
+
+                MatrixBatch::Multiply(left, models.data(), products.data(), count);
+                MatrixBatch::TransformPoints(left, points.data(), transformed.data(), count);
+                for (unsigned int i = 0; i < count; i++)
+                {
+                    multiplyError = std::max(multiplyError, productError(left, models[i], products[i], left * models[i]));
+                    pointsError = std::max(pointsError, pointError(left, points[i], transformed[i], glm::vec3(left * glm::vec4(points[i], 1.0f))));
+                    // normal matrices of well conditioned models, the inverse of a random matrix can be anything
+                    models[i] = randomModel(random, 10.0f);
+                }
+                MatrixBatch::NormalMatrices(models.data(), normals.data(), count);
+                for (unsigned int i = 0; i < count; i++)
+                    normalsError = std::max(normalsError, normalError(normals[i], glm::transpose(glm::inverse(glm::mat3(models[i])))));
+                overrun |= products[count] != sentinel || transformed[count] != glm::vec3(sentinel[0]) || normals[count] != glm::mat3(sentinel);
+            }
+            bool passed = !overrun && multiplyError <= TOLERANCE && pointsError <= TOLERANCE && normalsError <= NORMAL_TOLERANCE;
+            allPassed &= passed;
+            printf("  %-7s multiply %.1e, points %.1e, normal matrices %.1e%s, %s\n", MatrixBatch::GetPathName(path), multiplyError, pointsError,
+                normalsError, overrun ? ", wrote past the output" : "", passed ? "passed" : "FAILED");
+        }
+        MatrixBatch::SetPath(MatrixBatch::GetBestPath());
+        return allPassed;
+    }
+
+    void runBenchmark()
+    {
+        std::mt19937 random(2);
+        std::uniform_real_distribution<float> unit(-100.0f, 100.0f);
+        glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 1000.0f) * glm::lookAt(glm::vec3(10.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        for (unsigned int count : BENCHMARK_COUNTS)
+        {
+            std::vector<glm::mat4> models(count), products(count);
+            std::vector<glm::vec3> points(count), transformed(count);
+            std::vector<glm::mat3> normals(count);
+            for (unsigned int i = 0; i < count; i++)
+            {
+                models[i] = randomModel(random, 10.0f);
+                points[i] = glm::vec3(unit(random), unit(random), unit(random));
+            }
+
+            printf("batches of %u, millions of matrices or points per second\n", count);
+            unsigned int repeats = BENCHMARK_TOTAL / count;
+            for (MatrixBatch::Path path : PATHS)
+            {
+                if ((int)path > (int)MatrixBatch::GetBestPath())
+                    continue;
+                MatrixBatch::SetPath(path);
+                double seconds[3] = {};
+                for (unsigned int repeat = 0; repeat < repeats; repeat++)
+                {
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                    MatrixBatch::Multiply(viewProjection, models.data(), products.data(), count);
+                    seconds[0] += secondsSince(start);
+                    start = std::chrono::steady_clock::now();
+                    MatrixBatch::TransformPoints(viewProjection, points.data(), transformed.data(), count);
+                    seconds[1] += secondsSince(start);
+                    start = std::chrono::steady_clock::now();
+                    MatrixBatch::NormalMatrices(models.data(), normals.data(), count);
+                    seconds[2] += secondsSince(start);
+                }
+                double millions = (double)count * repeats / 1e6;
+                printf("  %-7s multiply %7.1f, points %7.1f, normal matrices %7.1f\n", MatrixBatch::GetPathName(path), millions / seconds[0],
+                    millions / seconds[1], millions / seconds[2]);
+            }
+        }
+        MatrixBatch::SetPath(MatrixBatch::GetBestPath());
+    }
+
+    int Main()
+    {
+        runAccuracyTests();
+        runBenchmark();
+
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwSetCursorPosCallback(window, mouse_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        // model-view-projection and normal matrices come from MatrixBatch instead of being multiplied per vertex
+        Shader shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs", { "PRECOMPUTED_MVP", "NORMAL_MATRIX" });
+
+        // a unit cube with face normals
+        std::vector<float> vertices;
+        for (int face = 0; face < 6; face++)
+        {
+            int axis = face / 2;
+            float sign = (face % 2) ? -1.0f : 1.0f;
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = sign;
+            u[(axis + 1) % 3] = sign;
+            v[(axis + 2) % 3] = 1.0f;
+            const float corners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+            for (const float* corner : corners)
+            {
+                glm::vec3 position = normal * 0.5f + u * (corner[0] - 0.5f) + v * (corner[1] - 0.5f);
+                vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z, corner[0], corner[1] });
+            }
+        }
+        VertexFormat format;
+        format.Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+        unsigned int VAO, VBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        format.Apply();
+
+        unsigned int whiteTexture;
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        shader.use();
+        shader.setInt("baseColor", 0);
+        shader.setVec4("baseColorFactor", glm::vec4(0.9f, 0.75f, 0.5f, 1.0f));
+        shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+
+        const size_t boxCount = BOXES_X * BOXES_Z;
+        std::vector<glm::mat4> models(boxCount), mvps(boxCount);
+        std::vector<glm::mat3> normalMatrices(boxCount);
+
+        // render loop
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        double reportSeconds = 0.0;
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            float currentFrame = static_cast<float>(glfwGetTime());
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            processInput(window);
+
+            for (int x = 0; x < BOXES_X; x++)
+                for (int z = 0; z < BOXES_Z; z++)
+                {
+                    float phase = currentFrame + 0.3f * x + 0.2f * z;
+                    glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x - (BOXES_X - 1) * 0.5f, 0.0f, z - (BOXES_Z - 1) * 0.5f) * BOX_SPACING);
+                    model = glm::rotate(model, phase * 0.5f, glm::normalize(glm::vec3(0.3f, 1.0f, 0.2f)));
+                    models[x * BOXES_Z + z] = glm::scale(model, glm::vec3(1.0f + 0.6f * glm::sin(phase), 1.0f + 0.6f * glm::cos(phase * 1.3f), 0.6f));
+                }
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)width / (float)std::max(height, 1), 0.1f, 300.0f);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            MatrixBatch::Multiply(projection * camera.GetViewMatrix(), models.data(), mvps.data(), boxCount);
+            MatrixBatch::NormalMatrices(models.data(), normalMatrices.data(), boxCount);
+            reportSeconds += secondsSince(start);
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            glBindVertexArray(VAO);
+            for (size_t i = 0; i < boxCount; i++)
+            {
+                shader.setMat4("modelViewProjection", mvps[i]);
+                shader.setMat3("normalMatrix", normalMatrices[i]);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += 12;
+            }
+
+            RenderStats::EndFrame();
+            reportFrames++;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                printf("%-7s %zu model-view-projection and normal matrices in %.4f ms\n", MatrixBatch::GetPathName(MatrixBatch::GetPath()), boxCount,
+                    reportSeconds * 1000.0 / reportFrames);
+                reportStart = now;
+                reportFrames = 0;
+                reportSeconds = 0.0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures(1, &whiteTexture);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        // 1 to 4 pick scalar, SSE4.1, AVX2 and AVX-512, falling back to the best the CPU has
+        for (int key = 0; key < 4; key++)
+            if (glfwGetKey(window, GLFW_KEY_1 + key) == GLFW_PRESS)
+                MatrixBatch::SetPath(PATHS[key]);
+
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            camera.ProcessKeyboard(FORWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            camera.ProcessKeyboard(BACKWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            camera.ProcessKeyboard(LEFT, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            camera.ProcessKeyboard(RIGHT, deltaTime);
+    }
+
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+    {
+        if (firstMouse)
+        {
+            mouseLastX = xpos;
+            mouseLastY = ypos;
+            firstMouse = false;
+        }
+
+        float xoffset = xpos - mouseLastX;
+        float yoffset = mouseLastY - ypos; // reversed since y-coordinates range from bottom to top
+
+        mouseLastX = xpos;
+        mouseLastY = ypos;
+
+        camera.ProcessMouseMovement(xoffset, yoffset);
+    }
+}
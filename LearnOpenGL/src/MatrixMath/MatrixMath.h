@@ -0,0 +1,4 @@
+namespace MatrixMath
+{
+    int Main();
+};
\ No newline at end of file
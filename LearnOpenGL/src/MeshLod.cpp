@@ -0,0 +1,84 @@
+#include "MeshLod.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+void MeshLod::Build(const std::vector<unsigned int>& indices, const float* positions, size_t positionStride, size_t vertexCount,
+    const float* attributes, size_t attributeStride, unsigned int attributeCount, float ratio, unsigned int maxLevels)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Indices = indices;
+    Levels.clear();
+    LodLevel full;
+    full.IndexCount = (unsigned int)indices.size();
+    Levels.push_back(full);
+
+    // the center of the box and the farthest vertex from it, a little loose but cheap
+    glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        glm::vec3 p = *(const glm::vec3*)((const char*)positions + v * positionStride);
+        boundsMin = v ? glm::min(boundsMin, p) : p;
+        boundsMax = v ? glm::max(boundsMax, p) : p;
+    }
+    Center = (boundsMin + boundsMax) * 0.5f;
+    Radius = 0.0f;
+    for (size_t v = 0; v < vertexCount; v++)
+        Radius = std::max(Radius, glm::length(*(const glm::vec3*)((const char*)positions + v * positionStride) - Center));
+
+    std::vector<unsigned int> previous = indices;
+    while (Levels.size() < maxLevels)
+    {
+        SimplifyOptions options;
+        options.TargetIndexCount = (size_t)(previous.size() / 3 * ratio) * 3;
+        float error = 0.0f;
+        std::vector<unsigned int> simplified = MeshSimplifier::Simplify(previous, positions, positionStride, vertexCount,
+            attributes, attributeStride, attributeCount, options, &error);
+        if (simplified.empty() || simplified.size() > previous.size() * 9 / 10)
+            break;
+
+        LodLevel level;
+        level.FirstIndex = (unsigned int)Indices.size();
+        level.IndexCount = (unsigned int)simplified.size();
+        // the quadrics only know the previous level, so the errors add up as a bound to the full detail surface
+        level.Error = Levels.back().Error + error;
+        Levels.push_back(level);
+        Indices.insert(Indices.end(), simplified.begin(), simplified.end());
+        previous.swap(simplified);
+    }
+    BuildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+float MeshLod::ProjectedError(float error, float distance, float fovY, float screenHeight)
+{
+    // at distance the screen covers 2 * distance * tan(fovY / 2) units vertically
+    float pixelsPerUnit = screenHeight / (2.0f * std::max(distance, 1e-4f) * std::tan(glm::radians(fovY) * 0.5f));
+    return error * pixelsPerUnit;
+}
+
+int MeshLod::Select(float distance, float fovY, float screenHeight, float pixelThreshold, int current, float hysteresis) const
+{
+    int count = (int)Levels.size();
+    int target = 0;
+    for (int level = count - 1; level > 0; level--)
+    {
+        if (ProjectedError(Levels[level].Error, distance, fovY, screenHeight) <= pixelThreshold)
+        {
+            target = level;
+            break;
+        }
+    }
+    if (current < 0 || current >= count || target <= current)
+        return target;
+
+    // coarser than last frame: only as far as the stricter threshold allows
+    int coarser = current;
+    while (coarser + 1 < count && ProjectedError(Levels[coarser + 1].Error, distance, fovY, screenHeight) <= pixelThreshold * (1.0f - hysteresis))
+        coarser++;
+    return coarser;
+}
+
+float MeshLod::Distance(const glm::vec3& eye, const glm::vec3& offset) const
+{
+    return std::max(glm::length(Center + offset - eye) - Radius, 0.0f);
+}
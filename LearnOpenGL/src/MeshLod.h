@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "MeshSimplifier.h"
+
+// a range of MeshLod::Indices
+struct LodLevel
+{
+    unsigned int FirstIndex = 0;
+    unsigned int IndexCount = 0;
+    // how far (object space) the surface of this level may be from the full detail one
+    float Error = 0.0f;
+};
+
+// A level of detail chain of one mesh: level 0 is the input, every further level is simplified from the previous one
+// with MeshSimplifier. all levels index the same vertices and are stored back to back in Indices, so drawing a level
+// is a draw call over its range of one index buffer. at runtime Select() picks the level whose error stays below a
+// pixel threshold on screen.
+class MeshLod
+{
+public:
+    static const unsigned int MAX_LEVELS = 8;
+
+    // every level targets ratio of the triangles of the previous one, building stops early when a level
+    // does not get at least a tenth smaller (everything left is locked or would flip)
+    void Build(const std::vector<unsigned int>& indices, const float* positions, size_t positionStride, size_t vertexCount,
+        const float* attributes, size_t attributeStride, unsigned int attributeCount, float ratio = 0.5f,
+        unsigned int maxLevels = MAX_LEVELS);
+
+    // pixels an object space error covers at distance, for a vertical field of view of fovY degrees (Camera::Zoom)
+    static float ProjectedError(float error, float distance, float fovY, float screenHeight);
+    // the coarsest level whose error projects to at most pixelThreshold pixels. current is the level drawn last
+    // frame (-1 for none): moving to a coarser level needs the error below (1 - hysteresis) * pixelThreshold, so
+    // a distance hovering around a switch point does not make the level pop back and forth
+    int Select(float distance, float fovY, float screenHeight, float pixelThreshold, int current = -1, float hysteresis = 0.25f) const;
+    // distance from eye to the bounding sphere translated by offset, 0 inside it
+    float Distance(const glm::vec3& eye, const glm::vec3& offset = glm::vec3(0.0f)) const;
+
+    std::vector<unsigned int> Indices;
+    std::vector<LodLevel> Levels;
+    // bounding sphere of the vertices
+    glm::vec3 Center = glm::vec3(0.0f);
+    float Radius = 0.0f;
+    double BuildSeconds = 0.0;
+};
@@ -0,0 +1,319 @@
+#include "MeshSimplifier.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+    // border edges pull this much harder than faces of the same size, so borders do not shrink
+    const double BORDER_WEIGHT = 10.0;
+    // a collapse is rejected when a triangle normal turns further than about 78 degrees
+    const float FLIP_COSINE = 0.2f;
+
+    enum VertexKind : unsigned char
+    {
+        MANIFOLD,
+        BORDER,
+        LOCKED
+    };
+
+    // symmetric 4x4 quadric (A, b, c) of the squared distance to a set of planes, weighted by area. Weight
+    // is the summed area, dividing by it turns the error back into a squared distance
+    struct Quadric
+    {
+        double A00 = 0, A01 = 0, A02 = 0, A11 = 0, A12 = 0, A22 = 0;
+        double B0 = 0, B1 = 0, B2 = 0;
+        double C = 0;
+        double Weight = 0;
+
+        void Add(const Quadric& other)
+        {
+            A00 += other.A00; A01 += other.A01; A02 += other.A02;
+            A11 += other.A11; A12 += other.A12; A22 += other.A22;
+            B0 += other.B0; B1 += other.B1; B2 += other.B2;
+            C += other.C;
+            Weight += other.Weight;
+        }
+
+        // the plane n.p + d = 0 with a unit normal
+        void AddPlane(const glm::dvec3& n, double d, double weight)
+        {
+            A00 += weight * n.x * n.x; A01 += weight * n.x * n.y; A02 += weight * n.x * n.z;
+            A11 += weight * n.y * n.y; A12 += weight * n.y * n.z; A22 += weight * n.z * n.z;
+            B0 += weight * n.x * d; B1 += weight * n.y * d; B2 += weight * n.z * d;
+            C += weight * d * d;
+            Weight += weight;
+        }
+
+        // weighted sum of squared distances of p to the planes
+        double Evaluate(const glm::dvec3& p) const
+        {
+            double rx = A00 * p.x + A01 * p.y + A02 * p.z;
+            double ry = A01 * p.x + A11 * p.y + A12 * p.z;
+            double rz = A02 * p.x + A12 * p.y + A22 * p.z;
+            double result = p.x * rx + p.y * ry + p.z * rz + 2.0 * (B0 * p.x + B1 * p.y + B2 * p.z) + C;
+            return std::max(result, 0.0);
+        }
+    };
+
+    struct Collapse
+    {
+        unsigned int From;
+        unsigned int To;
+        // squared distance, and the same plus the attribute term used for ordering
+        float Error;
+        float Cost;
+    };
+
+    uint64_t edgeKey(unsigned int a, unsigned int b)
+    {
+        return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+    }
+
+    // triangles around each vertex, in compressed rows
+    struct Adjacency
+    {
+        std::vector<unsigned int> Offsets;
+        std::vector<unsigned int> Triangles;
+
+        void Build(const std::vector<unsigned int>& indices, size_t vertexCount)
+        {
+            Offsets.assign(vertexCount + 1, 0);
+            for (unsigned int index : indices)
+                Offsets[index + 1]++;
+            for (size_t v = 0; v < vertexCount; v++)
+                Offsets[v + 1] += Offsets[v];
+            Triangles.resize(indices.size());
+            std::vector<unsigned int> fill(Offsets.begin(), Offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+                Triangles[fill[indices[i]]++] = (unsigned int)(i / 3);
+        }
+    };
+
+    // number of triangles on every undirected edge, 1 on open borders. positions are compared through
+    // positionIds so the two sides of a seam count as one edge
+    std::unordered_map<uint64_t, unsigned int> countEdges(const std::vector<unsigned int>& indices, const std::vector<unsigned int>& positionIds)
+    {
+        std::unordered_map<uint64_t, unsigned int> edges;
+        edges.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3)
+            for (int e = 0; e < 3; e++)
+                edges[edgeKey(positionIds[indices[i + e]], positionIds[indices[i + (e + 1) % 3]])]++;
+        return edges;
+    }
+}
+
+namespace MeshSimplifier
+{
+    std::vector<unsigned int> Simplify(const std::vector<unsigned int>& indices, const float* positions, size_t positionStride,
+        size_t vertexCount, const float* attributes, size_t attributeStride, unsigned int attributeCount,
+        const SimplifyOptions& options, float* error)
+    {
+        std::vector<glm::dvec3> points(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            const float* p = (const float*)((const char*)positions + v * positionStride);
+            points[v] = glm::dvec3(p[0], p[1], p[2]);
+        }
+        auto attribute = [&](unsigned int v) { return (const float*)((const char*)attributes + v * attributeStride); };
+
+        // vertices with the same position share an id, any vertex whose position is shared is on a seam
+        std::vector<unsigned int> positionIds(vertexCount);
+        std::vector<VertexKind> kinds(vertexCount, MANIFOLD);
+        {
+            std::unordered_map<uint64_t, unsigned int> firstAt;
+            firstAt.reserve(vertexCount);
+            for (size_t v = 0; v < vertexCount; v++)
+            {
+                const float* p = (const float*)((const char*)positions + v * positionStride);
+                uint32_t bits[3];
+                memcpy(bits, p, sizeof(bits));
+                // a cheap mix of the three coordinates, collisions are resolved by comparing the positions
+                uint64_t key = (uint64_t)bits[0] * 0x9E3779B97F4A7C15ull ^ (uint64_t)bits[1] * 0xC2B2AE3D27D4EB4Full ^ bits[2];
+                unsigned int id = (unsigned int)v;
+                while (true)
+                {
+                    auto inserted = firstAt.insert({ key, (unsigned int)v });
+                    if (inserted.second || points[inserted.first->second] == points[v])
+                    {
+                        id = inserted.first->second;
+                        break;
+                    }
+                    key++;
+                }
+                positionIds[v] = id;
+                if (id != v)
+                    kinds[v] = kinds[id] = LOCKED;
+            }
+        }
+
+        std::vector<unsigned int> result(indices);
+        std::unordered_map<uint64_t, unsigned int> edges = countEdges(result, positionIds);
+        auto isBorderEdge = [&](unsigned int a, unsigned int b)
+        {
+            auto edge = edges.find(edgeKey(positionIds[a], positionIds[b]));
+            return edge != edges.end() && edge->second == 1;
+        };
+
+        // plane quadrics of the faces, plus planes perpendicular to the border edges
+        std::vector<Quadric> quadrics(vertexCount);
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const unsigned int* t = &result[i];
+            glm::dvec3 normal = glm::cross(points[t[1]] - points[t[0]], points[t[2]] - points[t[0]]);
+            double length = glm::length(normal);
+            if (length == 0.0)
+                continue;
+            normal /= length;
+            double area = length * 0.5;
+            for (int c = 0; c < 3; c++)
+                quadrics[t[c]].AddPlane(normal, -glm::dot(normal, points[t[0]]), area);
+
+            for (int e = 0; e < 3; e++)
+            {
+                unsigned int a = t[e], b = t[(e + 1) % 3];
+                if (!isBorderEdge(a, b))
+                    continue;
+                for (unsigned int v : { a, b })
+                {
+                    if (kinds[v] == MANIFOLD)
+                        kinds[v] = options.LockBorder ? LOCKED : BORDER;
+                }
+                glm::dvec3 edge = points[b] - points[a];
+                glm::dvec3 borderNormal = glm::cross(edge, normal);
+                double borderLength = glm::length(borderNormal);
+                if (borderLength == 0.0)
+                    continue;
+                borderNormal /= borderLength;
+                double weight = glm::dot(edge, edge) * BORDER_WEIGHT;
+                for (unsigned int v : { a, b })
+                    quadrics[v].AddPlane(borderNormal, -glm::dot(borderNormal, points[a]), weight);
+            }
+        }
+
+        size_t triangleCount = result.size() / 3;
+        size_t targetTriangles = options.TargetIndexCount / 3;
+        double maxError = (double)options.MaxError * options.MaxError;
+        double worstError = 0.0;
+        Adjacency adjacency;
+        std::vector<Collapse> best(vertexCount);
+        std::vector<Collapse> candidates;
+        std::vector<unsigned int> remap(vertexCount);
+        std::vector<unsigned char> touched(vertexCount);
+
+        while (triangleCount > targetTriangles)
+        {
+            adjacency.Build(result, vertexCount);
+            if (!options.LockBorder)
+                edges = countEdges(result, positionIds);
+
+            // the cheapest collapse of every vertex that may move, a vertex can only collapse once per pass anyway
+            // and this keeps the sort to one entry per vertex instead of one per directed edge
+            std::fill(best.begin(), best.end(), Collapse{ 0, 0, 0.0f, std::numeric_limits<float>::max() });
+            for (size_t i = 0; i < result.size(); i += 3)
+                for (int e = 0; e < 3; e++)
+                {
+                    unsigned int a = result[i + e], b = result[i + (e + 1) % 3];
+                    for (int direction = 0; direction < 2; direction++, std::swap(a, b))
+                    {
+                        if (kinds[a] == LOCKED)
+                            continue;
+                        // border vertices slide along border edges onto border vertices only
+                        if (kinds[a] == BORDER && (kinds[b] == MANIFOLD || !isBorderEdge(a, b)))
+                            continue;
+                        Quadric merged = quadrics[a];
+                        merged.Add(quadrics[b]);
+                        double distance = merged.Weight > 0.0 ? merged.Evaluate(points[b]) / merged.Weight : 0.0;
+                        double attributeCost = 0.0;
+                        for (unsigned int k = 0; k < attributeCount; k++)
+                        {
+                            double difference = attribute(a)[k] - attribute(b)[k];
+                            attributeCost += difference * difference;
+                        }
+                        float cost = (float)(distance + options.AttributeWeight * attributeCost);
+                        if (cost < best[a].Cost)
+                            best[a] = { a, b, (float)distance, cost };
+                    }
+                }
+            candidates.clear();
+            for (const Collapse& collapse : best)
+            {
+                if (collapse.Cost < std::numeric_limits<float>::max())
+                    candidates.push_back(collapse);
+            }
+            std::sort(candidates.begin(), candidates.end(), [](const Collapse& x, const Collapse& y) { return x.Cost < y.Cost; });
+
+            for (size_t v = 0; v < vertexCount; v++)
+                remap[v] = (unsigned int)v;
+            std::fill(touched.begin(), touched.end(), 0);
+            size_t collapses = 0;
+            for (const Collapse& collapse : candidates)
+            {
+                if (triangleCount <= targetTriangles || collapse.Error > maxError)
+                    break;
+                unsigned int a = collapse.From, b = collapse.To;
+                if (touched[a] || touched[b])
+                    continue;
+
+                // triangles around a keep their orientation once a moves onto b
+                bool flips = false;
+                size_t removed = 0;
+                for (unsigned int k = adjacency.Offsets[a]; k < adjacency.Offsets[a + 1] && !flips; k++)
+                {
+                    const unsigned int* t = &result[adjacency.Triangles[k] * 3];
+                    if (t[0] == b || t[1] == b || t[2] == b)
+                    {
+                        removed++;
+                        continue;
+                    }
+                    glm::dvec3 corners[3] = { points[t[0]], points[t[1]], points[t[2]] };
+                    glm::dvec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                    for (int c = 0; c < 3; c++)
+                    {
+                        if (t[c] == a)
+                            corners[c] = points[b];
+                    }
+                    glm::dvec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                    flips = glm::dot(before, after) < FLIP_COSINE * glm::length(before) * glm::length(after);
+                }
+                if (flips)
+                    continue;
+
+                remap[a] = b;
+                quadrics[b].Add(quadrics[a]);
+                worstError = std::max(worstError, (double)collapse.Error);
+                triangleCount -= removed;
+                collapses++;
+                // nothing else in this pass may change a triangle this collapse changed
+                for (unsigned int k = adjacency.Offsets[a]; k < adjacency.Offsets[a + 1]; k++)
+                {
+                    const unsigned int* t = &result[adjacency.Triangles[k] * 3];
+                    touched[t[0]] = touched[t[1]] = touched[t[2]] = 1;
+                }
+            }
+            if (collapses == 0)
+                break;
+
+            // move the collapsed corners and drop the triangles that became degenerate
+            size_t write = 0;
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                unsigned int t0 = remap[result[i]], t1 = remap[result[i + 1]], t2 = remap[result[i + 2]];
+                if (t0 == t1 || t1 == t2 || t2 == t0)
+                    continue;
+                result[write++] = t0;
+                result[write++] = t1;
+                result[write++] = t2;
+            }
+            result.resize(write);
+            triangleCount = write / 3;
+        }
+
+        if (error)
+            *error = (float)std::sqrt(worstError);
+        return result;
+    }
+}
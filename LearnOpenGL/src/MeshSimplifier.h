@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+struct SimplifyOptions
+{
+    // collapses stop once the index count is down to this
+    size_t TargetIndexCount = 0;
+    // collapses that would move the surface further than this (object space units) are not made
+    float MaxError = std::numeric_limits<float>::max();
+    // how much a squared attribute difference costs against a squared distance when ordering collapses
+    float AttributeWeight = 1.0f;
+    // vertices on open borders stay, otherwise they may only slide along the border
+    bool LockBorder = true;
+};
+
+// Quadric error metric simplification by half edge collapses: a vertex is merged into a neighbour, so the result
+// only indexes the input vertices and every level of detail can share one vertex buffer. collapses run in passes,
+// each pass sorts the candidate edges by cost (positional quadric error plus weighted attribute difference) and
+// makes the cheapest ones that touch disjoint triangles and do not flip any. vertices sharing a position with
+// another vertex (uv or normal seams) are locked so seams do not open.
+namespace MeshSimplifier
+{
+    // positions and attributes are floats at a byte stride, attributes may be NULL with attributeCount 0.
+    // error receives the largest positional error of the collapses made, in the units of the positions
+    std::vector<unsigned int> Simplify(const std::vector<unsigned int>& indices, const float* positions, size_t positionStride,
+        size_t vertexCount, const float* attributes, size_t attributeStride, unsigned int attributeCount,
+        const SimplifyOptions& options, float* error = nullptr);
+}
@@ -0,0 +1,173 @@
+#include "Meshlets.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+    // cones wider than this (the smallest cosine between a triangle normal and the axis) can face away from
+    // no point outside the cluster worth testing, they get a cutoff that never culls
+    const float MIN_CONE_COSINE = 0.1f;
+
+    MeshletBounds computeBounds(const Meshlet& meshlet, const std::vector<unsigned int>& indices, const float* positions, size_t positionStride)
+    {
+        auto position = [&](unsigned int v) { return *(const glm::vec3*)((const char*)positions + v * positionStride); };
+        const unsigned int* triangles = &indices[meshlet.TriangleOffset * 3];
+        unsigned int cornerCount = meshlet.TriangleCount * 3;
+
+        MeshletBounds bounds;
+        glm::vec3 boundsMin = position(triangles[0]), boundsMax = boundsMin;
+        for (unsigned int i = 1; i < cornerCount; i++)
+        {
+            boundsMin = glm::min(boundsMin, position(triangles[i]));
+            boundsMax = glm::max(boundsMax, position(triangles[i]));
+        }
+        bounds.Center = (boundsMin + boundsMax) * 0.5f;
+        for (unsigned int i = 0; i < cornerCount; i++)
+            bounds.Radius = std::max(bounds.Radius, glm::length(position(triangles[i]) - bounds.Center));
+
+        // the cone axis is the average direction, every normal counts the same regardless of triangle size
+        std::vector<glm::vec3> normals;
+        normals.reserve(meshlet.TriangleCount);
+        glm::vec3 sum(0.0f);
+        for (unsigned int i = 0; i < cornerCount; i += 3)
+        {
+            glm::vec3 p0 = position(triangles[i]);
+            glm::vec3 normal = glm::cross(position(triangles[i + 1]) - p0, position(triangles[i + 2]) - p0);
+            float length = glm::length(normal);
+            if (length == 0.0f)
+                continue;
+            normals.push_back(normal / length);
+            sum += normals.back();
+        }
+        float sumLength = glm::length(sum);
+        if (sumLength == 0.0f)
+            return bounds;
+        bounds.ConeAxis = sum / sumLength;
+        float minCosine = 1.0f;
+        for (const glm::vec3& normal : normals)
+            minCosine = std::min(minCosine, glm::dot(normal, bounds.ConeAxis));
+        // the view direction has to be within 90 degrees minus the cone angle of the axis, i.e. its cosine
+        // above the sine of the cone angle
+        if (minCosine > MIN_CONE_COSINE)
+            bounds.ConeCutoff = std::sqrt(1.0f - minCosine * minCosine);
+        return bounds;
+    }
+}
+
+void MeshletMesh::Build(const std::vector<unsigned int>& indices, const float* positions, size_t positionStride, size_t vertexCount,
+    unsigned int maxVertices, unsigned int maxTriangles)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Meshlets.clear();
+    Bounds.clear();
+    Vertices.clear();
+    Triangles.clear();
+    Indices.clear();
+    Indices.reserve(indices.size());
+    Triangles.reserve(indices.size());
+    size_t triangleCount = indices.size() / 3;
+
+    // triangles around each vertex, in compressed rows
+    std::vector<unsigned int> offsets(vertexCount + 1, 0), adjacent(indices.size());
+    for (unsigned int index : indices)
+        offsets[index + 1]++;
+    for (size_t v = 0; v < vertexCount; v++)
+        offsets[v + 1] += offsets[v];
+    {
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+            adjacent[fill[indices[i]]++] = (unsigned int)(i / 3);
+    }
+
+    std::vector<unsigned char> emitted(triangleCount, 0);
+    // meshlet-local index of every mesh vertex in the current meshlet, -1 outside it
+    std::vector<int> local(vertexCount, -1);
+    // triangles next to the current meshlet, emitted ones are dropped lazily
+    std::vector<unsigned int> candidates;
+    size_t seedScan = 0;
+    Meshlet meshlet;
+
+    auto newVertices = [&](unsigned int triangle)
+    {
+        const unsigned int* t = &indices[triangle * 3];
+        // distinct vertices only, degenerate triangles repeat one
+        unsigned int added = local[t[0]] < 0;
+        added += local[t[1]] < 0 && t[1] != t[0];
+        added += local[t[2]] < 0 && t[2] != t[0] && t[2] != t[1];
+        return added;
+    };
+    auto finish = [&]()
+    {
+        Meshlets.push_back(meshlet);
+        Bounds.push_back(computeBounds(meshlet, Indices, positions, positionStride));
+        for (unsigned int i = 0; i < meshlet.VertexCount; i++)
+            local[Vertices[meshlet.VertexOffset + i]] = -1;
+        meshlet = Meshlet();
+        meshlet.VertexOffset = (unsigned int)Vertices.size();
+        meshlet.TriangleOffset = (unsigned int)(Triangles.size() / 3);
+    };
+
+    for (size_t done = 0; done < triangleCount; done++)
+    {
+        // the neighbour adding the fewest vertices, a triangle closing a gap adds none
+        int best = -1;
+        unsigned int bestNew = 4;
+        for (size_t c = 0; c < candidates.size();)
+        {
+            unsigned int triangle = candidates[c];
+            if (emitted[triangle])
+            {
+                candidates[c] = candidates.back();
+                candidates.pop_back();
+                continue;
+            }
+            unsigned int added = newVertices(triangle);
+            if (added < bestNew)
+            {
+                best = (int)triangle;
+                bestNew = added;
+                if (added == 0)
+                    break;
+            }
+            c++;
+        }
+        // nothing adjacent left, e.g. a disconnected part: continue with the next triangle in index order
+        if (best < 0)
+        {
+            while (emitted[seedScan])
+                seedScan++;
+            best = (int)seedScan;
+            bestNew = newVertices(best);
+        }
+        // full: the triangle seeds the next meshlet, which therefore starts right next to this one
+        if (meshlet.VertexCount + bestNew > maxVertices || meshlet.TriangleCount + 1 > maxTriangles)
+        {
+            finish();
+            candidates.clear();
+        }
+
+        const unsigned int* t = &indices[best * 3];
+        for (int c = 0; c < 3; c++)
+        {
+            unsigned int v = t[c];
+            if (local[v] < 0)
+            {
+                local[v] = (int)meshlet.VertexCount++;
+                Vertices.push_back(v);
+                for (unsigned int k = offsets[v]; k < offsets[v + 1]; k++)
+                {
+                    if (!emitted[adjacent[k]])
+                        candidates.push_back(adjacent[k]);
+                }
+            }
+            Triangles.push_back((unsigned char)local[v]);
+            Indices.push_back(v);
+        }
+        emitted[best] = 1;
+        meshlet.TriangleCount++;
+    }
+    if (meshlet.TriangleCount > 0)
+        finish();
+    BuildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// a cluster of neighbouring triangles, ranges into MeshletMesh::Vertices and MeshletMesh::Triangles
+struct Meshlet
+{
+    unsigned int VertexOffset = 0;
+    unsigned int TriangleOffset = 0;
+    unsigned int VertexCount = 0;
+    unsigned int TriangleCount = 0;
+};
+
+// what cluster culling tests against, in the space of the mesh positions
+struct MeshletBounds
+{
+    glm::vec3 Center = glm::vec3(0.0f);
+    float Radius = 0.0f;
+    // every triangle normal is within the cone around ConeAxis, the cluster faces away from an eye at e when
+    // dot(Center - e, ConeAxis) >= ConeCutoff * length(Center - e) + Radius. a cutoff of 1 never culls
+    glm::vec3 ConeAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    float ConeCutoff = 1.0f;
+};
+
+// Splits an indexed triangle mesh into meshlets of at most MAX_VERTICES vertices and MAX_TRIANGLES triangles.
+// a meshlet grows from a seed triangle by the adjacent triangle adding the fewest new vertices, which keeps it
+// compact so its bounding sphere and normal cone are tight enough to cull it on its own.
+class MeshletMesh
+{
+public:
+    // the limits mesh shader hardware is tuned for, 124 keeps the local index block under 128 * 3 bytes
+    static const unsigned int MAX_VERTICES = 64;
+    static const unsigned int MAX_TRIANGLES = 124;
+
+    // positions are floats at a byte stride
+    void Build(const std::vector<unsigned int>& indices, const float* positions, size_t positionStride, size_t vertexCount,
+        unsigned int maxVertices = MAX_VERTICES, unsigned int maxTriangles = MAX_TRIANGLES);
+
+    std::vector<Meshlet> Meshlets;
+    std::vector<MeshletBounds> Bounds;
+    // mesh vertex of every meshlet vertex
+    std::vector<unsigned int> Vertices;
+    // three meshlet-local vertices per triangle
+    std::vector<unsigned char> Triangles;
+    // the triangles again as mesh indices, meshlet i is the range from Meshlets[i].TriangleOffset * 3, so without
+    // mesh shaders a meshlet is drawn as a range of one index buffer
+    std::vector<unsigned int> Indices;
+    double BuildSeconds = 0.0;
+};
@@ -0,0 +1,611 @@
+#include "ObjModel.h"
+#include <stb_image.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include "MappedFile.h"
+#include "Shader.h"
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double secondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // runs task(0 .. count-1) on up to threads worker threads
+    void parallelFor(size_t count, unsigned int threads, const std::function<void(size_t)>& task)
+    {
+        std::atomic<size_t> next(0);
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < std::min((size_t)threads, count); i++)
+        {
+            workers.emplace_back([&]()
+            {
+                for (size_t index = next++; index < count; index = next++)
+                    task(index);
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    void skipSpaces(const char*& p, const char* end)
+    {
+        while (p < end && isSpace(*p))
+            p++;
+    }
+
+    // decimal float without locale or allocation: [sign] digits [. digits] [e [sign] digits]. the mantissa is
+    // accumulated as an integer and scaled once, which is exact for the up to 9 significant digits OBJ
+    // exporters write and within a few ulp beyond
+    float parseFloat(const char*& p, const char* end)
+    {
+        static const double POWERS[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+            1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        skipSpaces(p, end);
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        int digits = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++)
+        {
+            // digits past what fits are dropped, the exponent keeps the magnitude
+            if (digits < 18)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+            }
+            else
+                exponent++;
+        }
+        if (p < end && *p == '.')
+        {
+            for (p++; p < end && *p >= '0' && *p <= '9'; p++)
+            {
+                if (digits < 18)
+                {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    digits += mantissa != 0;
+                    exponent--;
+                }
+            }
+        }
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            p++;
+            bool negativeExponent = false;
+            if (p < end && (*p == '-' || *p == '+'))
+                negativeExponent = *p++ == '-';
+            int value = 0;
+            for (; p < end && *p >= '0' && *p <= '9'; p++)
+                value = std::min(value * 10 + (*p - '0'), 1000);
+            exponent += negativeExponent ? -value : value;
+        }
+
+        double result = (double)mantissa;
+        while (exponent > 22)
+        {
+            result *= 1e22;
+            exponent -= 22;
+        }
+        while (exponent < -22)
+        {
+            result /= 1e22;
+            exponent += 22;
+        }
+        result = exponent >= 0 ? result * POWERS[exponent] : result / POWERS[-exponent];
+        return (float)(negative ? -result : result);
+    }
+
+    // integer with optional sign, 0 when there is none (OBJ indices are never 0)
+    int parseInt(const char*& p, const char* end)
+    {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+        int value = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++)
+            value = value * 10 + (*p - '0');
+        return negative ? -value : value;
+    }
+
+    // the rest of the line without surrounding spaces
+    std::string restOfLine(const char* p, const char* end)
+    {
+        skipSpaces(p, end);
+        const char* lineEnd = p;
+        while (lineEnd < end && *lineEnd != '\n')
+            lineEnd++;
+        while (lineEnd > p && isSpace(lineEnd[-1]))
+            lineEnd--;
+        return std::string(p, lineEnd);
+    }
+
+    bool keyword(const char* p, const char* end, const char* word, size_t length)
+    {
+        return (size_t)(end - p) > length && memcmp(p, word, length) == 0 && isSpace(p[length]);
+    }
+
+    // one face corner. indices are 0-based, positive ones are already global, relative (negative) ones are
+    // counted from the start of the chunk and made global once the chunk's base is known
+    struct Corner
+    {
+        int Position;
+        int TexCoord;   // -1 for none
+        unsigned char Relative;
+    };
+
+    const unsigned char RELATIVE_POSITION = 1;
+    const unsigned char RELATIVE_TEXCOORD = 2;
+
+    struct Chunk
+    {
+        const char* Begin;
+        const char* End;
+        std::vector<glm::vec3> Positions;
+        std::vector<glm::vec2> TexCoords;
+        std::vector<Corner> Corners;
+        // usemtl lines: first corner they apply to, material name
+        std::vector<std::pair<size_t, std::string>> MaterialSwitches;
+        std::vector<std::string> Libraries;
+        // welding: the chunk's unique (position, uv) keys and, per corner, its index among them
+        std::vector<uint64_t> UniqueKeys;
+        std::vector<unsigned int> LocalIndices;
+        std::vector<unsigned int> Remap;
+    };
+
+    // open addressing hash map from a (position, uv) key to a vertex index, far faster than std::unordered_map
+    // for the tens of millions of lookups of a big file. it doubles when half full
+    class WeldMap
+    {
+    public:
+        explicit WeldMap(size_t expected)
+        {
+            size_t capacity = 16;
+            while (capacity < expected * 2)
+                capacity *= 2;
+            resize(capacity);
+        }
+
+        // returns the index stored for key, storing candidate if the key is new
+        unsigned int Insert(uint64_t key, unsigned int candidate)
+        {
+            size_t slot = hash(key) & mask;
+            while (true)
+            {
+                if (keys[slot] == key)
+                    return values[slot];
+                if (keys[slot] == EMPTY)
+                    break;
+                slot = (slot + 1) & mask;
+            }
+            keys[slot] = key;
+            values[slot] = candidate;
+            if (++count * 2 > keys.size())
+                resize(keys.size() * 2);
+            return candidate;
+        }
+
+    private:
+        // positions are below 2^31, so no real key has every bit set
+        static const uint64_t EMPTY = ~0ull;
+        std::vector<uint64_t> keys;
+        std::vector<unsigned int> values;
+        size_t mask = 0;
+        size_t count = 0;
+
+        static size_t hash(uint64_t key)
+        {
+            // murmur3 finalizer
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdull;
+            key ^= key >> 33;
+            key *= 0xc4ceb9fe1a85ec53ull;
+            key ^= key >> 33;
+            return (size_t)key;
+        }
+
+        void resize(size_t capacity)
+        {
+            std::vector<uint64_t> oldKeys(capacity, (uint64_t)EMPTY);
+            std::vector<unsigned int> oldValues(capacity);
+            oldKeys.swap(keys);
+            oldValues.swap(values);
+            mask = capacity - 1;
+            for (size_t i = 0; i < oldKeys.size(); i++)
+            {
+                if (oldKeys[i] == EMPTY)
+                    continue;
+                size_t slot = hash(oldKeys[i]) & mask;
+                while (keys[slot] != EMPTY)
+                    slot = (slot + 1) & mask;
+                keys[slot] = oldKeys[i];
+                values[slot] = oldValues[i];
+            }
+        }
+    };
+
+    void parseChunk(Chunk& chunk)
+    {
+        const char* p = chunk.Begin;
+        const char* end = chunk.End;
+        std::vector<Corner> polygon;
+        // typical exporter output is around 30 bytes per v/vt line and 3 corners per 40 bytes of faces, a rough
+        // reservation saves most of the regrowth copies
+        size_t size = end - p;
+        chunk.Positions.reserve(size / 64);
+        chunk.TexCoords.reserve(size / 64);
+        chunk.Corners.reserve(size / 16);
+        while (p < end)
+        {
+            skipSpaces(p, end);
+            if (p + 1 < end && p[0] == 'v' && isSpace(p[1]))
+            {
+                p += 2;
+                float x = parseFloat(p, end);
+                float y = parseFloat(p, end);
+                float z = parseFloat(p, end);
+                chunk.Positions.push_back(glm::vec3(x, y, z));
+            }
+            else if (p + 2 < end && p[0] == 'v' && p[1] == 't' && isSpace(p[2]))
+            {
+                p += 3;
+                float u = parseFloat(p, end);
+                float v = parseFloat(p, end);
+                chunk.TexCoords.push_back(glm::vec2(u, v));
+            }
+            else if (p + 1 < end && p[0] == 'f' && isSpace(p[1]))
+            {
+                p += 2;
+                polygon.clear();
+                while (true)
+                {
+                    skipSpaces(p, end);
+                    if (p >= end || *p == '\n' || *p == '#')
+                        break;
+                    Corner corner = { 0, -1, 0 };
+                    int position = parseInt(p, end);
+                    if (position == 0)
+                        break;
+                    corner.Position = position > 0 ? position - 1 : (int)chunk.Positions.size() + position;
+                    corner.Relative |= position < 0 ? RELATIVE_POSITION : 0;
+                    if (p < end && *p == '/')
+                    {
+                        p++;
+                        int texCoord = parseInt(p, end);
+                        if (texCoord != 0)
+                        {
+                            corner.TexCoord = texCoord > 0 ? texCoord - 1 : (int)chunk.TexCoords.size() + texCoord;
+                            corner.Relative |= texCoord < 0 ? RELATIVE_TEXCOORD : 0;
+                        }
+                        // normal index, not part of the vertex layout
+                        if (p < end && *p == '/')
+                        {
+                            p++;
+                            parseInt(p, end);
+                        }
+                    }
+                    polygon.push_back(corner);
+                }
+                // triangle fan
+                for (size_t i = 2; i < polygon.size(); i++)
+                {
+                    chunk.Corners.push_back(polygon[0]);
+                    chunk.Corners.push_back(polygon[i - 1]);
+                    chunk.Corners.push_back(polygon[i]);
+                }
+            }
+            else if (keyword(p, end, "usemtl", 6))
+                chunk.MaterialSwitches.push_back(std::make_pair(chunk.Corners.size(), restOfLine(p + 6, end)));
+            else if (keyword(p, end, "mtllib", 6))
+                chunk.Libraries.push_back(restOfLine(p + 6, end));
+
+            // everything else (vn, o, g, s, comments) is skipped with the rest of the line
+            const char* newline = (const char*)memchr(p, '\n', end - p);
+            p = newline ? newline + 1 : end;
+        }
+    }
+}
+
+// std::max takes it by reference
+constexpr size_t ObjModel::MIN_CHUNK_SIZE;
+
+ObjModel::~ObjModel()
+{
+    release();
+}
+
+void ObjModel::release()
+{
+    if (VAO)
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+    VAO = VBO = EBO = 0;
+    for (ObjMaterial& material : Materials)
+    {
+        if (material.Texture)
+            glDeleteTextures(1, &material.Texture);
+    }
+    Vertices.clear();
+    Indices.clear();
+    Groups.clear();
+    Materials.clear();
+}
+
+bool ObjModel::Load(const std::string& path, unsigned int threads)
+{
+    release();
+    Stats = ObjLoadStats();
+    Stats.Threads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    Clock::time_point start = Clock::now();
+    directory = path.substr(0, path.find_last_of("/\\") + 1);
+
+    MappedFile file(path);
+    if (!file.IsOpen())
+    {
+        std::cout << "ERROR::OBJ::FILE_NOT_FOUND: " << path << std::endl;
+        return false;
+    }
+    Stats.FileBytes = file.Size();
+
+    // line-aligned chunks, a few per thread so uneven chunks even out
+    const char* text = (const char*)file.Data();
+    const char* textEnd = text + file.Size();
+    size_t chunkSize = std::max(MIN_CHUNK_SIZE, file.Size() / (Stats.Threads * 4) + 1);
+    std::vector<Chunk> chunks;
+    for (const char* begin = text; begin < textEnd;)
+    {
+        const char* end = begin + std::min(chunkSize, (size_t)(textEnd - begin));
+        if (end < textEnd)
+        {
+            const char* newline = (const char*)memchr(end, '\n', textEnd - end);
+            end = newline ? newline + 1 : textEnd;
+        }
+        chunks.emplace_back();
+        chunks.back().Begin = begin;
+        chunks.back().End = end;
+        begin = end;
+    }
+    Stats.Chunks = (unsigned int)chunks.size();
+    parallelFor(chunks.size(), Stats.Threads, [&](size_t i) { parseChunk(chunks[i]); });
+    Stats.ParseSeconds = secondsSince(start);
+
+    // where each chunk's positions, uvs and corners start globally
+    Clock::time_point weldStart = Clock::now();
+    std::vector<size_t> positionBase(chunks.size() + 1, 0), texCoordBase(chunks.size() + 1, 0), cornerBase(chunks.size() + 1, 0);
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        positionBase[i + 1] = positionBase[i] + chunks[i].Positions.size();
+        texCoordBase[i + 1] = texCoordBase[i] + chunks[i].TexCoords.size();
+        cornerBase[i + 1] = cornerBase[i] + chunks[i].Corners.size();
+    }
+    size_t positionCount = positionBase.back(), texCoordCount = texCoordBase.back();
+    Stats.Corners = cornerBase.back();
+    Stats.Triangles = Stats.Corners / 3;
+
+    // weld within every chunk: resolve the corners to global (position, uv) keys and dedupe them
+    parallelFor(chunks.size(), Stats.Threads, [&](size_t c)
+    {
+        Chunk& chunk = chunks[c];
+        // a closed mesh has about one vertex per six corners, the map grows if there are more
+        WeldMap local(chunk.Corners.size() / 6 + 1);
+        chunk.LocalIndices.resize(chunk.Corners.size());
+        for (size_t i = 0; i < chunk.Corners.size(); i++)
+        {
+            const Corner& corner = chunk.Corners[i];
+            long long position = corner.Position + ((corner.Relative & RELATIVE_POSITION) ? (long long)positionBase[c] : 0);
+            long long texCoord = corner.TexCoord + ((corner.Relative & RELATIVE_TEXCOORD) ? (long long)texCoordBase[c] : 0);
+            // indices past the arrays fall back to the first position / no uv instead of reading out of bounds
+            if (position < 0 || position >= (long long)positionCount)
+                position = 0;
+            if (texCoord < 0 || texCoord >= (long long)texCoordCount)
+                texCoord = -1;
+            uint64_t key = (uint64_t)position << 32 | (uint32_t)(texCoord + 1);
+            unsigned int index = local.Insert(key, (unsigned int)chunk.UniqueKeys.size());
+            if (index == chunk.UniqueKeys.size())
+                chunk.UniqueKeys.push_back(key);
+            chunk.LocalIndices[i] = index;
+        }
+        std::vector<Corner>().swap(chunk.Corners);
+    });
+
+    // weld across chunks, only the chunks' unique vertices are looked at
+    size_t uniqueCount = 0;
+    for (const Chunk& chunk : chunks)
+        uniqueCount += chunk.UniqueKeys.size();
+    WeldMap global(uniqueCount);
+    unsigned int vertexCount = 0;
+    for (Chunk& chunk : chunks)
+    {
+        chunk.Remap.resize(chunk.UniqueKeys.size());
+        for (size_t i = 0; i < chunk.UniqueKeys.size(); i++)
+        {
+            unsigned int index = global.Insert(chunk.UniqueKeys[i], vertexCount);
+            if (index == vertexCount)
+                vertexCount++;
+            chunk.Remap[i] = index;
+        }
+    }
+    Vertices.resize(vertexCount);
+    if (!Vertices.empty())
+    {
+        // fill the vertices from the keys, positions and uvs are read through the chunk that owns them
+        auto fetchPosition = [&](size_t index) -> glm::vec3
+        {
+            size_t c = std::upper_bound(positionBase.begin(), positionBase.end(), index) - positionBase.begin() - 1;
+            return chunks[c].Positions[index - positionBase[c]];
+        };
+        auto fetchTexCoord = [&](long long index) -> glm::vec2
+        {
+            if (index < 0)
+                return glm::vec2(0.0f);
+            size_t c = std::upper_bound(texCoordBase.begin(), texCoordBase.end(), (size_t)index) - texCoordBase.begin() - 1;
+            return chunks[c].TexCoords[(size_t)index - texCoordBase[c]];
+        };
+        parallelFor(chunks.size(), Stats.Threads, [&](size_t c)
+        {
+            const Chunk& chunk = chunks[c];
+            for (size_t i = 0; i < chunk.UniqueKeys.size(); i++)
+            {
+                ObjVertex& vertex = Vertices[chunk.Remap[i]];
+                vertex.Position = fetchPosition((size_t)(chunk.UniqueKeys[i] >> 32));
+                vertex.TexCoord = fetchTexCoord((long long)(chunk.UniqueKeys[i] & 0xFFFFFFFFu) - 1);
+            }
+        });
+    }
+    Indices.resize(Stats.Corners);
+    parallelFor(chunks.size(), Stats.Threads, [&](size_t c)
+    {
+        const Chunk& chunk = chunks[c];
+        for (size_t i = 0; i < chunk.LocalIndices.size(); i++)
+            Indices[cornerBase[c] + i] = chunk.Remap[chunk.LocalIndices[i]];
+    });
+    Stats.Vertices = Vertices.size();
+    Stats.WeldSeconds = secondsSince(weldStart);
+
+    // materials, then the usemtl runs become groups
+    Clock::time_point materialStart = Clock::now();
+    for (const Chunk& chunk : chunks)
+    {
+        for (const std::string& library : chunk.Libraries)
+            loadMaterials(library);
+    }
+    std::unordered_map<std::string, int> materialIndex;
+    for (size_t i = 0; i < Materials.size(); i++)
+        materialIndex[Materials[i].Name] = (int)i;
+    ObjGroup group;
+    for (size_t c = 0; c < chunks.size(); c++)
+    {
+        for (const std::pair<size_t, std::string>& change : chunks[c].MaterialSwitches)
+        {
+            unsigned int at = (unsigned int)(cornerBase[c] + change.first);
+            group.IndexCount = at - group.FirstIndex;
+            if (group.IndexCount)
+                Groups.push_back(group);
+            std::unordered_map<std::string, int>::const_iterator found = materialIndex.find(change.second);
+            group.Material = found != materialIndex.end() ? found->second : -1;
+            group.FirstIndex = at;
+        }
+    }
+    group.IndexCount = (unsigned int)Indices.size() - group.FirstIndex;
+    if (group.IndexCount)
+        Groups.push_back(group);
+    Stats.MaterialSeconds = secondsSince(materialStart);
+    Stats.TotalSeconds = secondsSince(start);
+    return true;
+}
+
+void ObjModel::loadMaterials(const std::string& library)
+{
+    MappedFile file(directory + library);
+    if (!file.IsOpen())
+    {
+        std::cout << "WARNING::OBJ::MATERIAL_LIBRARY_NOT_FOUND: " << directory + library << std::endl;
+        return;
+    }
+    const char* p = (const char*)file.Data();
+    const char* end = p + file.Size();
+    while (p < end)
+    {
+        skipSpaces(p, end);
+        if (keyword(p, end, "newmtl", 6))
+        {
+            Materials.push_back(ObjMaterial());
+            Materials.back().Name = restOfLine(p + 6, end);
+        }
+        else if (!Materials.empty() && keyword(p, end, "Kd", 2))
+        {
+            const char* values = p + 2;
+            float r = parseFloat(values, end);
+            float g = parseFloat(values, end);
+            float b = parseFloat(values, end);
+            Materials.back().Diffuse = glm::vec3(r, g, b);
+        }
+        else if (!Materials.empty() && keyword(p, end, "map_Kd", 6))
+        {
+            // options like -bm come before the file name, which is the last word
+            std::string value = restOfLine(p + 6, end);
+            size_t space = value.find_last_of(" \t");
+            Materials.back().DiffuseTexture = space == std::string::npos ? value : value.substr(space + 1);
+        }
+        const char* newline = (const char*)memchr(p, '\n', end - p);
+        p = newline ? newline + 1 : end;
+    }
+}
+
+void ObjModel::Upload()
+{
+    if (!VAO)
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+    }
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, Vertices.size() * sizeof(ObjVertex), Vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size() * sizeof(unsigned int), Indices.data(), GL_STATIC_DRAW);
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(ObjVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    // texture coordinate attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ObjVertex), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+
+    // OBJ puts uv (0, 0) at the bottom left, like GL once the image is flipped
+    stbi_set_flip_vertically_on_load(true);
+    for (ObjMaterial& material : Materials)
+    {
+        if (material.Texture || material.DiffuseTexture.empty())
+            continue;
+        int width, height, channels;
+        unsigned char* data = stbi_load((directory + material.DiffuseTexture).c_str(), &width, &height, &channels, 4);
+        if (!data)
+        {
+            std::cout << "Failed to load texture " << directory + material.DiffuseTexture << std::endl;
+            continue;
+        }
+        glGenTextures(1, &material.Texture);
+        glBindTexture(GL_TEXTURE_2D, material.Texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        stbi_image_free(data);
+    }
+}
+
+void ObjModel::Draw(Shader& shader) const
+{
+    shader.setInt("texture0", 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(VAO);
+    for (const ObjGroup& group : Groups)
+    {
+        unsigned int texture = group.Material >= 0 ? Materials[group.Material].Texture : 0;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glDrawElements(GL_TRIANGLES, group.IndexCount, GL_UNSIGNED_INT, (void*)(group.FirstIndex * sizeof(unsigned int)));
+    }
+    glBindVertexArray(0);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+class Shader;
+
+// interleaved vertex in the layout Textures.vs reads: position (location 0), texture coordinates (1)
+struct ObjVertex
+{
+    glm::vec3 Position;
+    glm::vec2 TexCoord;
+};
+
+struct ObjMaterial
+{
+    std::string Name;
+    glm::vec3 Diffuse = glm::vec3(1.0f);
+    // map_Kd relative to the .obj, empty for none
+    std::string DiffuseTexture;
+    // set by Upload()
+    unsigned int Texture = 0;
+};
+
+// a run of triangles between two usemtl lines
+struct ObjGroup
+{
+    int Material = -1;
+    unsigned int FirstIndex = 0;
+    unsigned int IndexCount = 0;
+};
+
+// where the time of the last Load() went
+struct ObjLoadStats
+{
+    double ParseSeconds = 0.0;    // chunks of text into positions, uvs and face corners
+    double WeldSeconds = 0.0;     // corners into unique vertices and indices
+    double MaterialSeconds = 0.0; // .mtl files
+    double TotalSeconds = 0.0;
+    size_t FileBytes = 0;
+    size_t Triangles = 0;
+    size_t Corners = 0;
+    size_t Vertices = 0;
+    unsigned int Threads = 0;
+    unsigned int Chunks = 0;
+
+    // bytes of .obj text parsed per second
+    double GetParseThroughput() const { return ParseSeconds > 0.0 ? FileBytes / ParseSeconds : 0.0; }
+};
+
+// Loads Wavefront .obj files with their .mtl materials into one indexed, interleaved buffer. the file is memory
+// mapped and split into line-aligned chunks that are parsed in parallel with a hand-written number parser, then
+// the face corners are welded into unique vertices with a hash map (per chunk in parallel, then across chunks).
+// polygons are fanned into triangles, negative (relative) indices are supported, normals are skipped.
+class ObjModel
+{
+public:
+    // chunks are at least this large so tiny files are not split into pieces smaller than the thread overhead
+    static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+    ObjModel() {}
+    ~ObjModel();
+    ObjModel(const ObjModel&) = delete;
+    ObjModel& operator=(const ObjModel&) = delete;
+
+    // loads path with threads workers (0 for one per hardware thread), returns false and prints why on failure
+    bool Load(const std::string& path, unsigned int threads = 0);
+    // creates the vertex array and the diffuse textures, the CPU copies of the vertices and indices are kept
+    void Upload();
+    // draws every group, binding its diffuse texture as "texture0" on unit 0
+    void Draw(Shader& shader) const;
+
+    std::vector<ObjVertex> Vertices;
+    std::vector<unsigned int> Indices;
+    std::vector<ObjGroup> Groups;
+    std::vector<ObjMaterial> Materials;
+    ObjLoadStats Stats;
+
+private:
+    unsigned int VAO = 0;
+    unsigned int VBO = 0;
+    unsigned int EBO = 0;
+    std::string directory;
+
+    void release();
+    void loadMaterials(const std::string& library);
+};
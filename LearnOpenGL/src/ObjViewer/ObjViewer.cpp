@@ -0,0 +1,203 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include "ObjViewer.h"
+#include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../ObjModel.h"
+
+namespace ObjViewer
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // the file to load, generated on first run when it does not exist
+    const char* MODEL_PATH = "models/Synthetic.obj";
+    const char* MATERIAL_LIBRARY = "Synthetic.mtl";
+    // SYNTHETIC_TILES height fields of SYNTHETIC_GRID x SYNTHETIC_GRID vertices, about 520 MB of text
+    const int SYNTHETIC_TILES = 16;
+    const int SYNTHETIC_GRID = 512;
+    const float SYNTHETIC_TILE = 10.0f;
+
+    // the camera orbits the model by a fixed step per frame
+    const float SCRIPT_STEP = 1.0f / 60.0f;
+
+    // writes an .obj of wavy quads tiles, each with its own positions and uvs and a material per tile row, and
+    // the .mtl next to it. faces are quads with v/vt/vn corners like most exporters write them
+    bool writeSyntheticModel(const std::string& path)
+    {
+        std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+        FILE* mtl = fopen((directory + MATERIAL_LIBRARY).c_str(), "w");
+        FILE* obj = fopen(path.c_str(), "w");
+        if (!mtl || !obj)
+        {
+            std::cout << "Failed to write " << path << " (does the models directory exist?)" << std::endl;
+            if (mtl)
+                fclose(mtl);
+            if (obj)
+                fclose(obj);
+            return false;
+        }
+        fprintf(mtl, "newmtl container\nKd 1.0 1.0 1.0\nmap_Kd ../textures/Container.jpg\n\n");
+        fprintf(mtl, "newmtl wall\nKd 0.8 0.8 0.8\nmap_Kd ../textures/Wall.jpg\n");
+        fclose(mtl);
+
+        fprintf(obj, "# synthetic benchmark model\nmtllib %s\n", MATERIAL_LIBRARY);
+        fprintf(obj, "vn 0 1 0\n");
+        int base = 1;
+        for (int tile = 0; tile < SYNTHETIC_TILES; tile++)
+        {
+            float offsetX = (tile % 4 - 1.5f) * SYNTHETIC_TILE, offsetZ = (tile / 4 - 1.5f) * SYNTHETIC_TILE;
+            fprintf(obj, "o tile%d\n", tile);
+            for (int y = 0; y < SYNTHETIC_GRID; y++)
+                for (int x = 0; x < SYNTHETIC_GRID; x++)
+                {
+                    float u = (float)x / (SYNTHETIC_GRID - 1), v = (float)y / (SYNTHETIC_GRID - 1);
+                    float px = (u - 0.5f) * SYNTHETIC_TILE, pz = (v - 0.5f) * SYNTHETIC_TILE;
+                    float height = 0.5f * sin(px + tile) * cos(pz * 1.3f + tile);
+                    fprintf(obj, "v %.6f %.6f %.6f\nvt %.6f %.6f\n", px + offsetX, height, pz + offsetZ, u * 4.0f, v * 4.0f);
+                }
+            fprintf(obj, "usemtl %s\n", tile / 4 % 2 ? "wall" : "container");
+            for (int y = 0; y + 1 < SYNTHETIC_GRID; y++)
+                for (int x = 0; x + 1 < SYNTHETIC_GRID; x++)
+                {
+                    int i = base + y * SYNTHETIC_GRID + x;
+                    fprintf(obj, "f %d/%d/1 %d/%d/1 %d/%d/1 %d/%d/1\n", i, i, i + SYNTHETIC_GRID, i + SYNTHETIC_GRID,
+                        i + SYNTHETIC_GRID + 1, i + SYNTHETIC_GRID + 1, i + 1, i + 1);
+                }
+            base += SYNTHETIC_GRID * SYNTHETIC_GRID;
+        }
+        fclose(obj);
+        return true;
+    }
+
+    void printStats(const ObjLoadStats& stats)
+    {
+        printf("%2u thread(s), %3u chunks: total %8.2f ms (parse %8.2f, weld %8.2f, materials %5.2f) parse %6.2f GB/s, %zu triangles, %zu vertices\n",
+            stats.Threads, stats.Chunks, stats.TotalSeconds * 1000.0, stats.ParseSeconds * 1000.0, stats.WeldSeconds * 1000.0,
+            stats.MaterialSeconds * 1000.0, stats.GetParseThroughput() / 1e9, stats.Triangles, stats.Vertices);
+    }
+
+    int Main()
+    {
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        FILE* existing = fopen(MODEL_PATH, "rb");
+        if (existing)
+            fclose(existing);
+        else
+        {
+            std::cout << "Writing " << MODEL_PATH << "..." << std::endl;
+            if (!writeSyntheticModel(MODEL_PATH))
+                return -1;
+        }
+
+        // load benchmark: thread counts doubling up to the hardware's, the first run also pays for the disk reads
+        ObjModel model;
+        unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int threads = 1; ; threads = std::min(threads * 2, hardwareThreads))
+        {
+            if (!model.Load(MODEL_PATH, threads))
+                return -1;
+            printStats(model.Stats);
+            if (threads == hardwareThreads)
+                break;
+        }
+        model.Upload();
+
+        // the OBJ layout is the one of the textured cubes, only the first texture is shown
+        Shader shader("shaders/VertexShaders/Textures.vs", "shaders/FragmentShaders/Textures.fs");
+        shader.use();
+        shader.setFloat("mixValue", 0.0f);
+
+        // render loop
+        float scriptTime = 0.0f;
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            processInput(window);
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            float radius = SYNTHETIC_TILE * 4.0f;
+            glm::vec3 eye(radius * cos(scriptTime * 0.2f), SYNTHETIC_TILE * 2.0f, radius * sin(scriptTime * 0.2f));
+            shader.use();
+            shader.setMat4("projection", glm::perspective(glm::radians(45.0f), (float)width / (float)std::max(height, 1), 0.1f, 500.0f));
+            shader.setMat4("view", glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+            shader.setMat4("model", glm::mat4(1.0f));
+            model.Draw(shader);
+            scriptTime += SCRIPT_STEP;
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+    }
+}
@@ -0,0 +1,4 @@
+namespace ObjViewer
+{
+    int Main();
+};
\ No newline at end of file
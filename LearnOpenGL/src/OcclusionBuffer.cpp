@@ -0,0 +1,218 @@
+#include "OcclusionBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <xmmintrin.h>
+
+namespace
+{
+    // clip w below this counts as at or behind the eye
+    const float MIN_W = 1e-4f;
+
+    // between the eye and the near plane, where z < -w in GL's clip space, or behind the eye. such points would get
+    // depths below 0, nearer than anything really visible
+    bool beforeNearPlane(const glm::vec4& clip)
+    {
+        return clip.w < MIN_W || clip.z < -clip.w;
+    }
+}
+
+OcclusionBuffer::OcclusionBuffer(int width, int height) : width((std::max(width, 4) + 3) & ~3), height(std::max(height, 1))
+{
+    int levelWidth = this->width, levelHeight = this->height;
+    while (true)
+    {
+        levels.push_back(std::vector<float>((size_t)levelWidth * levelHeight, 1.0f));
+        levelWidths.push_back(levelWidth);
+        levelHeights.push_back(levelHeight);
+        if (levelWidth == 1 && levelHeight == 1)
+            break;
+        levelWidth = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+    }
+}
+
+void OcclusionBuffer::Begin(const glm::mat4& viewProjection)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    this->viewProjection = viewProjection;
+    std::fill(levels[0].begin(), levels[0].end(), 1.0f);
+    Stats = OcclusionStats();
+    Stats.RasterSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void OcclusionBuffer::AddOccluder(const glm::mat4& model, const glm::vec3* positions, size_t vertexCount, const unsigned int* indices, size_t indexCount)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    glm::mat4 modelViewProjection = viewProjection * model;
+    clip.resize(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        clip[v] = modelViewProjection * glm::vec4(positions[v], 1.0f);
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+        rasterizeTriangle(clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]]);
+    Stats.RasterSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void OcclusionBuffer::rasterizeTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2)
+{
+    if (beforeNearPlane(c0) || beforeNearPlane(c1) || beforeNearPlane(c2))
+        return;
+    // window coordinates, pixel centers at half integers
+    glm::vec3 p[3];
+    const glm::vec4* corners[3] = { &c0, &c1, &c2 };
+    for (int i = 0; i < 3; i++)
+    {
+        glm::vec3 ndc = glm::vec3(*corners[i]) / corners[i]->w;
+        p[i] = glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+    }
+    if (p[0].z > 1.0f && p[1].z > 1.0f && p[2].z > 1.0f)
+        return;
+    float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+    if (std::fabs(area) < 1e-8f)
+        return;
+    // occluders count from both sides, make the winding counterclockwise so every edge function is positive inside
+    if (area < 0.0f)
+    {
+        std::swap(p[1], p[2]);
+        area = -area;
+    }
+
+    int minX = std::max((int)std::floor(std::min(p[0].x, std::min(p[1].x, p[2].x))), 0);
+    int maxX = std::min((int)std::ceil(std::max(p[0].x, std::max(p[1].x, p[2].x))), width - 1);
+    int minY = std::max((int)std::floor(std::min(p[0].y, std::min(p[1].y, p[2].y))), 0);
+    int maxY = std::min((int)std::ceil(std::max(p[0].y, std::max(p[1].y, p[2].y))), height - 1);
+    if (minX > maxX || minY > maxY)
+        return;
+    Stats.OccluderTriangles++;
+
+    // edge i runs from vertex i to i + 1, e(x, y) = a * x + b * y + c is the triangle's area at the opposite vertex
+    float a[3], b[3], c[3];
+    for (int i = 0; i < 3; i++)
+    {
+        const glm::vec3& from = p[i];
+        const glm::vec3& to = p[(i + 1) % 3];
+        a[i] = -(to.y - from.y);
+        b[i] = to.x - from.x;
+        c[i] = (to.y - from.y) * from.x - (to.x - from.x) * from.y;
+    }
+    // depth is linear in window space, the barycentric weight of a vertex is the edge opposite it over the area
+    float depthA = (a[1] * p[0].z + a[2] * p[1].z + a[0] * p[2].z) / area;
+    float depthB = (b[1] * p[0].z + b[2] * p[1].z + b[0] * p[2].z) / area;
+    float depthC = (c[1] * p[0].z + c[2] * p[1].z + c[0] * p[2].z) / area;
+
+    const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    __m128 edgeStep[3];
+    for (int i = 0; i < 3; i++)
+        edgeStep[i] = _mm_set1_ps(a[i] * 4.0f);
+    __m128 depthStep = _mm_set1_ps(depthA * 4.0f);
+    __m128 zero = _mm_setzero_ps();
+    int startX = minX & ~3;
+    __m128 startPixels = _mm_add_ps(_mm_set1_ps((float)startX), laneOffsets);
+
+    for (int y = minY; y <= maxY; y++)
+    {
+        float centerY = y + 0.5f;
+        __m128 edge[3];
+        for (int i = 0; i < 3; i++)
+            edge[i] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[i]), startPixels), _mm_set1_ps(b[i] * centerY + c[i]));
+        __m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(depthA), startPixels), _mm_set1_ps(depthB * centerY + depthC));
+        float* row = &levels[0][(size_t)y * width];
+        for (int x = startX; x <= maxX; x += 4)
+        {
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge[0], zero), _mm_cmpge_ps(edge[1], zero)), _mm_cmpge_ps(edge[2], zero));
+            if (_mm_movemask_ps(inside))
+            {
+                __m128 old = _mm_loadu_ps(row + x);
+                __m128 nearer = _mm_and_ps(inside, _mm_cmplt_ps(depth, old));
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(nearer, depth), _mm_andnot_ps(nearer, old)));
+            }
+            for (int i = 0; i < 3; i++)
+                edge[i] = _mm_add_ps(edge[i], edgeStep[i]);
+            depth = _mm_add_ps(depth, depthStep);
+        }
+    }
+}
+
+void OcclusionBuffer::BuildPyramid()
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t l = 1; l < levels.size(); l++)
+    {
+        const std::vector<float>& source = levels[l - 1];
+        std::vector<float>& target = levels[l];
+        int sourceWidth = levelWidths[l - 1], sourceHeight = levelHeights[l - 1];
+        int targetWidth = levelWidths[l], targetHeight = levelHeights[l];
+        for (int y = 0; y < targetHeight; y++)
+        {
+            // an odd last row or column is covered by one texel instead of two
+            const float* row0 = &source[(size_t)(y * 2) * sourceWidth];
+            const float* row1 = &source[(size_t)std::min(y * 2 + 1, sourceHeight - 1) * sourceWidth];
+            float* out = &target[(size_t)y * targetWidth];
+            int x = 0;
+            // four target texels from eight source texels of both rows
+            if (sourceWidth % 8 == 0)
+            {
+                for (; x < targetWidth; x += 4)
+                {
+                    __m128 low = _mm_max_ps(_mm_loadu_ps(row0 + x * 2), _mm_loadu_ps(row1 + x * 2));
+                    __m128 high = _mm_max_ps(_mm_loadu_ps(row0 + x * 2 + 4), _mm_loadu_ps(row1 + x * 2 + 4));
+                    __m128 even = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+                    __m128 odd = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+                    _mm_storeu_ps(out + x, _mm_max_ps(even, odd));
+                }
+            }
+            for (; x < targetWidth; x++)
+            {
+                int x1 = std::min(x * 2 + 1, sourceWidth - 1);
+                out[x] = std::max(std::max(row0[x * 2], row0[x1]), std::max(row1[x * 2], row1[x1]));
+            }
+        }
+    }
+    Stats.RasterSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool OcclusionBuffer::IsOccluded(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Stats.Tested++;
+    glm::vec2 windowMin(1e30f), windowMax(-1e30f);
+    float nearest = 1.0f;
+    bool crossesNear = false;
+    for (int corner = 0; corner < 8; corner++)
+    {
+        glm::vec3 position((corner & 1) ? boundsMax.x : boundsMin.x, (corner & 2) ? boundsMax.y : boundsMin.y, (corner & 4) ? boundsMax.z : boundsMin.z);
+        glm::vec4 clipPosition = viewProjection * glm::vec4(position, 1.0f);
+        if (beforeNearPlane(clipPosition))
+        {
+            crossesNear = true;
+            break;
+        }
+        glm::vec3 ndc = glm::vec3(clipPosition) / clipPosition.w;
+        glm::vec2 window((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height);
+        windowMin = glm::min(windowMin, window);
+        windowMax = glm::max(windowMax, window);
+        nearest = std::min(nearest, ndc.z * 0.5f + 0.5f);
+    }
+
+    bool occluded = false;
+    int minX = std::max((int)std::floor(windowMin.x), 0), maxX = std::min((int)std::floor(windowMax.x), width - 1);
+    int minY = std::max((int)std::floor(windowMin.y), 0), maxY = std::min((int)std::floor(windowMax.y), height - 1);
+    if (!crossesNear && minX <= maxX && minY <= maxY)
+    {
+        // the finest level where the rectangle is at most 2 x 2 texels, or the whole last level
+        size_t level = 0;
+        while (level + 1 < levels.size() && ((maxX >> level) - (minX >> level) > 1 || (maxY >> level) - (minY >> level) > 1))
+            level++;
+        int levelWidth = levelWidths[level];
+        const std::vector<float>& depth = levels[level];
+        float farthest = 0.0f;
+        for (int y = minY >> level; y <= (maxY >> level); y++)
+            for (int x = minX >> level; x <= (maxX >> level); x++)
+                farthest = std::max(farthest, depth[(size_t)y * levelWidth + x]);
+        occluded = nearest > farthest;
+    }
+    if (occluded)
+        Stats.Occluded++;
+    Stats.TestSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return occluded;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// what the occlusion buffer did since the last Begin()
+struct OcclusionStats
+{
+    unsigned int OccluderTriangles = 0;
+    unsigned int Tested = 0;
+    unsigned int Occluded = 0;
+    // Begin() to BuildPyramid(), i.e. clearing, rasterizing and the pyramid
+    double RasterSeconds = 0.0;
+    double TestSeconds = 0.0;
+};
+
+// Software occlusion culling: a few large occluders are rasterized on the CPU into a small depth buffer, four pixels
+// at a time with SSE, a hierarchical Z pyramid of the farthest depth per texel is built from it and object bounds
+// are tested against the pyramid level where they cover at most 2 x 2 texels. works the same on every GPU and
+// needs no read back of the real depth buffer, which would stall the pipeline or lag a frame behind.
+// depths are window depths in [0, 1], 1 is the far plane.
+class OcclusionBuffer
+{
+public:
+    // width is rounded up to a multiple of 4, a quarter or less of the window is plenty
+    OcclusionBuffer(int width, int height);
+
+    // clears the buffer for a new view
+    void Begin(const glm::mat4& viewProjection);
+    // rasterizes an indexed triangle mesh. triangles crossing the near plane are skipped, which only ever loses
+    // occlusion, so occluders should be large and closed and objects should not be occluders of themselves
+    void AddOccluder(const glm::mat4& model, const glm::vec3* positions, size_t vertexCount, const unsigned int* indices, size_t indexCount);
+    // builds the pyramid, call after the last AddOccluder()
+    void BuildPyramid();
+    // true when the world space box is certainly behind the occluders. boxes crossing the near plane or
+    // outside the view are never occluded, frustum culling is up to the caller
+    bool IsOccluded(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    // the rasterized depth, rows bottom up
+    const std::vector<float>& GetDepth() const { return levels[0]; }
+
+    OcclusionStats Stats;
+
+private:
+    int width, height;
+    glm::mat4 viewProjection;
+    // levels[0] is the rasterized depth, every further level the farthest depth of 2 x 2 texels of the one before
+    std::vector<std::vector<float>> levels;
+    std::vector<int> levelWidths, levelHeights;
+    // clip space vertices of the occluder being added
+    std::vector<glm::vec4> clip;
+
+    void rasterizeTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2);
+};
@@ -0,0 +1,350 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "OcclusionCulling.h"
+#include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../ClusterCuller.h"
+#include "../OcclusionBuffer.h"
+#include "../RenderStats.h"
+#include "../VertexFormat.h"
+
+namespace OcclusionCulling
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // BLOCKS x BLOCKS buildings on a street grid, the occluders
+    const int BLOCKS = 12;
+    const float BLOCK_PITCH = 12.0f;
+    const float BUILDING_SIZE = 9.0f;
+    // small objects in the streets, each a cube of OBJECT_SUBDIVISIONS^2 quads per side (768 triangles)
+    const int OBJECT_COUNT = 10000;
+    const int OBJECT_SUBDIVISIONS = 8;
+    const float OBJECT_SIZE = 0.6f;
+
+    // the software depth buffer, about a tenth of the window in each direction
+    const int OCCLUSION_WIDTH = 256;
+    const int OCCLUSION_HEIGHT = 192;
+
+    // switched with the 1/2 keys
+    bool useOcclusion = true;
+
+    // the walk advances by a fixed step per frame, so both modes see the same camera path
+    const float SCRIPT_STEP = 1.0f / 60.0f;
+    // around the ring of streets WALK_RING blocks out from the center, at eye height
+    const float WALK_RING = 3.0f * BLOCK_PITCH;
+    const float WALK_SPEED = 6.0f;
+    const float EYE_HEIGHT = 1.7f;
+
+    struct Vertex
+    {
+        glm::vec3 Position;
+        glm::vec3 Normal;
+        glm::vec2 TexCoord;
+    };
+
+    // a unit cube centered on the origin with subdivisions x subdivisions quads per side
+    void addCube(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, int subdivisions)
+    {
+        for (int face = 0; face < 6; face++)
+        {
+            int axis = face / 2;
+            float sign = (face % 2) ? -1.0f : 1.0f;
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = sign;
+            u[(axis + 1) % 3] = sign;
+            v[(axis + 2) % 3] = 1.0f;
+            unsigned int base = (unsigned int)vertices.size();
+            for (int y = 0; y <= subdivisions; y++)
+                for (int x = 0; x <= subdivisions; x++)
+                {
+                    float s = (float)x / subdivisions, t = (float)y / subdivisions;
+                    vertices.push_back({ normal * 0.5f + u * (s - 0.5f) + v * (t - 0.5f), normal, glm::vec2(s, t) });
+                }
+            for (int y = 0; y < subdivisions; y++)
+                for (int x = 0; x < subdivisions; x++)
+                {
+                    unsigned int i = base + y * (subdivisions + 1) + x;
+                    indices.insert(indices.end(), { i, i + 1, i + subdivisions + 2, i, i + subdivisions + 2, i + subdivisions + 1 });
+                }
+        }
+    }
+
+    // true when the point is on a building or too close to one for an object
+    bool onBuilding(float x, float z, float margin)
+    {
+        float half = BLOCKS * BLOCK_PITCH * 0.5f;
+        float localX = std::fmod(x + half, BLOCK_PITCH), localZ = std::fmod(z + half, BLOCK_PITCH);
+        float from = (BLOCK_PITCH - BUILDING_SIZE) * 0.5f - margin, to = (BLOCK_PITCH + BUILDING_SIZE) * 0.5f + margin;
+        return localX > from && localX < to && localZ > from && localZ < to;
+    }
+
+    int Main()
+    {
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        Shader shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs");
+
+        // the detailed object cube first, then the plain cube of the buildings and the ground
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        addCube(vertices, indices, OBJECT_SUBDIVISIONS);
+        const GLsizei objectIndexCount = (GLsizei)indices.size();
+        const size_t boxFirstIndex = indices.size();
+        addCube(vertices, indices, 1);
+        const GLsizei boxIndexCount = (GLsizei)(indices.size() - boxFirstIndex);
+
+        // the occluder mesh, the same unit cube with shared corners
+        glm::vec3 occluderCorners[8];
+        for (int corner = 0; corner < 8; corner++)
+            occluderCorners[corner] = glm::vec3((corner & 1) ? 0.5f : -0.5f, (corner & 2) ? 0.5f : -0.5f, (corner & 4) ? 0.5f : -0.5f);
+        const unsigned int occluderIndices[] = {
+            0, 1, 3, 0, 3, 2,  4, 6, 7, 4, 7, 5,  0, 4, 5, 0, 5, 1,
+            2, 3, 7, 2, 7, 6,  0, 2, 6, 0, 6, 4,  1, 5, 7, 1, 7, 3
+        };
+
+        // the same city every run
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        float half = BLOCKS * BLOCK_PITCH * 0.5f;
+        std::vector<glm::mat4> buildings;
+        for (int x = 0; x < BLOCKS; x++)
+            for (int z = 0; z < BLOCKS; z++)
+            {
+                float height = 6.0f + 14.0f * unit(random);
+                glm::vec3 center(-half + BLOCK_PITCH * (x + 0.5f), height * 0.5f, -half + BLOCK_PITCH * (z + 0.5f));
+                buildings.push_back(glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(BUILDING_SIZE, height, BUILDING_SIZE)));
+            }
+        std::vector<glm::vec3> objects;
+        while (objects.size() < OBJECT_COUNT)
+        {
+            glm::vec3 position((unit(random) - 0.5f) * 2.0f * half, OBJECT_SIZE * 0.5f + unit(random) * 2.0f, (unit(random) - 0.5f) * 2.0f * half);
+            if (!onBuilding(position.x, position.z, OBJECT_SIZE))
+                objects.push_back(position);
+        }
+
+        VertexFormat format;
+        format.Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+        unsigned int VAO, VBO, EBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        format.Apply();
+
+        // untextured, the tints only color a white texel
+        unsigned int whiteTexture;
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        shader.use();
+        shader.setInt("baseColor", 0);
+        shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+
+        OcclusionBuffer occlusion(OCCLUSION_WIDTH, OCCLUSION_HEIGHT);
+        const glm::mat4 ground = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.05f, 0.0f)), glm::vec3(2.0f * half, 0.1f, 2.0f * half));
+        const float objectRadius = OBJECT_SIZE * 0.5f * std::sqrt(3.0f);
+
+        // render loop
+        float walked = 0.0f;
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        double reportInFrustum = 0.0, reportOccluded = 0.0, reportTriangles = 0.0, reportOcclusionSeconds = 0.0;
+        // last reported frame time of each mode, for the net saving
+        double frameMilliseconds[2] = { 0.0, 0.0 };
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            processInput(window);
+
+            // walk the square of streets around the center, looking ahead
+            float side = std::fmod(walked, 8.0f * WALK_RING);
+            int leg = (int)(side / (2.0f * WALK_RING));
+            float along = side - leg * 2.0f * WALK_RING - WALK_RING;
+            glm::vec3 eye, forward;
+            switch (leg)
+            {
+            case 0: eye = glm::vec3(along, EYE_HEIGHT, -WALK_RING); forward = glm::vec3(1.0f, 0.0f, 0.0f); break;
+            case 1: eye = glm::vec3(WALK_RING, EYE_HEIGHT, along); forward = glm::vec3(0.0f, 0.0f, 1.0f); break;
+            case 2: eye = glm::vec3(-along, EYE_HEIGHT, WALK_RING); forward = glm::vec3(-1.0f, 0.0f, 0.0f); break;
+            default: eye = glm::vec3(-WALK_RING, EYE_HEIGHT, -along); forward = glm::vec3(0.0f, 0.0f, -1.0f); break;
+            }
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / (float)std::max(height, 1), 0.1f, 300.0f);
+            glm::mat4 view = glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::mat4 viewProjection = projection * view;
+            glm::vec4 planes[6];
+            ClusterCuller::ExtractFrustumPlanes(viewProjection, planes);
+
+            // the buildings are drawn anyway, they double as the occluders
+            if (useOcclusion)
+            {
+                occlusion.Begin(viewProjection);
+                for (const glm::mat4& building : buildings)
+                    occlusion.AddOccluder(building, occluderCorners, 8, occluderIndices, 36);
+                occlusion.BuildPyramid();
+            }
+
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            shader.setMat4("projection", projection);
+            shader.setMat4("view", view);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            glBindVertexArray(VAO);
+
+            shader.setVec4("baseColorFactor", glm::vec4(0.45f, 0.45f, 0.45f, 1.0f));
+            shader.setMat4("model", ground);
+            glDrawElements(GL_TRIANGLES, boxIndexCount, GL_UNSIGNED_INT, (void*)(boxFirstIndex * sizeof(unsigned int)));
+            shader.setVec4("baseColorFactor", glm::vec4(0.75f, 0.72f, 0.68f, 1.0f));
+            for (const glm::mat4& building : buildings)
+            {
+                shader.setMat4("model", building);
+                glDrawElements(GL_TRIANGLES, boxIndexCount, GL_UNSIGNED_INT, (void*)(boxFirstIndex * sizeof(unsigned int)));
+            }
+            RenderStats::Frame.DrawCalls += (unsigned int)buildings.size() + 1;
+            RenderStats::Frame.Triangles += (unsigned int)(buildings.size() + 1) * boxIndexCount / 3;
+
+            shader.setVec4("baseColorFactor", glm::vec4(1.0f, 0.55f, 0.2f, 1.0f));
+            unsigned int inFrustum = 0;
+            for (const glm::vec3& object : objects)
+            {
+                bool outside = false;
+                for (int p = 0; p < 6 && !outside; p++)
+                    outside = glm::dot(glm::vec3(planes[p]), object) + planes[p].w < -objectRadius;
+                if (outside)
+                    continue;
+                inFrustum++;
+                if (useOcclusion && occlusion.IsOccluded(object - OBJECT_SIZE * 0.5f, object + OBJECT_SIZE * 0.5f))
+                    continue;
+                shader.setMat4("model", glm::scale(glm::translate(glm::mat4(1.0f), object), glm::vec3(OBJECT_SIZE)));
+                glDrawElements(GL_TRIANGLES, objectIndexCount, GL_UNSIGNED_INT, 0);
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += objectIndexCount / 3;
+            }
+
+            RenderStats::EndFrame();
+            reportInFrustum += inFrustum;
+            if (useOcclusion)
+            {
+                reportOccluded += occlusion.Stats.Occluded;
+                reportOcclusionSeconds += occlusion.Stats.RasterSeconds + occlusion.Stats.TestSeconds;
+            }
+            reportTriangles += RenderStats::Last.Triangles;
+            reportFrames++;
+            walked += SCRIPT_STEP * WALK_SPEED;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                double frame = (now - reportStart) * 1000.0 / reportFrames;
+                frameMilliseconds[useOcclusion] = frame;
+                printf("%-16s objects in frustum %6.0f, occluded %5.1f%%, triangles/frame %9.0f, occlusion %6.3f ms, frame %6.3f ms",
+                    useOcclusion ? "frustum+occlusion" : "frustum only", reportInFrustum / reportFrames,
+                    reportInFrustum > 0.0 ? reportOccluded * 100.0 / reportInFrustum : 0.0, reportTriangles / reportFrames,
+                    reportOcclusionSeconds * 1000.0 / reportFrames, frame);
+                // the other mode's last report was on another part of the walk, switch back and forth for a fair number
+                if (frameMilliseconds[0] > 0.0 && frameMilliseconds[1] > 0.0)
+                    printf(", net saved %6.3f ms", frameMilliseconds[0] - frameMilliseconds[1]);
+                printf("\n");
+                reportStart = now;
+                reportFrames = 0;
+                reportInFrustum = 0.0;
+                reportOccluded = 0.0;
+                reportTriangles = 0.0;
+                reportOcclusionSeconds = 0.0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        glDeleteTextures(1, &whiteTexture);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            useOcclusion = false;
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+            useOcclusion = true;
+    }
+}
@@ -0,0 +1,4 @@
+namespace OcclusionCulling
+{
+    int Main();
+};
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "QuaternionCamera.h"
+#include "FastTrig.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const float MAX_PITCH = 89.0f;
+    const float MIN_DISTANCE = 0.1f;
+
+    // a critically damped spring from current toward target over smoothTime, exact for a target that holds still
+    // during deltaTime; it neither overshoots nor lags behind more than it has to
+    float smoothDamp(float current, float target, float& velocity, float smoothTime, float deltaTime)
+    {
+        float omega = 2.0f / smoothTime;
+        float change = current - target;
+        float impulse = (velocity + omega * change) * deltaTime;
+        float decay = std::exp(-omega * deltaTime);
+        velocity = (velocity - omega * impulse) * decay;
+        return target + (change + impulse) * decay;
+    }
+}
+
+QuaternionCamera::QuaternionCamera(glm::vec3 position, float yaw, float pitch) : Position(position), Yaw(yaw), Pitch(pitch),
+    MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM), SmoothTime(0.0f), Orbit(false), Target(0.0f), Distance(1.0f),
+    targetYaw(yaw), targetPitch(pitch), yawVelocity(0.0f), pitchVelocity(0.0f), pendingYaw(0.0f), pendingPitch(0.0f), constrainPitch(true)
+{
+    updateOrientation();
+}
+
+void QuaternionCamera::Update(float deltaTime)
+{
+    targetYaw += pendingYaw;
+    targetPitch += pendingPitch;
+    pendingYaw = 0.0f;
+    pendingPitch = 0.0f;
+    if (constrainPitch)
+        targetPitch = glm::clamp(targetPitch, -MAX_PITCH, MAX_PITCH);
+    // whole turns dropped from both angles at once, so the spring doesn't see them and the floats stay precise
+    if (std::fabs(targetYaw) > 360.0f)
+    {
+        float turns = 360.0f * std::floor(targetYaw / 360.0f);
+        targetYaw -= turns;
+        Yaw -= turns;
+    }
+
+    if (SmoothTime > 0.0f && deltaTime > 0.0f)
+    {
+        Yaw = smoothDamp(Yaw, targetYaw, yawVelocity, SmoothTime, deltaTime);
+        Pitch = smoothDamp(Pitch, targetPitch, pitchVelocity, SmoothTime, deltaTime);
+    }
+    else
+    {
+        Yaw = targetYaw;
+        Pitch = targetPitch;
+        yawVelocity = 0.0f;
+        pitchVelocity = 0.0f;
+    }
+    updateOrientation();
+
+    if (Orbit)
+        Position = Target - Front * Distance;
+}
+
+glm::mat4 QuaternionCamera::GetViewMatrix() const
+{
+    // the inverse rotation, whose rows are Right, Up and -Front, then the position moved into view space
+    glm::mat4 view = glm::mat4_cast(glm::conjugate(Orientation));
+    view[3] = glm::vec4(-glm::dot(Right, Position), -glm::dot(Up, Position), glm::dot(Front, Position), 1.0f);
+    return view;
+}
+
+void QuaternionCamera::ProcessKeyboard(Camera_Movement direction, float deltaTime)
+{
+    float velocity = MovementSpeed * deltaTime;
+    if (Orbit)
+    {
+        if (direction == FORWARD)
+            Distance = std::max(Distance - velocity, MIN_DISTANCE);
+        if (direction == BACKWARD)
+            Distance += velocity;
+        if (direction == LEFT)
+            Target -= Right * velocity;
+        if (direction == RIGHT)
+            Target += Right * velocity;
+        return;
+    }
+    if (direction == FORWARD)
+        Position += Front * velocity;
+    if (direction == BACKWARD)
+        Position -= Front * velocity;
+    if (direction == LEFT)
+        Position -= Right * velocity;
+    if (direction == RIGHT)
+        Position += Right * velocity;
+}
+
+void QuaternionCamera::ProcessMouseMovement(float xoffset, float yoffset, bool constrainPitch)
+{
+    pendingYaw += xoffset * MouseSensitivity;
+    pendingPitch += yoffset * MouseSensitivity;
+    this->constrainPitch = constrainPitch;
+}
+
+void QuaternionCamera::ProcessMouseScroll(float yoffset)
+{
+    Zoom -= (float)yoffset;
+    if (Zoom < 1.0f)
+        Zoom = 1.0f;
+    if (Zoom > 45.0f)
+        Zoom = 45.0f;
+}
+
+void QuaternionCamera::StartOrbit(glm::vec3 target)
+{
+    glm::vec3 offset = target - glm::vec3(Position);
+    Distance = std::max(glm::length(offset), MIN_DISTANCE);
+    Target = target;
+    Orbit = true;
+    if (glm::length(offset) < MIN_DISTANCE)
+        return;
+
+    // the angles of Camera's Front = (cos yaw cos pitch, sin pitch, sin yaw cos pitch) pointing at the target
+    glm::vec3 front = offset / glm::length(offset);
+    targetYaw = Yaw = glm::degrees(std::atan2(front.z, front.x));
+    targetPitch = Pitch = glm::clamp(glm::degrees(std::asin(glm::clamp(front.y, -1.0f, 1.0f))), -MAX_PITCH, MAX_PITCH);
+    yawVelocity = 0.0f;
+    pitchVelocity = 0.0f;
+    updateOrientation();
+    Position = Target - Front * Distance;
+}
+
+void QuaternionCamera::StopOrbit()
+{
+    Orbit = false;
+}
+
+void QuaternionCamera::updateOrientation()
+{
+    // yaw turns the default -Z view direction about the world Y axis, so Camera's -90 degrees looks down -Z; pitch
+    // then turns about the camera's own X axis. half angles, as quaternions take them
+    float sinYaw, cosYaw, sinPitch, cosPitch;
+    FastTrig::SinCos(glm::radians(-(Yaw + 90.0f)) * 0.5f, sinYaw, cosYaw);
+    FastTrig::SinCos(glm::radians(Pitch) * 0.5f, sinPitch, cosPitch);
+    Orientation = glm::quat(cosYaw, 0.0f, sinYaw, 0.0f) * glm::quat(cosPitch, sinPitch, 0.0f, 0.0f);
+
+    glm::mat3 rotation = glm::mat3_cast(Orientation);
+    Right = rotation[0];
+    Up = rotation[1];
+    Front = -rotation[2];
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "AlignedMath.h"
+#include "Camera.h"
+
+// A camera kept as a quaternion rather than recomputed from Euler angles on every mouse event: ProcessMouseMovement
+// only adds the offsets up, and Update() applies them once per frame, before rendering, so a mouse polled at 1000 Hz
+// costs two additions per event and one orientation per frame. the orientation is yaw about the world Y axis times
+// pitch about the camera's X axis, so Front, Right and Up come out of it orthonormal without cross products or
+// normalizations. optionally the angles follow the mouse through a critically damped spring, and in orbit mode the
+// camera circles Target at Distance instead of flying. the same yaw and pitch as Camera give the same Front
+class QuaternionCamera
+{
+public:
+    // camera Attributes, Front, Right and Up as of the last Update()
+    AlignedVec3 Position;
+    AlignedVec3 Front;
+    AlignedVec3 Up;
+    AlignedVec3 Right;
+    glm::quat Orientation;
+    // the angles Orientation is built from, in degrees like Camera's; with smoothing they trail the mouse
+    float Yaw;
+    float Pitch;
+    // camera options
+    float MovementSpeed;
+    float MouseSensitivity;
+    float Zoom;
+    // the time in seconds the angles take to mostly catch up with the mouse, 0 applies the mouse directly
+    float SmoothTime;
+    // orbit mode: Position is Distance away from Target, looking at it
+    bool Orbit;
+    AlignedVec3 Target;
+    float Distance;
+
+    QuaternionCamera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), float yaw = YAW, float pitch = PITCH);
+
+    // applies the mouse offsets added up since the last call, moves the angles toward them and rebuilds Orientation,
+    // Front, Right and Up, and in orbit mode Position. once per frame, before GetViewMatrix()
+    void Update(float deltaTime);
+
+    // the view matrix straight from Orientation and Position, no lookAt
+    glm::mat4 GetViewMatrix() const;
+
+    // flying moves Position along Front and Right; orbiting moves closer to and further from Target, and Target
+    // sideways
+    void ProcessKeyboard(Camera_Movement direction, float deltaTime);
+
+    // only adds the offsets up for the next Update(), so it can be called for every event. the pitch is constrained
+    // once per frame rather than per event
+    void ProcessMouseMovement(float xoffset, float yoffset, bool constrainPitch = true);
+
+    // processes input received from a mouse scroll-wheel event. Only requires input on the vertical wheel-axis
+    void ProcessMouseScroll(float yoffset);
+
+    // switches to orbiting target from where the camera is, turned to face it
+    void StartOrbit(glm::vec3 target);
+    // back to flying from where the orbit left the camera
+    void StopOrbit();
+
+private:
+    // the angles the mouse asked for, which Yaw and Pitch follow, and the spring's angular velocities
+    float targetYaw;
+    float targetPitch;
+    float yawVelocity;
+    float pitchVelocity;
+    // mouse offsets in degrees since the last Update()
+    float pendingYaw;
+    float pendingPitch;
+    bool constrainPitch;
+
+    void updateOrientation();
+};
@@ -0,0 +1,13 @@
+#include "RenderStats.h"
+
+namespace RenderStats
+{
+    Counters Frame;
+    Counters Last;
+
+    void EndFrame()
+    {
+        Last = Frame;
+        Frame = Counters();
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+// Per-frame counters of the GL work submitted, for comparing render paths and the benchmark reports.
+// the counting is manual: code that binds, switches programs or draws bumps the matching counter.
+namespace RenderStats
+{
+    struct Counters
+    {
+        unsigned int DrawCalls = 0;
+        unsigned int Triangles = 0;
+        unsigned int TextureBinds = 0;
+        unsigned int ProgramBinds = 0;
+        unsigned int BufferBinds = 0;
+        // anything else that changes pipeline state (uniform uploads, blend/depth toggles ...)
+        unsigned int StateChanges = 0;
+    };
+
+    // counters of the frame in progress
+    extern Counters Frame;
+    // counters of the last completed frame
+    extern Counters Last;
+
+    // moves Frame to Last and clears Frame, call once per frame
+    void EndFrame();
+}
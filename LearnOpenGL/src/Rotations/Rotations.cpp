@@ -0,0 +1,465 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "Rotations.h"
+#include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../Camera.h"
+#include "../FastTrig.h"
+#include "../RenderStats.h"
+#include "../TransformStore.h"
+#include "../VertexFormat.h"
+
+namespace Rotations
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // angles per accuracy test range and per benchmark run, the fastest of BENCHMARK_ROUNDS runs counts
+    const unsigned int TEST_COUNT = 1000000;
+    const unsigned int BENCHMARK_COUNT = 1000000;
+    const unsigned int BENCHMARK_ROUNDS = 5;
+
+    // the scene, cubes spinning about their own axes at their own speeds
+    const int CUBES_X = 50;
+    const int CUBES_Z = 50;
+    const float CUBE_SPACING = 2.0f;
+
+    const FastTrig::Accuracy ACCURACIES[] = { FastTrig::Accuracy::Low, FastTrig::Accuracy::Medium, FastTrig::Accuracy::High };
+    const FastTrig::Path PATHS[] = { FastTrig::Path::Scalar, FastTrig::Path::Avx2 };
+
+    // switched with the 1/2/3 keys: glm::angleAxis per cube, or FastTrig::AxisAngles on the scalar or AVX2 path;
+    // 4/5/6 pick its accuracy
+    bool useGlm = false;
+    FastTrig::Accuracy accuracy = FastTrig::Accuracy::Medium;
+
+    // camera
+    Camera camera(glm::vec3(0.0f, 20.0f, CUBES_Z * CUBE_SPACING * 0.5f + 20.0f));
+
+    bool firstMouse = true;
+    float mouseLastX = SCR_WIDTH / 2.0;
+    float mouseLastY = SCR_HEIGHT / 2.0;
+
+    // timing
+    float deltaTime = 0.0f;	// Time between current frame and last frame
+    float lastFrame = 0.0f;
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::vector<float> randomAngles(std::mt19937& random, unsigned int count, float range)
+    {
+        std::uniform_real_distribution<float> unit(-range, range);
+        std::vector<float> angles(count);
+        for (float& angle : angles)
+            angle = unit(random);
+        return angles;
+    }
+
+    std::vector<glm::vec3> randomAxes(std::mt19937& random, unsigned int count)
+    {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::vector<glm::vec3> axes(count);
+        for (glm::vec3& axis : axes)
+            axis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 0.01f));
+        return axes;
+    }
+
+    // every accuracy on every path against sin and cos in double, over small angles and over all of MAX_ANGLE, then
+    // the quaternions against glm::angleAxis in double for every count up to 20, for the tails of the 8 wide loop,
+    // with a sentinel after them. returns whether all passed
+    bool runAccuracyTests()
+    {
+        std::mt19937 random(1);
+        const float ranges[] = { 2.0f * glm::pi<float>(), FastTrig::MAX_ANGLE };
+        std::vector<float> angles[2] = { randomAngles(random, TEST_COUNT, ranges[0]), randomAngles(random, TEST_COUNT, ranges[1]) };
+        // the points where the reduction switches quadrant and where the polynomials are least accurate
+        for (int quadrant = -16; quadrant <= 16; quadrant++)
+            for (float offset : { -1e-3f, 0.0f, 1e-3f })
+            {
+                angles[0].push_back(quadrant * glm::half_pi<float>() + offset);
+                angles[0].push_back(quadrant * glm::half_pi<float>() + glm::quarter_pi<float>() + offset);
+            }
+        std::vector<float> sines, cosines;
+
+        bool allPassed = true;
+        printf("largest error against double, angles up to %.1f and up to %.0f\n", ranges[0], ranges[1]);
+        for (FastTrig::Path path : PATHS)
+        {
+            if ((int)path > (int)FastTrig::GetBestPath())
+            {
+                printf("  %-6s not supported by this CPU\n", FastTrig::GetPathName(path));
+                continue;
+            }
+            FastTrig::SetPath(path);
+            for (FastTrig::Accuracy level : ACCURACIES)
+            {
+                double worst[2] = {};
+                for (int range = 0; range < 2; range++)
+                {
+                    sines.assign(angles[range].size() + 1, 12345.0f);
+                    cosines.assign(angles[range].size() + 1, 12345.0f);
+                    FastTrig::SinCos(angles[range].data(), sines.data(), cosines.data(), angles[range].size(), level);
+                    for (size_t i = 0; i < angles[range].size(); i++)
+                    {
+                        double angle = angles[range][i];
+                        worst[range] = std::max(worst[range], std::max(std::fabs(sines[i] - std::sin(angle)), std::fabs(cosines[i] - std::cos(angle))));
+                    }
+                    if (sines.back() != 12345.0f || cosines.back() != 12345.0f)
+                        worst[range] = 1e30;
+                }
+
+                double quaternionWorst = 0.0;
+                for (unsigned int count = 0; count <= 20; count++)
+                {
+                    std::vector<glm::vec3> axes = randomAxes(random, count);
+                    std::vector<float> quaternionAngles = randomAngles(random, count, 100.0f);
+                    std::vector<glm::quat> quats(count + 1, glm::quat(12345.0f, 0.0f, 0.0f, 0.0f));
+                    FastTrig::AxisAngles(axes.data(), quaternionAngles.data(), quats.data(), count, level);
+                    for (unsigned int i = 0; i < count; i++)
+                    {
+                        glm::dquat reference = glm::angleAxis((double)quaternionAngles[i], glm::dvec3(axes[i]));
+                        for (int component = 0; component < 4; component++)
+                            quaternionWorst = std::max(quaternionWorst, std::fabs(quats[i][component] - reference[component]));
+                    }
+                    if (quats[count].w != 12345.0f)
+                        quaternionWorst = 1e30;
+                }
+
+                double bound = FastTrig::GetMaxError(level);
+                bool passed = worst[0] <= bound && worst[1] <= bound && quaternionWorst <= bound;
+                allPassed &= passed;
+                printf("  %-6s %-6s sin and cos %.1e and %.1e, quaternions %.1e, bound %.1e, %s\n", FastTrig::GetPathName(path),
+                    FastTrig::GetAccuracyName(level), worst[0], worst[1], quaternionWorst, bound, passed ? "passed" : "FAILED");
+            }
+        }
+        FastTrig::SetPath(FastTrig::GetBestPath());
+        return allPassed;
+    }
+
+    // the fastest of BENCHMARK_ROUNDS calls of run, in millions of angles per second
+    template<typename Function>
+    double millionsPerSecond(Function run)
+    {
+        double fastest = 1e30;
+        for (unsigned int round = 0; round < BENCHMARK_ROUNDS; round++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            run();
+            fastest = std::min(fastest, secondsSince(start));
+        }
+        return BENCHMARK_COUNT / fastest / 1e6;
+    }
+
+    void runBenchmark()
+    {
+        std::mt19937 random(2);
+        std::vector<float> angles = randomAngles(random, BENCHMARK_COUNT, 100.0f);
+        std::vector<glm::vec3> axes = randomAxes(random, BENCHMARK_COUNT);
+        std::vector<float> sines(BENCHMARK_COUNT), cosines(BENCHMARK_COUNT);
+        std::vector<glm::quat> quats(BENCHMARK_COUNT);
+
+        printf("%u angles, millions per second\n", BENCHMARK_COUNT);
+        printf("  std::sin and std::cos  %7.1f\n", millionsPerSecond([&]()
+        {
+            for (unsigned int i = 0; i < BENCHMARK_COUNT; i++)
+            {
+                sines[i] = std::sin(angles[i]);
+                cosines[i] = std::cos(angles[i]);
+            }
+        }));
+        printf("  glm::sin and glm::cos  %7.1f (vec4)\n", millionsPerSecond([&]()
+        {
+            for (unsigned int i = 0; i + 4 <= BENCHMARK_COUNT; i += 4)
+            {
+                glm::vec4 angle(angles[i], angles[i + 1], angles[i + 2], angles[i + 3]);
+                glm::vec4 sine = glm::sin(angle), cosine = glm::cos(angle);
+                for (int lane = 0; lane < 4; lane++)
+                {
+                    sines[i + lane] = sine[lane];
+                    cosines[i + lane] = cosine[lane];
+                }
+            }
+        }));
+        for (FastTrig::Path path : PATHS)
+        {
+            if ((int)path > (int)FastTrig::GetBestPath())
+                continue;
+            FastTrig::SetPath(path);
+            for (FastTrig::Accuracy level : ACCURACIES)
+                printf("  FastTrig %-6s %-6s %7.1f\n", FastTrig::GetPathName(path), FastTrig::GetAccuracyName(level), millionsPerSecond([&]()
+                {
+                    FastTrig::SinCos(angles.data(), sines.data(), cosines.data(), BENCHMARK_COUNT, level);
+                }));
+        }
+
+        printf("%u axis-angle rotations, millions per second\n", BENCHMARK_COUNT);
+        printf("  glm::angleAxis         %7.1f\n", millionsPerSecond([&]()
+        {
+            for (unsigned int i = 0; i < BENCHMARK_COUNT; i++)
+                quats[i] = glm::angleAxis(angles[i], axes[i]);
+        }));
+        for (FastTrig::Path path : PATHS)
+        {
+            if ((int)path > (int)FastTrig::GetBestPath())
+                continue;
+            FastTrig::SetPath(path);
+            for (FastTrig::Accuracy level : ACCURACIES)
+                printf("  FastTrig %-6s %-6s %7.1f\n", FastTrig::GetPathName(path), FastTrig::GetAccuracyName(level), millionsPerSecond([&]()
+                {
+                    FastTrig::AxisAngles(axes.data(), angles.data(), quats.data(), BENCHMARK_COUNT, level);
+                }));
+        }
+        FastTrig::SetPath(FastTrig::GetBestPath());
+    }
+
+    int Main()
+    {
+        runAccuracyTests();
+        runBenchmark();
+
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwSetCursorPosCallback(window, mouse_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        Shader shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs");
+
+        // a unit cube with face normals
+        std::vector<float> vertices;
+        for (int face = 0; face < 6; face++)
+        {
+            int axis = face / 2;
+            float sign = (face % 2) ? -1.0f : 1.0f;
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = sign;
+            u[(axis + 1) % 3] = sign;
+            v[(axis + 2) % 3] = 1.0f;
+            const float corners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+            for (const float* corner : corners)
+            {
+                glm::vec3 position = normal * 0.5f + u * (corner[0] - 0.5f) + v * (corner[1] - 0.5f);
+                vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z, corner[0], corner[1] });
+            }
+        }
+        VertexFormat format;
+        format.Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+        unsigned int VAO, VBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        format.Apply();
+
+        unsigned int whiteTexture;
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        shader.use();
+        shader.setInt("baseColor", 0);
+        shader.setVec4("baseColorFactor", glm::vec4(0.85f, 0.6f, 0.4f, 1.0f));
+        shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+
+        // every cube a root node of the store, its rotation written every frame
+        const unsigned int cubeCount = CUBES_X * CUBES_Z;
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<glm::vec3> axes = randomAxes(random, cubeCount);
+        std::vector<float> speeds(cubeCount), angles(cubeCount);
+        std::vector<glm::quat> rotations(cubeCount);
+        TransformStore transforms;
+        for (int x = 0; x < CUBES_X; x++)
+            for (int z = 0; z < CUBES_Z; z++)
+            {
+                unsigned int handle = transforms.Create();
+                transforms.SetPosition(handle, glm::vec3(x - (CUBES_X - 1) * 0.5f, 0.0f, z - (CUBES_Z - 1) * 0.5f) * CUBE_SPACING);
+                speeds[handle] = 0.5f + 3.0f * unit(random);
+            }
+
+        // render loop
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        double reportSeconds = 0.0;
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            float currentFrame = static_cast<float>(glfwGetTime());
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            processInput(window);
+
+            // the rotations of all cubes at once, then into the store
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (unsigned int i = 0; i < cubeCount; i++)
+                angles[i] = currentFrame * speeds[i];
+            if (useGlm)
+            {
+                for (unsigned int i = 0; i < cubeCount; i++)
+                    rotations[i] = glm::angleAxis(angles[i], axes[i]);
+            }
+            else
+                FastTrig::AxisAngles(axes.data(), angles.data(), rotations.data(), cubeCount, accuracy);
+            reportSeconds += secondsSince(start);
+            for (unsigned int i = 0; i < cubeCount; i++)
+                transforms.SetRotation(i, rotations[i]);
+            transforms.Update();
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            shader.setMat4("projection", glm::perspective(glm::radians(camera.Zoom), (float)width / (float)std::max(height, 1), 0.1f, 300.0f));
+            shader.setMat4("view", camera.GetViewMatrix());
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            glBindVertexArray(VAO);
+            for (unsigned int i = 0; i < cubeCount; i++)
+            {
+                shader.setMat4("model", transforms.GetWorld(i));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += 12;
+            }
+
+            RenderStats::EndFrame();
+            reportFrames++;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                if (useGlm)
+                    printf("glm::angleAxis, %u rotations in %.4f ms\n", cubeCount, reportSeconds * 1000.0 / reportFrames);
+                else
+                    printf("FastTrig %s %s, %u rotations in %.4f ms\n", FastTrig::GetPathName(FastTrig::GetPath()), FastTrig::GetAccuracyName(accuracy),
+                        cubeCount, reportSeconds * 1000.0 / reportFrames);
+                reportStart = now;
+                reportFrames = 0;
+                reportSeconds = 0.0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures(1, &whiteTexture);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            useGlm = true;
+        for (int key = 0; key < 2; key++)
+            if (glfwGetKey(window, GLFW_KEY_2 + key) == GLFW_PRESS)
+            {
+                useGlm = false;
+                FastTrig::SetPath(PATHS[key]);
+            }
+        for (int key = 0; key < 3; key++)
+            if (glfwGetKey(window, GLFW_KEY_4 + key) == GLFW_PRESS)
+                accuracy = ACCURACIES[key];
+
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            camera.ProcessKeyboard(FORWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            camera.ProcessKeyboard(BACKWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            camera.ProcessKeyboard(LEFT, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            camera.ProcessKeyboard(RIGHT, deltaTime);
+    }
+
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+    {
+        if (firstMouse)
+        {
+            mouseLastX = xpos;
+            mouseLastY = ypos;
+            firstMouse = false;
+        }
+
+        float xoffset = xpos - mouseLastX;
+        float yoffset = mouseLastY - ypos; // reversed since y-coordinates range from bottom to top
+
+        mouseLastX = xpos;
+        mouseLastY = ypos;
+
+        camera.ProcessMouseMovement(xoffset, yoffset);
+    }
+}
@@ -0,0 +1,4 @@
+namespace Rotations
+{
+    int Main();
+};
\ No newline at end of file
@@ -5,10 +5,26 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <vector>
 #include "Sandbox.h"
 #include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../ShaderWatcher.h"
+#include "../TextureCache.h"
+#include "../TransformStore.h"
 #include "../Camera.h"
+#include "../EntityWorld.h"
+#include "../FastTrig.h"
+#include "../FixedTimestep.h"
+#include "../FramePacer.h"
+#include "../GoldenImage.h"
+#include "../Input.h"
+#include "../InputRecording.h"
+#include "../VertexFormat.h"
 
 namespace Sandbox
 {
@@ -20,23 +36,71 @@ namespace Sandbox
     // settings
     const unsigned int SCR_WIDTH = 800;
     const unsigned int SCR_HEIGHT = 600;
+    const size_t TEXTURE_BUDGET = 256 * 1024 * 1024;
+    // the simulation runs at its own rate, the frames are paced to theirs and show the simulation interpolated
+    const double SIMULATION_STEPS_PER_SECOND = 50.0;
+    const double FRAMES_PER_SECOND = 120.0;
+    // where F5 saves the input it recorded
+    const char* RECORDING_PATH = "Sandbox.input";
+
+    // textures
+    const char* CONTAINER_TEXTURE = "textures/Container.jpg";
+    const char* FACE_TEXTURE = "textures/Awesomeface.png";
 
     // stores how much we're seeing of either texture
     float mixValue = 0.2f;
 
+    // components of the scene's entities
+    struct SceneNode
+    {
+        unsigned int Transform;
+    };
+    struct Spin
+    {
+        glm::vec3 Axis;
+        float DegreesPerSecond;
+        // radians after the last simulation step and the one before, which frames blend between
+        float Angle;
+        float PreviousAngle;
+    };
+
     // camera
-    Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
+    const glm::vec3 CAMERA_START(0.0f, 0.0f, 3.0f);
+    Camera camera(CAMERA_START);
+
+    // the window's events, taken in one batch at the start of each frame
+    Input input;
 
     bool firstMouse = true;
     float mouseLastX = SCR_WIDTH / 2.0;
     float mouseLastY = SCR_HEIGHT / 2.0;
 
-    // timing
-    float deltaTime = 0.0f;	// Time between current frame and last frame
+    // timing, deltaTime is the simulation step's
+    float deltaTime = 0.0f;
     float lastFrame = 0.0f;
+    // switched with the 1/2/3 keys
+    FramePacer::Method pacing = FramePacer::Method::SleepAndSpin;
 
-    int Main()
+    // F5 starts recording from the scene's starting state and stops and saves
+    bool recording = false;
+    InputRecording recordedInput;
+
+    // live from the window, or a replay
+    int run(const ReplaySettings* replay)
     {
+        InputReplay replayInput;
+        if (replay)
+        {
+            if (!recordedInput.Load(replay->Recording))
+            {
+                std::cout << "Failed to load input recording " << replay->Recording << std::endl;
+                return -1;
+            }
+            recordedInput.FillReplay(replayInput);
+            // the scalar path gives the same rotations on every CPU
+            FastTrig::SetPath(FastTrig::Path::Scalar);
+        }
+
         // glfw: initialize and configure
         glfwInit();
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -46,6 +110,8 @@ namespace Sandbox
 #ifdef __APPLE__
         glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+        if (replay)
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
         // glfw window creation
         GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
@@ -57,9 +123,13 @@ namespace Sandbox
         }
         glfwMakeContextCurrent(window);
         glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-        glfwSetCursorPosCallback(window, mouse_callback);
-        glfwSetScrollCallback(window, scroll_callback);
+        if (!replay)
+        {
+            glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+            input.Attach(window);
+        }
+        // the pacer sets the frame rate instead of vsync
+        glfwSwapInterval(0);
 
         // glad: load all OpenGL function pointers
         if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -67,12 +137,33 @@ namespace Sandbox
             std::cout << "Failed to initialize GLAD" << std::endl;
             return -1;
         }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
 
         // configure global opengl state
         glEnable(GL_DEPTH_TEST);
 
+        // a replay renders into its own framebuffer, which unlike a hidden window's is sure to hold the pixels, at
+        // the same size everywhere
+        unsigned int replayFramebuffer = 0, replayRenderbuffers[2] = {};
+        if (replay)
+        {
+            glGenFramebuffers(1, &replayFramebuffer);
+            glGenRenderbuffers(2, replayRenderbuffers);
+            glBindRenderbuffer(GL_RENDERBUFFER, replayRenderbuffers[0]);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, SCR_WIDTH, SCR_HEIGHT);
+            glBindRenderbuffer(GL_RENDERBUFFER, replayRenderbuffers[1]);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, SCR_WIDTH, SCR_HEIGHT);
+            glBindFramebuffer(GL_FRAMEBUFFER, replayFramebuffer);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, replayRenderbuffers[0]);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, replayRenderbuffers[1]);
+            glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+        }
+
         // build and compile our shader program
         Shader shader("shaders/VertexShaders/Textures.vs", "shaders/FragmentShaders/Textures.fs");
+        // recompile on edits instead of restarting
+        ShaderWatcher shaderWatcher({ "shaders/VertexShaders", "shaders/FragmentShaders", "shaders/Common" });
+        shaderWatcher.Watch(shader);
 
         // Set up vertex and indices data (and buffer(s)) and configure vertex attributes
         float vertices[] = {
@@ -131,6 +222,23 @@ namespace Sandbox
             glm::vec3(1.5f,  0.2f, -1.5f),
             glm::vec3(-1.3f,  1.0f, -1.5f)
         };
+        // every cube is an entity with a node in the transform store, spinning about the same axis at its own speed
+        TransformStore transforms;
+        // like the rotations, the scalar composition gives the same matrices on every CPU, FMA or not
+        if (replay)
+            transforms.UpdatePath = TransformStore::Path::Scalar;
+        EntityWorld entities;
+        const glm::vec3 cubeAxis = glm::normalize(glm::vec3(1.0f, 0.3f, 0.5f));
+        for (unsigned int i = 0; i < 10; i++)
+        {
+            SceneNode node = { transforms.Create() };
+            transforms.SetPosition(node.Transform, cubePositions[i]);
+            entities.Create(node, Spin{ cubeAxis, 20.0f * (i + 1), 0.0f, 0.0f });
+        }
+        std::vector<unsigned int> spinNodes;
+        std::vector<glm::vec3> spinAxes;
+        std::vector<float> spinAngles;
+        std::vector<glm::quat> spinRotations;
 
         unsigned int VAO, VBO;
         glGenVertexArrays(1, &VAO);
@@ -139,91 +247,150 @@ namespace Sandbox
         // bind the Vertex Array Oject first, then bind and set vertex buffer(s), and then configure vertex attribute(s)
         glBindVertexArray(VAO);
 
+        // half float positions and texture coordinates, 12 bytes per vertex instead of 20. the cube's
+        // coordinates are exact in half precision and the shader still reads floats
+        VertexFormat format;
+        format.Add(0, AttributeFormat::Half3).Add(1, AttributeFormat::Half2);
+        std::vector<unsigned char> vertexData = format.Encode(vertices, sizeof(vertices) / sizeof(float) / format.SourceComponents());
+
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, vertexData.size(), vertexData.data(), GL_STATIC_DRAW);
 
-        // position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-        // texture coordinate attribute
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
+        // position and texture coordinate attributes
+        format.Apply();
 
-        // load and create a texture 
-        unsigned int texture0, texture1;
+        // load and create the textures, they are decoded on a background thread and uploaded by the cache
+        TextureCache textures(TEXTURE_BUDGET);
         // texture 0
-        glGenTextures(1, &texture0);
-        glBindTexture(GL_TEXTURE_2D, texture0); // all upcoming GL_TEXTURE_2D operations now have effect on this texture object
+        TextureSampling containerSampling;
         // set the texture wrapping parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
+        containerSampling.WrapS = GL_CLAMP_TO_EDGE;
+        containerSampling.WrapT = GL_MIRRORED_REPEAT;
         // set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        // load image, create texture and generate mipmaps
-        int width0, height0, nrChannels0;
+        containerSampling.MinFilter = GL_NEAREST;
+        containerSampling.MagFilter = GL_NEAREST;
         stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-        unsigned char* data = stbi_load("textures/Container.jpg", &width0, &height0, &nrChannels0, 0);
-        if (data)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width0, height0, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else
-        {
-            std::cout << "Failed to load texture" << std::endl;
-        }
-
-        stbi_image_free(data);
+        textures.Get(CONTAINER_TEXTURE, containerSampling);
         // texture 1
-        glGenTextures(1, &texture1);
-        glBindTexture(GL_TEXTURE_2D, texture1); // all upcoming GL_TEXTURE_2D operations now have effect on this texture object
-        // set the texture wrapping parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        // set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // load image, create texture and generate mipmaps
-        int width1, height1, nrChannels1;
-        // The FileSystem::getPath(...) is part of the GitHub repository so we can find files on any IDE/platform; replace it with your own image path.
-        data = stbi_load("textures/Awesomeface.png", &width1, &height1, &nrChannels1, 0);
-        if (data)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width1, height1, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else
-        {
-            std::cout << "Failed to load texture" << std::endl;
-        }
-        stbi_image_free(data);
+        textures.Get(FACE_TEXTURE);
+        textures.WaitForLoads();
 
         // activate the shader before setting uniforms!
         shader.use();
         shader.setInt("texture0", 0);
         shader.setInt("texture1", 1);
 
+        // everything the input and the simulation change, back to how it starts, for a recording to start from
+        FixedTimestep timestep(SIMULATION_STEPS_PER_SECOND);
+        glm::vec3 previousCameraPosition;
+        auto resetScene = [&]()
+        {
+            camera = Camera(CAMERA_START);
+            previousCameraPosition = camera.Position;
+            firstMouse = true;
+            mixValue = 0.2f;
+            timestep = FixedTimestep(SIMULATION_STEPS_PER_SECOND);
+            entities.View<Spin>().Each([&](Entity, Spin& spin)
+            {
+                spin.Angle = 0.0f;
+                spin.PreviousAngle = 0.0f;
+            });
+        };
+        resetScene();
+
+        auto toggleRecording = [&](double frameSeconds)
+        {
+            if (recording)
+            {
+                recording = false;
+                bool saved = recordedInput.Save(RECORDING_PATH);
+                printf("%u frames of input %s %s\n", recordedInput.GetFrameCount(), saved ? "saved to" : "could not be saved to", RECORDING_PATH);
+                return;
+            }
+            resetScene();
+            recordedInput.Clear();
+            recordedInput.BeginFrame(frameSeconds);
+            // keys already down are pressed at the start of the recording
+            for (int key = GLFW_KEY_SPACE; key <= GLFW_KEY_LAST; key++)
+                if (key != GLFW_KEY_F5 && input.IsKeyDown(key))
+                    recordedInput.Add(InputEvent{ InputEventType::Key, key, GLFW_PRESS, 0, 0.0, 0.0, 0.0 });
+            recording = true;
+            printf("recording input, F5 again to save it\n");
+        };
+
         // render loop
-        while (!glfwWindowShouldClose(window))
+        FramePacer pacer(FRAMES_PER_SECOND, replay ? FramePacer::Method::None : pacing);
+        std::vector<double> frameMilliseconds;
+        bool goldenMatched = true;
+        unsigned int frame = 0;
+        double reportStart = glfwGetTime();
+        lastFrame = static_cast<float>(reportStart);
+        while (!glfwWindowShouldClose(window) && (!replay || frame < recordedInput.GetFrameCount()))
         {
-            // per-frame time logic
+            std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+
+            // per-frame time logic, a replay takes the recorded frame's time
             float currentFrame = static_cast<float>(glfwGetTime());
-            deltaTime = currentFrame - lastFrame;
+            double frameSeconds = replay ? recordedInput.GetFrame(frame).Seconds : currentFrame - lastFrame;
             lastFrame = currentFrame;
 
-            // input
-            processInput(window);
+            // the events since the last frame: the mouse turns the camera right away, the keys are read in the steps
+            if (replay)
+                replayInput.Feed(input.GetQueue(), frame);
+            if (recording)
+                recordedInput.BeginFrame(frameSeconds);
+            for (const InputEvent& event : input.ProcessEvents())
+            {
+                // F5 itself is left out of the recording
+                if (event.Type == InputEventType::Key && event.Code == GLFW_KEY_F5)
+                {
+                    if (!replay && event.Action == GLFW_PRESS)
+                        toggleRecording(frameSeconds);
+                    continue;
+                }
+                if (recording)
+                    recordedInput.Add(event);
+                if (event.Type == InputEventType::CursorPosition)
+                    mouse_callback(window, event.X, event.Y);
+                if (event.Type == InputEventType::Scroll)
+                    scroll_callback(window, event.X, event.Y);
+            }
+
+            // input and simulation in fixed steps, however long the frame took
+            unsigned int steps = timestep.Advance(frameSeconds);
+            deltaTime = (float)timestep.GetStepSeconds();
+            for (unsigned int step = 0; step < steps; step++)
+            {
+                previousCameraPosition = camera.Position;
+                processInput(window);
+                entities.View<Spin>().Each([&](Entity, Spin& spin)
+                {
+                    spin.PreviousAngle = spin.Angle;
+                    spin.Angle += glm::radians(spin.DegreesPerSecond) * deltaTime;
+                    // whole turns off both, so the blend between them stays right and the angle small
+                    if (spin.Angle > glm::two_pi<float>())
+                    {
+                        spin.Angle -= glm::two_pi<float>();
+                        spin.PreviousAngle -= glm::two_pi<float>();
+                    }
+                });
+            }
+            // a replay keeps the shaders it started with
+            if (!replay)
+                shaderWatcher.Poll();
+            // how far between the last two steps this frame shows the scene
+            float alpha = timestep.GetAlpha();
 
             // render
             glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            // bind textures on corresponding texture units
+            // bind textures on corresponding texture units, the IDs may change when the cache is over budget
+            textures.BeginFrame();
             glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, texture0);
+            glBindTexture(GL_TEXTURE_2D, textures.Get(CONTAINER_TEXTURE, containerSampling));
             glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, texture1);
+            glBindTexture(GL_TEXTURE_2D, textures.Get(FACE_TEXTURE));
 
             // activate shader
             shader.use();
@@ -233,36 +400,117 @@ namespace Sandbox
             glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
             shader.setMat4("projection", projection);
 
-            // camera/view transformation
-            glm::mat4 view = camera.GetViewMatrix();
+            // camera/view transformation, from between the last two camera positions
+            glm::vec3 cameraPosition = glm::mix(previousCameraPosition, glm::vec3(camera.Position), alpha);
+            glm::mat4 view = glm::lookAt(cameraPosition, cameraPosition + glm::vec3(camera.Front), glm::vec3(camera.Up));
             shader.setMat4("view", view);
 
             // render boxes
             glBindVertexArray(VAO);
-            for (unsigned int i = 0; i < 10; i++)
+            // the rotations of all spinning cubes in one batch
+            spinNodes.clear();
+            spinAxes.clear();
+            spinAngles.clear();
+            entities.View<const SceneNode, const Spin>().Each([&](Entity, const SceneNode& node, const Spin& spin)
             {
-                // calculate the model matrix for each object and pass it to shader before drawing
-                glm::mat4 model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-                model = glm::translate(model, cubePositions[i]);
-                float angle = 20.0f * (i + 1);
-                model = glm::rotate(model, (float)glfwGetTime() * glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-                shader.setMat4("model", model);
+                spinNodes.push_back(node.Transform);
+                spinAxes.push_back(spin.Axis);
+                spinAngles.push_back(glm::mix(spin.PreviousAngle, spin.Angle, alpha));
+            });
+            spinRotations.resize(spinNodes.size());
+            FastTrig::AxisAngles(spinAxes.data(), spinAngles.data(), spinRotations.data(), spinNodes.size(), FastTrig::Accuracy::Medium);
+            for (size_t i = 0; i < spinNodes.size(); i++)
+                transforms.SetRotation(spinNodes[i], spinRotations[i]);
+            transforms.Update();
+            entities.View<const SceneNode>().Each([&](Entity, const SceneNode& node)
+            {
+                // pass each object's model matrix to the shader before drawing
+                shader.setMat4("model", transforms.GetWorld(node.Transform));
 
                 glDrawArrays(GL_TRIANGLES, 0, 36);
+            });
+
+            if (replay)
+            {
+                // the frame's time with its GPU work, then the frames to compare
+                glFinish();
+                frameMilliseconds.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+                bool last = frame + 1 == recordedInput.GetFrameCount();
+                if (replay->GoldenInterval > 0 && (frame % replay->GoldenInterval == 0 || last))
+                {
+                    char name[64];
+                    snprintf(name, sizeof(name), "/Sandbox_%05u.ppm", frame);
+                    goldenMatched &= GoldenImage::Check(replay->GoldenDirectory + name, GoldenImage::ReadFramebuffer(SCR_WIDTH, SCR_HEIGHT),
+                        replay->GoldenTolerance);
+                }
+                frame++;
+                glfwPollEvents();
+                pacer.Wait();
+                continue;
+            }
+
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                FramePacer::Report report = pacer.TakeReport();
+                printf("%s at %.0f fps, simulation at %.0f Hz: %u frames, %.2f ms mean, %.3f ms standard deviation, %.2f ms max, %.0f%% CPU\n",
+                    FramePacer::GetMethodName(pacer.GetMethod()), pacer.GetFramesPerSecond(), timestep.GetStepsPerSecond(), report.Frames,
+                    report.MeanMilliseconds, report.StandardDeviationMilliseconds, report.MaxMilliseconds, report.CpuUsage * 100.0);
+                Input::LatencyReport latency = input.TakeLatencyReport();
+                printf("  input to present: %u events in %u frames, %.2f ms mean, %.2f ms max, %zu dropped\n", latency.Events, latency.Frames,
+                    latency.MeanMilliseconds, latency.MaxMilliseconds, latency.Dropped);
+                reportStart = now;
             }
 
             // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
             glfwSwapBuffers(window);
+            input.Presented();
             glfwPollEvents();
+            // hold the frame to the target frame time
+            pacer.SetMethod(pacing);
+            pacer.Wait();
+        }
+
+        if (recording)
+            toggleRecording(0.0);
+        if (replay)
+        {
+            FramePacer::Report report = pacer.TakeReport();
+            printf("replayed %u frames of %s: %.2f ms mean, %.3f ms standard deviation, %.2f ms max, %.0f%% CPU\n", report.Frames,
+                replay->Recording.c_str(), report.MeanMilliseconds, report.StandardDeviationMilliseconds, report.MaxMilliseconds,
+                report.CpuUsage * 100.0);
+            if (!replay->Trace.empty())
+            {
+                std::ofstream trace(replay->Trace);
+                for (double milliseconds : frameMilliseconds)
+                    trace << milliseconds << "\n";
+                if (!trace)
+                    std::cout << "Failed to write frame time trace " << replay->Trace << std::endl;
+            }
+            glDeleteFramebuffers(1, &replayFramebuffer);
+            glDeleteRenderbuffers(2, replayRenderbuffers);
         }
 
         // optional: de-allocate all resources once they've outlived their purpose:
         glDeleteVertexArrays(1, &VAO);
         glDeleteBuffers(1, &VBO);
 
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
         // glfw: terminate, clearing all previously allocated GLFW resources.
         glfwTerminate();
-        return 0;
+        return goldenMatched ? 0 : 1;
+    }
+
+    int Main()
+    {
+        return run(nullptr);
+    }
+
+    int Replay(const ReplaySettings& settings)
+    {
+        return run(&settings);
     }
 
     // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -273,38 +521,43 @@ namespace Sandbox
         glViewport(0, 0, width, height);
     }
 
-    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    // process all input: check whether relevant keys are down as of the last batch of events and react accordingly
     void processInput(GLFWwindow* window)
     {
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        if (input.IsKeyDown(GLFW_KEY_ESCAPE))
             glfwSetWindowShouldClose(window, true);
 
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+        // 1/2/3 switch the frame pacing between none, sleeping and sleeping then spinning
+        for (int key = 0; key < 3; key++)
+            if (input.IsKeyDown(GLFW_KEY_1 + key))
+                pacing = (FramePacer::Method)key;
+
+        if (input.IsKeyDown(GLFW_KEY_UP))
         {
-            mixValue += 0.01f; // change this value accordingly (might be too slow or too fast based on system hardware)
+            mixValue += 0.01f; // per simulation step, so the same speed on any hardware
             if (mixValue >= 1.0f)
                 mixValue = 1.0f;
         }
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+        if (input.IsKeyDown(GLFW_KEY_DOWN))
         {
-            mixValue -= 0.01f; // change this value accordingly (might be too slow or too fast based on system hardware)
+            mixValue -= 0.01f; // per simulation step, so the same speed on any hardware
             if (mixValue <= 0.0f)
                 mixValue = 0.0f;
         }
 
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        if (input.IsKeyDown(GLFW_KEY_W))
         {
             camera.ProcessKeyboard(FORWARD, deltaTime);
         }
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        if (input.IsKeyDown(GLFW_KEY_S))
         {
             camera.ProcessKeyboard(BACKWARD, deltaTime);
         }
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        if (input.IsKeyDown(GLFW_KEY_A))
         {
             camera.ProcessKeyboard(LEFT, deltaTime);
         }
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        if (input.IsKeyDown(GLFW_KEY_D))
         {
             camera.ProcessKeyboard(RIGHT, deltaTime);
         }
@@ -1,4 +1,25 @@
+#include <string>
+
 namespace Sandbox
 {
+    // what Replay() plays back and what it writes
+    struct ReplaySettings
+    {
+        // a recording made with F5
+        std::string Recording = "Sandbox.input";
+        // each frame's time in milliseconds, GPU work included, one line per frame; empty for none
+        std::string Trace;
+        // every GoldenInterval-th frame and the last one are compared with the images in GoldenDirectory, and
+        // become them where there are none yet; 0 compares none
+        unsigned int GoldenInterval = 0;
+        std::string GoldenDirectory = ".";
+        // the largest difference of a channel that still counts as the same
+        int GoldenTolerance = 0;
+    };
+
     int Main();
-};
\ No newline at end of file
+    // plays a recording back in a hidden window, rendering into an offscreen framebuffer as fast as it goes. the
+    // recorded frame times drive the simulation and the recorded events the camera, so every run renders the same
+    // frames. returns 0 when all compared frames matched
+    int Replay(const ReplaySettings& settings);
+};
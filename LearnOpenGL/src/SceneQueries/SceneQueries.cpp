@@ -0,0 +1,472 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "SceneQueries.h"
+#include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../Bvh.h"
+#include "../Camera.h"
+#include "../ClusterCuller.h"
+#include "../RenderStats.h"
+#include "../VertexFormat.h"
+
+namespace SceneQueries
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // the startup benchmark
+    const unsigned int BENCHMARK_OBJECTS = 1000000;
+    const unsigned int BENCHMARK_FRUSTUMS = 100;
+    const unsigned int BENCHMARK_SPHERES = 10000;
+    const unsigned int BENCHMARK_RAYS = 100000;
+    // linear scans of 1M objects are slow, they are timed on fewer queries
+    const unsigned int BENCHMARK_LINEAR = 10;
+
+    // CUBES_X x CUBES_Y x CUBES_Z rotating cubes, refitted every frame
+    const int CUBES_X = 32;
+    const int CUBES_Y = 8;
+    const int CUBES_Z = 32;
+    const float CUBE_SPACING = 2.5f;
+    // the camera is a sphere that cannot enter the cubes' boxes
+    const float CAMERA_RADIUS = 0.3f;
+
+    // switched with the 1/2 keys: every query as a linear scan, or through the BVH
+    bool useBvh = true;
+
+    // camera
+    Camera camera(glm::vec3(0.0f, 0.0f, CUBES_Z * CUBE_SPACING * 0.5f + 5.0f));
+
+    bool firstMouse = true;
+    float mouseLastX = SCR_WIDTH / 2.0;
+    float mouseLastY = SCR_HEIGHT / 2.0;
+
+    // timing
+    float deltaTime = 0.0f;	// Time between current frame and last frame
+    float lastFrame = 0.0f;
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // the brute force references the BVH is checked and timed against
+    void linearFrustum(const std::vector<BoundingBox>& boxes, const glm::vec4 planes[6], std::vector<unsigned int>& objects)
+    {
+        for (unsigned int i = 0; i < boxes.size(); i++)
+        {
+            bool outside = false;
+            for (int p = 0; p < 6 && !outside; p++)
+            {
+                glm::vec3 corner(planes[p].x >= 0.0f ? boxes[i].Max.x : boxes[i].Min.x, planes[p].y >= 0.0f ? boxes[i].Max.y : boxes[i].Min.y,
+                    planes[p].z >= 0.0f ? boxes[i].Max.z : boxes[i].Min.z);
+                outside = glm::dot(glm::vec3(planes[p]), corner) + planes[p].w < 0.0f;
+            }
+            if (!outside)
+                objects.push_back(i);
+        }
+    }
+
+    void linearSphere(const std::vector<BoundingBox>& boxes, const glm::vec3& center, float radius, std::vector<unsigned int>& objects)
+    {
+        for (unsigned int i = 0; i < boxes.size(); i++)
+        {
+            glm::vec3 outside = glm::max(glm::max(boxes[i].Min - center, center - boxes[i].Max), glm::vec3(0.0f));
+            if (glm::dot(outside, outside) <= radius * radius)
+                objects.push_back(i);
+        }
+    }
+
+    bool linearRaycast(const std::vector<BoundingBox>& boxes, const glm::vec3& origin, const glm::vec3& direction, float maxDistance, BvhRayHit& hit)
+    {
+        glm::vec3 inverseDirection = 1.0f / direction;
+        bool found = false;
+        for (unsigned int i = 0; i < boxes.size(); i++)
+        {
+            glm::vec3 t1 = (boxes[i].Min - origin) * inverseDirection, t2 = (boxes[i].Max - origin) * inverseDirection;
+            glm::vec3 entries = glm::min(t1, t2), exits = glm::max(t1, t2);
+            float enter = std::max(std::max(entries.x, entries.y), std::max(entries.z, 0.0f));
+            float exit = std::min(std::min(exits.x, exits.y), std::min(exits.z, maxDistance));
+            if (enter <= exit && (!found || enter < hit.Distance))
+            {
+                hit.Object = i;
+                hit.Distance = enter;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    // random boxes in a 1000 x 100 x 1000 volume, timed against linear scans
+    void runBenchmark()
+    {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<BoundingBox> boxes(BENCHMARK_OBJECTS);
+        for (BoundingBox& box : boxes)
+        {
+            glm::vec3 center(unit(random) * 1000.0f, unit(random) * 100.0f, unit(random) * 1000.0f);
+            glm::vec3 half(0.2f + unit(random) * 0.8f);
+            box = BoundingBox(center - half, center + half);
+        }
+        Bvh bvh;
+        bvh.Build(boxes);
+        printf("bvh of %u objects: build %.1f ms, %zu nodes\n", BENCHMARK_OBJECTS, bvh.BuildSeconds * 1000.0, bvh.GetNodeCount());
+        for (BoundingBox& box : boxes)
+        {
+            glm::vec3 move(unit(random) - 0.5f, 0.0f, unit(random) - 0.5f);
+            box = BoundingBox(box.Min + move, box.Max + move);
+        }
+        bvh.Refit(boxes);
+        printf("  refit after moving every object: %.1f ms\n", bvh.RefitSeconds * 1000.0);
+
+        std::vector<unsigned int> found, expected;
+        unsigned int mismatches = 0;
+        size_t results = 0;
+        double bvhSeconds = 0.0, linearSeconds = 0.0;
+        for (unsigned int q = 0; q < BENCHMARK_FRUSTUMS; q++)
+        {
+            glm::vec3 eye(unit(random) * 1000.0f, 50.0f, unit(random) * 1000.0f);
+            glm::vec3 forward(unit(random) - 0.5f, -0.2f, unit(random) - 0.5f);
+            glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 150.0f) * glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+            glm::vec4 planes[6];
+            ClusterCuller::ExtractFrustumPlanes(viewProjection, planes);
+            found.clear();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            bvh.QueryFrustum(planes, found);
+            bvhSeconds += secondsSince(start);
+            results += found.size();
+            if (q < BENCHMARK_LINEAR)
+            {
+                expected.clear();
+                start = std::chrono::steady_clock::now();
+                linearFrustum(boxes, planes, expected);
+                linearSeconds += secondsSince(start);
+                std::sort(found.begin(), found.end());
+                mismatches += found != expected;
+            }
+        }
+        printf("  frustum: %6.3f ms per query (linear %7.3f ms), %zu objects each, %u mismatches\n", bvhSeconds * 1000.0 / BENCHMARK_FRUSTUMS,
+            linearSeconds * 1000.0 / BENCHMARK_LINEAR, results / BENCHMARK_FRUSTUMS, mismatches);
+
+        mismatches = 0;
+        results = 0;
+        bvhSeconds = linearSeconds = 0.0;
+        for (unsigned int q = 0; q < BENCHMARK_SPHERES; q++)
+        {
+            glm::vec3 center(unit(random) * 1000.0f, unit(random) * 100.0f, unit(random) * 1000.0f);
+            found.clear();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            bvh.QuerySphere(center, 5.0f, found);
+            bvhSeconds += secondsSince(start);
+            results += found.size();
+            if (q < BENCHMARK_LINEAR)
+            {
+                expected.clear();
+                start = std::chrono::steady_clock::now();
+                linearSphere(boxes, center, 5.0f, expected);
+                linearSeconds += secondsSince(start);
+                std::sort(found.begin(), found.end());
+                mismatches += found != expected;
+            }
+        }
+        printf("  sphere:  %6.4f ms per query (linear %7.3f ms), %.1f objects each, %u mismatches\n", bvhSeconds * 1000.0 / BENCHMARK_SPHERES,
+            linearSeconds * 1000.0 / BENCHMARK_LINEAR, (double)results / BENCHMARK_SPHERES, mismatches);
+
+        mismatches = 0;
+        unsigned int hits = 0;
+        bvhSeconds = linearSeconds = 0.0;
+        for (unsigned int q = 0; q < BENCHMARK_RAYS; q++)
+        {
+            glm::vec3 origin(unit(random) * 1000.0f, unit(random) * 100.0f, unit(random) * 1000.0f);
+            glm::vec3 direction = glm::normalize(glm::vec3(unit(random) - 0.5f, unit(random) - 0.5f, unit(random) - 0.5f));
+            BvhRayHit hit, expectedHit;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            bool hitSomething = bvh.Raycast(origin, direction, 1e30f, hit);
+            bvhSeconds += secondsSince(start);
+            hits += hitSomething;
+            if (q < BENCHMARK_LINEAR)
+            {
+                start = std::chrono::steady_clock::now();
+                bool expectedSomething = linearRaycast(boxes, origin, direction, 1e30f, expectedHit);
+                linearSeconds += secondsSince(start);
+                mismatches += hitSomething != expectedSomething || (hitSomething && std::fabs(hit.Distance - expectedHit.Distance) > 1e-4f);
+            }
+        }
+        printf("  ray:     %6.4f ms per query (linear %7.3f ms), %u of %u hit, %u mismatches\n", bvhSeconds * 1000.0 / BENCHMARK_RAYS,
+            linearSeconds * 1000.0 / BENCHMARK_LINEAR, hits, BENCHMARK_RAYS, mismatches);
+    }
+
+    int Main()
+    {
+        runBenchmark();
+
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwSetCursorPosCallback(window, mouse_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        Shader shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs");
+
+        // a unit cube with face normals
+        std::vector<float> vertices;
+        for (int face = 0; face < 6; face++)
+        {
+            int axis = face / 2;
+            float sign = (face % 2) ? -1.0f : 1.0f;
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = sign;
+            u[(axis + 1) % 3] = sign;
+            v[(axis + 2) % 3] = 1.0f;
+            const float corners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+            for (const float* corner : corners)
+            {
+                glm::vec3 position = normal * 0.5f + u * (corner[0] - 0.5f) + v * (corner[1] - 0.5f);
+                vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z, corner[0], corner[1] });
+            }
+        }
+        VertexFormat format;
+        format.Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+        unsigned int VAO, VBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        format.Apply();
+
+        unsigned int whiteTexture;
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        shader.use();
+        shader.setInt("baseColor", 0);
+        shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+
+        // the cube field, every cube spins about its own axis like the Sandbox ones
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> axes;
+        for (int x = 0; x < CUBES_X; x++)
+            for (int y = 0; y < CUBES_Y; y++)
+                for (int z = 0; z < CUBES_Z; z++)
+                {
+                    positions.push_back(glm::vec3((x - (CUBES_X - 1) * 0.5f) * CUBE_SPACING, (y - (CUBES_Y - 1) * 0.5f) * CUBE_SPACING, (z - (CUBES_Z - 1) * 0.5f) * CUBE_SPACING));
+                    axes.push_back(glm::normalize(glm::vec3(1.0f + x % 3, 0.3f + y % 2, 0.5f + z % 5)));
+                }
+        const BoundingBox unitBox(glm::vec3(-0.5f), glm::vec3(0.5f));
+        std::vector<glm::mat4> models(positions.size());
+        std::vector<BoundingBox> boxes(positions.size());
+        auto updateCubes = [&](float time)
+        {
+            for (size_t i = 0; i < positions.size(); i++)
+            {
+                float angle = time * glm::radians(20.0f * (i % 10 + 1));
+                models[i] = glm::rotate(glm::translate(glm::mat4(1.0f), positions[i]), angle, axes[i]);
+                boxes[i] = unitBox.Transformed(models[i]);
+            }
+        };
+        updateCubes(0.0f);
+        Bvh bvh;
+        bvh.Build(boxes);
+
+        std::vector<unsigned int> visible, touching;
+
+        // render loop
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        double reportVisible = 0.0, reportRefitSeconds = 0.0, reportQuerySeconds = 0.0;
+        unsigned int reportBlocked = 0;
+        int picked = -1;
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            float currentFrame = static_cast<float>(glfwGetTime());
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input, moves the camera unless that would put it inside a cube's box
+            AlignedVec3 lastPosition = camera.Position;
+            processInput(window);
+
+            // the cubes spin, the tree keeps its structure and only gets new boxes
+            updateCubes(currentFrame);
+            bvh.Refit(boxes);
+            reportRefitSeconds += bvh.RefitSeconds;
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)width / (float)std::max(height, 1), 0.1f, 200.0f);
+            glm::mat4 view = camera.GetViewMatrix();
+            glm::vec4 planes[6];
+            ClusterCuller::ExtractFrustumPlanes(projection * view, planes);
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            touching.clear();
+            if (useBvh)
+                bvh.QuerySphere(camera.Position, CAMERA_RADIUS, touching);
+            else
+                linearSphere(boxes, camera.Position, CAMERA_RADIUS, touching);
+            if (!touching.empty() && camera.Position != lastPosition)
+            {
+                camera.Position = lastPosition;
+                reportBlocked++;
+            }
+            visible.clear();
+            if (useBvh)
+                bvh.QueryFrustum(planes, visible);
+            else
+                linearFrustum(boxes, planes, visible);
+            // the cube under the crosshair
+            BvhRayHit hit;
+            bool hitSomething = useBvh ? bvh.Raycast(camera.Position, camera.Front, 200.0f, hit) : linearRaycast(boxes, camera.Position, camera.Front, 200.0f, hit);
+            picked = hitSomething ? (int)hit.Object : -1;
+            reportQuerySeconds += secondsSince(start);
+            view = camera.GetViewMatrix();
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            shader.setMat4("projection", projection);
+            shader.setMat4("view", view);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            glBindVertexArray(VAO);
+            for (unsigned int cube : visible)
+            {
+                shader.setMat4("model", models[cube]);
+                shader.setVec4("baseColorFactor", (int)cube == picked ? glm::vec4(1.0f, 0.3f, 0.2f, 1.0f) : glm::vec4(0.8f, 0.8f, 0.75f, 1.0f));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += 12;
+            }
+
+            RenderStats::EndFrame();
+            reportVisible += visible.size();
+            reportFrames++;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                printf("%-6s %5.0f of %zu cubes visible, refit %6.3f ms, queries %6.3f ms, picked %5d, %u moves blocked, frame %6.3f ms\n",
+                    useBvh ? "bvh" : "linear", reportVisible / reportFrames, boxes.size(), reportRefitSeconds * 1000.0 / reportFrames,
+                    reportQuerySeconds * 1000.0 / reportFrames, picked, reportBlocked, (now - reportStart) * 1000.0 / reportFrames);
+                reportStart = now;
+                reportFrames = 0;
+                reportVisible = 0.0;
+                reportRefitSeconds = 0.0;
+                reportQuerySeconds = 0.0;
+                reportBlocked = 0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures(1, &whiteTexture);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            useBvh = false;
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+            useBvh = true;
+
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            camera.ProcessKeyboard(FORWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            camera.ProcessKeyboard(BACKWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            camera.ProcessKeyboard(LEFT, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            camera.ProcessKeyboard(RIGHT, deltaTime);
+    }
+
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+    {
+        if (firstMouse)
+        {
+            mouseLastX = xpos;
+            mouseLastY = ypos;
+            firstMouse = false;
+        }
+
+        float xoffset = xpos - mouseLastX;
+        float yoffset = mouseLastY - ypos; // reversed since y-coordinates range from bottom to top
+
+        mouseLastX = xpos;
+        mouseLastY = ypos;
+
+        camera.ProcessMouseMovement(xoffset, yoffset);
+    }
+}
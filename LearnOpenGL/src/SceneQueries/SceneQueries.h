@@ -0,0 +1,4 @@
+namespace SceneQueries
+{
+    int Main();
+};
\ No newline at end of file
@@ -1,72 +1,89 @@
 #include "Shader.h"
-#include <fstream>
-#include <sstream>
+#include <cstring>
 #include <iostream>
+#include <unordered_map>
 #include <glm/glm.hpp>
+#include "ShaderPreprocessor.h"
+#include "GLExtensions.h"
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath)
-{
-    // 1. retrieve the vertex/fragment source code from filePath
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    // ensure ifstream objects can throw exceptions:
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try
+namespace
+{
+    // a compiled shader object and the programs built from it
+    struct Stage
+    {
+        uint64_t Key = 0;
+        unsigned int Programs = 0;
+    };
+
+    // compiled shader objects keyed by the hash of their preprocessed source and stage,
+    // so a stage shared by several programs (e.g. HelloTriangle.vs) is only compiled once
+    std::unordered_map<uint64_t, unsigned int> stageCache;
+    // every shader object still in use, cached or not. a stage is deleted with the last program using it,
+    // so the stages a hot reload replaced do not pile up
+    std::unordered_map<unsigned int, Stage> stages;
+
+    unsigned int acquireStage(unsigned int shader, uint64_t key)
     {
-        // open files
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        // read file's buffer contents into streams
-        std::stringstream vShaderStream, fShaderStream;
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        // close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+        Stage& stage = stages[shader];
+        stage.Key = key;
+        stage.Programs++;
+        return shader;
     }
-    catch (std::ifstream::failure e)
+
+    // takes a stage out of the cache, programs built from it still hold it
+    void forgetStage(unsigned int shader)
     {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+        auto stage = stages.find(shader);
+        if (stage == stages.end())
+            return;
+        auto cached = stageCache.find(stage->second.Key);
+        if (cached != stageCache.end() && cached->second == shader)
+            stageCache.erase(cached);
     }
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
 
-    // 2. compile shaders
-    unsigned int vertex, fragment;
+    void releaseStage(unsigned int shader)
+    {
+        auto stage = stages.find(shader);
+        // already deleted by ReleaseStageCache()
+        if (stage == stages.end() || --stage->second.Programs > 0)
+            return;
+        forgetStage(shader);
+        stages.erase(stage);
+        glDeleteShader(shader);
+    }
+}
 
-    // vertex Shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
+Shader::Shader(const char* vertexPath, const char* fragmentPath) : Shader(vertexPath, fragmentPath, {})
+{
+}
 
-    // Fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines, bool waitForBuild)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath), defines(defines)
+{
+    // 1. preprocess and compile shaders, both are taken from the stage cache when possible
+    vertexStage = compileStage(vertexPath, GL_VERTEX_SHADER, defines);
+    fragmentStage = compileStage(fragmentPath, GL_FRAGMENT_SHADER, defines);
 
-    // shader Program
+    // 2. shader Program
     ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
+    glAttachShader(ID, vertexStage);
+    glAttachShader(ID, fragmentStage);
     glLinkProgram(ID);
-    checkCompileErrors(ID, "PROGRAM");
 
-    // delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    // detach so the shared stages are not kept alive by the program, they are deleted with the last program using them
+    glDetachShader(ID, vertexStage);
+    glDetachShader(ID, fragmentStage);
+
+    // querying the status blocks until the driver is done, deferring it lets several programs compile in parallel
+    if (waitForBuild)
+        finishBuild();
 }
 
 Shader::~Shader()
 {
     glDeleteProgram(ID);
+    releaseStage(vertexStage);
+    releaseStage(fragmentStage);
 }
 
 void Shader::use()
@@ -76,65 +93,210 @@ void Shader::use()
 
 void Shader::setBool(const std::string& name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    setInt(name, (int)value);
 }
 
 void Shader::setInt(const std::string& name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    Uniform& uniform = cacheUniform(name, UniformType::Int, (const float*)&value, 1);
+    glUniform1i(uniform.Location, value);
 }
 
 void Shader::setFloat(const std::string& name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    Uniform& uniform = cacheUniform(name, UniformType::Float, &value, 1);
+    glUniform1f(uniform.Location, value);
 }
 
 void Shader::setVec2(const std::string& name, const glm::vec2& value) const
 {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    Uniform& uniform = cacheUniform(name, UniformType::Vec2, &value[0], 2);
+    glUniform2fv(uniform.Location, 1, &value[0]);
 }
 
 void Shader::setVec2(const std::string& name, float x, float y) const
 {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+    setVec2(name, glm::vec2(x, y));
 }
 
 void Shader::setVec3(const std::string& name, const glm::vec3& value) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    Uniform& uniform = cacheUniform(name, UniformType::Vec3, &value[0], 3);
+    glUniform3fv(uniform.Location, 1, &value[0]);
 }
 
 void Shader::setVec3(const std::string& name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    setVec3(name, glm::vec3(x, y, z));
 }
 
 void Shader::setVec4(const std::string& name, const glm::vec4& value) const
 {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    Uniform& uniform = cacheUniform(name, UniformType::Vec4, &value[0], 4);
+    glUniform4fv(uniform.Location, 1, &value[0]);
 }
 
 void Shader::setVec4(const std::string& name, float x, float y, float z, float w) const
 {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+    setVec4(name, glm::vec4(x, y, z, w));
 }
 
 void Shader::setMat2(const std::string& name, const glm::mat2& mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    Uniform& uniform = cacheUniform(name, UniformType::Mat2, &mat[0][0], 4);
+    glUniformMatrix2fv(uniform.Location, 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setMat3(const std::string& name, const glm::mat3& mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    Uniform& uniform = cacheUniform(name, UniformType::Mat3, &mat[0][0], 9);
+    glUniformMatrix3fv(uniform.Location, 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setMat4(const std::string& name, const glm::mat4& mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    Uniform& uniform = cacheUniform(name, UniformType::Mat4, &mat[0][0], 16);
+    glUniformMatrix4fv(uniform.Location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::reload()
+{
+    // a newer edit supersedes a reload that is still compiling
+    pending.reset(new Shader(vertexPath.c_str(), fragmentPath.c_str(), defines, false));
+}
+
+bool Shader::pollReload()
+{
+    if (!pending || !pending->isBuildComplete())
+        return false;
+
+    std::unique_ptr<Shader> next = std::move(pending);
+    if (!next->finishBuild())
+    {
+        std::cout << "ERROR::SHADER::RELOAD_FAILED: keeping the previous program of " << vertexPath << " / " << fragmentPath << std::endl;
+        return false;
+    }
+
+    // swap programs, the old one and the stages only it used are deleted together with next
+    std::swap(ID, next->ID);
+    std::swap(vertexStage, next->vertexStage);
+    std::swap(fragmentStage, next->fragmentStage);
+
+    // re-apply every uniform value set on the old program, locations differ between programs
+    GLint current = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+    glUseProgram(ID);
+    for (auto& uniform : uniforms)
+    {
+        uniform.second.Location = glGetUniformLocation(ID, uniform.first.c_str());
+        applyUniform(uniform.second);
+    }
+    glUseProgram(current == (GLint)next->ID ? ID : current);
+    return true;
+}
+
+bool Shader::dependsOn(const std::vector<std::string>& files) const
+{
+    for (const std::string& file : files)
+    {
+        if (file == ShaderPreprocessor::NormalizePath(vertexPath) || file == ShaderPreprocessor::NormalizePath(fragmentPath))
+            return true;
+    }
+    return false;
+}
+
+Shader::Uniform& Shader::cacheUniform(const std::string& name, UniformType type, const float* values, int count) const
+{
+    auto it = uniforms.find(name);
+    if (it == uniforms.end())
+    {
+        it = uniforms.emplace(name, Uniform()).first;
+        it->second.Location = glGetUniformLocation(ID, name.c_str());
+    }
+    it->second.Type = type;
+    memcpy(it->second.Values, values, count * sizeof(float));
+    return it->second;
+}
+
+void Shader::applyUniform(const Uniform& uniform) const
+{
+    const float* v = uniform.Values;
+    switch (uniform.Type)
+    {
+    case UniformType::Int: glUniform1i(uniform.Location, *(const int*)v); break;
+    case UniformType::Float: glUniform1f(uniform.Location, v[0]); break;
+    case UniformType::Vec2: glUniform2fv(uniform.Location, 1, v); break;
+    case UniformType::Vec3: glUniform3fv(uniform.Location, 1, v); break;
+    case UniformType::Vec4: glUniform4fv(uniform.Location, 1, v); break;
+    case UniformType::Mat2: glUniformMatrix2fv(uniform.Location, 1, GL_FALSE, v); break;
+    case UniformType::Mat3: glUniformMatrix3fv(uniform.Location, 1, GL_FALSE, v); break;
+    case UniformType::Mat4: glUniformMatrix4fv(uniform.Location, 1, GL_FALSE, v); break;
+    }
+}
+
+bool Shader::finishBuild()
+{
+    if (!built)
+    {
+        // stage errors are reported by every program using the stage, which is fine as they are rare
+        bool vertexCompiled = checkCompileErrors(vertexStage, "VERTEX");
+        bool fragmentCompiled = checkCompileErrors(fragmentStage, "FRAGMENT");
+        if (!vertexCompiled)
+            forgetStage(vertexStage);
+        if (!fragmentCompiled)
+            forgetStage(fragmentStage);
+        bool compiled = vertexCompiled && fragmentCompiled;
+        linked = checkCompileErrors(ID, "PROGRAM") && compiled;
+        built = true;
+    }
+    return linked;
+}
+
+bool Shader::isBuildComplete() const
+{
+    if (built || !GLExtensions::KHR_parallel_shader_compile)
+        return true;
+    int complete = 0;
+    glGetProgramiv(ID, GLExtensions::COMPLETION_STATUS_KHR, &complete);
+    return complete != 0;
+}
+
+void Shader::ReleaseStageCache()
+{
+    for (const auto& stage : stages)
+        glDeleteShader(stage.first);
+    stages.clear();
+    stageCache.clear();
+}
+
+unsigned int Shader::compileStage(const char* path, GLenum type, const std::vector<std::string>& defines)
+{
+    const ShaderPreprocessor::Result& preprocessed = ShaderPreprocessor::Get().Process(path, defines);
+    // the preprocessor reported what is missing, compile a stage that fails so the program does not link
+    if (!preprocessed.Success)
+    {
+        const char* code = "#version 330 core\n#error the source could not be preprocessed\n";
+        unsigned int shader = glCreateShader(type);
+        glShaderSource(shader, 1, &code, NULL);
+        glCompileShader(shader);
+        return acquireStage(shader, 0);
+    }
+
+    uint64_t key = preprocessed.Hash ^ type;
+    auto cached = stageCache.find(key);
+    if (cached != stageCache.end())
+        return acquireStage(cached->second, key);
+
+    const char* code = preprocessed.Source.c_str();
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 1, &code, NULL);
+    glCompileShader(shader);
+    // the compile status is only checked in finishBuild(), which takes the stage out again if it failed
+    stageCache[key] = shader;
+    return acquireStage(shader, key);
 }
 
-void Shader::checkCompileErrors(unsigned int shader, std::string type)
+bool Shader::checkCompileErrors(unsigned int shader, std::string type)
 {
     int success;
     char infoLog[1024];
@@ -156,4 +318,5 @@ void Shader::checkCompileErrors(unsigned int shader, std::string type)
             std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
         }
     }
+    return success != 0;
 }
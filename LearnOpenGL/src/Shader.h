@@ -1,8 +1,12 @@
+#pragma once
 
 #include <glad/glad.h> // include glad to get all the required OpenGL headers
 #include <glm/fwd.hpp>
 
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 class Shader
 {
@@ -10,10 +14,17 @@ public:
     // the program ID
     unsigned int ID;
 
-    // constructor reads and builds the shader
+    // constructor reads and builds the shader, sources go through ShaderPreprocessor (#include, #pragma once)
     Shader(const char* vertexPath, const char* fragmentPath);
+    // same as above with extra #define lines ("NAME" or "NAME VALUE") injected after #version,
+    // without waitForBuild the build is only submitted and finishBuild() has to be called before use
+    Shader(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines, bool waitForBuild = true);
     // deconstructor delete shader
     ~Shader();
+    // waits for a submitted build and reports compile/link errors, returns whether the program linked
+    bool finishBuild();
+    // true when finishBuild() would not block (always true without GL_KHR_parallel_shader_compile)
+    bool isBuildComplete() const;
     // use/activate the shader
     void use();
     // utility uniform functions
@@ -29,7 +40,45 @@ public:
     void setMat2(const std::string& name, const glm::mat2& mat) const;
     void setMat3(const std::string& name, const glm::mat3& mat) const;
     void setMat4(const std::string& name, const glm::mat4& mat) const;
+    // starts rebuilding the program from the current sources without blocking, the old program stays in use meanwhile
+    void reload();
+    // finishes a started reload once the driver is done: on success ID is swapped and every uniform value set
+    // so far is re-applied, on failure the old program is kept. returns true when ID changed
+    bool pollReload();
+    // true while a reload is compiling
+    bool isReloading() const { return pending != nullptr; }
+    // true when one of the (normalized) files is the vertex or fragment source of this shader
+    bool dependsOn(const std::vector<std::string>& files) const;
+    // deletes every compiled shader stage still held by a program, call at shutdown before the context goes away.
+    // until then a stage is deleted together with the last program using it
+    static void ReleaseStageCache();
 private:
+    enum class UniformType { Int, Float, Vec2, Vec3, Vec4, Mat2, Mat3, Mat4 };
+    // last value set through the set* functions, ints are stored bitwise in Values[0]
+    struct Uniform
+    {
+        int Location = -1;
+        UniformType Type = UniformType::Float;
+        float Values[16];
+    };
+
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::vector<std::string> defines;
+    unsigned int vertexStage;
+    unsigned int fragmentStage;
+    bool built = false;
+    bool linked = false;
+    // uniform locations and values, also saves the glGetUniformLocation string lookup on every set
+    mutable std::unordered_map<std::string, Uniform> uniforms;
+    // program being rebuilt by reload()
+    std::unique_ptr<Shader> pending;
+
+    Uniform& cacheUniform(const std::string& name, UniformType type, const float* values, int count) const;
+    void applyUniform(const Uniform& uniform) const;
+
+    // returns the compiled shader object for path, reusing it when the preprocessed source was compiled before
+    static unsigned int compileStage(const char* path, GLenum type, const std::vector<std::string>& defines);
     // utility function for checking shader compilation/linking errors.
-    void checkCompileErrors(unsigned int shader, std::string type);
+    static bool checkCompileErrors(unsigned int shader, std::string type);
 };
\ No newline at end of file
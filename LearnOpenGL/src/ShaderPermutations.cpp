@@ -0,0 +1,82 @@
+#include "ShaderPermutations.h"
+#include "GLExtensions.h"
+#include <iostream>
+
+ShaderPermutations::ShaderPermutations(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& features)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath), features(features)
+{
+    if (this->features.size() > MAX_FEATURES)
+    {
+        std::cout << "ERROR::SHADER::TOO_MANY_PERMUTATION_FEATURES: " << vertexPath << std::endl;
+        this->features.resize(MAX_FEATURES);
+    }
+    programs.resize(size_t(1) << this->features.size());
+}
+
+unsigned int ShaderPermutations::Mask(const std::string& feature) const
+{
+    for (unsigned int i = 0; i < features.size(); i++)
+    {
+        if (features[i] == feature)
+            return 1u << i;
+    }
+    return 0;
+}
+
+Shader& ShaderPermutations::Get(unsigned int mask)
+{
+    mask &= static_cast<unsigned int>(programs.size() - 1);
+    std::unique_ptr<Shader>& program = programs[mask];
+    if (!program)
+        program.reset(new Shader(vertexPath.c_str(), fragmentPath.c_str(), definesFor(mask)));
+    return *program;
+}
+
+void ShaderPermutations::Precompile(const std::vector<unsigned int>& masks)
+{
+    // let the driver use as many compiler threads as it likes
+    if (GLExtensions::KHR_parallel_shader_compile)
+        GLExtensions::glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+
+    // submit every build first, querying any status would serialize the compiles
+    std::vector<Shader*> submitted;
+    for (unsigned int mask : masks)
+    {
+        mask &= static_cast<unsigned int>(programs.size() - 1);
+        std::unique_ptr<Shader>& program = programs[mask];
+        if (program)
+            continue;
+        program.reset(new Shader(vertexPath.c_str(), fragmentPath.c_str(), definesFor(mask), false));
+        submitted.push_back(program.get());
+    }
+    for (Shader* program : submitted)
+        program->finishBuild();
+}
+
+unsigned int ShaderPermutations::BuiltCount() const
+{
+    unsigned int count = 0;
+    for (const std::unique_ptr<Shader>& program : programs)
+    {
+        if (program)
+            count++;
+    }
+    return count;
+}
+
+void ShaderPermutations::Clear()
+{
+    for (std::unique_ptr<Shader>& program : programs)
+        program.reset();
+}
+
+std::vector<std::string> ShaderPermutations::definesFor(unsigned int mask) const
+{
+    std::vector<std::string> defines;
+    for (unsigned int i = 0; i < features.size(); i++)
+    {
+        if (mask & (1u << i))
+            defines.push_back(features[i]);
+    }
+    return defines;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+
+// Builds variants of one vertex/fragment shader pair from feature bits (TEXTURED, VERTEX_COLOR, INSTANCED ...).
+// every feature set in a mask is injected as "#define <FEATURE>" and the programs are stored in a table indexed
+// by the mask, so picking a variant at draw time is a single array lookup.
+class ShaderPermutations
+{
+public:
+    // features are limited so the table indexed by mask stays small
+    static const unsigned int MAX_FEATURES = 8;
+
+    // declares the shader sources and their feature bits, the first feature is bit 0
+    ShaderPermutations(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& features);
+
+    // returns the bit of the named feature, 0 if the shader does not declare it
+    unsigned int Mask(const std::string& feature) const;
+    // returns the program for mask, building it on first use
+    Shader& Get(unsigned int mask);
+    // builds every listed variant up front, the builds are submitted together so the driver can compile them in parallel
+    void Precompile(const std::vector<unsigned int>& masks);
+    // number of variants built so far
+    unsigned int BuiltCount() const;
+    // calls f for every variant built so far
+    template<typename F>
+    void ForEachBuilt(F f)
+    {
+        for (std::unique_ptr<Shader>& program : programs)
+        {
+            if (program)
+                f(*program);
+        }
+    }
+    // drops every built variant, the next Get() rebuilds from the current sources. a ShaderWatcher watching the
+    // table forgets reloads of the dropped variants on its next Poll()
+    void Clear();
+
+private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::vector<std::string> features;
+    // indexed by mask, NULL until the variant is requested
+    std::vector<std::unique_ptr<Shader>> programs;
+
+    std::vector<std::string> definesFor(unsigned int mask) const;
+};
@@ -0,0 +1,279 @@
+#include "ShaderPreprocessor.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+namespace
+{
+    // nested includes deeper than this are treated as a cycle
+    const int MAX_INCLUDE_DEPTH = 32;
+
+    std::string directoryOf(const std::string& path)
+    {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    // returns the directive name if line is a preprocessor directive ("include", "pragma" ...), empty otherwise
+    std::string directiveOf(const std::string& line, size_t& argStart)
+    {
+        size_t pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos || line[pos] != '#')
+            return std::string();
+        pos = line.find_first_not_of(" \t", pos + 1);
+        if (pos == std::string::npos)
+            return std::string();
+        size_t end = line.find_first_of(" \t", pos);
+        argStart = end == std::string::npos ? line.size() : end;
+        return line.substr(pos, argStart - pos);
+    }
+}
+
+std::string ShaderPreprocessor::NormalizePath(const std::string& path)
+{
+    std::vector<std::string> parts;
+    std::string part;
+    std::stringstream stream(path);
+    while (std::getline(stream, part, '/'))
+    {
+        if (part == "..")
+        {
+            if (!parts.empty() && parts.back() != "..")
+                parts.pop_back();
+            else
+                parts.push_back(part);
+        }
+        else if (!part.empty() && part != ".")
+            parts.push_back(part);
+    }
+    std::string result = (!path.empty() && path[0] == '/') ? "/" : "";
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        if (i > 0)
+            result += '/';
+        result += parts[i];
+    }
+    return result;
+}
+
+uint64_t ShaderPreprocessor::HashString(const std::string& text, uint64_t seed)
+{
+    uint64_t hash = seed;
+    for (unsigned char c : text)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+ShaderPreprocessor& ShaderPreprocessor::Get()
+{
+    static ShaderPreprocessor instance;
+    return instance;
+}
+
+const ShaderPreprocessor::Result& ShaderPreprocessor::Process(const std::string& path, const std::vector<std::string>& defines)
+{
+    std::string root = NormalizePath(path);
+    uint64_t key = HashString(root);
+    for (const std::string& define : defines)
+        key = HashString(define, key ^ 0xff);
+
+    auto cached = cache.find(key);
+    if (cached != cache.end() && isUpToDate(cached->second))
+    {
+        CacheHits++;
+        return cached->second.Output;
+    }
+    CacheMisses++;
+
+    CacheEntry entry;
+    Result& result = entry.Output;
+    std::unordered_set<std::string> onceFiles;
+
+    // the root file is expanded first so #version ends up on the first line, defines follow right after it
+    std::string body;
+    result.Success = expand(root, result, onceFiles, 0);
+    body.swap(result.Source);
+
+    std::string header;
+    size_t bodyStart = 0;
+    if (body.compare(0, 8, "#version") == 0)
+    {
+        bodyStart = body.find('\n');
+        bodyStart = bodyStart == std::string::npos ? body.size() : bodyStart + 1;
+        header = body.substr(0, bodyStart);
+    }
+    for (const std::string& define : defines)
+        header += "#define " + define + "\n";
+    // keep line numbers of the root file intact in driver error messages
+    if (!defines.empty())
+        header += bodyStart > 0 ? "#line 2 0\n" : "#line 1 0\n";
+
+    result.Source = header + body.substr(bodyStart);
+    result.Hash = HashString(result.Source);
+
+    for (const std::string& file : result.Files)
+        entry.Dependencies.emplace_back(file, files[file].Hash);
+
+    CacheEntry& stored = cache[key];
+    stored = std::move(entry);
+    return stored.Output;
+}
+
+std::vector<std::string> ShaderPreprocessor::GetDependents(const std::string& path) const
+{
+    std::string target = NormalizePath(path);
+    std::vector<std::string> dependents{ target };
+    // walk the reverse include graph breadth first
+    for (size_t i = 0; i < dependents.size(); i++)
+    {
+        for (const auto& file : files)
+        {
+            for (const std::string& include : file.second.Includes)
+            {
+                if (include == dependents[i] && std::find(dependents.begin(), dependents.end(), file.first) == dependents.end())
+                    dependents.push_back(file.first);
+            }
+        }
+    }
+    return dependents;
+}
+
+std::vector<std::string> ShaderPreprocessor::GetKnownFiles() const
+{
+    std::vector<std::string> known;
+    for (const auto& file : files)
+        known.push_back(file.first);
+    return known;
+}
+
+void ShaderPreprocessor::Invalidate(const std::string& path)
+{
+    auto it = files.find(NormalizePath(path));
+    if (it != files.end())
+        it->second.Loaded = false;
+}
+
+ShaderPreprocessor::FileEntry& ShaderPreprocessor::loadFile(const std::string& path)
+{
+    FileEntry& entry = files[path];
+    if (entry.Loaded)
+        return entry;
+
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file)
+    {
+        entry.Contents.clear();
+        entry.Hash = 0;
+        return entry;
+    }
+    std::stringstream stream;
+    stream << file.rdbuf();
+    entry.Contents = stream.str();
+    entry.Hash = HashString(entry.Contents);
+    entry.Loaded = true;
+
+    // scan the directives once per load, expand() only has to look them up
+    entry.PragmaOnce = false;
+    entry.Includes.clear();
+    std::stringstream lines(entry.Contents);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        size_t argStart = 0;
+        std::string directive = directiveOf(line, argStart);
+        if (directive == "pragma" && line.find("once", argStart) != std::string::npos)
+            entry.PragmaOnce = true;
+        else if (directive == "include")
+        {
+            size_t open = line.find('"', argStart);
+            size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close != std::string::npos)
+                entry.Includes.push_back(NormalizePath(directoryOf(path) + line.substr(open + 1, close - open - 1)));
+        }
+    }
+    return entry;
+}
+
+bool ShaderPreprocessor::expand(const std::string& path, Result& result, std::unordered_set<std::string>& onceFiles, int depth)
+{
+    if (depth > MAX_INCLUDE_DEPTH)
+    {
+        std::cout << "ERROR::SHADER::INCLUDE_DEPTH_EXCEEDED: " << path << std::endl;
+        return false;
+    }
+
+    FileEntry& entry = loadFile(path);
+    if (!entry.Loaded)
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+        return false;
+    }
+    if (entry.PragmaOnce && !onceFiles.insert(path).second)
+        return true;
+
+    int fileIndex = static_cast<int>(std::find(result.Files.begin(), result.Files.end(), path) - result.Files.begin());
+    if (fileIndex == static_cast<int>(result.Files.size()))
+        result.Files.push_back(path);
+
+    // copy, expanding nested includes may rehash the files map
+    std::string contents = entry.Contents;
+    std::stringstream lines(contents);
+    std::string line;
+    int lineNumber = 0;
+    bool success = true;
+    while (std::getline(lines, line))
+    {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        size_t argStart = 0;
+        std::string directive = directiveOf(line, argStart);
+        if (directive == "pragma" && line.find("once", argStart) != std::string::npos)
+        {
+            result.Source += "\n";
+            continue;
+        }
+        // only the root file may declare the version
+        if (directive == "version" && depth > 0)
+        {
+            result.Source += "\n";
+            continue;
+        }
+        if (directive == "include")
+        {
+            size_t open = line.find('"', argStart);
+            size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close == std::string::npos)
+            {
+                std::cout << "ERROR::SHADER::MALFORMED_INCLUDE: " << path << "(" << lineNumber << ")" << std::endl;
+                success = false;
+                continue;
+            }
+            std::string includePath = NormalizePath(directoryOf(path) + line.substr(open + 1, close - open - 1));
+            int includeIndex = static_cast<int>(std::find(result.Files.begin(), result.Files.end(), includePath) - result.Files.begin());
+            result.Source += "#line 1 " + std::to_string(includeIndex) + "\n";
+            success = expand(includePath, result, onceFiles, depth + 1) && success;
+            result.Source += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+            continue;
+        }
+        result.Source += line;
+        result.Source += '\n';
+    }
+    return success;
+}
+
+bool ShaderPreprocessor::isUpToDate(const CacheEntry& entry)
+{
+    for (const auto& dependency : entry.Dependencies)
+    {
+        FileEntry& file = loadFile(dependency.first);
+        if (!file.Loaded || file.Hash != dependency.second)
+            return false;
+    }
+    return true;
+}
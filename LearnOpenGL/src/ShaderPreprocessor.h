@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// GLSL preprocessor that resolves #include "file" directives (relative to the including file),
+// honours #pragma once, injects #define lines right after #version and caches the result.
+// The driver's own preprocessor does not support #include, so this runs on the CPU before glShaderSource.
+class ShaderPreprocessor
+{
+public:
+    // result of preprocessing a single root shader file
+    struct Result
+    {
+        std::string Source;                 // final source handed to glShaderSource
+        uint64_t Hash = 0;                  // content hash of Source, used to share compiled shader objects
+        std::vector<std::string> Files;     // every file that took part, index matches the #line source number
+        bool Success = false;
+    };
+
+    // preprocesses the root file at path with the given defines ("NAME" or "NAME VALUE")
+    const Result& Process(const std::string& path, const std::vector<std::string>& defines = {});
+
+    // files that directly or transitively include path (path itself included), used to find affected shaders on change
+    std::vector<std::string> GetDependents(const std::string& path) const;
+    // drops the cached contents of path so the next Process call re-reads it from disk
+    void Invalidate(const std::string& path);
+
+    // counters, mostly to check that the cache does its job
+    unsigned int CacheHits = 0;
+    unsigned int CacheMisses = 0;
+
+    // collapses "a/b/../c" so the same file is always keyed by the same string
+    static std::string NormalizePath(const std::string& path);
+    // every file read so far, e.g. for watching them
+    std::vector<std::string> GetKnownFiles() const;
+    size_t GetKnownFileCount() const { return files.size(); }
+
+    // FNV-1a 64 bit hash, cheap and good enough to key caches by content
+    static uint64_t HashString(const std::string& text, uint64_t seed = 14695981039346656037ull);
+
+    // the process wide instance Shader uses
+    static ShaderPreprocessor& Get();
+
+private:
+    struct FileEntry
+    {
+        std::string Contents;
+        uint64_t Hash = 0;
+        bool PragmaOnce = false;
+        bool Loaded = false;
+        std::vector<std::string> Includes;  // direct includes, resolved to full paths
+    };
+
+    struct CacheEntry
+    {
+        Result Output;
+        std::vector<std::pair<std::string, uint64_t>> Dependencies; // file + content hash it was built from
+    };
+
+    FileEntry& loadFile(const std::string& path);
+    bool expand(const std::string& path, Result& result, std::unordered_set<std::string>& onceFiles, int depth);
+    bool isUpToDate(const CacheEntry& entry);
+
+    std::unordered_map<std::string, FileEntry> files;
+    // keyed by hash of root path + defines
+    std::unordered_map<uint64_t, CacheEntry> cache;
+};
@@ -0,0 +1,213 @@
+#include "ShaderWatcher.h"
+#include "Shader.h"
+#include "ShaderPermutations.h"
+#include "ShaderPreprocessor.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    bool isShaderFile(const std::string& name)
+    {
+        size_t dot = name.find_last_of('.');
+        if (dot == std::string::npos)
+            return false;
+        std::string extension = name.substr(dot);
+        return extension == ".vs" || extension == ".fs" || extension == ".glsl";
+    }
+}
+
+ShaderWatcher::ShaderWatcher(const std::vector<std::string>& directories) : running(true)
+{
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd >= 0)
+    {
+        // editors either rewrite in place (close_write) or write a temp file and rename it over (moved_to)
+        for (const std::string& directory : directories)
+        {
+            int descriptor = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (descriptor < 0)
+                std::cout << "ERROR::SHADER_WATCHER::CANNOT_WATCH: " << directory << std::endl;
+            else
+                watchDirectories[descriptor] = directory;
+        }
+        thread = std::thread(&ShaderWatcher::watchLoop, this);
+        return;
+    }
+    std::cout << "ERROR::SHADER_WATCHER::INOTIFY_UNAVAILABLE, falling back to polling" << std::endl;
+#endif
+    thread = std::thread(&ShaderWatcher::pollLoop, this);
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    running = false;
+    if (thread.joinable())
+        thread.join();
+#ifdef __linux__
+    if (inotifyFd >= 0)
+        close(inotifyFd);
+#endif
+}
+
+void ShaderWatcher::Watch(Shader& shader)
+{
+    shaders.push_back(&shader);
+}
+
+void ShaderWatcher::Watch(ShaderPermutations& permutations)
+{
+    this->permutations.push_back(&permutations);
+}
+
+void ShaderWatcher::Poll()
+{
+    std::vector<std::string> files;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        files.swap(changed);
+        // the polling fallback only learns about files once the preprocessor has read them
+        if (inotifyFd < 0 && ShaderPreprocessor::Get().GetKnownFileCount() != polledFiles.size())
+            polledFiles = ShaderPreprocessor::Get().GetKnownFiles();
+    }
+
+    if (!files.empty())
+    {
+        // collect every root file affected through the include graph
+        ShaderPreprocessor& preprocessor = ShaderPreprocessor::Get();
+        std::vector<std::string> affected;
+        for (const std::string& file : files)
+        {
+            preprocessor.Invalidate(file);
+            for (const std::string& dependent : preprocessor.GetDependents(file))
+            {
+                if (std::find(affected.begin(), affected.end(), dependent) == affected.end())
+                    affected.push_back(dependent);
+            }
+        }
+
+        for (Shader* shader : shaders)
+        {
+            if (shader->dependsOn(affected))
+                startReload(*shader);
+        }
+        for (ShaderPermutations* table : permutations)
+        {
+            table->ForEachBuilt([&](Shader& shader)
+            {
+                if (shader.dependsOn(affected))
+                    startReload(shader);
+            });
+        }
+    }
+
+    // variants dropped by ShaderPermutations::Clear() since their reload started are gone, forget them
+    if (!reloading.empty() && !permutations.empty())
+    {
+        std::vector<Shader*> alive(shaders);
+        for (ShaderPermutations* table : permutations)
+            table->ForEachBuilt([&](Shader& shader) { alive.push_back(&shader); });
+        reloading.erase(std::remove_if(reloading.begin(), reloading.end(), [&](Shader* shader)
+        {
+            return std::find(alive.begin(), alive.end(), shader) == alive.end();
+        }), reloading.end());
+    }
+
+    // swap in whatever the driver finished, the rest keeps compiling in the background
+    for (size_t i = 0; i < reloading.size();)
+    {
+        if (reloading[i]->pollReload())
+            ReloadCount++;
+        if (!reloading[i]->isReloading())
+        {
+            reloading[i] = reloading.back();
+            reloading.pop_back();
+        }
+        else
+            i++;
+    }
+}
+
+void ShaderWatcher::startReload(Shader& shader)
+{
+    shader.reload();
+    if (std::find(reloading.begin(), reloading.end(), &shader) == reloading.end())
+        reloading.push_back(&shader);
+}
+
+void ShaderWatcher::watchLoop()
+{
+#ifdef __linux__
+    // inotify events are variable sized, the buffer fits plenty of them
+    alignas(inotify_event) char buffer[4096];
+    while (running)
+    {
+        pollfd descriptor = { inotifyFd, POLLIN, 0 };
+        // wake up regularly to notice the destructor
+        if (poll(&descriptor, 1, 100) <= 0)
+            continue;
+
+        ssize_t length;
+        while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (char* ptr = buffer; ptr < buffer + length;)
+            {
+                const inotify_event* event = (const inotify_event*)ptr;
+                ptr += sizeof(inotify_event) + event->len;
+                if (event->len == 0 || !isShaderFile(event->name))
+                    continue;
+
+                auto directory = watchDirectories.find(event->wd);
+                if (directory == watchDirectories.end())
+                    continue;
+                std::string path = ShaderPreprocessor::NormalizePath(directory->second + "/" + event->name);
+                if (std::find(changed.begin(), changed.end(), path) == changed.end())
+                    changed.push_back(path);
+            }
+        }
+    }
+#endif
+}
+
+void ShaderWatcher::pollLoop()
+{
+    // last seen modification time per file
+    std::unordered_map<std::string, long long> timestamps;
+    while (running)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+        std::vector<std::string> files;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            files = polledFiles;
+        }
+        for (const std::string& file : files)
+        {
+            struct stat info;
+            if (stat(file.c_str(), &info) != 0)
+                continue;
+            long long modified = (long long)info.st_mtime;
+            auto it = timestamps.find(file);
+            if (it == timestamps.end())
+                timestamps[file] = modified;
+            else if (it->second != modified)
+            {
+                it->second = modified;
+                std::lock_guard<std::mutex> lock(mutex);
+                if (std::find(changed.begin(), changed.end(), file) == changed.end())
+                    changed.push_back(file);
+            }
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Shader;
+class ShaderPermutations;
+
+// Watches shader source directories and hot-reloads the registered shaders when one of their files
+// (or anything they #include) changes. Uses inotify on Linux and polls file timestamps elsewhere,
+// both on a background thread. Recompiling happens on the GL thread in Poll() without blocking the frame.
+class ShaderWatcher
+{
+public:
+    // starts watching the given directories for .vs/.fs/.glsl changes (the polling fallback checks every file the preprocessor read instead)
+    ShaderWatcher(const std::vector<std::string>& directories);
+    ~ShaderWatcher();
+
+    // registers a shader (or every built variant of a permutation table) for reloading, must outlive the watcher
+    void Watch(Shader& shader);
+    void Watch(ShaderPermutations& permutations);
+
+    // call once per frame on the GL thread: starts reloads for changed files and swaps in finished programs
+    void Poll();
+
+    // number of programs swapped in so far
+    unsigned int ReloadCount = 0;
+
+private:
+    std::vector<Shader*> shaders;
+    std::vector<ShaderPermutations*> permutations;
+    // shaders with a reload in flight, variants of a table are only valid until the table is cleared
+    std::vector<Shader*> reloading;
+
+    std::thread thread;
+    std::atomic<bool> running;
+    std::mutex mutex;
+    // filled by the background thread, drained by Poll()
+    std::vector<std::string> changed;
+    // files the polling fallback checks, refreshed by Poll() from the preprocessor
+    std::vector<std::string> polledFiles;
+    int inotifyFd = -1;
+    // inotify watch descriptor -> watched directory
+    std::unordered_map<int, std::string> watchDirectories;
+
+    void watchLoop();
+    void pollLoop();
+    void startReload(Shader& shader);
+};
@@ -0,0 +1,282 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "Sprites.h"
+#include "../ShaderPermutations.h"
+#include "../GLExtensions.h"
+#include "../RenderStats.h"
+#include "../TextureAtlas.h"
+
+namespace Sprites
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // the corpus: SPRITE_COUNT procedurally generated sprites between MIN_SPRITE_SIZE and MAX_SPRITE_SIZE texels
+    const int SPRITE_COUNT = 1000;
+    const int MIN_SPRITE_SIZE = 8;
+    const int MAX_SPRITE_SIZE = 64;
+
+    // how the sprites get their textures, switched with the 1/2/3 keys
+    enum TextureMode
+    {
+        SEPARATE,   // one texture per sprite
+        ATLAS,      // packed into TextureAtlas pages
+        ARRAY       // one layer per sprite in a TextureArray
+    };
+    const char* MODE_NAMES[] = { "separate textures", "atlas", "texture array" };
+    TextureMode mode = SEPARATE;
+
+    struct Sprite
+    {
+        int Index;              // position in the corpus, the draw list gets reordered
+        glm::vec4 Rect;         // NDC placement
+        unsigned int Texture;   // texture (SEPARATE) or atlas page texture (ATLAS)
+        glm::vec4 UVRect;
+        int Layer;
+    };
+
+    // a filled disc with a ring in a colour picked from seed, transparent outside
+    std::vector<unsigned char> generateSprite(unsigned int seed, int width, int height)
+    {
+        std::mt19937 random(seed);
+        unsigned char r = random() % 256, g = random() % 256, b = random() % 256;
+        std::vector<unsigned char> pixels((size_t)width * height * 4);
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+            {
+                float dx = (x + 0.5f) / width * 2.0f - 1.0f;
+                float dy = (y + 0.5f) / height * 2.0f - 1.0f;
+                float distance = dx * dx + dy * dy;
+                bool ring = distance > 0.6f;
+                unsigned char* pixel = &pixels[((size_t)y * width + x) * 4];
+                pixel[0] = ring ? 255 - r : r;
+                pixel[1] = ring ? 255 - g : g;
+                pixel[2] = ring ? 255 - b : b;
+                pixel[3] = distance <= 1.0f ? 255 : 0;
+            }
+        return pixels;
+    }
+
+    // draws the sprites sorted by texture so consecutive sprites sharing one skip the bind
+    void drawSprites(std::vector<Sprite>& sprites, Shader& shader, GLenum target, unsigned int arrayTexture)
+    {
+        shader.use();
+        RenderStats::Frame.ProgramBinds++;
+        glActiveTexture(GL_TEXTURE0);
+        if (target == GL_TEXTURE_2D_ARRAY)
+        {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, arrayTexture);
+            RenderStats::Frame.TextureBinds++;
+        }
+        unsigned int bound = 0;
+        for (const Sprite& sprite : sprites)
+        {
+            if (target == GL_TEXTURE_2D && sprite.Texture != bound)
+            {
+                glBindTexture(GL_TEXTURE_2D, sprite.Texture);
+                bound = sprite.Texture;
+                RenderStats::Frame.TextureBinds++;
+            }
+            shader.setVec4("rect", sprite.Rect);
+            shader.setVec4("uvRect", sprite.UVRect);
+            if (target == GL_TEXTURE_2D_ARRAY)
+                shader.setFloat("layer", (float)sprite.Layer);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            RenderStats::Frame.DrawCalls++;
+            RenderStats::Frame.Triangles += 2;
+        }
+    }
+
+    int Main()
+    {
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        ShaderPermutations shaders("shaders/VertexShaders/Sprite.vs", "shaders/FragmentShaders/Sprite.fs", { "TEXTURE_ARRAY" });
+        const unsigned int TEXTURE_ARRAY = shaders.Mask("TEXTURE_ARRAY");
+        shaders.Precompile({ 0, TEXTURE_ARRAY });
+
+        // the same corpus three times: separate textures, an atlas and a texture array
+        std::mt19937 random(42);
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        int layers = std::min(SPRITE_COUNT, (int)maxLayers);
+        TextureAtlas atlas;
+        TextureArray array(MAX_SPRITE_SIZE, MAX_SPRITE_SIZE, layers);
+        std::vector<unsigned int> separate(SPRITE_COUNT);
+        glGenTextures(SPRITE_COUNT, separate.data());
+        std::vector<Sprite> sprites(SPRITE_COUNT);
+        for (int i = 0; i < SPRITE_COUNT; i++)
+        {
+            int width = MIN_SPRITE_SIZE + random() % (MAX_SPRITE_SIZE - MIN_SPRITE_SIZE + 1);
+            int height = MIN_SPRITE_SIZE + random() % (MAX_SPRITE_SIZE - MIN_SPRITE_SIZE + 1);
+            std::vector<unsigned char> pixels = generateSprite(i, width, height);
+
+            glBindTexture(GL_TEXTURE_2D, separate[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            atlas.Add(pixels.data(), width, height);
+            // every layer of the array has the same size, the sprite is generated again at that size
+            if (i < layers)
+                array.Add(generateSprite(i, MAX_SPRITE_SIZE, MAX_SPRITE_SIZE).data(), MAX_SPRITE_SIZE, MAX_SPRITE_SIZE);
+
+            // sprites keep their texel size on screen
+            glm::vec2 size(2.0f * width / SCR_WIDTH, 2.0f * height / SCR_HEIGHT);
+            glm::vec2 position((random() % 1000) / 1000.0f * (2.0f - size.x) - 1.0f, (random() % 1000) / 1000.0f * (2.0f - size.y) - 1.0f);
+            sprites[i].Index = i;
+            sprites[i].Rect = glm::vec4(position, size);
+            sprites[i].Layer = i % layers;
+        }
+        atlas.Build();
+        array.Finish();
+        if (layers < SPRITE_COUNT)
+            std::cout << "GL_MAX_ARRAY_TEXTURE_LAYERS is " << maxLayers << ", array sprites reuse layers" << std::endl;
+        printf("atlas: %d sprites in %d page(s) of 2048x2048, packing efficiency %.1f%%\n", SPRITE_COUNT, atlas.GetPageCount(), atlas.GetEfficiency() * 100.0f);
+
+        // unit quad as a triangle strip
+        float vertices[] = {
+            0.0f, 0.0f,
+            1.0f, 0.0f,
+            0.0f, 1.0f,
+            1.0f, 1.0f
+        };
+        unsigned int VAO, VBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+
+        for (int i = 0; i < 2; i++)
+        {
+            shaders.Get(i ? TEXTURE_ARRAY : 0).use();
+            shaders.Get(i ? TEXTURE_ARRAY : 0).setInt("sprites", 0);
+        }
+
+        // render loop
+        TextureMode preparedMode = ARRAY;
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        RenderStats::Counters reportTotals;
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            processInput(window);
+
+            // fill in the per-mode texture data and sort by texture once per switch
+            if (mode != preparedMode)
+            {
+                for (Sprite& sprite : sprites)
+                {
+                    const AtlasRegion& region = atlas.GetRegion(sprite.Index);
+                    sprite.Texture = mode == ATLAS ? atlas.GetPageTexture(region.Page) : separate[sprite.Index];
+                    sprite.UVRect = mode == ATLAS ? region.UVRect : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+                }
+                std::stable_sort(sprites.begin(), sprites.end(), [](const Sprite& a, const Sprite& b) { return a.Texture < b.Texture; });
+                preparedMode = mode;
+            }
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glBindVertexArray(VAO);
+            if (mode == ARRAY)
+                drawSprites(sprites, shaders.Get(TEXTURE_ARRAY), GL_TEXTURE_2D_ARRAY, array.GetTexture());
+            else
+                drawSprites(sprites, shaders.Get(0), GL_TEXTURE_2D, 0);
+
+            RenderStats::EndFrame();
+            reportTotals.TextureBinds += RenderStats::Last.TextureBinds;
+            reportTotals.DrawCalls += RenderStats::Last.DrawCalls;
+            reportFrames++;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                printf("%-18s texture binds/frame %6.1f draws/frame %6.1f frame %6.3f ms\n", MODE_NAMES[mode],
+                    (double)reportTotals.TextureBinds / reportFrames, (double)reportTotals.DrawCalls / reportFrames, (now - reportStart) * 1000.0 / reportFrames);
+                reportStart = now;
+                reportFrames = 0;
+                reportTotals = RenderStats::Counters();
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures(SPRITE_COUNT, separate.data());
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            mode = SEPARATE;
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+            mode = ATLAS;
+        if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+            mode = ARRAY;
+    }
+}
@@ -0,0 +1,4 @@
+namespace Sprites
+{
+    int Main();
+};
@@ -0,0 +1,280 @@
+#include "TextureAtlas.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    const int ALIGNMENT = 1 << TextureAtlas::SAFE_MIP_LEVELS;
+
+    int alignUp(int value)
+    {
+        return (value + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    // skyline bottom-left packer: the skyline is a list of horizontal segments, a rectangle goes where its top ends lowest
+    class SkylinePacker
+    {
+    public:
+        SkylinePacker(int width, int height) : width(width), height(height)
+        {
+            skyline.push_back({ 0, 0, width });
+        }
+
+        bool Insert(int w, int h, int& x, int& y)
+        {
+            int bestIndex = -1, bestTop = height + 1, bestWidth = width + 1;
+            for (int i = 0; i < (int)skyline.size(); i++)
+            {
+                int top;
+                // lowest top first, narrowest segment on ties to keep wide segments for wide rectangles
+                if (fits(i, w, h, top) && (top + h < bestTop || (top + h == bestTop && skyline[i].Width < bestWidth)))
+                {
+                    bestIndex = i;
+                    bestTop = top + h;
+                    bestWidth = skyline[i].Width;
+                }
+            }
+            if (bestIndex < 0)
+                return false;
+
+            x = skyline[bestIndex].X;
+            y = bestTop - h;
+            skyline.insert(skyline.begin() + bestIndex, { x, bestTop, w });
+
+            // shrink or drop the segments now covered by the new one
+            for (size_t i = bestIndex + 1; i < skyline.size();)
+            {
+                Segment& previous = skyline[i - 1];
+                int overlap = previous.X + previous.Width - skyline[i].X;
+                if (overlap <= 0)
+                    break;
+                skyline[i].X += overlap;
+                skyline[i].Width -= overlap;
+                if (skyline[i].Width <= 0)
+                    skyline.erase(skyline.begin() + i);
+                else
+                    break;
+            }
+            // merge neighbours of equal height
+            for (size_t i = 0; i + 1 < skyline.size();)
+            {
+                if (skyline[i].Y == skyline[i + 1].Y)
+                {
+                    skyline[i].Width += skyline[i + 1].Width;
+                    skyline.erase(skyline.begin() + i + 1);
+                }
+                else
+                    i++;
+            }
+            return true;
+        }
+
+    private:
+        struct Segment
+        {
+            int X;
+            int Y;
+            int Width;
+        };
+
+        int width;
+        int height;
+        std::vector<Segment> skyline;
+
+        // height a w x h rectangle would rest at when its left edge is on segment index
+        bool fits(int index, int w, int h, int& top) const
+        {
+            if (skyline[index].X + w > width)
+                return false;
+            top = 0;
+            int remaining = w;
+            for (int i = index; remaining > 0; i++)
+            {
+                if (i >= (int)skyline.size())
+                    return false;
+                top = std::max(top, skyline[i].Y);
+                if (top + h > height)
+                    return false;
+                remaining -= skyline[i].Width;
+            }
+            return true;
+        }
+    };
+}
+
+TextureAtlas::TextureAtlas(int pageSize) : pageSize(pageSize)
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    if (!pages.empty())
+        glDeleteTextures((GLsizei)pages.size(), pages.data());
+}
+
+int TextureAtlas::Add(const unsigned char* rgba, int width, int height)
+{
+    Image image;
+    image.Pixels.assign(rgba, rgba + (size_t)width * height * 4);
+    image.Width = width;
+    image.Height = height;
+    images.push_back(std::move(image));
+    regions.push_back(AtlasRegion());
+    return (int)images.size() - 1;
+}
+
+int TextureAtlas::AddFile(const std::string& path)
+{
+    int width, height, channels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if (!data)
+    {
+        std::cout << "Failed to load texture " << path << std::endl;
+        return -1;
+    }
+    int index = Add(data, width, height);
+    stbi_image_free(data);
+    return index;
+}
+
+bool TextureAtlas::Build()
+{
+    // tallest first packs best with a skyline
+    std::vector<int> order(images.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = (int)i;
+    std::sort(order.begin(), order.end(), [this](int a, int b)
+    {
+        return images[a].Height != images[b].Height ? images[a].Height > images[b].Height : images[a].Width > images[b].Width;
+    });
+
+    std::vector<SkylinePacker> packers;
+    for (int index : order)
+    {
+        const Image& image = images[index];
+        int w = alignUp(image.Width + 2 * PADDING);
+        int h = alignUp(image.Height + 2 * PADDING);
+        if (w > pageSize || h > pageSize)
+        {
+            std::cout << "ERROR::TEXTURE_ATLAS::IMAGE_TOO_LARGE: " << image.Width << "x" << image.Height << std::endl;
+            return false;
+        }
+        // first page with room, otherwise a new one
+        AtlasRegion& region = regions[index];
+        int x = 0, y = 0;
+        for (size_t page = 0; page < packers.size() && region.Page < 0; page++)
+        {
+            if (packers[page].Insert(w, h, x, y))
+                region.Page = (int)page;
+        }
+        if (region.Page < 0)
+        {
+            packers.push_back(SkylinePacker(pageSize, pageSize));
+            packers.back().Insert(w, h, x, y);
+            region.Page = (int)packers.size() - 1;
+        }
+        region.X = x + PADDING;
+        region.Y = y + PADDING;
+        region.Width = image.Width;
+        region.Height = image.Height;
+        region.UVRect = glm::vec4((float)region.X / pageSize, (float)region.Y / pageSize, (float)image.Width / pageSize, (float)image.Height / pageSize);
+    }
+
+    // compose the pages on the CPU, padding is the image edge clamped outwards
+    std::vector<std::vector<unsigned char>> pixels(packers.size(), std::vector<unsigned char>((size_t)pageSize * pageSize * 4, 0));
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        const Image& image = images[i];
+        const AtlasRegion& region = regions[i];
+        std::vector<unsigned char>& page = pixels[region.Page];
+        int w = alignUp(image.Width + 2 * PADDING), h = alignUp(image.Height + 2 * PADDING);
+        int left = region.X - PADDING, bottom = region.Y - PADDING;
+        for (int y = 0; y < h; y++)
+        {
+            int sy = std::min(std::max(y - PADDING, 0), image.Height - 1);
+            for (int x = 0; x < w; x++)
+            {
+                int sx = std::min(std::max(x - PADDING, 0), image.Width - 1);
+                const unsigned char* src = &image.Pixels[((size_t)sy * image.Width + sx) * 4];
+                std::copy(src, src + 4, &page[((size_t)(bottom + y) * pageSize + left + x) * 4]);
+            }
+        }
+    }
+
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    pages.resize(packers.size());
+    glGenTextures((GLsizei)pages.size(), pages.data());
+    for (size_t page = 0; page < pages.size(); page++)
+    {
+        glBindTexture(GL_TEXTURE_2D, pages[page]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, pageSize, pageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels[page].data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // deeper levels would blend neighbouring images
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, SAFE_MIP_LEVELS);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glBindTexture(GL_TEXTURE_2D, previous);
+
+    // the source pixels live on in the pages
+    images.clear();
+    images.shrink_to_fit();
+    return true;
+}
+
+float TextureAtlas::GetEfficiency() const
+{
+    if (pages.empty())
+        return 0.0f;
+    double used = 0.0;
+    for (const AtlasRegion& region : regions)
+        used += (double)region.Width * region.Height;
+    return (float)(used / ((double)pageSize * pageSize * pages.size()));
+}
+
+TextureArray::TextureArray(int width, int height, int layers) : width(width), height(height), layers(layers)
+{
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &previous);
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, previous);
+}
+
+TextureArray::~TextureArray()
+{
+    glDeleteTextures(1, &texture);
+}
+
+int TextureArray::Add(const unsigned char* rgba, int width, int height)
+{
+    if (width != this->width || height != this->height || count >= layers)
+    {
+        std::cout << "ERROR::TEXTURE_ARRAY::LAYER_MISMATCH: " << width << "x" << height << std::endl;
+        return -1;
+    }
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &previous);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, count, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, previous);
+    return count++;
+}
+
+void TextureArray::Finish()
+{
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &previous);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, previous);
+}
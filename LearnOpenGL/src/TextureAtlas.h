@@ -0,0 +1,82 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+// where an image ended up in a TextureAtlas
+struct AtlasRegion
+{
+    int Page = -1;
+    // uv = UVRect.xy + uv * UVRect.zw maps the image's own uvs into the atlas page
+    glm::vec4 UVRect = glm::vec4(0.0f);
+    int X = 0;
+    int Y = 0;
+    int Width = 0;
+    int Height = 0;
+};
+
+// Packs many small images into a few large textures with a skyline (bottom-left) packer, so sprites sorted by
+// page share one bind. every image is surrounded by PADDING texels copied from its edges and placed on a grid of
+// 2^SAFE_MIP_LEVELS texels, so mip levels up to SAFE_MIP_LEVELS never mix neighbouring images.
+class TextureAtlas
+{
+public:
+    static const int PADDING = 2;
+    static const int SAFE_MIP_LEVELS = 2;
+
+    TextureAtlas(int pageSize = 2048);
+    ~TextureAtlas();
+
+    // queues an RGBA image (copied), returns its index for GetRegion
+    int Add(const unsigned char* rgba, int width, int height);
+    // queues an image file, returns -1 if it cannot be loaded
+    int AddFile(const std::string& path);
+    // packs every queued image, largest first, and uploads one texture per page
+    bool Build();
+
+    const AtlasRegion& GetRegion(int index) const { return regions[index]; }
+    unsigned int GetPageTexture(int page) const { return pages[page]; }
+    int GetPageCount() const { return (int)pages.size(); }
+    // image texels / page texels over all pages, padding and unused space count as waste
+    float GetEfficiency() const;
+
+private:
+    struct Image
+    {
+        std::vector<unsigned char> Pixels;
+        int Width;
+        int Height;
+    };
+
+    int pageSize;
+    std::vector<Image> images;
+    std::vector<AtlasRegion> regions;
+    std::vector<unsigned int> pages;
+};
+
+// The alternative when every image has the same size: one GL_TEXTURE_2D_ARRAY, a single bind for all of them
+// and no padding at all, the layer index is passed to the shader instead of a uv rectangle.
+class TextureArray
+{
+public:
+    TextureArray(int width, int height, int layers);
+    ~TextureArray();
+
+    // uploads an RGBA image of exactly width x height into the next layer, returns the layer or -1
+    int Add(const unsigned char* rgba, int width, int height);
+    // generates the mip chain once every layer is added
+    void Finish();
+
+    unsigned int GetTexture() const { return texture; }
+    int GetLayerCount() const { return count; }
+
+private:
+    unsigned int texture = 0;
+    int width;
+    int height;
+    int layers;
+    int count = 0;
+};
@@ -0,0 +1,327 @@
+#include "TextureCache.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <iostream>
+
+namespace
+{
+    GLenum formatFor(int channels)
+    {
+        switch (channels)
+        {
+        case 1: return GL_RED;
+        case 2: return GL_RG;
+        case 3: return GL_RGB;
+        default: return GL_RGBA;
+        }
+    }
+
+    void applySampling(const TextureSampling& sampling)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, sampling.WrapS);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, sampling.WrapT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, sampling.MinFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, sampling.MagFilter);
+    }
+}
+
+TextureCache::TextureCache(size_t budgetBytes, unsigned int loaderThreads) : budgetBytes(budgetBytes)
+{
+    loader = [](const std::string& path, int& width, int& height, int& channels)
+    {
+        return stbi_load(path.c_str(), &width, &height, &channels, 0);
+    };
+
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    // shown while the real texture is loading
+    const unsigned char white[4] = { 255, 255, 255, 255 };
+    glGenTextures(1, &placeholder);
+    glBindTexture(GL_TEXTURE_2D, placeholder);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, previous);
+    glGenFramebuffers(2, copyFramebuffers);
+
+    for (unsigned int i = 0; i < std::max(loaderThreads, 1u); i++)
+        threads.emplace_back(&TextureCache::loaderLoop, this);
+}
+
+TextureCache::~TextureCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wakeLoaders.notify_all();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (LoadedImage& image : finished)
+        free(image.Pixels);
+    for (auto& entry : entries)
+        glDeleteTextures(1, &entry.second.Texture);
+    glDeleteTextures(1, &placeholder);
+    glDeleteFramebuffers(2, copyFramebuffers);
+}
+
+unsigned int TextureCache::Get(const std::string& path, const TextureSampling& sampling)
+{
+    auto it = entries.find(path);
+    if (it == entries.end())
+    {
+        Misses++;
+        Entry& entry = entries[path];
+        entry.Sampling = sampling;
+        entry.LastUsedFrame = frame;
+        lru.push_front(path);
+        entry.LruPosition = lru.begin();
+        requestLoad(path, entry);
+        return placeholder;
+    }
+
+    Entry& entry = it->second;
+    entry.LastUsedFrame = frame;
+    lru.splice(lru.begin(), lru, entry.LruPosition);
+    if (entry.Texture == 0)
+    {
+        // after a failed load the placeholder stands in, without counting misses, until it is time to try again
+        if (!entry.Loading)
+        {
+            if (frame < entry.RetryFrame)
+                return placeholder;
+            requestLoad(path, entry);
+        }
+        Misses++;
+        return placeholder;
+    }
+    // a downgraded texture is back in use, bring back the full resolution
+    if (entry.Width < entry.FullWidth && !entry.Loading && frame >= entry.RetryFrame)
+        requestLoad(path, entry);
+    Hits++;
+    return entry.Texture;
+}
+
+void TextureCache::BeginFrame()
+{
+    frame++;
+    std::vector<LoadedImage> images;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        images.swap(finished);
+    }
+    for (LoadedImage& image : images)
+        upload(image);
+    enforceBudget();
+}
+
+void TextureCache::WaitForLoads()
+{
+    std::vector<LoadedImage> images;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        loadFinished.wait(lock, [this] { return inFlight == 0; });
+        images.swap(finished);
+    }
+    for (LoadedImage& image : images)
+        upload(image);
+    enforceBudget();
+}
+
+void TextureCache::SetBudget(size_t budgetBytes)
+{
+    this->budgetBytes = budgetBytes;
+}
+
+void TextureCache::SetLoader(Loader loader)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->loader = loader;
+}
+
+void TextureCache::loaderLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wakeLoaders.wait(lock, [this] { return !running || !requests.empty(); });
+        if (!running)
+            return;
+
+        LoadedImage image;
+        image.Path = requests.front();
+        requests.pop_front();
+        Loader load = loader;
+
+        // decode without holding the lock, this is the expensive part
+        lock.unlock();
+        image.Pixels = load(image.Path, image.Width, image.Height, image.Channels);
+        lock.lock();
+
+        finished.push_back(image);
+        inFlight--;
+        loadFinished.notify_all();
+    }
+}
+
+void TextureCache::requestLoad(const std::string& path, Entry& entry)
+{
+    entry.Loading = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back(path);
+        inFlight++;
+    }
+    wakeLoaders.notify_one();
+}
+
+void TextureCache::upload(LoadedImage& image)
+{
+    auto it = entries.find(image.Path);
+    // gone since it was requested, e.g. the cache is being torn down
+    if (it == entries.end())
+    {
+        free(image.Pixels);
+        return;
+    }
+    Entry& entry = it->second;
+    entry.Loading = false;
+    if (!image.Pixels)
+    {
+        std::cout << "Failed to load texture " << image.Path << std::endl;
+        entry.RetryFrame = frame + RETRY_FRAMES;
+        LoadFailures++;
+        return;
+    }
+    entry.RetryFrame = 0;
+
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    applySampling(entry.Sampling);
+    GLenum format = formatFor(image.Channels);
+    // rows of 1 and 3 channel images are not 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image.Width, image.Height, 0, format, GL_UNSIGNED_BYTE, image.Pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, previous);
+    free(image.Pixels);
+
+    // replaces a placeholder or a downgraded version
+    if (entry.Texture)
+        glDeleteTextures(1, &entry.Texture);
+    residentBytes -= entry.Bytes;
+    entry.Texture = texture;
+    entry.Width = entry.FullWidth = image.Width;
+    entry.Height = entry.FullHeight = image.Height;
+    entry.Format = format;
+    entry.Bytes = textureBytes(image.Width, image.Height, format);
+    residentBytes += entry.Bytes;
+    Uploads++;
+}
+
+void TextureCache::enforceBudget()
+{
+    if (residentBytes <= budgetBytes)
+        return;
+
+    // textures used in the last frame are most likely visible, never touch them
+    // first pass: halve the least recently used textures, each pass frees 3/4 of their memory
+    for (auto it = lru.rbegin(); it != lru.rend() && residentBytes > budgetBytes; ++it)
+    {
+        Entry& entry = entries[*it];
+        if (entry.LastUsedFrame + 1 >= frame)
+            break;
+        if (entry.Texture && !entry.Loading && std::min(entry.Width, entry.Height) / 2 >= MIN_DOWNGRADED_SIZE)
+            downgrade(entry);
+    }
+
+    // second pass: evict from the least recently used end. textures still loading are passed over, evicting one
+    // would have it requested and loaded a second time when it is used again
+    auto next = lru.end();
+    while (residentBytes > budgetBytes && next != lru.begin())
+    {
+        auto candidate = std::prev(next);
+        const Entry& entry = entries[*candidate];
+        if (entry.LastUsedFrame + 1 >= frame)
+            break;
+        if (entry.Loading)
+            next = candidate;
+        else
+            evict(*candidate);
+    }
+}
+
+bool TextureCache::downgrade(Entry& entry)
+{
+    int width = std::max(entry.Width / 2, 1);
+    int height = std::max(entry.Height / 2, 1);
+
+    GLint previousTexture = 0, previousRead = 0, previousDraw = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDraw);
+
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    applySampling(entry.Sampling);
+    glTexImage2D(GL_TEXTURE_2D, 0, entry.Format, width, height, 0, entry.Format, GL_UNSIGNED_BYTE, NULL);
+
+    // copy mip level 1 of the old texture into level 0 of the new one on the GPU, no CPU copy is kept
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, copyFramebuffers[0]);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, entry.Texture, 1);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, copyFramebuffers[1]);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    bool complete = glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE
+        && glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (complete)
+    {
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previousRead);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousDraw);
+    glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+    // the format is not renderable on this driver, the caller falls back to evicting
+    if (!complete)
+    {
+        glDeleteTextures(1, &texture);
+        return false;
+    }
+
+    glDeleteTextures(1, &entry.Texture);
+    residentBytes -= entry.Bytes;
+    entry.Texture = texture;
+    entry.Width = width;
+    entry.Height = height;
+    entry.Bytes = textureBytes(width, height, entry.Format);
+    residentBytes += entry.Bytes;
+    Downgrades++;
+    return true;
+}
+
+void TextureCache::evict(const std::string& path)
+{
+    auto it = entries.find(path);
+    Entry& entry = it->second;
+    glDeleteTextures(1, &entry.Texture);
+    residentBytes -= entry.Bytes;
+    lru.erase(entry.LruPosition);
+    entries.erase(it);
+    Evictions++;
+}
+
+size_t TextureCache::textureBytes(int width, int height, GLenum format)
+{
+    size_t channels = format == GL_RED ? 1 : format == GL_RG ? 2 : format == GL_RGB ? 3 : 4;
+    // a full mip chain adds a third
+    return (size_t)width * height * channels * 4 / 3;
+}
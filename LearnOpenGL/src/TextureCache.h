@@ -0,0 +1,121 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// wrapping and filtering applied when a texture is created
+struct TextureSampling
+{
+    GLint WrapS = GL_REPEAT;
+    GLint WrapT = GL_REPEAT;
+    GLint MinFilter = GL_LINEAR_MIPMAP_LINEAR;
+    GLint MagFilter = GL_LINEAR;
+};
+
+// Keeps textures resident under a GPU memory budget. Textures are loaded on background threads and uploaded
+// in BeginFrame(); when the budget is exceeded the least recently used ones first lose their top mip level
+// and are evicted once they are at MIN_DOWNGRADED_SIZE. Textures used again are reloaded at full size.
+// Get() may return a different ID from frame to frame, so call it every frame instead of keeping the ID.
+class TextureCache
+{
+public:
+    // decodes path into 8 bit pixels (like stbi_load), returns NULL on failure. the result is released with free()
+    typedef std::function<unsigned char* (const std::string& path, int& width, int& height, int& channels)> Loader;
+
+    // textures are not shrunk below this size before being evicted
+    static const int MIN_DOWNGRADED_SIZE = 64;
+    // a texture that failed to load is requested again this many frames later, so a fixed file is picked up
+    static const unsigned int RETRY_FRAMES = 120;
+
+    TextureCache(size_t budgetBytes, unsigned int loaderThreads = 1);
+    ~TextureCache();
+
+    // returns the texture for path and marks it used this frame. while it is loading, or after its load failed, a 1x1
+    // placeholder is returned
+    unsigned int Get(const std::string& path, const TextureSampling& sampling = TextureSampling());
+    // advances the frame counter, uploads finished loads and enforces the budget. call once per frame before drawing
+    void BeginFrame();
+    // blocks until every queued load is uploaded, useful at startup
+    void WaitForLoads();
+
+    void SetBudget(size_t budgetBytes);
+    // replaces the stbi_load based loader, e.g. with a generator of synthetic textures
+    void SetLoader(Loader loader);
+
+    size_t GetResidentBytes() const { return residentBytes; }
+    size_t GetTextureCount() const { return entries.size(); }
+
+    // statistics, reset by the user whenever convenient
+    unsigned int Hits = 0;
+    unsigned int Misses = 0;
+    unsigned int Evictions = 0;
+    unsigned int Downgrades = 0;
+    unsigned int Uploads = 0;
+    unsigned int LoadFailures = 0;
+
+private:
+    struct Entry
+    {
+        unsigned int Texture = 0;
+        int Width = 0;
+        int Height = 0;
+        int FullWidth = 0;
+        int FullHeight = 0;
+        GLenum Format = GL_RGBA;
+        size_t Bytes = 0;
+        unsigned long long LastUsedFrame = 0;
+        // a load is queued or decoding, the entry is not evicted until it is uploaded
+        bool Loading = false;
+        // set when a load failed, no new load is requested before this frame
+        unsigned long long RetryFrame = 0;
+        TextureSampling Sampling;
+        std::list<std::string>::iterator LruPosition;
+    };
+
+    // decoded pixels waiting for the GL thread
+    struct LoadedImage
+    {
+        std::string Path;
+        unsigned char* Pixels;
+        int Width;
+        int Height;
+        int Channels;
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+    // most recently used at the front
+    std::list<std::string> lru;
+    size_t budgetBytes;
+    size_t residentBytes = 0;
+    unsigned long long frame = 0;
+    unsigned int placeholder = 0;
+    unsigned int copyFramebuffers[2] = { 0, 0 };
+
+    Loader loader;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wakeLoaders;
+    std::condition_variable loadFinished;
+    std::deque<std::string> requests;
+    std::vector<LoadedImage> finished;
+    unsigned int inFlight = 0;
+    bool running = true;
+
+    void loaderLoop();
+    void requestLoad(const std::string& path, Entry& entry);
+    void upload(LoadedImage& image);
+    void enforceBudget();
+    bool downgrade(Entry& entry);
+    void evict(const std::string& path);
+    static size_t textureBytes(int width, int height, GLenum format);
+};
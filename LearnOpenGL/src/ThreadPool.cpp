@@ -0,0 +1,80 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int threads) : nextRange(0)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int i = 1; i < threads; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wakeWorkers.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t first, size_t last)>& task)
+{
+    grain = std::max(grain, (size_t)1);
+    // not worth waking anyone for
+    if (workers.empty() || count <= grain)
+    {
+        for (size_t first = 0; first < count; first += grain)
+            task(first, std::min(count, first + grain));
+        return;
+    }
+
+    std::lock_guard<std::mutex> calling(callerMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        this->count = count;
+        this->grain = grain;
+        nextRange = 0;
+        finishedWorkers = 0;
+        generation++;
+    }
+    wakeWorkers.notify_all();
+    runRanges(task, count, grain);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    workersFinished.wait(lock, [this] { return finishedWorkers == workers.size(); });
+    this->task = nullptr;
+}
+
+void ThreadPool::workerLoop()
+{
+    unsigned int seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wakeWorkers.wait(lock, [&] { return !running || generation != seenGeneration; });
+        if (!running)
+            return;
+        seenGeneration = generation;
+        const std::function<void(size_t, size_t)>& loopTask = *task;
+        size_t loopCount = count;
+        size_t loopGrain = grain;
+
+        lock.unlock();
+        runRanges(loopTask, loopCount, loopGrain);
+        lock.lock();
+
+        if (++finishedWorkers == workers.size())
+            workersFinished.notify_one();
+    }
+}
+
+void ThreadPool::runRanges(const std::function<void(size_t, size_t)>& task, size_t count, size_t grain)
+{
+    for (size_t range = nextRange++; range * grain < count; range = nextRange++)
+        task(range * grain, std::min(count, (range + 1) * grain));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker threads kept around for data-parallel loops, so a frame does not pay for starting threads. ParallelFor()
+// hands out ranges of indices to the workers and to the calling thread and returns once all of them are done.
+// ParallelFor() calls from several threads take turns; calling it from inside a task deadlocks.
+class ThreadPool
+{
+public:
+    // threads counts the calling thread, 0 means one per hardware thread
+    explicit ThreadPool(unsigned int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // runs task(first, last) over [0, count) in ranges of grain indices, the last one possibly shorter
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t first, size_t last)>& task);
+
+    unsigned int GetThreadCount() const { return (unsigned int)workers.size() + 1; }
+
+private:
+    std::vector<std::thread> workers;
+    // one ParallelFor() at a time
+    std::mutex callerMutex;
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable workersFinished;
+    // the current loop, every worker takes part in every one so none of them can see a stale loop
+    const std::function<void(size_t, size_t)>* task = nullptr;
+    size_t count = 0;
+    size_t grain = 1;
+    std::atomic<size_t> nextRange;
+    unsigned int generation = 0;
+    unsigned int finishedWorkers = 0;
+    bool running = true;
+
+    void workerLoop();
+    void runRanges(const std::function<void(size_t, size_t)>& task, size_t count, size_t grain);
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+// The loops behind TransformStore::Update(), one per instruction set. the AVX2 one lives in its own file compiled
+// for AVX2, only call it when CpuFeatures says so. no glm here: inline functions that file instantiates could be the
+// copy the linker keeps for the whole program, AVX2 instructions and all
+namespace TransformKernels
+{
+    // the store's arrays, indexed by slot. the float arrays can be read 8 floats at a time from any slot
+    struct Arrays
+    {
+        const float* Position[3];
+        // x, y, z, w of a unit quaternion
+        const float* Rotation[4];
+        const float* Scale[3];
+        // slot of the parent, which is on an earlier level, or -1
+        const int* Parents;
+        // nonzero for slots to compose, can be read 8 at a time from any slot
+        const unsigned char* Dirty;
+        // 16 floats per slot like glm::mat4, 64 byte aligned
+        float* Worlds;
+    };
+
+    // composes world = parent world * translate * rotate * scale for the dirty slots in [first, last), whose
+    // parents are all outside the range
+    void ComposeScalar(const Arrays& arrays, size_t first, size_t last);
+    void ComposeSse(const Arrays& arrays, size_t first, size_t last);
+    void ComposeAvx2(const Arrays& arrays, size_t first, size_t last);
+}
@@ -0,0 +1,83 @@
+// compiled with /arch:AVX2 (see the project file), only reached when CpuFeatures reports AVX2 and FMA
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2,fma")
+#endif
+
+#include "TransformKernels.h"
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+
+namespace
+{
+    // a in the low four lanes, b in the high four
+    inline __m256 pair(float a, float b)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(a)), _mm_set1_ps(b), 1);
+    }
+}
+
+void TransformKernels::ComposeAvx2(const Arrays& arrays, size_t first, size_t last)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    // the local matrices of a batch, 3 x 3 rotation-scale then translation, each row one value of 8 nodes
+    alignas(32) float local[12][8];
+    for (size_t i = first; i < last; i += 8)
+    {
+        uint64_t batchDirty;
+        std::memcpy(&batchDirty, arrays.Dirty + i, sizeof(batchDirty));
+        if (batchDirty == 0)
+            continue;
+
+        __m256 x = _mm256_loadu_ps(arrays.Rotation[0] + i), y = _mm256_loadu_ps(arrays.Rotation[1] + i);
+        __m256 z = _mm256_loadu_ps(arrays.Rotation[2] + i), w = _mm256_loadu_ps(arrays.Rotation[3] + i);
+        __m256 sx = _mm256_loadu_ps(arrays.Scale[0] + i), sy = _mm256_loadu_ps(arrays.Scale[1] + i), sz = _mm256_loadu_ps(arrays.Scale[2] + i);
+        __m256 x2 = _mm256_mul_ps(x, two), y2 = _mm256_mul_ps(y, two), z2 = _mm256_mul_ps(z, two);
+        __m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+        __m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+        __m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+        _mm256_store_ps(local[0], _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx));
+        _mm256_store_ps(local[1], _mm256_mul_ps(_mm256_add_ps(xy, wz), sx));
+        _mm256_store_ps(local[2], _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx));
+        _mm256_store_ps(local[3], _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy));
+        _mm256_store_ps(local[4], _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy));
+        _mm256_store_ps(local[5], _mm256_mul_ps(_mm256_add_ps(yz, wx), sy));
+        _mm256_store_ps(local[6], _mm256_mul_ps(_mm256_add_ps(xz, wy), sz));
+        _mm256_store_ps(local[7], _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz));
+        _mm256_store_ps(local[8], _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz));
+        _mm256_store_ps(local[9], _mm256_loadu_ps(arrays.Position[0] + i));
+        _mm256_store_ps(local[10], _mm256_loadu_ps(arrays.Position[1] + i));
+        _mm256_store_ps(local[11], _mm256_loadu_ps(arrays.Position[2] + i));
+
+        // the batch may run past the range, those lanes belong to someone else
+        size_t lanes = last - i < 8 ? last - i : 8;
+        for (size_t lane = 0; lane < lanes; lane++)
+        {
+            if (!arrays.Dirty[i + lane])
+                continue;
+            float* world = arrays.Worlds + (i + lane) * 16;
+            int parentSlot = arrays.Parents[i + lane];
+            if (parentSlot < 0)
+            {
+                _mm256_store_ps(world, _mm256_setr_ps(local[0][lane], local[1][lane], local[2][lane], 0.0f, local[3][lane], local[4][lane], local[5][lane], 0.0f));
+                _mm256_store_ps(world + 8, _mm256_setr_ps(local[6][lane], local[7][lane], local[8][lane], 0.0f, local[9][lane], local[10][lane], local[11][lane], 1.0f));
+                continue;
+            }
+            // two columns of parent * local per register
+            const float* parent = arrays.Worlds + parentSlot * 16;
+            __m256 parent0 = _mm256_broadcast_ps((const __m128*)parent);
+            __m256 parent1 = _mm256_broadcast_ps((const __m128*)(parent + 4));
+            __m256 parent2 = _mm256_broadcast_ps((const __m128*)(parent + 8));
+            __m256 parent3 = _mm256_insertf128_ps(_mm256_setzero_ps(), _mm_load_ps(parent + 12), 1);
+            __m256 columns01 = _mm256_mul_ps(parent0, pair(local[0][lane], local[3][lane]));
+            columns01 = _mm256_fmadd_ps(parent1, pair(local[1][lane], local[4][lane]), columns01);
+            columns01 = _mm256_fmadd_ps(parent2, pair(local[2][lane], local[5][lane]), columns01);
+            __m256 columns23 = _mm256_fmadd_ps(parent0, pair(local[6][lane], local[9][lane]), parent3);
+            columns23 = _mm256_fmadd_ps(parent1, pair(local[7][lane], local[10][lane]), columns23);
+            columns23 = _mm256_fmadd_ps(parent2, pair(local[8][lane], local[11][lane]), columns23);
+            _mm256_store_ps(world, columns01);
+            _mm256_store_ps(world + 8, columns23);
+        }
+    }
+}
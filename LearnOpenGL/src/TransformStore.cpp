@@ -0,0 +1,313 @@
+#include "TransformStore.h"
+#include "CpuFeatures.h"
+#include "TransformKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <xmmintrin.h>
+
+namespace
+{
+    // translate * rotate * scale as its three rotation-scale columns and the translation
+    struct Local
+    {
+        glm::vec3 Columns[3];
+        glm::vec3 Translation;
+    };
+
+    Local localMatrix(const TransformKernels::Arrays& arrays, size_t i)
+    {
+        float x = arrays.Rotation[0][i], y = arrays.Rotation[1][i], z = arrays.Rotation[2][i], w = arrays.Rotation[3][i];
+        float sx = arrays.Scale[0][i], sy = arrays.Scale[1][i], sz = arrays.Scale[2][i];
+        Local local;
+        local.Columns[0] = glm::vec3(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y)) * sx;
+        local.Columns[1] = glm::vec3(2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x)) * sy;
+        local.Columns[2] = glm::vec3(2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y)) * sz;
+        local.Translation = glm::vec3(arrays.Position[0][i], arrays.Position[1][i], arrays.Position[2][i]);
+        return local;
+    }
+}
+
+void TransformKernels::ComposeScalar(const Arrays& arrays, size_t first, size_t last)
+{
+    for (size_t i = first; i < last; i++)
+    {
+        if (!arrays.Dirty[i])
+            continue;
+        Local local = localMatrix(arrays, i);
+        glm::mat4& world = ((glm::mat4*)arrays.Worlds)[i];
+        if (arrays.Parents[i] < 0)
+        {
+            world = glm::mat4(glm::vec4(local.Columns[0], 0.0f), glm::vec4(local.Columns[1], 0.0f), glm::vec4(local.Columns[2], 0.0f),
+                glm::vec4(local.Translation, 1.0f));
+            continue;
+        }
+        const glm::mat4& parent = ((const glm::mat4*)arrays.Worlds)[arrays.Parents[i]];
+        for (int column = 0; column < 3; column++)
+            world[column] = parent[0] * local.Columns[column].x + parent[1] * local.Columns[column].y + parent[2] * local.Columns[column].z;
+        world[3] = parent[0] * local.Translation.x + parent[1] * local.Translation.y + parent[2] * local.Translation.z + parent[3];
+    }
+}
+
+void TransformKernels::ComposeSse(const Arrays& arrays, size_t first, size_t last)
+{
+    for (size_t i = first; i < last; i++)
+    {
+        if (!arrays.Dirty[i])
+            continue;
+        Local local = localMatrix(arrays, i);
+        float* world = arrays.Worlds + i * 16;
+        if (arrays.Parents[i] < 0)
+        {
+            for (int column = 0; column < 3; column++)
+                _mm_store_ps(world + column * 4, _mm_setr_ps(local.Columns[column].x, local.Columns[column].y, local.Columns[column].z, 0.0f));
+            _mm_store_ps(world + 12, _mm_setr_ps(local.Translation.x, local.Translation.y, local.Translation.z, 1.0f));
+            continue;
+        }
+        const float* parent = arrays.Worlds + arrays.Parents[i] * 16;
+        __m128 parent0 = _mm_load_ps(parent), parent1 = _mm_load_ps(parent + 4), parent2 = _mm_load_ps(parent + 8), parent3 = _mm_load_ps(parent + 12);
+        for (int column = 0; column < 3; column++)
+        {
+            __m128 result = _mm_mul_ps(parent0, _mm_set1_ps(local.Columns[column].x));
+            result = _mm_add_ps(result, _mm_mul_ps(parent1, _mm_set1_ps(local.Columns[column].y)));
+            result = _mm_add_ps(result, _mm_mul_ps(parent2, _mm_set1_ps(local.Columns[column].z)));
+            _mm_store_ps(world + column * 4, result);
+        }
+        __m128 result = _mm_add_ps(parent3, _mm_mul_ps(parent0, _mm_set1_ps(local.Translation.x)));
+        result = _mm_add_ps(result, _mm_mul_ps(parent1, _mm_set1_ps(local.Translation.y)));
+        result = _mm_add_ps(result, _mm_mul_ps(parent2, _mm_set1_ps(local.Translation.z)));
+        _mm_store_ps(world + 12, result);
+    }
+}
+
+TransformStore::TransformStore()
+{
+    const CpuFeatures& cpu = CpuFeatures::Get();
+    UpdatePath = cpu.Avx2 && cpu.Fma ? Path::Avx2 : Path::Sse;
+    levelStarts.push_back(0);
+}
+
+unsigned int TransformStore::Create(int parent)
+{
+    unsigned int handle = (unsigned int)handles.size();
+    unsigned int slot = handle;
+    slots.push_back(slot);
+    handles.push_back(handle);
+    parentHandles.push_back(parent);
+    resizeArrays(handles.size());
+    positionX[slot] = positionY[slot] = positionZ[slot] = 0.0f;
+    rotationX[slot] = rotationY[slot] = rotationZ[slot] = 0.0f;
+    rotationW[slot] = 1.0f;
+    scaleX[slot] = scaleY[slot] = scaleZ[slot] = 1.0f;
+    parentSlots[slot] = parent >= 0 ? (int)slots[parent] : -1;
+    dirty[slot] = 1;
+    orderChanged = anyDirty = true;
+    return handle;
+}
+
+bool TransformStore::SetParent(unsigned int handle, int parent)
+{
+    for (int ancestor = parent; ancestor >= 0; ancestor = parentHandles[ancestor])
+        if (ancestor == (int)handle)
+            return false;
+    parentHandles[handle] = parent;
+    parentSlots[slots[handle]] = parent >= 0 ? (int)slots[parent] : -1;
+    dirty[slots[handle]] = 1;
+    orderChanged = anyDirty = true;
+    return true;
+}
+
+void TransformStore::SetLocal(unsigned int handle, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+    SetPosition(handle, position);
+    SetRotation(handle, rotation);
+    SetScale(handle, scale);
+}
+
+void TransformStore::SetPosition(unsigned int handle, const glm::vec3& position)
+{
+    unsigned int slot = slots[handle];
+    positionX[slot] = position.x;
+    positionY[slot] = position.y;
+    positionZ[slot] = position.z;
+    dirty[slot] = 1;
+    anyDirty = true;
+}
+
+void TransformStore::SetRotation(unsigned int handle, const glm::quat& rotation)
+{
+    unsigned int slot = slots[handle];
+    rotationX[slot] = rotation.x;
+    rotationY[slot] = rotation.y;
+    rotationZ[slot] = rotation.z;
+    rotationW[slot] = rotation.w;
+    dirty[slot] = 1;
+    anyDirty = true;
+}
+
+void TransformStore::SetScale(unsigned int handle, const glm::vec3& scale)
+{
+    unsigned int slot = slots[handle];
+    scaleX[slot] = scale.x;
+    scaleY[slot] = scale.y;
+    scaleZ[slot] = scale.z;
+    dirty[slot] = 1;
+    anyDirty = true;
+}
+
+glm::vec3 TransformStore::GetPosition(unsigned int handle) const
+{
+    unsigned int slot = slots[handle];
+    return glm::vec3(positionX[slot], positionY[slot], positionZ[slot]);
+}
+
+glm::quat TransformStore::GetRotation(unsigned int handle) const
+{
+    unsigned int slot = slots[handle];
+    return glm::quat(rotationW[slot], rotationX[slot], rotationY[slot], rotationZ[slot]);
+}
+
+glm::vec3 TransformStore::GetScale(unsigned int handle) const
+{
+    unsigned int slot = slots[handle];
+    return glm::vec3(scaleX[slot], scaleY[slot], scaleZ[slot]);
+}
+
+void TransformStore::Update(unsigned int threads)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Composed = 0;
+    if (!anyDirty)
+    {
+        UpdateSeconds = 0.0;
+        return;
+    }
+    anyDirty = false;
+    if (orderChanged)
+    {
+        sortSlots();
+        orderChanged = false;
+    }
+
+    // parents come first, so one pass marks every descendant of a changed node
+    size_t count = handles.size();
+    for (size_t slot = 0; slot < count; slot++)
+    {
+        if (parentSlots[slot] >= 0 && dirty[parentSlots[slot]])
+            dirty[slot] = 1;
+        Composed += dirty[slot];
+    }
+    for (size_t level = 0; level + 1 < levelStarts.size(); level++)
+        composeLevel(levelStarts[level], levelStarts[level + 1], threads);
+    std::fill(dirty.begin(), dirty.end(), 0);
+    UpdateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void TransformStore::resizeArrays(size_t count)
+{
+    // 8 wide loads from the last slot stay inside
+    size_t padded = ((count + 7) & ~(size_t)7) + 8;
+    if (padded != positionX.size())
+    {
+        for (AlignedVector<float>* field : { &positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ, &rotationW, &scaleX, &scaleY, &scaleZ })
+            field->resize(padded, 0.0f);
+        dirty.resize(padded, 0);
+    }
+    parentSlots.resize(count);
+    worlds.resize(count);
+}
+
+void TransformStore::sortSlots()
+{
+    size_t count = handles.size();
+    // depth of every handle, walking up to the nearest ancestor whose depth is known
+    std::vector<int> depths(count, -1);
+    std::vector<unsigned int> chain;
+    int maxDepth = 0;
+    for (unsigned int handle = 0; handle < count; handle++)
+    {
+        int node = (int)handle;
+        while (node >= 0 && depths[node] < 0)
+        {
+            chain.push_back(node);
+            node = parentHandles[node];
+        }
+        int depth = node >= 0 ? depths[node] : -1;
+        while (!chain.empty())
+        {
+            depths[chain.back()] = ++depth;
+            chain.pop_back();
+        }
+        maxDepth = std::max(maxDepth, depths[handle]);
+    }
+
+    // counting sort by depth, in the current slot order within a level
+    levelStarts.assign(count > 0 ? maxDepth + 2 : 1, 0);
+    for (unsigned int handle = 0; handle < count; handle++)
+        levelStarts[depths[handle] + 1]++;
+    for (size_t level = 1; level < levelStarts.size(); level++)
+        levelStarts[level] += levelStarts[level - 1];
+    std::vector<unsigned int> next(levelStarts.begin(), levelStarts.end() - 1);
+    std::vector<unsigned int> newSlots(count);
+    for (unsigned int slot = 0; slot < count; slot++)
+        newSlots[slot] = next[depths[handles[slot]]]++;
+
+    for (AlignedVector<float>* field : { &positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ, &rotationW, &scaleX, &scaleY, &scaleZ })
+    {
+        AlignedVector<float> sorted(field->size(), 0.0f);
+        for (unsigned int slot = 0; slot < count; slot++)
+            sorted[newSlots[slot]] = (*field)[slot];
+        field->swap(sorted);
+    }
+    AlignedVector<unsigned char> sortedDirty(dirty.size(), 0);
+    AlignedVector<AlignedMat4> sortedWorlds(count);
+    std::vector<unsigned int> sortedHandles(count);
+    for (unsigned int slot = 0; slot < count; slot++)
+    {
+        sortedDirty[newSlots[slot]] = dirty[slot];
+        sortedWorlds[newSlots[slot]] = worlds[slot];
+        sortedHandles[newSlots[slot]] = handles[slot];
+    }
+    dirty.swap(sortedDirty);
+    worlds.swap(sortedWorlds);
+    handles.swap(sortedHandles);
+    for (unsigned int slot = 0; slot < count; slot++)
+        slots[handles[slot]] = slot;
+    for (unsigned int slot = 0; slot < count; slot++)
+    {
+        int parent = parentHandles[handles[slot]];
+        parentSlots[slot] = parent >= 0 ? (int)slots[parent] : -1;
+    }
+}
+
+void TransformStore::composeLevel(size_t first, size_t last, unsigned int threads)
+{
+    TransformKernels::Arrays arrays = { { positionX.data(), positionY.data(), positionZ.data() },
+        { rotationX.data(), rotationY.data(), rotationZ.data(), rotationW.data() }, { scaleX.data(), scaleY.data(), scaleZ.data() },
+        parentSlots.data(), dirty.data(), &worlds.data()[0][0][0] };
+    void (*compose)(const TransformKernels::Arrays&, size_t, size_t) = UpdatePath == Path::Avx2 ? TransformKernels::ComposeAvx2
+        : UpdatePath == Path::Sse ? TransformKernels::ComposeSse : TransformKernels::ComposeScalar;
+    if (threads <= 1 || last - first < MIN_PARALLEL_LEVEL)
+    {
+        compose(arrays, first, last);
+        return;
+    }
+
+    // chunks of whole 8-node batches, a few per thread so they even out
+    size_t chunkSize = ((last - first) / (threads * 4) + 7) & ~(size_t)7;
+    size_t chunkCount = (last - first + chunkSize - 1) / chunkSize;
+    std::atomic<size_t> nextChunk(0);
+    auto work = [&]()
+    {
+        for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+            compose(arrays, first + chunk * chunkSize, std::min(last, first + (chunk + 1) * chunkSize));
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < threads; i++)
+        workers.emplace_back(work);
+    work();
+    for (std::thread& worker : workers)
+        worker.join();
+}
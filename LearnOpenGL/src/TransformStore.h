@@ -0,0 +1,84 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include "AlignedAllocator.h"
+#include "AlignedMath.h"
+
+// Translation, rotation and scale of many scene nodes with an optional parent each, stored as a structure of aligned
+// arrays. slots are kept sorted by depth in the hierarchy, so parents come before their children and every level is
+// a contiguous range; Update() composes the world matrices of changed nodes and their descendants level by level,
+// eight nodes at a time with AVX2 where the CPU has it. nodes are named by handles, which stay the same when the
+// slots are re-sorted after the hierarchy changes.
+class TransformStore
+{
+public:
+    // the instruction set Update() uses, the best one the CPU has unless changed
+    enum class Path
+    {
+        Scalar,
+        Sse,
+        Avx2
+    };
+
+    // levels smaller than this are composed on the calling thread even when Update() is given more threads
+    static const unsigned int MIN_PARALLEL_LEVEL = 16384;
+
+    TransformStore();
+
+    // adds a node at the origin with no rotation and unit scale, returns its handle
+    unsigned int Create(int parent = -1);
+    // reparents handle, -1 makes it a root. false, changing nothing, when parent is handle or below it
+    bool SetParent(unsigned int handle, int parent);
+    int GetParent(unsigned int handle) const { return parentHandles[handle]; }
+
+    // rotations are expected to be unit quaternions
+    void SetLocal(unsigned int handle, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+    void SetPosition(unsigned int handle, const glm::vec3& position);
+    void SetRotation(unsigned int handle, const glm::quat& rotation);
+    void SetScale(unsigned int handle, const glm::vec3& scale);
+    glm::vec3 GetPosition(unsigned int handle) const;
+    glm::quat GetRotation(unsigned int handle) const;
+    glm::vec3 GetScale(unsigned int handle) const;
+
+    // recomputes the world matrices of the nodes changed since the last call and of their descendants. threads
+    // above 1 split large levels between that many threads
+    void Update(unsigned int threads = 1);
+    // as of the last Update()
+    const AlignedMat4& GetWorld(unsigned int handle) const { return worlds[slots[handle]]; }
+
+    size_t GetCount() const { return handles.size(); }
+    size_t GetLevelCount() const { return levelStarts.size() - 1; }
+
+    Path UpdatePath;
+    // of the last Update()
+    double UpdateSeconds = 0.0;
+    unsigned int Composed = 0;
+
+private:
+    // by slot, padded so the AVX2 loads of the last nodes stay inside
+    AlignedVector<float> positionX, positionY, positionZ;
+    AlignedVector<float> rotationX, rotationY, rotationZ, rotationW;
+    AlignedVector<float> scaleX, scaleY, scaleZ;
+    AlignedVector<unsigned char> dirty;
+    std::vector<int> parentSlots;
+    AlignedVector<AlignedMat4> worlds;
+    // handle to slot and back
+    std::vector<unsigned int> slots;
+    std::vector<unsigned int> handles;
+    // by handle, the hierarchy the slots are sorted from
+    std::vector<int> parentHandles;
+    // first slot of every level, then the slot count
+    std::vector<unsigned int> levelStarts;
+    // the slots need sorting before the next Update()
+    bool orderChanged = false;
+    // a node was set since the last Update(), which has nothing to do otherwise
+    bool anyDirty = false;
+
+    void resizeArrays(size_t count);
+    // sorts the slots by depth, stable within a level
+    void sortSlots();
+    void composeLevel(size_t first, size_t last, unsigned int threads);
+};
@@ -0,0 +1,402 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "Transforms.h"
+#include "../Shader.h"
+#include "../GLExtensions.h"
+#include "../Camera.h"
+#include "../CpuFeatures.h"
+#include "../RenderStats.h"
+#include "../TransformStore.h"
+#include "../VertexFormat.h"
+
+namespace Transforms
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // the startup benchmark: BENCHMARK_ROOTS roots with BENCHMARK_CHILDREN children with BENCHMARK_GRANDCHILDREN
+    // children each, about a million nodes, all rotated every frame
+    const unsigned int BENCHMARK_ROOTS = 10000;
+    const unsigned int BENCHMARK_CHILDREN = 10;
+    const unsigned int BENCHMARK_GRANDCHILDREN = 9;
+    const unsigned int BENCHMARK_FRAMES = 10;
+
+    // the scene: towers on a grid, each with arms made of chained segments that every bend a little
+    const int TOWERS_X = 8;
+    const int TOWERS_Z = 8;
+    const unsigned int ARMS = 6;
+    const unsigned int SEGMENTS = 8;
+
+    const char* PATH_NAMES[] = { "scalar", "sse", "avx2" };
+    // switched with the 1/2/3 keys, threads toggled with T
+    TransformStore::Path path = TransformStore::Path::Avx2;
+    bool threaded = false;
+    bool threadKeyDown = false;
+
+    // camera
+    Camera camera(glm::vec3(0.0f, 12.0f, 45.0f));
+
+    bool firstMouse = true;
+    float mouseLastX = SCR_WIDTH / 2.0;
+    float mouseLastY = SCR_HEIGHT / 2.0;
+
+    // timing
+    float deltaTime = 0.0f;	// Time between current frame and last frame
+    float lastFrame = 0.0f;
+
+    unsigned int hardwareThreads()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // world matrix updates per second of every path, against composing the same tree with plain glm calls
+    void runBenchmark()
+    {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        TransformStore store;
+        std::vector<int> parents;
+        for (unsigned int root = 0; root < BENCHMARK_ROOTS; root++)
+        {
+            unsigned int rootHandle = store.Create();
+            parents.push_back(-1);
+            for (unsigned int child = 0; child < BENCHMARK_CHILDREN; child++)
+            {
+                unsigned int childHandle = store.Create(rootHandle);
+                parents.push_back(rootHandle);
+                for (unsigned int grandchild = 0; grandchild < BENCHMARK_GRANDCHILDREN; grandchild++)
+                {
+                    store.Create(childHandle);
+                    parents.push_back(childHandle);
+                }
+            }
+        }
+        unsigned int count = (unsigned int)store.GetCount();
+        std::vector<glm::vec3> positions(count), scales(count), axes(count);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            positions[i] = glm::vec3(unit(random), unit(random), unit(random)) * 3.0f;
+            scales[i] = glm::vec3(0.75f + 0.25f * unit(random));
+            axes[i] = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 2.0f));
+            store.SetPosition(i, positions[i]);
+            store.SetScale(i, scales[i]);
+        }
+        auto rotate = [&](unsigned int frame)
+        {
+            for (unsigned int i = 0; i < count; i++)
+                store.SetRotation(i, glm::angleAxis(0.01f * frame + 0.001f * i, axes[i]));
+        };
+
+        // the way the Sandbox built its matrices, translate then rotate then scale, parents created before children
+        std::vector<glm::mat4> reference(count);
+        double glmSeconds = 0.0;
+        for (unsigned int frame = 0; frame < BENCHMARK_FRAMES; frame++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (unsigned int i = 0; i < count; i++)
+            {
+                glm::mat4 local = glm::translate(glm::mat4(1.0f), positions[i]);
+                local = glm::rotate(local, 0.01f * frame + 0.001f * i, axes[i]);
+                local = glm::scale(local, scales[i]);
+                reference[i] = parents[i] >= 0 ? reference[parents[i]] * local : local;
+            }
+            glmSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        printf("%u transforms in 3 levels, %u threads\n", count, hardwareThreads());
+        printf("  glm     %7.2f ms per update, %6.1f M matrices/s\n", glmSeconds * 1000.0 / BENCHMARK_FRAMES, count * BENCHMARK_FRAMES / glmSeconds / 1e6);
+
+        const CpuFeatures& cpu = CpuFeatures::Get();
+        for (int p = 0; p < 3; p++)
+        {
+            if ((TransformStore::Path)p == TransformStore::Path::Avx2 && !(cpu.Avx2 && cpu.Fma))
+                continue;
+            for (unsigned int threads : { 1u, hardwareThreads() })
+            {
+                store.UpdatePath = (TransformStore::Path)p;
+                double seconds = 0.0;
+                for (unsigned int frame = 0; frame < BENCHMARK_FRAMES; frame++)
+                {
+                    rotate(frame);
+                    store.Update(threads);
+                    seconds += store.UpdateSeconds;
+                }
+                // against the last glm frame
+                float maxError = 0.0f;
+                for (unsigned int i = 0; i < count; i++)
+                    for (int column = 0; column < 4; column++)
+                    {
+                        glm::vec4 difference = glm::abs(glm::vec4(store.GetWorld(i)[column]) - reference[i][column]) / (glm::abs(reference[i][column]) + 1.0f);
+                        maxError = std::max(maxError, std::max(std::max(difference.x, difference.y), std::max(difference.z, difference.w)));
+                    }
+                printf("  %-6s  %7.2f ms per update, %6.1f M matrices/s with %u threads, largest relative difference to glm %.1e\n", PATH_NAMES[p],
+                    seconds * 1000.0 / BENCHMARK_FRAMES, count * BENCHMARK_FRAMES / seconds / 1e6, threads, maxError);
+                if (hardwareThreads() == 1)
+                    break;
+            }
+        }
+    }
+
+    int Main()
+    {
+        runBenchmark();
+
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        glfwSetCursorPosCallback(window, mouse_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        Shader shader("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs");
+
+        // a unit cube with face normals
+        std::vector<float> vertices;
+        for (int face = 0; face < 6; face++)
+        {
+            int axis = face / 2;
+            float sign = (face % 2) ? -1.0f : 1.0f;
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = sign;
+            u[(axis + 1) % 3] = sign;
+            v[(axis + 2) % 3] = 1.0f;
+            const float corners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+            for (const float* corner : corners)
+            {
+                glm::vec3 position = normal * 0.5f + u * (corner[0] - 0.5f) + v * (corner[1] - 0.5f);
+                vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z, corner[0], corner[1] });
+            }
+        }
+        VertexFormat format;
+        format.Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+        unsigned int VAO, VBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        format.Apply();
+
+        unsigned int whiteTexture;
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        shader.use();
+        shader.setInt("baseColor", 0);
+        shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+
+        // towers spin about y, their arms hang off them and every segment bends relative to the previous one
+        TransformStore transforms;
+        std::vector<unsigned int> towers, segments;
+        std::vector<glm::vec4> segmentColors;
+        for (int x = 0; x < TOWERS_X; x++)
+            for (int z = 0; z < TOWERS_Z; z++)
+            {
+                unsigned int tower = transforms.Create();
+                transforms.SetLocal(tower, glm::vec3((x - (TOWERS_X - 1) * 0.5f) * 10.0f, 0.0f, (z - (TOWERS_Z - 1) * 0.5f) * 10.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                    glm::vec3(1.0f, 4.0f, 1.0f));
+                towers.push_back(tower);
+                for (unsigned int arm = 0; arm < ARMS; arm++)
+                {
+                    int parent = (int)tower;
+                    for (unsigned int segment = 0; segment < SEGMENTS; segment++)
+                    {
+                        unsigned int node = transforms.Create(parent);
+                        if (segment == 0)
+                        {
+                            // undo the tower's scale and start at its top, pointing outwards
+                            float angle = glm::two_pi<float>() * arm / ARMS;
+                            transforms.SetPosition(node, glm::vec3(0.0f, 0.45f, 0.0f));
+                            transforms.SetScale(node, glm::vec3(1.0f, 0.25f, 1.0f));
+                            transforms.SetRotation(node, glm::angleAxis(angle, glm::vec3(0.0f, 1.0f, 0.0f)));
+                        }
+                        else
+                            transforms.SetPosition(node, glm::vec3(0.6f, 0.0f, 0.0f));
+                        segments.push_back(node);
+                        segmentColors.push_back(glm::mix(glm::vec4(0.9f, 0.6f, 0.2f, 1.0f), glm::vec4(0.2f, 0.6f, 0.9f, 1.0f), (float)segment / (SEGMENTS - 1)));
+                        parent = (int)node;
+                    }
+                }
+            }
+        std::vector<unsigned int> drawOrder(towers);
+        drawOrder.insert(drawOrder.end(), segments.begin(), segments.end());
+        std::vector<glm::vec4> drawColors(towers.size(), glm::vec4(0.5f, 0.5f, 0.55f, 1.0f));
+        drawColors.insert(drawColors.end(), segmentColors.begin(), segmentColors.end());
+
+        // render loop
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        double reportUpdateSeconds = 0.0;
+        while (!glfwWindowShouldClose(window))
+        {
+            // per-frame time logic
+            float currentFrame = static_cast<float>(glfwGetTime());
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            processInput(window);
+
+            for (size_t i = 0; i < towers.size(); i++)
+                transforms.SetRotation(towers[i], glm::angleAxis(currentFrame * (0.3f + 0.05f * (i % 7)), glm::vec3(0.0f, 1.0f, 0.0f)));
+            for (size_t i = 0; i < segments.size(); i++)
+            {
+                unsigned int segment = (unsigned int)(i % SEGMENTS);
+                if (segment == 0)
+                    continue;
+                float bend = 0.35f * glm::sin(currentFrame * 1.5f + segment * 0.7f + (float)(i / SEGMENTS));
+                transforms.SetRotation(segments[i], glm::angleAxis(bend, glm::vec3(0.0f, 0.0f, 1.0f)));
+            }
+            transforms.UpdatePath = path;
+            transforms.Update(threaded ? hardwareThreads() : 1);
+            reportUpdateSeconds += transforms.UpdateSeconds;
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            shader.setMat4("projection", glm::perspective(glm::radians(camera.Zoom), (float)width / (float)std::max(height, 1), 0.1f, 300.0f));
+            shader.setMat4("view", camera.GetViewMatrix());
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            glBindVertexArray(VAO);
+            for (size_t i = 0; i < drawOrder.size(); i++)
+            {
+                shader.setMat4("model", transforms.GetWorld(drawOrder[i]));
+                shader.setVec4("baseColorFactor", drawColors[i]);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += 12;
+            }
+
+            RenderStats::EndFrame();
+            reportFrames++;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0)
+            {
+                printf("%-6s %s %zu transforms in %zu levels, update %6.3f ms, frame %6.3f ms\n", PATH_NAMES[(int)path], threaded ? "threaded" : "1 thread",
+                    transforms.GetCount(), transforms.GetLevelCount(), reportUpdateSeconds * 1000.0 / reportFrames, (now - reportStart) * 1000.0 / reportFrames);
+                reportStart = now;
+                reportFrames = 0;
+                reportUpdateSeconds = 0.0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures(1, &whiteTexture);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        const CpuFeatures& cpu = CpuFeatures::Get();
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            path = TransformStore::Path::Scalar;
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+            path = TransformStore::Path::Sse;
+        if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS && cpu.Avx2 && cpu.Fma)
+            path = TransformStore::Path::Avx2;
+        bool threadKey = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+        if (threadKey && !threadKeyDown)
+            threaded = !threaded;
+        threadKeyDown = threadKey;
+
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            camera.ProcessKeyboard(FORWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            camera.ProcessKeyboard(BACKWARD, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            camera.ProcessKeyboard(LEFT, deltaTime);
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            camera.ProcessKeyboard(RIGHT, deltaTime);
+    }
+
+    void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+    {
+        if (firstMouse)
+        {
+            mouseLastX = xpos;
+            mouseLastY = ypos;
+            firstMouse = false;
+        }
+
+        float xoffset = xpos - mouseLastX;
+        float yoffset = mouseLastY - ypos; // reversed since y-coordinates range from bottom to top
+
+        mouseLastX = xpos;
+        mouseLastY = ypos;
+
+        camera.ProcessMouseMovement(xoffset, yoffset);
+    }
+}
@@ -0,0 +1,4 @@
+namespace Transforms
+{
+    int Main();
+};
\ No newline at end of file
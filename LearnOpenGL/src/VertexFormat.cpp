@@ -0,0 +1,258 @@
+#include "VertexFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    struct FormatInfo
+    {
+        GLint Components;           // what the shader sees
+        GLenum Type;
+        GLboolean Normalized;
+        unsigned int Size;          // bytes in the buffer with padding
+        unsigned int Source;        // floats Encode() reads
+    };
+
+    // indexed by AttributeFormat
+    const FormatInfo FORMATS[] = {
+        { 1, GL_FLOAT, GL_FALSE, 4, 1 },                    // Float1
+        { 2, GL_FLOAT, GL_FALSE, 8, 2 },                    // Float2
+        { 3, GL_FLOAT, GL_FALSE, 12, 3 },                   // Float3
+        { 4, GL_FLOAT, GL_FALSE, 16, 4 },                   // Float4
+        { 2, GL_HALF_FLOAT, GL_FALSE, 4, 2 },               // Half2
+        { 3, GL_HALF_FLOAT, GL_FALSE, 8, 3 },               // Half3
+        { 2, GL_UNSIGNED_SHORT, GL_TRUE, 4, 2 },            // Unorm16x2
+        { 3, GL_UNSIGNED_SHORT, GL_TRUE, 8, 3 },            // Unorm16x3
+        { 2, GL_SHORT, GL_TRUE, 4, 2 },                     // Snorm16x2
+        { 3, GL_UNSIGNED_BYTE, GL_TRUE, 4, 3 },             // Unorm8x3
+        { 4, GL_UNSIGNED_BYTE, GL_TRUE, 4, 4 },             // Unorm8x4
+        // the packed type only exists with 4 components, the shader uses x and y
+        { 4, GL_INT_2_10_10_10_REV, GL_TRUE, 4, 3 }         // Octahedral10
+    };
+
+    const FormatInfo& info(AttributeFormat format)
+    {
+        return FORMATS[(int)format];
+    }
+
+    // the components of value converted by encode, the padding up to size zeroed
+    template<typename T, typename F>
+    void writeComponents(unsigned char* out, const glm::vec4& value, const FormatInfo& format, F encode)
+    {
+        T components[4] = {};
+        for (int c = 0; c < format.Components; c++)
+            components[c] = encode(value[c]);
+        memcpy(out, components, format.Size);
+    }
+
+    // signed 10 bit normalized, decoded as max(c / 511, -1)
+    int toSnorm10(float value)
+    {
+        return (int)std::round(std::min(std::max(value, -1.0f), 1.0f) * 511.0f);
+    }
+
+    float signNotZero(float value)
+    {
+        return value >= 0.0f ? 1.0f : -1.0f;
+    }
+}
+
+PositionQuantization PositionQuantization::FromBounds(const glm::vec3& min, const glm::vec3& max)
+{
+    PositionQuantization quantization;
+    quantization.Offset = min;
+    for (int axis = 0; axis < 3; axis++)
+        quantization.Scale[axis] = max[axis] > min[axis] ? max[axis] - min[axis] : 1.0f;
+    return quantization;
+}
+
+VertexFormat& VertexFormat::Add(GLuint location, AttributeFormat format)
+{
+    VertexAttribute attribute;
+    attribute.Location = location;
+    attribute.Format = format;
+    attribute.Offset = stride;
+    attributes.push_back(attribute);
+    // every size is a multiple of 4, so the next attribute stays aligned
+    stride += Size(format);
+    return *this;
+}
+
+void VertexFormat::Apply(size_t offset) const
+{
+    for (const VertexAttribute& attribute : attributes)
+    {
+        const FormatInfo& format = info(attribute.Format);
+        glVertexAttribPointer(attribute.Location, format.Components, format.Type, format.Normalized, stride, (void*)(offset + attribute.Offset));
+        glEnableVertexAttribArray(attribute.Location);
+    }
+}
+
+void VertexFormat::Write(unsigned char* vertex, size_t attribute, const glm::vec4& value) const
+{
+    const VertexAttribute& target = attributes[attribute];
+    const FormatInfo& format = info(target.Format);
+    unsigned char* out = vertex + target.Offset;
+    switch (target.Format)
+    {
+    case AttributeFormat::Float1:
+    case AttributeFormat::Float2:
+    case AttributeFormat::Float3:
+    case AttributeFormat::Float4:
+        memcpy(out, &value[0], format.Size);
+        break;
+    case AttributeFormat::Half2:
+    case AttributeFormat::Half3:
+        writeComponents<uint16_t>(out, value, format, VertexEncoding::FloatToHalf);
+        break;
+    case AttributeFormat::Unorm16x2:
+    case AttributeFormat::Unorm16x3:
+        writeComponents<uint16_t>(out, value, format, VertexEncoding::ToUnorm16);
+        break;
+    case AttributeFormat::Snorm16x2:
+        writeComponents<int16_t>(out, value, format, VertexEncoding::ToSnorm16);
+        break;
+    case AttributeFormat::Unorm8x3:
+    case AttributeFormat::Unorm8x4:
+        writeComponents<uint8_t>(out, value, format, VertexEncoding::ToUnorm8);
+        break;
+    case AttributeFormat::Octahedral10:
+    {
+        uint32_t packed = VertexEncoding::PackOctahedral(glm::vec3(value));
+        memcpy(out, &packed, sizeof(packed));
+        break;
+    }
+    }
+}
+
+std::vector<unsigned char> VertexFormat::Encode(const float* source, size_t count) const
+{
+    std::vector<unsigned char> data(count * stride);
+    for (size_t v = 0; v < count; v++)
+    {
+        for (size_t a = 0; a < attributes.size(); a++)
+        {
+            glm::vec4 value(0.0f);
+            unsigned int components = info(attributes[a].Format).Source;
+            for (unsigned int c = 0; c < components; c++)
+                value[c] = *source++;
+            Write(&data[v * stride], a, value);
+        }
+    }
+    return data;
+}
+
+unsigned int VertexFormat::SourceComponents() const
+{
+    unsigned int components = 0;
+    for (const VertexAttribute& attribute : attributes)
+        components += info(attribute.Format).Source;
+    return components;
+}
+
+unsigned int VertexFormat::Size(AttributeFormat format)
+{
+    return info(format).Size;
+}
+
+unsigned int VertexFormat::Components(AttributeFormat format)
+{
+    return info(format).Components;
+}
+
+namespace VertexEncoding
+{
+    uint16_t FloatToHalf(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        uint32_t sign = (bits >> 16) & 0x8000;
+        uint32_t magnitude = bits & 0x7fffffff;
+        // infinity and NaN, NaN keeps a mantissa bit
+        if (magnitude >= 0x7f800000)
+            return (uint16_t)(sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0));
+        // 65520 and up round past the largest half (65504)
+        if (magnitude >= 0x477ff000)
+            return (uint16_t)(sign | 0x7c00);
+        // below the smallest normal half (2^-14) the result is denormal, up to 2^-25 it rounds to zero
+        if (magnitude < 0x38800000)
+        {
+            if (magnitude <= 0x33000000)
+                return (uint16_t)sign;
+            uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+            uint32_t shift = 126 - (magnitude >> 23);
+            uint32_t half = mantissa >> shift;
+            uint32_t rest = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+            if (rest > halfway || (rest == halfway && (half & 1)))
+                half++;
+            return (uint16_t)(sign | half);
+        }
+        // rebias the exponent from 127 to 15 and round the 13 dropped mantissa bits to nearest even,
+        // a carry out of the mantissa correctly bumps the exponent
+        uint32_t half = (magnitude - 0x38000000) >> 13;
+        uint32_t rest = magnitude & 0x1fff;
+        if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+            half++;
+        return (uint16_t)(sign | half);
+    }
+
+    float HalfToFloat(uint16_t half)
+    {
+        uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+        uint32_t exponent = (half >> 10) & 0x1f;
+        uint32_t mantissa = half & 0x3ff;
+        if (exponent == 0)
+        {
+            float value = std::ldexp((float)mantissa, -24);
+            return sign ? -value : value;
+        }
+        uint32_t bits = exponent == 31 ? sign | 0x7f800000 | (mantissa << 13) : sign | ((exponent + 112) << 23) | (mantissa << 13);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    uint16_t ToUnorm16(float value)
+    {
+        return (uint16_t)std::round(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f);
+    }
+
+    int16_t ToSnorm16(float value)
+    {
+        return (int16_t)std::round(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f);
+    }
+
+    uint8_t ToUnorm8(float value)
+    {
+        return (uint8_t)std::round(std::min(std::max(value, 0.0f), 1.0f) * 255.0f);
+    }
+
+    uint32_t PackOctahedral(const glm::vec3& n)
+    {
+        float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if (sum == 0.0f)
+            return 0;
+        // project onto the octahedron, the lower half is folded over the diagonals
+        float x = n.x / sum, y = n.y / sum;
+        if (n.z < 0.0f)
+        {
+            float foldedX = (1.0f - std::abs(y)) * signNotZero(x);
+            y = (1.0f - std::abs(x)) * signNotZero(y);
+            x = foldedX;
+        }
+        return (uint32_t)(toSnorm10(x) & 0x3ff) | (uint32_t)(toSnorm10(y) & 0x3ff) << 10;
+    }
+
+    glm::vec3 UnpackOctahedral(uint32_t packed)
+    {
+        // sign extend the 10 bit fields
+        int ix = (int)(packed << 22) >> 22, iy = (int)(packed << 12) >> 22;
+        float x = std::max(ix / 511.0f, -1.0f), y = std::max(iy / 511.0f, -1.0f);
+        glm::vec3 n(x, y, 1.0f - std::abs(x) - std::abs(y));
+        float t = std::max(-n.z, 0.0f);
+        n.x += n.x >= 0.0f ? -t : t;
+        n.y += n.y >= 0.0f ? -t : t;
+        return glm::normalize(n);
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// How one vertex attribute is stored in the buffer. the shader always reads floats: the normalized integer
+// formats arrive in [0, 1] or [-1, 1], half floats are widened by the vertex fetch.
+enum class AttributeFormat
+{
+    Float1,
+    Float2,
+    Float3,
+    Float4,
+    Half2,          // uvs outside [0, 1]
+    Half3,          // padded to 8 bytes
+    Unorm16x2,      // uvs in [0, 1], e.g. atlas regions
+    Unorm16x3,      // positions normalized with PositionQuantization, padded to 8 bytes
+    Snorm16x2,
+    Unorm8x3,       // rgb colors, padded to 4 bytes
+    Unorm8x4,       // rgba colors
+    Octahedral10    // unit vectors folded onto the octahedron, x and y of a signed 10:10:10:2 word, see VertexDecode.glsl
+};
+
+struct VertexAttribute
+{
+    GLuint Location = 0;
+    AttributeFormat Format = AttributeFormat::Float3;
+    unsigned int Offset = 0;
+};
+
+// Maps positions into [0, 1] for the Unorm16x3 format and back. the shader decodes with
+// position * Scale + Offset (the positionScale and positionOffset uniforms of VertexDecode.glsl)
+struct PositionQuantization
+{
+    glm::vec3 Offset = glm::vec3(0.0f);
+    glm::vec3 Scale = glm::vec3(1.0f);
+
+    // a quantization covering the axis aligned box, flat axes keep a scale of 1 so nothing divides by zero
+    static PositionQuantization FromBounds(const glm::vec3& min, const glm::vec3& max);
+    glm::vec3 Normalize(const glm::vec3& position) const { return (position - Offset) / Scale; }
+    glm::vec3 Denormalize(const glm::vec3& normalized) const { return normalized * Scale + Offset; }
+};
+
+// Declarative interleaved vertex layout: attributes are listed once, offsets and the stride follow from their
+// formats and Apply() issues the matching glVertexAttribPointer calls. Write()/Encode() convert float data into
+// the formats so a layout can be switched from full floats to quantized without touching the setup code.
+class VertexFormat
+{
+public:
+    // appends an attribute after the previous one, every attribute starts 4 byte aligned
+    VertexFormat& Add(GLuint location, AttributeFormat format);
+
+    unsigned int Stride() const { return stride; }
+    const std::vector<VertexAttribute>& Attributes() const { return attributes; }
+
+    // points and enables every attribute on the bound vertex array and GL_ARRAY_BUFFER, vertices starting at offset
+    void Apply(size_t offset = 0) const;
+    // encodes value into the attribute'th attribute of vertex, components the format does not store are dropped
+    void Write(unsigned char* vertex, size_t attribute, const glm::vec4& value) const;
+    // interleaves count vertices of tightly packed floats (every attribute's components in a row, three for
+    // Octahedral10) into the layout
+    std::vector<unsigned char> Encode(const float* source, size_t count) const;
+
+    // floats Encode() reads per vertex
+    unsigned int SourceComponents() const;
+    // bytes of a format in the buffer, including its padding
+    static unsigned int Size(AttributeFormat format);
+    // components of a format the shader sees
+    static unsigned int Components(AttributeFormat format);
+
+private:
+    std::vector<VertexAttribute> attributes;
+    unsigned int stride = 0;
+};
+
+// the encodings behind VertexFormat::Write, usable on their own
+namespace VertexEncoding
+{
+    // round to nearest even, overflows to infinity and keeps denormals
+    uint16_t FloatToHalf(float value);
+    float HalfToFloat(uint16_t half);
+    uint16_t ToUnorm16(float value);
+    int16_t ToSnorm16(float value);
+    uint8_t ToUnorm8(float value);
+    // the unit vector n as an octahedral x, y in the low 20 bits of a GL_INT_2_10_10_10_REV word
+    uint32_t PackOctahedral(const glm::vec3& n);
+    // the exact inverse of what the shader computes, for error measurements
+    glm::vec3 UnpackOctahedral(uint32_t packed);
+}
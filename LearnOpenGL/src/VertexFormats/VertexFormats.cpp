@@ -0,0 +1,337 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "VertexFormats.h"
+#include "../ShaderPermutations.h"
+#include "../GLExtensions.h"
+#include "../RenderStats.h"
+#include "../VertexFormat.h"
+
+namespace VertexFormats
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // one height field of GRID x GRID vertices drawn TILES x TILES times, enough vertices that fetching them dominates
+    const int GRID = 1024;
+    const int TILES = 4;
+    const float TILE_SIZE = 10.0f;
+
+    // the same mesh stored two ways, switched with the 1/2 keys
+    enum Layout
+    {
+        FLOATS,     // position, normal and uv as 32 bit floats
+        QUANTIZED   // unorm16 position, octahedral normal, half float uv
+    };
+    const char* LAYOUT_NAMES[] = { "float", "quantized" };
+    Layout layout = FLOATS;
+
+    // the camera orbits by a fixed step per frame so both layouts render the same frames
+    const float SCRIPT_STEP = 1.0f / 60.0f;
+
+    struct SourceVertex
+    {
+        glm::vec3 Position;
+        glm::vec3 Normal;
+        glm::vec2 TexCoord;
+    };
+
+    // a wavy height field with analytic normals and uvs tiling 4 times
+    void buildHeightField(std::vector<SourceVertex>& vertices, std::vector<unsigned int>& indices)
+    {
+        vertices.resize((size_t)GRID * GRID);
+        for (int y = 0; y < GRID; y++)
+            for (int x = 0; x < GRID; x++)
+            {
+                float u = (float)x / (GRID - 1), v = (float)y / (GRID - 1);
+                float px = (u - 0.5f) * TILE_SIZE, pz = (v - 0.5f) * TILE_SIZE;
+                SourceVertex& vertex = vertices[(size_t)y * GRID + x];
+                vertex.Position = glm::vec3(px, 0.5f * sin(px * 2.0f) * cos(pz * 1.3f), pz);
+                // derivative of the height for the normal
+                float dx = cos(px * 2.0f) * cos(pz * 1.3f);
+                float dz = -0.65f * sin(px * 2.0f) * sin(pz * 1.3f);
+                vertex.Normal = glm::normalize(glm::vec3(-dx, 1.0f, -dz));
+                vertex.TexCoord = glm::vec2(u, v) * 4.0f;
+            }
+        indices.clear();
+        indices.reserve((size_t)(GRID - 1) * (GRID - 1) * 6);
+        for (int y = 0; y + 1 < GRID; y++)
+            for (int x = 0; x + 1 < GRID; x++)
+            {
+                unsigned int i = y * GRID + x;
+                indices.insert(indices.end(), { i, i + GRID, i + 1, i + 1, i + GRID, i + GRID + 1 });
+            }
+    }
+
+    // vertex array over the mesh encoded in format, the index buffer is shared
+    unsigned int createVertexArray(const VertexFormat& format, const std::vector<unsigned char>& data, unsigned int EBO, unsigned int& VBO)
+    {
+        unsigned int VAO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, data.size(), data.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        format.Apply();
+        glBindVertexArray(0);
+        return VAO;
+    }
+
+    int Main()
+    {
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        ShaderPermutations shaders("shaders/VertexShaders/Model.vs", "shaders/FragmentShaders/Model.fs", { "QUANTIZED" });
+        const unsigned int QUANTIZED_MASK = shaders.Mask("QUANTIZED");
+        shaders.Precompile({ 0, QUANTIZED_MASK });
+
+        std::vector<SourceVertex> vertices;
+        std::vector<unsigned int> indices;
+        buildHeightField(vertices, indices);
+
+        VertexFormat formats[2];
+        formats[FLOATS].Add(0, AttributeFormat::Float3).Add(1, AttributeFormat::Float3).Add(2, AttributeFormat::Float2);
+        formats[QUANTIZED].Add(0, AttributeFormat::Unorm16x3).Add(1, AttributeFormat::Octahedral10).Add(2, AttributeFormat::Half2);
+
+        glm::vec3 boundsMin(vertices[0].Position), boundsMax(vertices[0].Position);
+        for (const SourceVertex& vertex : vertices)
+        {
+            boundsMin = glm::min(boundsMin, vertex.Position);
+            boundsMax = glm::max(boundsMax, vertex.Position);
+        }
+        PositionQuantization quantization = PositionQuantization::FromBounds(boundsMin, boundsMax);
+
+        // encode both layouts, the float one is a straight copy through the same path
+        std::vector<unsigned char> data[2];
+        for (int l = 0; l < 2; l++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            const VertexFormat& format = formats[l];
+            data[l].resize(vertices.size() * format.Stride());
+            for (size_t v = 0; v < vertices.size(); v++)
+            {
+                unsigned char* out = &data[l][v * format.Stride()];
+                const SourceVertex& vertex = vertices[v];
+                format.Write(out, 0, glm::vec4(l == QUANTIZED ? quantization.Normalize(vertex.Position) : vertex.Position, 0.0f));
+                format.Write(out, 1, glm::vec4(vertex.Normal, 0.0f));
+                format.Write(out, 2, glm::vec4(vertex.TexCoord, 0.0f, 0.0f));
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printf("%-10s %2u bytes/vertex, %7.2f MB of vertices, encoded in %7.2f ms (%6.1f M vertices/s)\n", LAYOUT_NAMES[l],
+                format.Stride(), data[l].size() / (1024.0 * 1024.0), seconds * 1000.0, vertices.size() / seconds / 1e6);
+        }
+
+        // what the quantization costs, measured by decoding like the shader does
+        float positionError = 0.0f, normalError = 0.0f, uvError = 0.0f;
+        const std::vector<VertexAttribute>& attributes = formats[QUANTIZED].Attributes();
+        for (size_t v = 0; v < vertices.size(); v++)
+        {
+            const unsigned char* in = &data[QUANTIZED][v * formats[QUANTIZED].Stride()];
+            uint16_t position[3], uv[2];
+            uint32_t normal;
+            memcpy(position, in + attributes[0].Offset, sizeof(position));
+            memcpy(&normal, in + attributes[1].Offset, sizeof(normal));
+            memcpy(uv, in + attributes[2].Offset, sizeof(uv));
+            glm::vec3 decoded = quantization.Denormalize(glm::vec3(position[0], position[1], position[2]) / 65535.0f);
+            positionError = std::max(positionError, glm::length(decoded - vertices[v].Position));
+            float cosine = glm::clamp(glm::dot(VertexEncoding::UnpackOctahedral(normal), vertices[v].Normal), -1.0f, 1.0f);
+            normalError = std::max(normalError, glm::degrees(std::acos(cosine)));
+            glm::vec2 decodedUv(VertexEncoding::HalfToFloat(uv[0]), VertexEncoding::HalfToFloat(uv[1]));
+            uvError = std::max(uvError, glm::length(decodedUv - vertices[v].TexCoord));
+        }
+        printf("quantization error: position %.5f units (%.5f of the extent), normal %.3f degrees, uv %.5f\n",
+            positionError, positionError / glm::length(boundsMax - boundsMin), normalError, uvError);
+
+        unsigned int EBO;
+        glGenBuffers(1, &EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        unsigned int VBOs[2], VAOs[2];
+        for (int l = 0; l < 2; l++)
+            VAOs[l] = createVertexArray(formats[l], data[l], EBO, VBOs[l]);
+
+        // untextured, the materials only tint a white texel
+        unsigned int whiteTexture;
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, &whiteTexture);
+        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        shaders.ForEachBuilt([&](Shader& shader)
+        {
+            shader.use();
+            shader.setInt("baseColor", 0);
+            shader.setVec3("lightDirection", glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f)));
+        });
+        Shader& quantizedShader = shaders.Get(QUANTIZED_MASK);
+        quantizedShader.use();
+        quantizedShader.setVec3("positionScale", quantization.Scale);
+        quantizedShader.setVec3("positionOffset", quantization.Offset);
+
+        // GPU time of the draws, read a frame late so waiting for the result does not stall the pipeline
+        unsigned int queries[2];
+        glGenQueries(2, queries);
+        bool queryPending[2] = { false, false };
+        int frameIndex = 0;
+
+        // render loop
+        float scriptTime = 0.0f;
+        double reportStart = glfwGetTime();
+        unsigned int reportFrames = 0;
+        unsigned int reportQueries = 0;
+        double reportGpu = 0.0;
+        Layout reportLayout = layout;
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            processInput(window);
+            // a report covers a single layout
+            if (layout != reportLayout)
+            {
+                reportStart = glfwGetTime();
+                reportFrames = 0;
+                reportQueries = 0;
+                reportGpu = 0.0;
+                reportLayout = layout;
+            }
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            int query = frameIndex % 2;
+            if (queryPending[query])
+            {
+                GLuint64 nanoseconds = 0;
+                glGetQueryObjectui64v(queries[query], GL_QUERY_RESULT, &nanoseconds);
+                reportGpu += nanoseconds * 1e-9;
+                reportQueries++;
+            }
+            glBeginQuery(GL_TIME_ELAPSED, queries[query]);
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            float radius = TILE_SIZE * TILES * 0.9f;
+            glm::vec3 eye(radius * cos(scriptTime * 0.2f), TILE_SIZE * 1.5f, radius * sin(scriptTime * 0.2f));
+            Shader& shader = shaders.Get(layout == QUANTIZED ? QUANTIZED_MASK : 0);
+            shader.use();
+            RenderStats::Frame.ProgramBinds++;
+            shader.setMat4("projection", glm::perspective(glm::radians(45.0f), (float)width / (float)std::max(height, 1), 0.1f, 500.0f));
+            shader.setMat4("view", glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, whiteTexture);
+            RenderStats::Frame.TextureBinds++;
+            glBindVertexArray(VAOs[layout]);
+            for (int tile = 0; tile < TILES * TILES; tile++)
+            {
+                glm::vec3 offset((tile % TILES - (TILES - 1) * 0.5f) * TILE_SIZE, 0.0f, (tile / TILES - (TILES - 1) * 0.5f) * TILE_SIZE);
+                shader.setMat4("model", glm::translate(glm::mat4(1.0f), offset));
+                shader.setVec4("baseColorFactor", glm::vec4(0.6f + 0.4f * (tile % 2), 0.7f, 0.6f + 0.4f * (tile / TILES % 2), 1.0f));
+                glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+                RenderStats::Frame.DrawCalls++;
+                RenderStats::Frame.Triangles += (unsigned int)(indices.size() / 3);
+            }
+            glEndQuery(GL_TIME_ELAPSED);
+            queryPending[query] = true;
+            frameIndex++;
+
+            RenderStats::EndFrame();
+            reportFrames++;
+            scriptTime += SCRIPT_STEP;
+            double now = glfwGetTime();
+            if (now - reportStart >= 1.0 && reportQueries > 0)
+            {
+                double gpu = reportGpu / reportQueries;
+                double verticesPerFrame = (double)vertices.size() * TILES * TILES;
+                printf("%-10s %2u bytes/vertex: GPU %7.3f ms/frame, %7.1f M vertices/s, %6.2f GB/s of vertex data, frame %6.3f ms\n",
+                    LAYOUT_NAMES[reportLayout], formats[reportLayout].Stride(), gpu * 1000.0, verticesPerFrame / gpu / 1e6,
+                    verticesPerFrame * formats[reportLayout].Stride() / gpu / 1e9, (now - reportStart) * 1000.0 / reportFrames);
+                reportStart = now;
+                reportFrames = 0;
+                reportQueries = 0;
+                reportGpu = 0.0;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteQueries(2, queries);
+        glDeleteVertexArrays(2, VAOs);
+        glDeleteBuffers(2, VBOs);
+        glDeleteBuffers(1, &EBO);
+        glDeleteTextures(1, &whiteTexture);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            layout = FLOATS;
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+            layout = QUANTIZED;
+    }
+}
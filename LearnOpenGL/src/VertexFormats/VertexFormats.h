@@ -0,0 +1,4 @@
+namespace VertexFormats
+{
+    int Main();
+};
\ No newline at end of file
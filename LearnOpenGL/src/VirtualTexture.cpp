@@ -0,0 +1,549 @@
+#include "VirtualTexture.h"
+#include "Shader.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define vtSeek _fseeki64
+#define vtTell _ftelli64
+#else
+#define vtSeek fseeko
+#define vtTell ftello
+#endif
+
+namespace
+{
+    const char COOKED_MAGIC[4] = { 'V', 'T', 'E', 'X' };
+    const int COOKED_VERSION = 1;
+
+    // written at the start of a cooked file, followed by every page of level 0, then level 1 ... row by row
+    struct CookedHeader
+    {
+        char Magic[4];
+        int32_t Version;
+        int32_t VirtualSize;
+        int32_t TileSize;
+        int32_t Border;
+        int32_t Levels;
+    };
+
+    const int SLOT_SIZE = VirtualTexture::TILE_SIZE + 2 * VirtualTexture::BORDER;
+    const size_t PAGE_BYTES = (size_t)SLOT_SIZE * SLOT_SIZE * 4;
+    const unsigned long long PINNED = ULLONG_MAX;
+
+    // levels of the page pyramid down to a single page
+    int levelsFor(int pages)
+    {
+        int levels = 1;
+        while ((pages >> (levels - 1)) > 1)
+            levels++;
+        return levels;
+    }
+
+    bool isValidSize(int virtualSize)
+    {
+        return virtualSize >= VirtualTexture::TILE_SIZE && virtualSize <= VirtualTexture::MAX_PAGES * VirtualTexture::TILE_SIZE
+            && (virtualSize & (virtualSize - 1)) == 0;
+    }
+
+    // 2x2 box filtered RGBA mip chain of the source image
+    std::vector<std::vector<unsigned char>> buildMips(const unsigned char* pixels, int width, int height, std::vector<int>& sizes)
+    {
+        std::vector<std::vector<unsigned char>> mips(1, std::vector<unsigned char>(pixels, pixels + (size_t)width * height * 4));
+        sizes = { width, height };
+        while (width > 1 && height > 1)
+        {
+            int w = width / 2, h = height / 2;
+            const std::vector<unsigned char>& src = mips.back();
+            std::vector<unsigned char> dst((size_t)w * h * 4);
+            for (int y = 0; y < h; y++)
+                for (int x = 0; x < w; x++)
+                    for (int c = 0; c < 4; c++)
+                    {
+                        int sum = src[((2 * y) * width + 2 * x) * 4 + c] + src[((2 * y) * width + 2 * x + 1) * 4 + c]
+                            + src[((2 * y + 1) * width + 2 * x) * 4 + c] + src[((2 * y + 1) * width + 2 * x + 1) * 4 + c];
+                        dst[((size_t)y * w + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+                    }
+            mips.push_back(std::move(dst));
+            width = w;
+            height = h;
+            sizes.push_back(width);
+            sizes.push_back(height);
+        }
+        return mips;
+    }
+}
+
+bool VirtualTexture::Cook(const std::string& sourcePath, const std::string& cookedPath, int virtualSize)
+{
+    if (!isValidSize(virtualSize))
+    {
+        std::cout << "ERROR::VIRTUAL_TEXTURE::INVALID_SIZE: " << virtualSize << " is not a power of two from " << TILE_SIZE
+            << " to " << MAX_PAGES * TILE_SIZE << std::endl;
+        return false;
+    }
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(sourcePath.c_str(), &width, &height, &channels, 4);
+    if (!pixels)
+    {
+        std::cout << "Failed to load texture " << sourcePath << std::endl;
+        return false;
+    }
+    std::vector<int> sizes;
+    std::vector<std::vector<unsigned char>> mips = buildMips(pixels, width, height, sizes);
+    stbi_image_free(pixels);
+
+    FILE* out = fopen(cookedPath.c_str(), "wb");
+    if (!out)
+    {
+        std::cout << "ERROR::VIRTUAL_TEXTURE::CANNOT_WRITE: " << cookedPath << std::endl;
+        return false;
+    }
+    int pages = virtualSize / TILE_SIZE;
+    int levels = levelsFor(pages);
+    CookedHeader header;
+    memcpy(header.Magic, COOKED_MAGIC, 4);
+    header.Version = COOKED_VERSION;
+    header.VirtualSize = virtualSize;
+    header.TileSize = TILE_SIZE;
+    header.Border = BORDER;
+    header.Levels = levels;
+    bool written = fwrite(&header, sizeof(header), 1, out) == 1;
+
+    // the source repeats over the virtual texture, level L samples source mip L with wrapping,
+    // so every page (borders included) is generated independently and the virtual image never exists in memory
+    std::vector<unsigned char> page(PAGE_BYTES);
+    for (int level = 0; level < levels && written; level++)
+    {
+        int mip = std::min(level, (int)mips.size() - 1);
+        int mipWidth = sizes[mip * 2], mipHeight = sizes[mip * 2 + 1];
+        const std::vector<unsigned char>& source = mips[mip];
+        int levelPages = std::max(pages >> level, 1);
+        for (int py = 0; py < levelPages && written; py++)
+            for (int px = 0; px < levelPages && written; px++)
+            {
+                for (int y = 0; y < SLOT_SIZE; y++)
+                    for (int x = 0; x < SLOT_SIZE; x++)
+                    {
+                        int vx = px * TILE_SIZE + x - BORDER;
+                        int vy = py * TILE_SIZE + y - BORDER;
+                        int sx = ((vx % mipWidth) + mipWidth) % mipWidth;
+                        int sy = ((vy % mipHeight) + mipHeight) % mipHeight;
+                        memcpy(&page[((size_t)y * SLOT_SIZE + x) * 4], &source[((size_t)sy * mipWidth + sx) * 4], 4);
+                    }
+                written = fwrite(page.data(), 1, page.size(), out) == page.size();
+            }
+    }
+    // fclose writes the buffered tail, it fails on a full disk as well
+    written = fclose(out) == 0 && written;
+    if (!written)
+    {
+        // a partial file would pass the header check of every later run
+        std::cout << "ERROR::VIRTUAL_TEXTURE::CANNOT_WRITE: " << cookedPath << std::endl;
+        remove(cookedPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+VirtualTexture::VirtualTexture(const std::string& cookedPath, int atlasSlots) : atlasSlots(atlasSlots)
+{
+    file = fopen(cookedPath.c_str(), "rb");
+    CookedHeader header;
+    if (!file || fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.Magic, COOKED_MAGIC, 4) != 0
+        || header.Version != COOKED_VERSION || header.TileSize != TILE_SIZE || header.Border != BORDER
+        || !isValidSize(header.VirtualSize) || header.Levels != levelsFor(header.VirtualSize / TILE_SIZE))
+    {
+        std::cout << "ERROR::VIRTUAL_TEXTURE::INVALID_COOKED_FILE: " << cookedPath << std::endl;
+        if (file)
+            fclose(file);
+        file = NULL;
+        return;
+    }
+    if (atlasSlots < 1 || atlasSlots > MAX_PAGES)
+    {
+        std::cout << "ERROR::VIRTUAL_TEXTURE::INVALID_ATLAS_SIZE: " << atlasSlots << " slots per side" << std::endl;
+        fclose(file);
+        file = NULL;
+        return;
+    }
+    virtualSize = header.VirtualSize;
+    pages = virtualSize / TILE_SIZE;
+    levels = header.Levels;
+
+    // the single page of the top level is loaded right away and never evicted, every lookup can fall back to it.
+    // the file has to end right after it, a cook cut short leaves a valid header in front of missing pages
+    LoadedPage top;
+    top.Page = pageKey(levels - 1, 0, 0);
+    top.Pixels.resize(PAGE_BYTES);
+    long long topOffset = pageOffset(levels - 1, 0, 0);
+    if (vtSeek(file, 0, SEEK_END) != 0 || vtTell(file) != topOffset + (long long)PAGE_BYTES || vtSeek(file, topOffset, SEEK_SET) != 0
+        || fread(top.Pixels.data(), 1, PAGE_BYTES, file) != PAGE_BYTES)
+    {
+        std::cout << "ERROR::VIRTUAL_TEXTURE::INCOMPLETE_COOKED_FILE: " << cookedPath << std::endl;
+        fclose(file);
+        file = NULL;
+        return;
+    }
+
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    // physical atlas, single level: pages of every mip level are stored side by side
+    glGenTextures(1, &atlas);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlasSlots * SLOT_SIZE, atlasSlots * SLOT_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // indirection: one texel per page, level L of the texture is level L of the page pyramid
+    glGenTextures(1, &indirection);
+    glBindTexture(GL_TEXTURE_2D, indirection);
+    for (int level = 0; level < levels; level++)
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, pagesAt(level), pagesAt(level), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, previous);
+
+    slots.resize((size_t)atlasSlots * atlasSlots);
+    pageSlots.resize(levels);
+    for (int level = 0; level < levels; level++)
+        pageSlots[level].assign((size_t)pagesAt(level) * pagesAt(level), -1);
+
+    requested[top.Page] = Clock::now();
+    uploadPage(top);
+    slots[pageSlots[levels - 1][0]].LastUsed = PINNED;
+    rebuildIndirection();
+
+    thread = std::thread(&VirtualTexture::loaderLoop, this);
+}
+
+VirtualTexture::~VirtualTexture()
+{
+    if (!file)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wakeLoader.notify_all();
+    thread.join();
+    fclose(file);
+
+    glDeleteTextures(1, &atlas);
+    glDeleteTextures(1, &indirection);
+    glDeleteFramebuffers(1, &feedbackFramebuffer);
+    glDeleteTextures(1, &feedbackColor);
+    glDeleteRenderbuffers(1, &feedbackDepth);
+    glDeleteBuffers(2, feedbackBuffers);
+}
+
+void VirtualTexture::Bind(Shader& shader, int indirectionUnit, int atlasUnit)
+{
+    glActiveTexture(GL_TEXTURE0 + indirectionUnit);
+    glBindTexture(GL_TEXTURE_2D, indirection);
+    glActiveTexture(GL_TEXTURE0 + atlasUnit);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    shader.setInt("vtIndirection", indirectionUnit);
+    shader.setInt("vtAtlas", atlasUnit);
+    shader.setFloat("vtPages", (float)pages);
+    shader.setFloat("vtMaxLevel", (float)(levels - 1));
+    shader.setFloat("vtTileSize", (float)TILE_SIZE);
+    shader.setFloat("vtBorder", (float)BORDER);
+    shader.setFloat("vtAtlasSlots", (float)atlasSlots);
+    shader.setFloat("vtFeedbackBias", -std::log2((float)FEEDBACK_DIVISOR));
+}
+
+void VirtualTexture::BeginFeedback(int screenWidth, int screenHeight)
+{
+    int width = std::max(screenWidth / FEEDBACK_DIVISOR, 1);
+    int height = std::max(screenHeight / FEEDBACK_DIVISOR, 1);
+    if (width != feedbackWidth || height != feedbackHeight)
+        createFeedbackTargets(width, height);
+
+    glGetIntegerv(GL_VIEWPORT, savedViewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, feedbackFramebuffer);
+    glViewport(0, 0, feedbackWidth, feedbackHeight);
+    // alpha 0 marks pixels without a virtual texture
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void VirtualTexture::EndFeedback()
+{
+    // start the read of this frame, then map last frame's buffer which is done by now
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackBuffers[feedbackIndex]);
+    glReadPixels(0, 0, feedbackWidth, feedbackHeight, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    feedbackIndex ^= 1;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackBuffers[feedbackIndex]);
+    const unsigned char* pixels = (const unsigned char*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (pixels)
+    {
+        processFeedback(pixels, feedbackWidth * feedbackHeight);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+}
+
+void VirtualTexture::Update()
+{
+    std::vector<LoadedPage> pending;
+    std::vector<int> unreadable;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t count = std::min(loaded.size(), (size_t)MAX_UPLOADS_PER_FRAME);
+        pending.assign(std::make_move_iterator(loaded.begin()), std::make_move_iterator(loaded.begin() + count));
+        loaded.erase(loaded.begin(), loaded.begin() + count);
+        unreadable.swap(failed);
+    }
+    for (int page : unreadable)
+        requested.erase(page);
+    for (LoadedPage& page : pending)
+        uploadPage(page);
+    if (indirectionDirty)
+        rebuildIndirection();
+}
+
+size_t VirtualTexture::GetResidentBytes() const
+{
+    return (size_t)ResidentPages * PAGE_BYTES;
+}
+
+size_t VirtualTexture::GetVirtualBytes() const
+{
+    size_t count = 0;
+    for (int level = 0; level < levels; level++)
+        count += (size_t)pagesAt(level) * pagesAt(level);
+    return count * TILE_SIZE * TILE_SIZE * 4;
+}
+
+long long VirtualTexture::pageOffset(int level, int x, int y) const
+{
+    long long offset = sizeof(CookedHeader);
+    for (int l = 0; l < level; l++)
+        offset += (long long)pagesAt(l) * pagesAt(l) * PAGE_BYTES;
+    return offset + ((long long)y * pagesAt(level) + x) * PAGE_BYTES;
+}
+
+void VirtualTexture::createFeedbackTargets(int width, int height)
+{
+    feedbackWidth = width;
+    feedbackHeight = height;
+    if (!feedbackFramebuffer)
+    {
+        glGenFramebuffers(1, &feedbackFramebuffer);
+        glGenTextures(1, &feedbackColor);
+        glGenRenderbuffers(1, &feedbackDepth);
+        glGenBuffers(2, feedbackBuffers);
+    }
+
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    glBindTexture(GL_TEXTURE_2D, feedbackColor);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, previous);
+    glBindRenderbuffer(GL_RENDERBUFFER, feedbackDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, feedbackFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, feedbackColor, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, feedbackDepth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::VIRTUAL_TEXTURE::FEEDBACK_FRAMEBUFFER_INCOMPLETE" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // both buffers start out zeroed so the first map does not request garbage
+    std::vector<unsigned char> zeros((size_t)width * height * 4, 0);
+    for (int i = 0; i < 2; i++)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackBuffers[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, zeros.size(), zeros.data(), GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void VirtualTexture::processFeedback(const unsigned char* pixels, int count)
+{
+    frame++;
+    // neighbouring pixels mostly request the same page, dedupe before touching any map
+    std::vector<int> keys;
+    int previous = -1;
+    for (int i = 0; i < count; i++)
+    {
+        const unsigned char* pixel = pixels + i * 4;
+        if (pixel[3] == 0)
+            continue;
+        int level = std::min((int)pixel[2], levels - 1);
+        int key = pageKey(level, std::min((int)pixel[0], pagesAt(level) - 1), std::min((int)pixel[1], pagesAt(level) - 1));
+        if (key != previous)
+            keys.push_back(key);
+        previous = key;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<int> missing;
+    for (int key : keys)
+    {
+        int level = key >> 24, y = (key >> 12) & 0xfff, x = key & 0xfff;
+        // the page and its ancestors: the ancestors are what the shader falls back to until the page arrives
+        for (; level < levels; level++, x >>= 1, y >>= 1)
+        {
+            int page = pageKey(level, x, y);
+            int slot = pageSlots[level][(size_t)y * pagesAt(level) + x];
+            if (slot >= 0)
+            {
+                if (slots[slot].LastUsed != PINNED)
+                    slots[slot].LastUsed = frame;
+            }
+            else if (requested.find(page) == requested.end())
+            {
+                requested[page] = Clock::now();
+                missing.push_back(page);
+            }
+        }
+    }
+    if (missing.empty())
+        return;
+
+    // coarse levels first, they cover more of the screen and make the fallback better sooner
+    std::sort(missing.begin(), missing.end(), [](int a, int b) { return (a >> 24) > (b >> 24); });
+    PageRequests += (unsigned int)missing.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        loadQueue.insert(loadQueue.end(), missing.begin(), missing.end());
+    }
+    wakeLoader.notify_one();
+}
+
+int VirtualTexture::allocateSlot()
+{
+    int victim = -1;
+    for (int i = 0; i < (int)slots.size(); i++)
+    {
+        if (slots[i].Page < 0)
+            return i;
+        // pages seen in the latest feedback stay
+        if (slots[i].LastUsed < frame && (victim < 0 || slots[i].LastUsed < slots[victim].LastUsed))
+            victim = i;
+    }
+    if (victim >= 0)
+    {
+        int page = slots[victim].Page;
+        int level = page >> 24, y = (page >> 12) & 0xfff, x = page & 0xfff;
+        pageSlots[level][(size_t)y * pagesAt(level) + x] = -1;
+        slots[victim].Page = -1;
+        ResidentPages--;
+        PageEvictions++;
+        indirectionDirty = true;
+    }
+    return victim;
+}
+
+void VirtualTexture::uploadPage(LoadedPage& page)
+{
+    int level = page.Page >> 24, y = (page.Page >> 12) & 0xfff, x = page.Page & 0xfff;
+    auto request = requested.find(page.Page);
+    int slot = allocateSlot();
+    if (slot < 0)
+    {
+        // every slot is in use by visible pages, the page is requested again by a later feedback
+        if (request != requested.end())
+            requested.erase(request);
+        return;
+    }
+
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, (slot % atlasSlots) * SLOT_SIZE, (slot / atlasSlots) * SLOT_SIZE, SLOT_SIZE, SLOT_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, page.Pixels.data());
+    glBindTexture(GL_TEXTURE_2D, previous);
+
+    slots[slot].Page = page.Page;
+    slots[slot].LastUsed = frame;
+    pageSlots[level][(size_t)y * pagesAt(level) + x] = slot;
+    ResidentPages++;
+    PageUploads++;
+    if (request != requested.end())
+    {
+        TotalMissLatency += std::chrono::duration<double>(Clock::now() - request->second).count();
+        requested.erase(request);
+    }
+    indirectionDirty = true;
+}
+
+void VirtualTexture::rebuildIndirection()
+{
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    glBindTexture(GL_TEXTURE_2D, indirection);
+
+    // top down so a missing page can copy the entry of its parent, which is already resolved
+    std::vector<unsigned char> parent, current;
+    for (int level = levels - 1; level >= 0; level--)
+    {
+        int n = pagesAt(level);
+        int parentN = pagesAt(std::min(level + 1, levels - 1));
+        current.assign((size_t)n * n * 4, 0);
+        for (int y = 0; y < n; y++)
+            for (int x = 0; x < n; x++)
+            {
+                unsigned char* entry = &current[((size_t)y * n + x) * 4];
+                int slot = pageSlots[level][(size_t)y * n + x];
+                if (slot >= 0)
+                {
+                    entry[0] = (unsigned char)(slot % atlasSlots);
+                    entry[1] = (unsigned char)(slot / atlasSlots);
+                    entry[2] = (unsigned char)level;
+                    entry[3] = 255;
+                }
+                else if (!parent.empty())
+                    memcpy(entry, &parent[((size_t)(y >> 1) * parentN + (x >> 1)) * 4], 4);
+            }
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, n, n, GL_RGBA, GL_UNSIGNED_BYTE, current.data());
+        parent.swap(current);
+    }
+    glBindTexture(GL_TEXTURE_2D, previous);
+    indirectionDirty = false;
+}
+
+void VirtualTexture::loaderLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wakeLoader.wait(lock, [this] { return !running || !loadQueue.empty(); });
+        if (!running)
+            return;
+        LoadedPage page;
+        page.Page = loadQueue.front();
+        loadQueue.pop_front();
+
+        lock.unlock();
+        int level = page.Page >> 24, y = (page.Page >> 12) & 0xfff, x = page.Page & 0xfff;
+        page.Pixels.resize(PAGE_BYTES);
+        vtSeek(file, pageOffset(level, x, y), SEEK_SET);
+        bool ok = fread(page.Pixels.data(), 1, PAGE_BYTES, file) == PAGE_BYTES;
+        lock.lock();
+
+        if (ok)
+            loaded.push_back(std::move(page));
+        else
+        {
+            std::cout << "ERROR::VIRTUAL_TEXTURE::PAGE_READ_FAILED" << std::endl;
+            failed.push_back(page.Page);
+        }
+    }
+}
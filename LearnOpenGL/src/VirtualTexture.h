@@ -0,0 +1,124 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Shader;
+
+// Sparse/virtual texture: the texture lives in a cooked file split into TILE_SIZE x TILE_SIZE pages per mip level,
+// only the pages the camera actually sees are streamed into a physical tile atlas. A feedback pass renders the
+// requested page/mip per pixel into a small framebuffer, the pages are read from disk on a background thread
+// and an indirection texture (one texel per page, with a mip chain) maps virtual uvs to atlas slots.
+// shaders sample it through shaders/Common/VirtualTexture.glsl.
+class VirtualTexture
+{
+public:
+    // content texels per page side
+    static const int TILE_SIZE = 128;
+    // texels copied from the neighbouring pages on every side so bilinear filtering does not bleed between slots
+    static const int BORDER = 4;
+    // feedback framebuffer is this many times smaller than the screen
+    static const int FEEDBACK_DIVISOR = 8;
+    // uploads per frame, bounds the hitch when many pages arrive together
+    static const int MAX_UPLOADS_PER_FRAME = 16;
+    // page and slot coordinates go through the RGBA8 feedback and indirection textures, which limits both the
+    // virtual texture (MAX_PAGES * TILE_SIZE texels) and the atlas to this many pages per side
+    static const int MAX_PAGES = 256;
+
+    // cooks sourcePath into a virtualSize x virtualSize virtual texture (power of two up to MAX_PAGES * TILE_SIZE,
+    // the source is repeated)
+    static bool Cook(const std::string& sourcePath, const std::string& cookedPath, int virtualSize);
+
+    // opens a cooked file and creates an atlas of atlasSlots x atlasSlots pages, at most MAX_PAGES
+    VirtualTexture(const std::string& cookedPath, int atlasSlots = 16);
+    ~VirtualTexture();
+    bool IsValid() const { return file != NULL; }
+
+    // binds the indirection and atlas textures to the given units and sets the sampling uniforms on shader
+    void Bind(Shader& shader, int indirectionUnit, int atlasUnit);
+    // feedback pass: binds the feedback framebuffer and viewport, draw the scene with the feedback shader in between
+    void BeginFeedback(int screenWidth, int screenHeight);
+    // reads the feedback back (one frame late, through a PBO so the pipeline does not stall) and queues page loads
+    void EndFeedback();
+    // uploads pages the loader finished and refreshes the indirection texture, call once per frame
+    void Update();
+
+    // statistics
+    unsigned int ResidentPages = 0;
+    unsigned int PageRequests = 0;   // distinct missing pages requested
+    unsigned int PageUploads = 0;
+    unsigned int PageEvictions = 0;
+    double TotalMissLatency = 0.0;   // seconds from the feedback request until the page is in the atlas
+    size_t GetResidentBytes() const;
+    size_t GetVirtualBytes() const;
+    double GetAverageMissLatency() const { return PageUploads ? TotalMissLatency / PageUploads : 0.0; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Slot
+    {
+        int Page = -1;                  // page key, -1 when free
+        unsigned long long LastUsed = 0;
+    };
+
+    struct LoadedPage
+    {
+        int Page;
+        std::vector<unsigned char> Pixels;
+    };
+
+    FILE* file = NULL;
+    int virtualSize = 0;
+    int pages = 0;                      // pages per side at level 0
+    int levels = 0;
+    int atlasSlots = 0;
+    unsigned int atlas = 0;
+    unsigned int indirection = 0;
+    unsigned int feedbackFramebuffer = 0;
+    unsigned int feedbackColor = 0;
+    unsigned int feedbackDepth = 0;
+    unsigned int feedbackBuffers[2] = { 0, 0 };
+    int feedbackWidth = 0;
+    int feedbackHeight = 0;
+    int feedbackIndex = 0;
+    GLint savedViewport[4];
+    unsigned long long frame = 0;
+
+    std::vector<Slot> slots;
+    // slot per page, per level
+    std::vector<std::vector<int>> pageSlots;
+    // when each requested page was asked for
+    std::unordered_map<int, Clock::time_point> requested;
+    bool indirectionDirty = true;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wakeLoader;
+    std::deque<int> loadQueue;
+    std::vector<LoadedPage> loaded;
+    // pages the loader could not read, Update() drops their requests so a later feedback asks again
+    std::vector<int> failed;
+    bool running = true;
+
+    static int pageKey(int level, int x, int y) { return (level << 24) | (y << 12) | x; }
+    int pagesAt(int level) const { return pages >> level > 0 ? pages >> level : 1; }
+    long long pageOffset(int level, int x, int y) const;
+
+    void createFeedbackTargets(int width, int height);
+    void processFeedback(const unsigned char* pixels, int count);
+    int allocateSlot();
+    void uploadPage(LoadedPage& page);
+    void rebuildIndirection();
+    void loaderLoop();
+};
@@ -0,0 +1,215 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include "VirtualTexturing.h"
+#include "../ShaderPermutations.h"
+#include "../GLExtensions.h"
+#include "../Camera.h"
+#include "../VirtualTexture.h"
+
+namespace VirtualTexturing
+{
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+    void processInput(GLFWwindow* window);
+
+    // settings
+    const unsigned int SCR_WIDTH = 800;
+    const unsigned int SCR_HEIGHT = 600;
+
+    // Wall.jpg repeated over a VIRTUAL_SIZE x VIRTUAL_SIZE texture, cooked once next to the source
+    const char* SOURCE_TEXTURE = "textures/Wall.jpg";
+    const char* COOKED_TEXTURE = "textures/Wall.vtex";
+    const int VIRTUAL_SIZE = 8192;
+    // the ground plane the texture is stretched over, in world units
+    const float GROUND_SIZE = 200.0f;
+
+    // the scripted fly-through advances by a fixed step per frame so every run sees the same camera path
+    const float SCRIPT_STEP = 1.0f / 60.0f;
+    const float SCRIPT_DURATION = 30.0f;
+
+    // camera
+    Camera camera(glm::vec3(0.0f, 4.0f, GROUND_SIZE * 0.4f), glm::vec3(0.0f, 1.0f, 0.0f), YAW, -20.0f);
+
+    // moves the camera along a fixed low flight over the ground, looking ahead and slightly down
+    void updateFlyThrough(float time)
+    {
+        float radius = GROUND_SIZE * 0.35f;
+        float angle = time * 0.15f;
+        camera.Position = glm::vec3(radius * cos(angle), 3.0f + 2.0f * sin(time * 0.4f), radius * sin(angle));
+        // tangent of the circle, pitch dips now and then to look at the texture up close
+        camera.Yaw = glm::degrees(angle) + 90.0f;
+        camera.Pitch = -15.0f - 10.0f * (0.5f + 0.5f * sin(time * 0.25f));
+        camera.ProcessMouseMovement(0.0f, 0.0f);
+    }
+
+    void printStats(const VirtualTexture& texture, float time)
+    {
+        printf("t=%5.1fs resident pages %4u (%7.2f MB of %8.2f MB virtual) requests %5u uploads %5u evictions %5u avg miss latency %6.2f ms\n",
+            time, texture.ResidentPages, texture.GetResidentBytes() / (1024.0 * 1024.0), texture.GetVirtualBytes() / (1024.0 * 1024.0),
+            texture.PageRequests, texture.PageUploads, texture.PageEvictions, texture.GetAverageMissLatency() * 1000.0);
+    }
+
+    int Main()
+    {
+        // glfw: initialize and configure
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+        // glfw window creation
+        GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+        // glad: load all OpenGL function pointers
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
+
+        // configure global opengl state
+        glEnable(GL_DEPTH_TEST);
+
+        // cook the virtual texture on first run
+        stbi_set_flip_vertically_on_load(true);
+        FILE* cooked = fopen(COOKED_TEXTURE, "rb");
+        if (cooked)
+            fclose(cooked);
+        else
+        {
+            std::cout << "Cooking " << COOKED_TEXTURE << "..." << std::endl;
+            if (!VirtualTexture::Cook(SOURCE_TEXTURE, COOKED_TEXTURE, VIRTUAL_SIZE))
+                return -1;
+        }
+        VirtualTexture texture(COOKED_TEXTURE);
+        if (!texture.IsValid())
+            return -1;
+
+        // the same shader renders the scene and, with FEEDBACK, the requested pages
+        ShaderPermutations shaders("shaders/VertexShaders/Textures.vs", "shaders/FragmentShaders/VirtualTexture.fs", { "FEEDBACK" });
+        const unsigned int FEEDBACK = shaders.Mask("FEEDBACK");
+        shaders.Precompile({ 0, FEEDBACK });
+
+        // ground plane
+        float half = GROUND_SIZE * 0.5f;
+        float vertices[] = {
+            -half, 0.0f, -half,  0.0f, 1.0f,
+             half, 0.0f, -half,  1.0f, 1.0f,
+             half, 0.0f,  half,  1.0f, 0.0f,
+             half, 0.0f,  half,  1.0f, 0.0f,
+            -half, 0.0f,  half,  0.0f, 0.0f,
+            -half, 0.0f, -half,  0.0f, 1.0f
+        };
+
+        unsigned int VAO, VBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        // position attribute
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        // texture coordinate attribute
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        // render loop
+        float scriptTime = 0.0f;
+        float nextReport = 1.0f;
+        while (!glfwWindowShouldClose(window) && scriptTime < SCRIPT_DURATION)
+        {
+            // input
+            processInput(window);
+            updateFlyThrough(scriptTime);
+
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)width / (float)height, 0.1f, GROUND_SIZE * 1.5f);
+            glm::mat4 view = camera.GetViewMatrix();
+
+            // feedback pass: which pages does this frame need
+            texture.BeginFeedback(width, height);
+            Shader& feedbackShader = shaders.Get(FEEDBACK);
+            feedbackShader.use();
+            texture.Bind(feedbackShader, 0, 1);
+            feedbackShader.setMat4("projection", projection);
+            feedbackShader.setMat4("view", view);
+            feedbackShader.setMat4("model", glm::mat4(1.0f));
+            glBindVertexArray(VAO);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            texture.EndFeedback();
+
+            // stream in what the loader finished
+            texture.Update();
+
+            // render
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            Shader& shader = shaders.Get(0);
+            shader.use();
+            texture.Bind(shader, 0, 1);
+            shader.setMat4("projection", projection);
+            shader.setMat4("view", view);
+            shader.setMat4("model", glm::mat4(1.0f));
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+
+            scriptTime += SCRIPT_STEP;
+            if (scriptTime >= nextReport)
+            {
+                printStats(texture, scriptTime);
+                nextReport += 1.0f;
+            }
+
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        printStats(texture, scriptTime);
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+
+        // the shader stages still held by programs go while the context is current
+        Shader::ReleaseStageCache();
+
+        // glfw: terminate, clearing all previously allocated GLFW resources.
+        glfwTerminate();
+        return 0;
+    }
+
+    // glfw: whenever the window size changed (by OS or user resize) this callback function executes
+    void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+    {
+        // make sure the viewport matches the new window dimensions; note that width and 
+        // height will be significantly larger than specified on retina displays.
+        glViewport(0, 0, width, height);
+    }
+
+    // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+    void processInput(GLFWwindow* window)
+    {
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, true);
+    }
+}
@@ -0,0 +1,4 @@
+namespace VirtualTexturing
+{
+    int Main();
+};